@@ -0,0 +1,169 @@
+/*
+ *****************************************************************************
+ *                                                                           *
+ *                 IMPINJ CONFIDENTIAL AND PROPRIETARY                       *
+ *                                                                           *
+ * This source code is the sole property of Impinj, Inc.  Reproduction or    *
+ * utilization of this source code in whole or in part is forbidden without  *
+ * the prior written consent of Impinj, Inc.                                 *
+ *                                                                           *
+ * (c) Copyright Impinj, Inc. 2009. All rights reserved.                     *
+ *                                                                           *
+ *****************************************************************************
+ */
+
+/*
+ *****************************************************************************
+ *
+ * $Id$
+ *
+ * Description: Routines for reading and changing 32-bit and 64-bit values
+ *     and pointers atomically, which Windows calls interlocked operations.
+ *     Each one is also a full memory barrier.
+ *
+ *****************************************************************************
+ */
+
+#ifndef COMPAT_ATOMIC_
+#define COMPAT_ATOMIC_
+
+#include <windows.h>
+
+#include "compat_lib.h"
+
+/****************************************************************************
+ * Name:        CPL_Atomic32, CPL_Atomic64
+ * Description: The types of the values that the routines below change.
+ *              Declare the values volatile.
+ ****************************************************************************/
+typedef LONG CPL_Atomic32;
+typedef LONGLONG CPL_Atomic64;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/****************************************************************************
+ *  Function:    CPL_AtomicExchange32
+ *  Description: Sets a value.
+ *  Parameters:  target  [IN/OUT] The value to set.
+ *               value   [IN] The new value.
+ *  Returns:     The old value.
+ ****************************************************************************/
+inline CPL_Atomic32 CPL_AtomicExchange32(volatile CPL_Atomic32 *target,
+                                         CPL_Atomic32 value) {
+    return InterlockedExchange(target, value);
+}
+
+/****************************************************************************
+ *  Function:    CPL_AtomicCompareExchange32
+ *  Description: Sets a value, but only if it holds what the caller expects.
+ *  Parameters:  target    [IN/OUT] The value to set.
+ *               value     [IN] The new value.
+ *               comparand [IN] The value that target must hold to be set.
+ *  Returns:     The old value; target was set if it equals comparand.
+ ****************************************************************************/
+inline CPL_Atomic32 CPL_AtomicCompareExchange32(volatile CPL_Atomic32 *target,
+                                                CPL_Atomic32 value,
+                                                CPL_Atomic32 comparand) {
+    return InterlockedCompareExchange(target, value, comparand);
+}
+
+/****************************************************************************
+ *  Function:    CPL_AtomicAdd32
+ *  Description: Adds to a value.
+ *  Parameters:  target  [IN/OUT] The value to add to.
+ *               value   [IN] The amount to add, which may be negative.
+ *  Returns:     The old value.
+ ****************************************************************************/
+inline CPL_Atomic32 CPL_AtomicAdd32(volatile CPL_Atomic32 *target,
+                                    CPL_Atomic32 value) {
+    return InterlockedExchangeAdd(target, value);
+}
+
+/****************************************************************************
+ *  Function:    CPL_AtomicIncrement32
+ *  Description: Adds one to a value.
+ *  Parameters:  target  [IN/OUT] The value to increment.
+ *  Returns:     The new value.
+ ****************************************************************************/
+inline CPL_Atomic32 CPL_AtomicIncrement32(volatile CPL_Atomic32 *target) {
+    return InterlockedIncrement(target);
+}
+
+/****************************************************************************
+ *  Function:    CPL_AtomicDecrement32
+ *  Description: Subtracts one from a value.
+ *  Parameters:  target  [IN/OUT] The value to decrement.
+ *  Returns:     The new value.
+ ****************************************************************************/
+inline CPL_Atomic32 CPL_AtomicDecrement32(volatile CPL_Atomic32 *target) {
+    return InterlockedDecrement(target);
+}
+
+/****************************************************************************
+ *  Function:    CPL_AtomicExchange64
+ *  Description: Sets a 64-bit value.
+ *  Parameters:  target  [IN/OUT] The value to set.
+ *               value   [IN] The new value.
+ *  Returns:     The old value.
+ ****************************************************************************/
+inline CPL_Atomic64 CPL_AtomicExchange64(volatile CPL_Atomic64 *target,
+                                         CPL_Atomic64 value) {
+    return InterlockedExchange64(target, value);
+}
+
+/****************************************************************************
+ *  Function:    CPL_AtomicCompareExchange64
+ *  Description: Sets a 64-bit value, but only if it holds what the caller
+ *               expects.  Also the way to read a 64-bit value atomically on
+ *               a 32-bit host (with value and comparand the same).
+ *  Parameters:  target    [IN/OUT] The value to set.
+ *               value     [IN] The new value.
+ *               comparand [IN] The value that target must hold to be set.
+ *  Returns:     The old value; target was set if it equals comparand.
+ ****************************************************************************/
+inline CPL_Atomic64 CPL_AtomicCompareExchange64(volatile CPL_Atomic64 *target,
+                                                CPL_Atomic64 value,
+                                                CPL_Atomic64 comparand) {
+    return InterlockedCompareExchange64(target, value, comparand);
+}
+
+/****************************************************************************
+ *  Function:    CPL_AtomicAdd64
+ *  Description: Adds to a 64-bit value.
+ *  Parameters:  target  [IN/OUT] The value to add to.
+ *               value   [IN] The amount to add, which may be negative.
+ *  Returns:     The old value.
+ ****************************************************************************/
+inline CPL_Atomic64 CPL_AtomicAdd64(volatile CPL_Atomic64 *target,
+                                    CPL_Atomic64 value) {
+    return InterlockedExchangeAdd64(target, value);
+}
+
+/****************************************************************************
+ *  Function:    CPL_AtomicIncrement64
+ *  Description: Adds one to a 64-bit value.
+ *  Parameters:  target  [IN/OUT] The value to increment.
+ *  Returns:     The new value.
+ ****************************************************************************/
+inline CPL_Atomic64 CPL_AtomicIncrement64(volatile CPL_Atomic64 *target) {
+    return InterlockedIncrement64(target);
+}
+
+/****************************************************************************
+ *  Function:    CPL_AtomicExchangePointer
+ *  Description: Sets a pointer.
+ *  Parameters:  target  [IN/OUT] The pointer to set.
+ *               value   [IN] The new pointer.
+ *  Returns:     The old pointer.
+ ****************************************************************************/
+inline void *CPL_AtomicExchangePointer(void * volatile *target, void *value) {
+    return InterlockedExchangePointer(target, value);
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* COMPAT_ATOMIC_ */
@@ -45,6 +45,17 @@ struct priv_CPL_Thread {
 typedef struct priv_CPL_Thread CPL_Thread;
 typedef DWORD CPL_ThreadID;
 
+/****************************************************************************
+ * Name:        CPL_ThreadKey, CPL_ThreadKeyDestructor
+ * Description: A key to a value that each thread keeps its own copy of,
+ *              and the routine that is called with a thread's copy, if it
+ *              is not NULL, when the thread exits or the key is deleted.
+ *              Declare the routine CPL_THREAD_KEY_CALLBACK.
+ ****************************************************************************/
+typedef DWORD CPL_ThreadKey;
+#define CPL_THREAD_KEY_CALLBACK WINAPI
+typedef VOID (CPL_THREAD_KEY_CALLBACK *CPL_ThreadKeyDestructor)(PVOID);
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -99,6 +110,52 @@ CPL_EXPORT void CPL_ThreadExit(void * value_ptr);
 
 inline CPL_ThreadID CPL_ThreadGetID(void) { return GetCurrentThreadId(); }
 
+/****************************************************************************
+ *  Function:    CPL_ThreadKeyCreate
+ *  Description: Creates a key whose value is NULL in every thread.
+ *  Parameters:  key        [OUT] Where to store the new key.
+ *               destructor [IN]  Called with a thread's value when the
+ *                                thread exits, or NULL.
+ *  Returns:     Zero on success, or a CPL_GetError() code on failure.
+ ****************************************************************************/
+inline INT32U CPL_ThreadKeyCreate(CPL_ThreadKey *key,
+                                  CPL_ThreadKeyDestructor destructor) {
+    *key = FlsAlloc(destructor);
+    return (FLS_OUT_OF_INDEXES == *key) ? GetLastError() : 0;
+}
+
+/****************************************************************************
+ *  Function:    CPL_ThreadKeyDelete
+ *  Description: Deletes a key, calling its destructor with each thread's
+ *               value that is not NULL.
+ *  Parameters:  key  [IN] The key to delete.
+ *  Returns:     Zero on success, or a CPL_GetError() code on failure.
+ ****************************************************************************/
+inline INT32U CPL_ThreadKeyDelete(CPL_ThreadKey key) {
+    return FlsFree(key) ? 0 : GetLastError();
+}
+
+/****************************************************************************
+ *  Function:    CPL_ThreadKeyGet
+ *  Description: Retrieves the calling thread's value for a key.
+ *  Parameters:  key  [IN] The key.
+ *  Returns:     The value, which is NULL until the thread sets it.
+ ****************************************************************************/
+inline void *CPL_ThreadKeyGet(CPL_ThreadKey key) {
+    return FlsGetValue(key);
+}
+
+/****************************************************************************
+ *  Function:    CPL_ThreadKeySet
+ *  Description: Sets the calling thread's value for a key.
+ *  Parameters:  key    [IN] The key.
+ *               value  [IN] The new value.
+ *  Returns:     Zero on success, or a CPL_GetError() code on failure.
+ ****************************************************************************/
+inline INT32U CPL_ThreadKeySet(CPL_ThreadKey key, void *value) {
+    return FlsSetValue(key, value) ? 0 : GetLastError();
+}
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
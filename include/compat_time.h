@@ -113,6 +113,31 @@ inline void CPL_MillisecondSleep(int msecs) {
     Sleep(msecs);
 }
 
+/****************************************************************************
+ *  Function:    CPL_TickCountGet
+ *  Description: Reads a high-resolution counter, which is cheap to read and
+ *               never goes backwards, for measuring short durations.
+ *  Parameters:  None.
+ *  Returns:     The counter, in ticks (see CPL_TickFrequencyGet).
+ ****************************************************************************/
+inline INT64U CPL_TickCountGet(void) {
+    LARGE_INTEGER count;
+    QueryPerformanceCounter(&count);
+    return (INT64U)count.QuadPart;
+}
+
+/****************************************************************************
+ *  Function:    CPL_TickFrequencyGet
+ *  Description: Returns the rate of the counter CPL_TickCountGet reads.
+ *  Parameters:  None.
+ *  Returns:     Ticks per second.
+ ****************************************************************************/
+inline INT64U CPL_TickFrequencyGet(void) {
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    return (INT64U)frequency.QuadPart;
+}
+
 /****************************************************************************
  *  Function:    CPL_TimeSpecToCalendarTime
  *  Description: Takes a time in "number of seconds since January 1, 1970"
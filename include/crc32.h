@@ -0,0 +1,61 @@
+/*
+ *****************************************************************************
+ *                                                                           *
+ *                 IMPINJ CONFIDENTIAL AND PROPRIETARY                       *
+ *                                                                           *
+ * This source code is the sole property of Impinj, Inc.  Reproduction or    *
+ * utilization of this source code in whole or in part is forbidden without  *
+ * the prior written consent of Impinj, Inc.                                 *
+ *                                                                           *
+ * (c) Copyright Impinj, Inc. 2009. All rights reserved.                     *
+ *                                                                           *
+ *****************************************************************************
+ */
+
+/*
+ *****************************************************************************
+ *
+ * $Id$
+ *
+ * Description:
+ *     This header presents the CRC-32 that the MAC uses to check the NV
+ *     update packets and that the library uses to check a saved radio
+ *     configuration.  It is the MSB-first CRC with the polynomial 0x04c11db7,
+ *     with no reflection and no final inversion, so that a sum can be carried
+ *     from one call to the next.
+ *
+ *
+ *****************************************************************************
+ */
+
+#ifndef CRC32_H_INCLUDED
+#define CRC32_H_INCLUDED
+
+#include "rfid_platform_types.h"
+
+namespace rfid
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: FastCrc32
+//
+// Description:
+//   Adds bytes to a CRC-32
+//
+// Parameters:
+//   sum - the current value of sum
+//   p - byte pointer to the data to be summed
+//   len - the number of bytes to sum starting from p
+//
+// Returns:
+//   The updated value of sum
+////////////////////////////////////////////////////////////////////////////////
+INT32U FastCrc32(
+    INT32U          sum,
+    const INT8U*    p,
+    INT32U          len
+    );
+
+} // namespace rfid
+
+#endif // #ifndef CRC32_H_INCLUDED
@@ -33,6 +33,7 @@
 #include "hostpkts.h"
 #include "rfid_exceptions.h"
 #include "rfid_extern.h"
+#include "rfid_probes.h"
 #include "tracer.h"
 
 namespace rfid
@@ -44,7 +45,8 @@ namespace rfid
 Mac::Mac(
     std::auto_ptr<MacTransport> pTransport
     ) :
-    m_pTransport(pTransport)
+    m_pTransport(pTransport),
+    m_pStatistics(NULL)
 {
     assert(NULL != m_pTransport.get());
 
@@ -134,6 +136,9 @@ INT32U Mac::RetrieveData(
     INT32U  bufferSize
     )
 {
+    m_pStatistics->Count(RadioStatistics::COUNTER_TRANSPORT_READS);
+    m_pStatistics->Count(RadioStatistics::COUNTER_BYTES_RECEIVED, bufferSize);
+
     // Instruct transport driver to read response data from the radio module
     return m_pTransport->ReadRadio(pBuffer, bufferSize);
 } // Mac::RetrieveData
@@ -147,7 +152,7 @@ void Mac::WriteRegister(
     INT32U  value
     )
 {
-    g_pTracer->PrintMessage(
+    RFID_TRACE(
         Tracer::RFID_LOG_SEVERITY_DEBUG,
         "%s: Write 0x%.8x to MAC virtual register 0x%.4x\n",
         __FUNCTION__,
@@ -163,8 +168,56 @@ void Mac::WriteRegister(
         };
     m_pTransport->WriteRadio(reinterpret_cast<INT8U *>(&request),
                              sizeof(request));
+    m_pStatistics->Count(RadioStatistics::COUNTER_REGISTER_WRITES);
+    RFID_PROBE3(register_write,
+        mac, this,
+        address, registerAddress,
+        value, value);
 } // Mac::WriteRegister
 
+////////////////////////////////////////////////////////////////////////////////
+// Name:        Mac::WriteRegisters
+// Description: Requests that values be written to the MAC's registers
+////////////////////////////////////////////////////////////////////////////////
+void Mac::WriteRegisters(
+    const INT16U*   pAddresses,
+    const INT32U*   pValues,
+    INT32U          count
+    )
+{
+    assert((NULL != pAddresses) && (NULL != pValues));
+
+    std::vector<host_reg_req> requests(count);
+
+    for (INT32U index = 0; index < count; ++index)
+    {
+        RFID_TRACE(
+            Tracer::RFID_LOG_SEVERITY_DEBUG,
+            "%s: Write 0x%.8x to MAC virtual register 0x%.4x\n",
+            __FUNCTION__,
+            pValues[index],
+            pAddresses[index]);
+
+        requests[index].access_flg = CPL_HostToMac16(HOST_REG_REQ_ACCESS_WRITE);
+        requests[index].reg_addr   = CPL_HostToMac16(pAddresses[index]);
+        requests[index].reg_data   = CPL_HostToMac32(pValues[index]);
+    }
+
+    // Send the register write requests to the MAC, as many at a time as the
+    // transport can take
+    INT32U perWrite = m_maxBufferSize / sizeof(host_reg_req);
+    perWrite = perWrite ? perWrite : 1;
+
+    for (INT32U index = 0; index < count; index += perWrite)
+    {
+        INT32U chunk = (count - index > perWrite) ? perWrite : count - index;
+
+        m_pTransport->WriteRadio(reinterpret_cast<INT8U *>(&requests[index]),
+                                 chunk * sizeof(host_reg_req));
+    }
+    m_pStatistics->Count(RadioStatistics::COUNTER_REGISTER_WRITES, count);
+} // Mac::WriteRegisters
+
 ////////////////////////////////////////////////////////////////////////////////
 // Name:        Mac::ReadRegister
 // Description: Requests that the value be read from the MAC's register
@@ -173,12 +226,17 @@ INT32U Mac::ReadRegister(
     INT16U  registerAddress
     )
 {
-    g_pTracer->PrintMessage(
+    RFID_TRACE(
         Tracer::RFID_LOG_SEVERITY_DEBUG,
         "%s: Read MAC virtual register 0x%.4x\n",
         __FUNCTION__,
         registerAddress);
 
+    RFID_PROBE2(register_read_begin,
+        mac, this,
+        address, registerAddress);
+    INT64U startTime = StatisticsClock::Now();
+
     // Send the register read request to the MAC
     host_reg_req request =
         {
@@ -196,12 +254,21 @@ INT32U Mac::ReadRegister(
     // Retrieve the register read response.
     m_pTransport->ReadRadio(pBuffer, bufferSize);
 
+    m_pStatistics->RecordRegisterRoundTrip(StatisticsClock::Now() - startTime);
+    m_pStatistics->Count(RadioStatistics::COUNTER_REGISTER_READS);
+    m_pStatistics->Count(RadioStatistics::COUNTER_TRANSPORT_READS);
+    m_pStatistics->Count(RadioStatistics::COUNTER_BYTES_RECEIVED, bufferSize);
+    RFID_PROBE3(register_read_end,
+        mac, this,
+        address, CPL_MacToHost16(response.reg_addr),
+        value, CPL_MacToHost32(response.reg_data));
+
     // If the register returned is not the register read, then we have a
     // problem (state is out of sync with MAC, requested an invalid register,
     // etc.)
     if (CPL_MacToHost16(response.reg_addr) != registerAddress)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_ERROR,
             "%s: Requested MAC virtual register 0x%.4x, but we received "
             "register 0x%.4x\n",
@@ -211,7 +278,7 @@ INT32U Mac::ReadRegister(
         throw RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
     }
 
-    g_pTracer->PrintMessage(
+    RFID_TRACE(
         Tracer::RFID_LOG_SEVERITY_DEBUG,
         "%s: MAC virtual register 0x%.4x returned value 0x%.8x\n",
         __FUNCTION__,
@@ -33,6 +33,7 @@
 #include "rfid_structs.h"
 #include "rfid_constants.h"
 #include "mac_transport.h"
+#include "radio_statistics.h"
 
 namespace rfid
 {
@@ -146,6 +147,23 @@ public:
         INT32U  value
         );
 
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        WriteRegisters
+    // Description: Requests that values be written to the MAC's registers, in
+    //              order.  The requests are handed to the transport together,
+    //              as few writes as its buffer size allows, instead of one
+    //              write per register.
+    // Parameters:  pAddresses - the registers to write
+    //              pValues - the values to write, one per register
+    //              count - the number of registers to write
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void WriteRegisters(
+        const INT16U*   pAddresses,
+        const INT32U*   pValues,
+        INT32U          count
+        );
+
     ////////////////////////////////////////////////////////////////////////////
     // Name:        ReadRegister
     // Description: Requests that the value be read from the MAC's register.
@@ -159,6 +177,34 @@ public:
         INT16U  registerAddress
         );
 
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        SetStatistics
+    // Description: Tells the Mac object where to count the register accesses
+    //              and transport reads.  The statistics belong to the radio
+    //              (which counts the rest) so that they outlive the Mac
+    //              object; the radio calls this before using the Mac object.
+    // Parameters:  pStatistics - the radio's statistics
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void SetStatistics(
+        RadioStatistics*    pStatistics
+        )
+    {
+        m_pStatistics = pStatistics;
+    } // SetStatistics
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        GetTransportHandle
+    // Description: Retrieves the handle of the radio module the Mac object
+    //              talks to, which is the cookie the radio was opened with
+    // Parameters:  None
+    // Returns:     The underlying radio module transport handle
+    ////////////////////////////////////////////////////////////////////////////
+    INT32U GetTransportHandle() const
+    {
+        return m_pTransport->GetTransportHandle();
+    } // GetTransportHandle
+
 private:
     // A pointer to the Mac objects' underlying transport object
     const std::auto_ptr<MacTransport>   m_pTransport;
@@ -168,6 +214,8 @@ private:
     INT32U                              m_maxPacketSize;
     // The driver version for the underlying transport driver
     RFID_VERSION                        m_driverVersion;
+    // What has been done with the radio
+    RadioStatistics*                    m_pStatistics;
 
     // Don't want MAC objects being copied
     Mac(const Mac&);
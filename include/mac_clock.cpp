@@ -0,0 +1,275 @@
+/*
+ *****************************************************************************
+ *                                                                           *
+ *                 IMPINJ CONFIDENTIAL AND PROPRIETARY                       *
+ *                                                                           *
+ * This source code is the sole property of Impinj, Inc.  Reproduction or    *
+ * utilization of this source code in whole or in part is forbidden without  *
+ * the prior written consent of Impinj, Inc.                                 *
+ *                                                                           *
+ * (c) Copyright Impinj, Inc. 2009. All rights reserved.                     *
+ *                                                                           *
+ *****************************************************************************
+ */
+
+/*
+ *****************************************************************************
+ *
+ * $Id$
+ *
+ * Description:
+ *     This file contains the implementation for the MAC clock model.
+ *
+ *
+ *****************************************************************************
+ */
+
+#include <math.h>
+#include "mac_clock.h"
+
+namespace
+{
+    // The length of a window, in MAC milliseconds, and the number of windows
+    // the drift is fitted over
+    const INT64S WINDOW_LENGTH  = 10000;
+    const size_t FIT_WINDOWS    = 30;
+    // The span, in MAC milliseconds, that the windows must cover before the
+    // drift is fitted, and the largest drift believed (1000 ppm)
+    const INT64S MIN_FIT_SPAN   = 30000;
+    const double MAX_DRIFT      = 0.001;
+    // A counter this many milliseconds behind the last one means that the
+    // MAC was reset; anything less is a stale packet
+    const INT32S MAX_BACKSTEP   = 1000;
+    // A quickest packet this many milliseconds off the model means that the
+    // host clock was stepped (e.g., set by hand or by a time server)
+    const double HOST_STEP      = 1000;
+}
+
+namespace rfid
+{
+
+////////////////////////////////////////////////////////////////////////////
+// Name: MacClock
+//
+// Description:
+//   Initializes a clock model that has seen no packets
+////////////////////////////////////////////////////////////////////////////
+MacClock::MacClock()
+{
+    this->Reset();
+} // MacClock::MacClock
+
+////////////////////////////////////////////////////////////////////////////
+// Name: Reset
+//
+// Description:
+//   Forgets everything learned
+////////////////////////////////////////////////////////////////////////////
+void MacClock::Reset()
+{
+    m_samples          = 0;
+    m_lastMacTime      = 0;
+    m_unwrappedMacTime = 0;
+    m_referenceMacTime = 0;
+    m_referenceOffset  = 0;
+    m_drift            = 0;
+    m_windowStart      = 0;
+    m_windowMinimum.macTime = 0;
+    m_windowMinimum.offset  = 0;
+    m_windowMinima.clear();
+} // MacClock::Reset
+
+////////////////////////////////////////////////////////////////////////////
+// Name: AddSample
+//
+// Description:
+//   Adds a packet's MAC time and the host time at which it was received to
+//   the model
+////////////////////////////////////////////////////////////////////////////
+void MacClock::AddSample(
+    INT32U  macTime,
+    INT64U  hostTime
+    )
+{
+    // Unwrap the 32-bit counter, noticing if it started again
+    if (m_samples)
+    {
+        INT32S delta = static_cast<INT32S>(macTime - m_lastMacTime);
+        if (delta < -MAX_BACKSTEP)
+        {
+            this->Reset();
+        }
+        else if (delta < 0)
+        {
+            return;
+        }
+        else
+        {
+            m_unwrappedMacTime += delta;
+        }
+    }
+    if (!m_samples)
+    {
+        m_unwrappedMacTime = macTime;
+    }
+    m_lastMacTime = macTime;
+
+    INT64S offset = static_cast<INT64S>(hostTime) - m_unwrappedMacTime;
+
+    if (0 == m_samples++)
+    {
+        m_referenceMacTime      = m_unwrappedMacTime;
+        m_referenceOffset       = static_cast<double>(offset);
+        m_windowStart           = m_unwrappedMacTime;
+        m_windowMinimum.macTime = m_unwrappedMacTime;
+        m_windowMinimum.offset  = offset;
+        return;
+    }
+
+    // A packet that arrived quicker than the model predicts moves the model
+    // down to it straight away.  If it is a long way quicker, the host clock
+    // was stepped back and the windows before the step no longer lie on the
+    // edge, so they are dropped; the drift is kept.
+    double predicted = m_referenceOffset +
+        (m_unwrappedMacTime - m_referenceMacTime) * m_drift;
+    if (offset < predicted - HOST_STEP)
+    {
+        m_windowMinima.clear();
+        m_windowStart           = m_unwrappedMacTime;
+        m_windowMinimum.macTime = m_unwrappedMacTime;
+        m_windowMinimum.offset  = offset;
+    }
+    if (offset < predicted)
+    {
+        m_referenceMacTime = m_unwrappedMacTime;
+        m_referenceOffset  = static_cast<double>(offset);
+    }
+
+    if (offset < m_windowMinimum.offset)
+    {
+        m_windowMinimum.macTime = m_unwrappedMacTime;
+        m_windowMinimum.offset  = offset;
+    }
+
+    // At the end of a window, refit the drift with its quickest packet.  A
+    // window whose quickest packet is still a long way slower than the model
+    // predicts means that the host clock was stepped forward, so the windows
+    // before the step are dropped, as above.
+    if (m_unwrappedMacTime - m_windowStart >= WINDOW_LENGTH)
+    {
+        if (m_windowMinimum.offset > m_referenceOffset + HOST_STEP +
+            (m_windowMinimum.macTime - m_referenceMacTime) * m_drift)
+        {
+            m_windowMinima.clear();
+        }
+        m_windowMinima.push_back(m_windowMinimum);
+        if (m_windowMinima.size() > FIT_WINDOWS)
+        {
+            m_windowMinima.pop_front();
+        }
+        this->FitDrift();
+
+        m_windowStart           = m_unwrappedMacTime;
+        m_windowMinimum.macTime = m_unwrappedMacTime;
+        m_windowMinimum.offset  = offset;
+    }
+} // MacClock::AddSample
+
+////////////////////////////////////////////////////////////////////////////
+// Name: FitDrift
+//
+// Description:
+//   Fits a line through the windows' quickest packets and re-anchors the
+//   model on the latest of them
+////////////////////////////////////////////////////////////////////////////
+void MacClock::FitDrift()
+{
+    const ENVELOPE_POINT& latest = m_windowMinima.back();
+    ENVELOPE_POINTS::const_iterator point;
+
+    if ((m_windowMinima.size() >= 2) &&
+        (latest.macTime - m_windowMinima.front().macTime >= MIN_FIT_SPAN))
+    {
+        // Least squares, relative to the latest point to keep the sums small
+        double sumX  = 0;
+        double sumY  = 0;
+        double sumXX = 0;
+        double sumXY = 0;
+        double count = static_cast<double>(m_windowMinima.size());
+
+        for (point = m_windowMinima.begin();
+             point != m_windowMinima.end();
+             ++point)
+        {
+            double x = static_cast<double>(point->macTime - latest.macTime);
+            double y = static_cast<double>(point->offset - latest.offset);
+
+            sumX  += x;
+            sumY  += y;
+            sumXX += x * x;
+            sumXY += x * y;
+        }
+
+        double denominator = count * sumXX - sumX * sumX;
+        if (denominator > 0)
+        {
+            m_drift = (count * sumXY - sumX * sumY) / denominator;
+            m_drift = (m_drift >  MAX_DRIFT) ?  MAX_DRIFT :
+                      (m_drift < -MAX_DRIFT) ? -MAX_DRIFT : m_drift;
+        }
+    }
+
+    // Anchor the model on the line with that slope that runs under all of
+    // the windows' quickest packets.  After a step of the host clock the
+    // windows start again, so they are all from after it.
+    m_referenceMacTime = latest.macTime;
+    m_referenceOffset  = static_cast<double>(latest.offset);
+    for (point = m_windowMinima.begin(); point != m_windowMinima.end(); ++point)
+    {
+        double offset = point->offset +
+            (latest.macTime - point->macTime) * m_drift;
+        if (offset < m_referenceOffset)
+        {
+            m_referenceOffset = offset;
+        }
+    }
+} // MacClock::FitDrift
+
+////////////////////////////////////////////////////////////////////////////
+// Name: GetModel
+//
+// Description:
+//   Retrieves the current model
+////////////////////////////////////////////////////////////////////////////
+void MacClock::GetModel(
+    RFID_RADIO_CLOCK_MODEL* pModel
+    ) const
+{
+    pModel->length        = sizeof(RFID_RADIO_CLOCK_MODEL);
+    pModel->valid         = m_samples ? 1 : 0;
+    pModel->samples       = m_samples;
+    pModel->macReference  = static_cast<INT32U>(m_referenceMacTime);
+    pModel->hostReference = static_cast<INT64U>(
+        floor(m_referenceMacTime + m_referenceOffset + 0.5));
+    pModel->drift         = static_cast<INT32S>(floor(m_drift * 1e9 + 0.5));
+} // MacClock::GetModel
+
+////////////////////////////////////////////////////////////////////////////
+// Name: GetHostTime
+//
+// Description:
+//   Converts a MAC time to host time using a model
+////////////////////////////////////////////////////////////////////////////
+INT64U MacClock::GetHostTime(
+    const RFID_RADIO_CLOCK_MODEL&   model,
+    INT32U                          macTime
+    )
+{
+    // The counter may have wrapped either side of the reference
+    INT32S delta = static_cast<INT32S>(macTime - model.macReference);
+
+    return model.hostReference + delta +
+        static_cast<INT64S>(floor(delta * (model.drift / 1e9) + 0.5));
+} // MacClock::GetHostTime
+
+} // namespace rfid
@@ -0,0 +1,178 @@
+/*
+ *****************************************************************************
+ *                                                                           *
+ *                 IMPINJ CONFIDENTIAL AND PROPRIETARY                       *
+ *                                                                           *
+ * This source code is the sole property of Impinj, Inc.  Reproduction or    *
+ * utilization of this source code in whole or in part is forbidden without  *
+ * the prior written consent of Impinj, Inc.                                 *
+ *                                                                           *
+ * (c) Copyright Impinj, Inc. 2009. All rights reserved.                     *
+ *                                                                           *
+ *****************************************************************************
+ */
+
+/*
+ *****************************************************************************
+ *
+ * $Id$
+ *
+ * Description:
+ *     This header presents the interface for the class that models the
+ *     relationship between a MAC's millisecond counter and the host's clock.
+ *
+ *
+ *****************************************************************************
+ */
+
+#ifndef MAC_CLOCK_H_INCLUDED
+#define MAC_CLOCK_H_INCLUDED
+
+#include <deque>
+#include "rfid_platform_types.h"
+#include "rfid_structs.h"
+
+namespace rfid
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: MacClock
+//
+// Description: Fits host time against the MAC's millisecond counter (ms_ctr).
+//   A packet reaches the host some time after the MAC stamped it, and that
+//   delay is never negative, so the packets that arrived quickest lie on the
+//   lower edge of host time minus MAC time.  The model follows that edge: its
+//   offset comes from the quickest packet seen recently and its drift from a
+//   least-squares fit through the quickest packet of each window.
+////////////////////////////////////////////////////////////////////////////////
+class MacClock
+{
+public:
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: MacClock
+    //
+    // Description:
+    //   Initializes a clock model that has seen no packets
+    //
+    // Parameters:
+    //   None
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    MacClock();
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: Reset
+    //
+    // Description:
+    //   Forgets everything learned, e.g., because the MAC has been reset and
+    //   its counter has started again.
+    //
+    // Parameters:
+    //   None
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void Reset();
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: AddSample
+    //
+    // Description:
+    //   Adds a packet's MAC time and the host time at which it was received
+    //   to the model.
+    //
+    // Parameters:
+    //   macTime - the packet's ms_ctr field
+    //   hostTime - the host time, in milliseconds since the epoch, when the
+    //     packet was received
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void AddSample(
+        INT32U  macTime,
+        INT64U  hostTime
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: GetModel
+    //
+    // Description:
+    //   Retrieves the current model.
+    //
+    // Parameters:
+    //   pModel - a pointer to a structure that will receive the model
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void GetModel(
+        RFID_RADIO_CLOCK_MODEL* pModel
+        ) const;
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: GetHostTime
+    //
+    // Description:
+    //   Converts a MAC time to host time using a model.
+    //
+    // Parameters:
+    //   model - the clock model
+    //   macTime - the ms_ctr value to convert
+    //
+    // Returns:
+    //   The host time, in milliseconds since the epoch
+    ////////////////////////////////////////////////////////////////////////////
+    static INT64U GetHostTime(
+        const RFID_RADIO_CLOCK_MODEL&   model,
+        INT32U                          macTime
+        );
+
+private:
+    // The quickest packet of a window: its unwrapped MAC time and its host
+    // time minus MAC time
+    typedef struct
+    {
+        INT64S  macTime;
+        INT64S  offset;
+    } ENVELOPE_POINT;
+    typedef std::deque<ENVELOPE_POINT> ENVELOPE_POINTS;
+
+    // The number of samples added since the last reset
+    INT32U          m_samples;
+    // The last ms_ctr seen and its value unwrapped to 64 bits
+    INT32U          m_lastMacTime;
+    INT64S          m_unwrappedMacTime;
+    // The reference point of the model and the drift of the host clock
+    // relative to the MAC's, i.e., host ms per MAC ms minus one
+    INT64S          m_referenceMacTime;
+    double          m_referenceOffset;
+    double          m_drift;
+    // The unwrapped MAC time the current window began at, its quickest
+    // packet and those of the windows before it
+    INT64S          m_windowStart;
+    ENVELOPE_POINT  m_windowMinimum;
+    ENVELOPE_POINTS m_windowMinima;
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: FitDrift
+    //
+    // Description:
+    //   Fits a line through the windows' quickest packets and re-anchors the
+    //   model on the latest of them.
+    //
+    // Parameters:
+    //   None
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void FitDrift();
+}; // class MacClock
+
+} // namespace rfid
+
+#endif // MAC_CLOCK_H_INCLUDED
@@ -127,6 +127,17 @@ public:
         RFID_MAC_RESET_TYPE resetType
         ) = 0;
 
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        GetTransportHandle
+    // Description: Retrieves the underlying radio module transport handle
+    // Parameters:  None
+    // Returns:     The underlying radio module transport handle
+    ////////////////////////////////////////////////////////////////////////////
+    INT32U GetTransportHandle() const
+    {
+        return m_transportHandle;
+    } // GetTransportHandle
+
 protected:
     ////////////////////////////////////////////////////////////////////////////
     // Name:        MacTransport
@@ -139,17 +150,6 @@ protected:
         INT32U  transportHandle
         );
 
-    ////////////////////////////////////////////////////////////////////////////
-    // Name:        GetTransportHandle
-    // Description: Retrieves the underlying radio module transport handle
-    // Parameters:  None
-    // Returns:     The underlying radio module transport handle
-    ////////////////////////////////////////////////////////////////////////////
-    INT32U GetTransportHandle() const
-    {
-        return m_transportHandle;
-    } // GetTransportHandle
-
 // A macro for calculating the amount of padding
 // l - the length in bytes
 // a - the alignment in bytes (i.e., 4 = 4-byte or 32-bit alignment)
@@ -37,6 +37,7 @@
 #include "auto_lock_compat.h"
 
 #include "rfid_extern.h"
+#include "rfid_probes.h"
 
 namespace rfid
 {
@@ -61,14 +62,14 @@ MacTransportLive::MacTransportLive(
     switch (status)
     {
         case CPL_SUCCESS:
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_DEBUG,
                 "%s: Radio 0x%.8x opened succesfully\n",
                 __FUNCTION__,
                 transportHandle);
             break;
         case CPL_ERROR_BUSY:
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_INFO,
                 "%s: Radio 0x%.8x already opened\n",
                 __FUNCTION__,
@@ -76,7 +77,7 @@ MacTransportLive::MacTransportLive(
             throw RfidErrorException(RFID_ERROR_ALREADY_OPEN, __FUNCTION__);
             break;
         case CPL_ERROR_NOTFOUND:
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_INFO,
                 "%s: Radio 0x%.8x does not exist\n",
                 __FUNCTION__,
@@ -84,7 +85,7 @@ MacTransportLive::MacTransportLive(
             throw RfidErrorException(RFID_ERROR_NO_SUCH_RADIO, __FUNCTION__);
             break;
         case CPL_ERROR_DEVICEGONE:
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_INFO,
                 "%s: Radio 0x%.8x has been detached\n",
                 __FUNCTION__,
@@ -92,7 +93,7 @@ MacTransportLive::MacTransportLive(
             throw RfidErrorException(RFID_ERROR_RADIO_NOT_PRESENT, __FUNCTION__);
             break;
         default:
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_ERROR,
                 "%s: Attempting to open radio 0x%.8x caused an unexpected "
                 "error (0x%.8x)\n",
@@ -152,7 +153,7 @@ void MacTransportLive::WriteRadio(
     switch (status)
     {
         case CPL_SUCCESS:           
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_DEBUG,
                 "%s: Wrote %u bytes to radio 0x%.8x\n",
                 __FUNCTION__,
@@ -162,7 +163,7 @@ void MacTransportLive::WriteRadio(
         case CPL_ERROR_ACCESSDENIED:
         case CPL_ERROR_NOTFOUND:    
         case CPL_ERROR_DEVICEGONE:  
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_INFO,
                 "%s: Write to radio 0x%.8x failed because it has been "
                 "detached\n",
@@ -171,7 +172,7 @@ void MacTransportLive::WriteRadio(
             throw RfidErrorException(RFID_ERROR_RADIO_NOT_PRESENT, __FUNCTION__);
             break;
         case CPL_WARN_CANCELLED:    
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_INFO,
                 "%s: Write to radio 0x%.8x failed because of a cancel\n",
                 __FUNCTION__,
@@ -179,7 +180,7 @@ void MacTransportLive::WriteRadio(
             throw RfidErrorException(RFID_ERROR_OPERATION_CANCELLED, __FUNCTION__);
             break;
         default:                    
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_ERROR,
                 "%s: Write to radio 0x%.8x returned an unexpected error "
                 "(0x%.8x)\n",
@@ -204,6 +205,10 @@ INT32U MacTransportLive::ReadRadio(
 
     assert(!bufferSize || (NULL != pBuffer));
 
+    RFID_PROBE2(transport_read_begin,
+        transport, this,
+        wanted, bufferSize);
+
     // If the caller only cares about the number of bytes available, tell the
     // caller how many bytes are available in the transport layer plus what
     // has already been cached.
@@ -257,6 +262,11 @@ INT32U MacTransportLive::ReadRadio(
         }
     }
 
+    RFID_PROBE3(transport_read_end,
+        transport, this,
+        wanted, bufferSize,
+        available, bytesAvailable);
+
     return bytesAvailable;
 } // MacTransportLive::ReadRadio
 
@@ -272,7 +282,7 @@ void MacTransportLive::CancelRadio()
     switch (status)
     {
         case CPL_SUCCESS:           
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_DEBUG,
                 "%s: Cancel of radio 0x%.8x successful\n",
                 __FUNCTION__,
@@ -280,7 +290,7 @@ void MacTransportLive::CancelRadio()
             break;
         case CPL_ERROR_NOTFOUND:    
         case CPL_ERROR_DEVICEGONE:  
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_INFO,
                 "%s: Cancel of radio 0x%.8x failed as radio has been "
                 "detached\n",
@@ -289,7 +299,7 @@ void MacTransportLive::CancelRadio()
             throw RfidErrorException(RFID_ERROR_RADIO_NOT_PRESENT, __FUNCTION__);
             break;
         case CPL_WARN_CANCELLED:
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_ERROR,
                 "%s: Cancel of radio 0x%.8x failed as radio did not respond\n",
                 __FUNCTION__,
@@ -297,7 +307,7 @@ void MacTransportLive::CancelRadio()
             throw RfidErrorException(RFID_ERROR_RADIO_NOT_RESPONDING, __FUNCTION__);
             break;
         default:                    
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_ERROR,
                 "%s: Cancel of radio 0x%.8x returned an unexpected error "
                 "(0x%.8x)\n",
@@ -325,7 +335,7 @@ void MacTransportLive::AbortRadio()
     switch (status)
     {
         case CPL_SUCCESS:           
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_DEBUG,
                 "%s: Abort of radio 0x%.8x successful\n",
                 __FUNCTION__,
@@ -333,7 +343,7 @@ void MacTransportLive::AbortRadio()
             break;
         case CPL_ERROR_NOTFOUND:    
         case CPL_ERROR_DEVICEGONE:  
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_INFO,
                 "%s: Abort of radio 0x%.8x failed as radio has been detached\n",
                 __FUNCTION__,
@@ -341,7 +351,7 @@ void MacTransportLive::AbortRadio()
             throw RfidErrorException(RFID_ERROR_RADIO_NOT_PRESENT, __FUNCTION__);
             break;
         case CPL_WARN_CANCELLED:
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_ERROR,
                 "%s: Abort of radio 0x%.8x failed as radio did not respond\n",
                 __FUNCTION__,
@@ -349,7 +359,7 @@ void MacTransportLive::AbortRadio()
             throw RfidErrorException(RFID_ERROR_RADIO_NOT_RESPONDING, __FUNCTION__);
             break;
         default:                    
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_ERROR,
                 "%s: Cancel of radio 0x%.8x returned an unexpected error "
                 "(0x%.8x)\n",
@@ -382,7 +392,7 @@ void MacTransportLive::ResetRadio(
     }
     else
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_ERROR,
             "%s: Radio 0x%.8x reset invalid parameter error "
             "(0x%.8x)\n",
@@ -397,7 +407,7 @@ void MacTransportLive::ResetRadio(
     switch (status)
     {
         case CPL_SUCCESS:           
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_DEBUG,
                 "%s: Radio 0x%.8x reset successful\n",
                 __FUNCTION__,
@@ -405,7 +415,7 @@ void MacTransportLive::ResetRadio(
             break;
         case CPL_ERROR_NOTFOUND:    
         case CPL_ERROR_DEVICEGONE:  
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_INFO,
                 "%s: Radio 0x%.8x reset failed as radio has been detached\n",
                 __FUNCTION__,
@@ -414,7 +424,7 @@ void MacTransportLive::ResetRadio(
             break;
 
         case CPL_ERROR_INVALID_FUNC:  
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_INFO,
                 "%s: Radio 0x%.8x reset failed invalid function (driver probably needs to be updated\n",
                 __FUNCTION__,
@@ -423,7 +433,7 @@ void MacTransportLive::ResetRadio(
             break;
             
         default:                    
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_ERROR,
                 "%s: Radio 0x%.8x reset returned an unexpected error "
                 "(0x%.8x)\n",
@@ -554,7 +564,7 @@ void MacTransportLive::EnumerateAttachedRadios(
             // A status that results in an unrecoverable error
             default:
             {
-                g_pTracer->PrintMessage(
+                RFID_TRACE(
                     Tracer::RFID_LOG_SEVERITY_ERROR,
                     "%s: Enumerating radios returned an unexpected error "
                     "(0x%.8x)\n",
@@ -570,7 +580,7 @@ void MacTransportLive::EnumerateAttachedRadios(
     // If the buffer is not large enough...
     if (pEnum->totalLength < requiredSize)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_DEBUG,
             "%s: Caller's buffer is %u bytes, but needs to be %u bytes\n",
             __FUNCTION__,
@@ -592,7 +602,7 @@ void MacTransportLive::EnumerateAttachedRadios(
         (pEnum->countRadios ? reinterpret_cast<RFID_RADIO_INFO **>(pEnum + 1) :
                               NULL);
 
-    g_pTracer->PrintMessage(
+    RFID_TRACE(
         Tracer::RFID_LOG_SEVERITY_DEBUG,
         "%s: There are %u radios attached to the system\n",
         __FUNCTION__,
@@ -691,7 +701,7 @@ void MacTransportLive::GetTransportCharacteristics(
     // If we stopped for any reason other than success, throw error
     if (CPL_SUCCESS != status)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_ERROR,
             "%s: Retrieving transport characteristics for radio 0x%.8x "
             "returned an unexpected error (0x%.8x)\n",
@@ -745,7 +755,7 @@ INT32U MacTransportLive::RawReadRadio(
     switch (status)
     {
         case CPL_SUCCESS:           
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_DEBUG,
                 "%s: Read %u bytes from radio 0x%.8x.  %u bytes still "
                 "available\n",
@@ -757,7 +767,7 @@ INT32U MacTransportLive::RawReadRadio(
         case CPL_ERROR_ACCESSDENIED:
         case CPL_ERROR_NOTFOUND:    
         case CPL_ERROR_DEVICEGONE:  
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_INFO,
                 "%s: Read from radio 0x%.8x failed because it has been "
                 "detached\n",
@@ -766,7 +776,7 @@ INT32U MacTransportLive::RawReadRadio(
             throw RfidErrorException(RFID_ERROR_RADIO_NOT_PRESENT, __FUNCTION__);
             break;
         case CPL_WARN_CANCELLED:    
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_INFO,
                 "%s: Read from radio 0x%.8x failed because of a cancel\n",
                 __FUNCTION__,
@@ -774,7 +784,7 @@ INT32U MacTransportLive::RawReadRadio(
             throw RfidErrorException(RFID_ERROR_OPERATION_CANCELLED, __FUNCTION__);
             break;
         case CPL_ERROR_RXOVERFLOW:
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_WARNING,
                 "%s: Read from radio 0x%.8x failed because of a RX overflow\n",
                 __FUNCTION__,
@@ -789,7 +799,7 @@ INT32U MacTransportLive::RawReadRadio(
             throw RfidErrorException(RFID_ERROR_RECEIVE_OVERFLOW, __FUNCTION__);
             break;
         default:       
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_ERROR,
                 "%s: Read from radio 0x%.8x returned an unexpected error "
                 "(0x%.8x)\n",
@@ -0,0 +1,604 @@
+/*
+ *****************************************************************************
+ *                                                                           *
+ *                 IMPINJ CONFIDENTIAL AND PROPRIETARY                       *
+ *                                                                           *
+ * This source code is the sole property of Impinj, Inc.  Reproduction or    *
+ * utilization of this source code in whole or in part is forbidden without  *
+ * the prior written consent of Impinj, Inc.                                 *
+ *                                                                           *
+ * (c) Copyright Impinj, Inc. 2009. All rights reserved.                     *
+ *                                                                           *
+ *****************************************************************************
+ */
+
+/*
+ *****************************************************************************
+ *
+ * $Id$
+ *
+ * Description:
+ *     This file contains the implementation for the synthetic MAC transport.
+ *
+ *
+ *****************************************************************************
+ */
+
+#include <memory>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "mac_transport_synthetic.h"
+#include "mac.h"
+#include "radio.h"
+#include "radio_statistics.h"
+#include "macregs.h"
+#include "maccmds.h"
+#include "hostpkts.h"
+#include "rfid_packets.h"
+#include "compat_lib.h"
+#include "compat_atomic.h"
+#include "rfid_exceptions.h"
+#include "auto_lock_compat.h"
+
+#include "rfid_extern.h"
+
+namespace rfid
+{
+
+namespace
+{
+
+// The tag population of each synthetic radio.  A radio's cookie is its index
+// plus one.
+const INT32U    TAG_POPULATIONS[]   = { 1, 100, 1000, 10000 };
+const INT32U    SYNTHETIC_RADIOS    =
+    sizeof(TAG_POPULATIONS) / sizeof(TAG_POPULATIONS[0]);
+
+// Whether each synthetic radio is open
+volatile CPL_Atomic32 g_isOpen[SYNTHETIC_RADIOS];
+
+// How many bytes of packets are made at a time, about what one transfer from
+// a USB radio brings
+const INT32U    GENERATE_BYTES      = 4096;
+
+// The version reported for the transport and the MAC firmware
+const INT32U    SYNTHETIC_MAC_VERSION = 0x02040000;
+
+// The EPC of a synthetic tag: the tag's number and when its packet was made
+const INT32U    EPC_BYTES           = 12;
+// The PC word of a 96-bit EPC
+const INT16U    EPC_PC              = 0x3000;
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        MacTransportSynthetic
+// Description: Initializes a synthetic MAC transport object
+////////////////////////////////////////////////////////////////////////////////
+MacTransportSynthetic::MacTransportSynthetic(
+    INT32U  transportHandle,
+    INT32U  tagPopulation
+    ) :
+    MacTransport(transportHandle),
+    m_outputHead(0),
+    m_stage(STAGE_IDLE),
+    m_command(0),
+    m_statusPackets(false),
+    m_nextTag(0),
+    m_tagPopulation(tagPopulation),
+    m_clockStart(StatisticsClock::Now())
+{
+    if (CPL_AtomicCompareExchange32(&g_isOpen[transportHandle - 1], 1, 0))
+    {
+        RFID_TRACE(
+            Tracer::RFID_LOG_SEVERITY_INFO,
+            "%s: Synthetic radio 0x%.8x already opened\n",
+            __FUNCTION__,
+            transportHandle);
+        throw RfidErrorException(RFID_ERROR_ALREADY_OPEN, __FUNCTION__);
+    }
+
+    INT32U result = CPL_MutexInit(&m_lock);
+    if (result)
+    {
+        CPL_AtomicExchange32(&g_isOpen[transportHandle - 1], 0);
+        RFID_TRACE(
+            Tracer::RFID_LOG_SEVERITY_ERROR,
+            "%s: Failed to create mutex.  Result = 0x%.8x\n",
+            __FUNCTION__,
+            result);
+        throw RfidErrorException(RFID_ERROR_FAILURE, __FUNCTION__);
+    }
+    m_lockWrapper.Assume(&m_lock);
+
+    this->ResetRegisters();
+
+    RFID_TRACE(
+        Tracer::RFID_LOG_SEVERITY_DEBUG,
+        "%s: Synthetic radio 0x%.8x opened with %u tags\n",
+        __FUNCTION__,
+        transportHandle,
+        tagPopulation);
+} // MacTransportSynthetic::MacTransportSynthetic
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        ~MacTransportSynthetic
+// Description: Cleans up the MAC transport object.
+////////////////////////////////////////////////////////////////////////////////
+MacTransportSynthetic::~MacTransportSynthetic()
+{
+    CPL_AtomicExchange32(&g_isOpen[this->GetTransportHandle() - 1], 0);
+} // MacTransportSynthetic::~MacTransportSynthetic
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        GetTransportCharacteristics
+// Description: Retrieves the transport characteristics for the underlying
+//              transport.
+////////////////////////////////////////////////////////////////////////////////
+void MacTransportSynthetic::GetTransportCharacteristics(
+    RFID_VERSION*   pDriverVersion,
+    INT32U*         pMaxBufferSize,
+    INT32U*         pMaxPacketSize
+    ) const
+{
+    pDriverVersion->major       = MAC_VER_GET_MAJ(SYNTHETIC_MAC_VERSION);
+    pDriverVersion->minor       = MAC_VER_GET_MIN(SYNTHETIC_MAC_VERSION);
+    pDriverVersion->maintenance = MAC_VER_GET_MAINT(SYNTHETIC_MAC_VERSION);
+    pDriverVersion->release     = MAC_VER_GET_REL(SYNTHETIC_MAC_VERSION);
+    if (NULL != pMaxBufferSize)
+    {
+        *pMaxBufferSize = GENERATE_BYTES;
+    }
+    if (NULL != pMaxPacketSize)
+    {
+        *pMaxPacketSize = 64;
+    }
+} // MacTransportSynthetic::GetTransportCharacteristics
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        WriteRadio
+// Description: Passes register accesses to the synthetic MAC.
+////////////////////////////////////////////////////////////////////////////////
+void MacTransportSynthetic::WriteRadio(
+    const INT8U*    pBuffer,
+    INT32U          bufferSize
+    )
+{
+    assert(pBuffer != NULL);
+
+    CplMutexAutoLock lock(&m_lock);
+
+    // Anything other than a register access (e.g., a firmware image) is
+    // ignored
+    for (INT32U offset = 0;
+         offset + sizeof(host_reg_req) <= bufferSize;
+         offset += sizeof(host_reg_req))
+    {
+        host_reg_req request;
+        memcpy(&request, pBuffer + offset, sizeof(request));
+
+        INT16U address = CPL_MacToHost16(request.reg_addr);
+        if (HOST_REG_REQ_ACCESS_WRITE ==
+            (CPL_MacToHost16(request.access_flg) & HOST_REG_REQ_ACCESS_TYPE))
+        {
+            INT32U value = CPL_MacToHost32(request.reg_data);
+            m_registers[address] = value;
+            if (HST_CMD == address)
+            {
+                this->BeginCommand(value);
+            }
+        }
+        else
+        {
+            host_reg_resp response;
+            response.rfu0     = 0;
+            response.reg_addr = request.reg_addr;
+            response.reg_data = CPL_HostToMac32(m_registers[address]);
+
+            const INT8U* pResponse = reinterpret_cast<INT8U *>(&response);
+            m_output.insert(
+                m_output.end(),
+                pResponse,
+                pResponse + sizeof(response));
+        }
+    }
+} // MacTransportSynthetic::WriteRadio
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        ReadRadio
+// Description: Reads what the synthetic MAC has sent
+////////////////////////////////////////////////////////////////////////////////
+INT32U MacTransportSynthetic::ReadRadio(
+    INT8U*  pBuffer,
+    INT32U  bufferSize
+    )
+{
+    assert(!bufferSize || (NULL != pBuffer));
+
+    CplMutexAutoLock lock(&m_lock);
+
+    this->Generate(bufferSize > GENERATE_BYTES ? bufferSize : GENERATE_BYTES);
+
+    if (bufferSize)
+    {
+        // A live MAC would leave the read waiting for bytes that never come
+        if (this->GetBytesWaiting() < bufferSize)
+        {
+            RFID_TRACE(
+                Tracer::RFID_LOG_SEVERITY_ERROR,
+                "%s: Synthetic radio 0x%.8x has %u bytes, but %u were read\n",
+                __FUNCTION__,
+                this->GetTransportHandle(),
+                this->GetBytesWaiting(),
+                bufferSize);
+            throw RfidErrorException(
+                RFID_ERROR_RADIO_NOT_RESPONDING,
+                __FUNCTION__);
+        }
+
+        memcpy(pBuffer, &m_output[m_outputHead], bufferSize);
+        m_outputHead += bufferSize;
+
+        // Once everything has been read, start the buffer over
+        if (m_outputHead == m_output.size())
+        {
+            m_output.clear();
+            m_outputHead = 0;
+        }
+    }
+
+    return this->GetBytesWaiting();
+} // MacTransportSynthetic::ReadRadio
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        CancelRadio
+// Description: Cuts the command short
+////////////////////////////////////////////////////////////////////////////////
+void MacTransportSynthetic::CancelRadio()
+{
+    CplMutexAutoLock lock(&m_lock);
+
+    if (STAGE_TAGS == m_stage)
+    {
+        m_stage = STAGE_END;
+    }
+} // MacTransportSynthetic::CancelRadio
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        AbortRadio
+// Description: Stops the command and discards what has not been read
+////////////////////////////////////////////////////////////////////////////////
+void MacTransportSynthetic::AbortRadio()
+{
+    CplMutexAutoLock lock(&m_lock);
+
+    m_stage = STAGE_IDLE;
+    m_output.clear();
+    m_outputHead = 0;
+} // MacTransportSynthetic::AbortRadio
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        ResetRadio
+// Description: Stops the command, discards what has not been read and puts
+//              the registers back to their reset values
+////////////////////////////////////////////////////////////////////////////////
+void MacTransportSynthetic::ResetRadio(
+    RFID_MAC_RESET_TYPE resetType
+    )
+{
+    if ((RFID_MAC_RESET_TYPE_SOFT != resetType) &&
+        (RFID_MAC_RESET_TYPE_TO_BOOTLOADER != resetType))
+    {
+        RFID_TRACE(
+            Tracer::RFID_LOG_SEVERITY_ERROR,
+            "%s: Radio 0x%.8x reset invalid parameter error "
+            "(0x%.8x)\n",
+            __FUNCTION__,
+            this->GetTransportHandle(),
+            resetType);
+        throw RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+    }
+
+    CplMutexAutoLock lock(&m_lock);
+
+    m_stage = STAGE_IDLE;
+    m_output.clear();
+    m_outputHead = 0;
+    this->ResetRegisters();
+} // MacTransportSynthetic::ResetRadio
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        EnumerateAttachedRadios
+// Description: Enumerates the synthetic radios
+////////////////////////////////////////////////////////////////////////////////
+void MacTransportSynthetic::EnumerateAttachedRadios(
+    RFID_RADIO_ENUM*    pEnum
+    )
+{
+    // A radio's unique ID is "SYNTHETIC-" and its tag population
+    char    serialNumbers[SYNTHETIC_RADIOS][24];
+    INT32U  requiredSize = sizeof(RFID_RADIO_ENUM);
+
+    for (INT32U index = 0; index < SYNTHETIC_RADIOS; ++index)
+    {
+        sprintf(serialNumbers[index], "SYNTHETIC-%u", TAG_POPULATIONS[index]);
+
+        INT32U idLength = static_cast<INT32U>(strlen(serialNumbers[index]));
+        requiredSize += sizeof(RFID_RADIO_INFO *) +
+                        sizeof(RFID_RADIO_INFO)   +
+                        idLength                  +
+                        CALCULATE_32BIT_PADDING(idLength);
+    }
+
+    // If the buffer is not large enough...
+    if (pEnum->totalLength < requiredSize)
+    {
+        RFID_TRACE(
+            Tracer::RFID_LOG_SEVERITY_DEBUG,
+            "%s: Caller's buffer is %u bytes, but needs to be %u bytes\n",
+            __FUNCTION__,
+            pEnum->totalLength,
+            requiredSize);
+
+        pEnum->totalLength = requiredSize;
+        throw RfidErrorException(RFID_ERROR_BUFFER_TOO_SMALL, __FUNCTION__);
+    }
+
+    // Set up the enumeration buffer as for attached radios
+    memset(pEnum, 0, requiredSize);
+    pEnum->length      = sizeof(RFID_RADIO_ENUM);
+    pEnum->totalLength = requiredSize;
+    pEnum->countRadios = SYNTHETIC_RADIOS;
+    pEnum->ppRadioInfo = reinterpret_cast<RFID_RADIO_INFO **>(pEnum + 1);
+
+    INT8U* pBuffer = reinterpret_cast<INT8U *>(pEnum + 1) +
+                     (pEnum->countRadios * sizeof(RFID_RADIO_INFO *));
+
+    for (INT32U index = 0; index < pEnum->countRadios; ++index)
+    {
+        pEnum->ppRadioInfo[index] =
+            reinterpret_cast<RFID_RADIO_INFO *>(pBuffer);
+
+        RFID_RADIO_INFO info;
+        info.cookie                    = index + 1;
+        info.driverVersion.major       = MAC_VER_GET_MAJ(SYNTHETIC_MAC_VERSION);
+        info.driverVersion.minor       = MAC_VER_GET_MIN(SYNTHETIC_MAC_VERSION);
+        info.driverVersion.maintenance = MAC_VER_GET_MAINT(SYNTHETIC_MAC_VERSION);
+        info.driverVersion.release     = MAC_VER_GET_REL(SYNTHETIC_MAC_VERSION);
+        info.idLength      = static_cast<INT32U>(strlen(serialNumbers[index]));
+        info.pUniqueId     = pBuffer + sizeof(RFID_RADIO_INFO);
+
+        INT32U serialNumberPad = CALCULATE_32BIT_PADDING(info.idLength);
+
+        info.length        = sizeof(RFID_RADIO_INFO) +
+                             info.idLength           +
+                             serialNumberPad;
+
+        memcpy(pBuffer, &info, sizeof(info));
+        pBuffer += sizeof(info);
+        memcpy(pBuffer, serialNumbers[index], info.idLength);
+        pBuffer += (info.idLength + serialNumberPad);
+    }
+} // MacTransportSynthetic::EnumerateAttachedRadios
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        OpenRadio
+// Description: Requests that a synthetic radio be opened.
+////////////////////////////////////////////////////////////////////////////////
+std::auto_ptr<Radio> MacTransportSynthetic::OpenRadio(
+    INT32U  transportHandle
+    )
+{
+    if ((transportHandle < 1) || (transportHandle > SYNTHETIC_RADIOS))
+    {
+        RFID_TRACE(
+            Tracer::RFID_LOG_SEVERITY_INFO,
+            "%s: There is no synthetic radio 0x%.8x\n",
+            __FUNCTION__,
+            transportHandle);
+        throw RfidErrorException(RFID_ERROR_RADIO_NOT_PRESENT, __FUNCTION__);
+    }
+
+    // As for a live radio, build the radio from the bottom up
+    std::auto_ptr<MacTransport> pMacTransport(
+                                    new MacTransportSynthetic(
+                                        transportHandle,
+                                        TAG_POPULATIONS[transportHandle - 1]));
+    std::auto_ptr<Mac>          pMac(new Mac(pMacTransport));
+    std::auto_ptr<Radio>        pRadio(new Radio(pMac));
+
+    return pRadio;
+} // MacTransportSynthetic::OpenRadio
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        ResetRegisters
+// Description: Puts the registers the library depends on to the values a MAC
+//              has after a reset
+////////////////////////////////////////////////////////////////////////////////
+void MacTransportSynthetic::ResetRegisters()
+{
+    m_registers.clear();
+
+    // A 2.4 MAC on an R2000, reporting the compact responses
+    m_registers[MAC_VER]      = SYNTHETIC_MAC_VERSION;
+    m_registers[MAC_INFO]     = 0x00000002;
+    m_registers[HST_CMNDIAGS] = HST_CMNDIAGS_INVRESP_ENABLED       |
+                                HST_CMNDIAGS_COMMANDACTIVE_ENABLED;
+} // MacTransportSynthetic::ResetRegisters
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        BeginCommand
+// Description: Starts answering a command written to HST_CMD
+////////////////////////////////////////////////////////////////////////////////
+void MacTransportSynthetic::BeginCommand(
+    INT32U  command
+    )
+{
+    INT32U diags = m_registers[HST_CMNDIAGS];
+
+    m_command       = command;
+    m_statusPackets = (0 != (diags & HST_CMNDIAGS_STATUS_ENABLED));
+    m_nextTag       = 0;
+
+    RFID_PACKET_COMMAND_BEGIN begin;
+    begin.command = CPL_HostToMac32(command);
+    begin.ms_ctr  = this->GetMillisecondCounter();
+    this->AppendPacket(
+        RFID_PACKET_TYPE_COMMAND_BEGIN,
+        &begin.command,
+        sizeof(begin) - sizeof(begin.cmn));
+
+    // Only an inventory reads tags
+    if (CMD_18K6CINV == command)
+    {
+        if (m_statusPackets)
+        {
+            RFID_PACKET_ANTENNA_BEGIN antennaBegin;
+            antennaBegin.antenna = 0;
+            RFID_PACKET_INVENTORY_CYCLE_BEGIN cycleBegin;
+            cycleBegin.ms_ctr = this->GetMillisecondCounter();
+
+            this->AppendPacket(RFID_PACKET_TYPE_ANTENNA_CYCLE_BEGIN, NULL, 0);
+            this->AppendPacket(
+                RFID_PACKET_TYPE_ANTENNA_BEGIN,
+                &antennaBegin.antenna,
+                sizeof(antennaBegin) - sizeof(antennaBegin.cmn));
+            this->AppendPacket(
+                RFID_PACKET_TYPE_INVENTORY_CYCLE_BEGIN,
+                &cycleBegin.ms_ctr,
+                sizeof(cycleBegin) - sizeof(cycleBegin.cmn));
+        }
+
+        // The tags are read, but only reported if the MAC is told to
+        if (!(diags & HST_CMNDIAGS_INVRESP_ENABLED))
+        {
+            m_nextTag = m_tagPopulation;
+        }
+        m_stage = STAGE_TAGS;
+    }
+    else
+    {
+        m_stage = STAGE_END;
+    }
+} // MacTransportSynthetic::BeginCommand
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        Generate
+// Description: Makes packets of the command being answered until the given
+//              number of bytes is waiting or the command has ended
+////////////////////////////////////////////////////////////////////////////////
+void MacTransportSynthetic::Generate(
+    INT32U  bytesWanted
+    )
+{
+    while ((this->GetBytesWaiting() < bytesWanted) && (STAGE_IDLE != m_stage))
+    {
+        if (STAGE_TAGS == m_stage)
+        {
+            if (m_nextTag < m_tagPopulation)
+            {
+                this->AppendInventory(m_nextTag++);
+                continue;
+            }
+            m_stage = STAGE_END;
+        }
+
+        if ((CMD_18K6CINV == m_command) && m_statusPackets)
+        {
+            RFID_PACKET_INVENTORY_CYCLE_END cycleEnd;
+            cycleEnd.ms_ctr = this->GetMillisecondCounter();
+
+            this->AppendPacket(
+                RFID_PACKET_TYPE_INVENTORY_CYCLE_END,
+                &cycleEnd.ms_ctr,
+                sizeof(cycleEnd) - sizeof(cycleEnd.cmn));
+            this->AppendPacket(RFID_PACKET_TYPE_ANTENNA_END, NULL, 0);
+            this->AppendPacket(RFID_PACKET_TYPE_ANTENNA_CYCLE_END, NULL, 0);
+        }
+
+        RFID_PACKET_COMMAND_END end;
+        end.ms_ctr = this->GetMillisecondCounter();
+        end.status = 0;
+        this->AppendPacket(
+            RFID_PACKET_TYPE_COMMAND_END,
+            &end.ms_ctr,
+            sizeof(end) - sizeof(end.cmn));
+
+        m_stage = STAGE_IDLE;
+    }
+} // MacTransportSynthetic::Generate
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        AppendPacket
+// Description: Adds a packet to what the MAC has sent
+////////////////////////////////////////////////////////////////////////////////
+void MacTransportSynthetic::AppendPacket(
+    INT16U          packetType,
+    const void*     pFields,
+    INT32U          fieldsSize
+    )
+{
+    assert(!(fieldsSize % 4));
+
+    RFID_PACKET_COMMON common;
+    common.pkt_ver  = 1;
+    common.flags    = 0;
+    common.pkt_type = CPL_HostToMac16(packetType);
+    common.pkt_len  = CPL_HostToMac16(static_cast<INT16U>(fieldsSize / 4));
+    common.res0     = 0;
+
+    const INT8U* pCommon = reinterpret_cast<const INT8U *>(&common);
+    m_output.insert(m_output.end(), pCommon, pCommon + sizeof(common));
+    if (fieldsSize)
+    {
+        const INT8U* pBytes = static_cast<const INT8U *>(pFields);
+        m_output.insert(m_output.end(), pBytes, pBytes + fieldsSize);
+    }
+} // MacTransportSynthetic::AppendPacket
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        AppendInventory
+// Description: Adds the inventory packet of a tag to what the MAC has sent
+////////////////////////////////////////////////////////////////////////////////
+void MacTransportSynthetic::AppendInventory(
+    INT32U  tag
+    )
+{
+    // The fields after the common preamble: the counter, the RSSI and
+    // channel words, then the PC, EPC and CRC
+    INT8U   fields[12 + 2 + EPC_BYTES + 2];
+    INT32U  msCounter = this->GetMillisecondCounter();
+    INT64U  made      = StatisticsClock::Now();
+
+    memset(fields, 0, sizeof(fields));
+    memcpy(fields, &msCounter, sizeof(msCounter));
+    fields[4]  = 0x60;                          // nb_rssi
+    fields[12] = static_cast<INT8U>(EPC_PC >> 8);
+    fields[13] = static_cast<INT8U>(EPC_PC);
+    for (INT32U index = 0; index < 4; ++index)
+    {
+        fields[14 + index] = static_cast<INT8U>(tag >> (24 - 8 * index));
+    }
+    for (INT32U index = 0; index < 8; ++index)
+    {
+        fields[18 + index] = static_cast<INT8U>(made >> (56 - 8 * index));
+    }
+
+    this->AppendPacket(RFID_PACKET_TYPE_18K6C_INVENTORY, fields, sizeof(fields));
+} // MacTransportSynthetic::AppendInventory
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        GetMillisecondCounter
+// Description: Reads the MAC's millisecond counter
+////////////////////////////////////////////////////////////////////////////////
+INT32U MacTransportSynthetic::GetMillisecondCounter() const
+{
+    return CPL_HostToMac32(
+        static_cast<INT32U>(
+            StatisticsClock::ToMicroseconds(
+                StatisticsClock::Now() - m_clockStart) / 1000));
+} // MacTransportSynthetic::GetMillisecondCounter
+
+} // namespace rfid
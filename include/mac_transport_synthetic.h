@@ -0,0 +1,289 @@
+/*
+ *****************************************************************************
+ *                                                                           *
+ *                 IMPINJ CONFIDENTIAL AND PROPRIETARY                       *
+ *                                                                           *
+ * This source code is the sole property of Impinj, Inc.  Reproduction or    *
+ * utilization of this source code in whole or in part is forbidden without  *
+ * the prior written consent of Impinj, Inc.                                 *
+ *                                                                           *
+ * (c) Copyright Impinj, Inc. 2009. All rights reserved.                     *
+ *                                                                           *
+ *****************************************************************************
+ */
+
+/*
+ *****************************************************************************
+ *
+ * $Id$
+ *
+ * Description:
+ *     This header presents the interface for the MAC transport of the
+ *     synthetic radios, which stand in for attached radios when the library
+ *     is started with RFID_FLAG_SYNTHETIC_RADIOS.  A synthetic MAC keeps its
+ *     registers in memory and answers every command at once with the packets
+ *     a live MAC would send, so that the path from the transport to the
+ *     application can be measured without a radio or an RF environment.
+ *
+ *     Each synthetic radio has a tag population of its own (1, 100, 1,000 or
+ *     10,000 tags, in the order they are enumerated) and an inventory
+ *     command reads every tag once.  Tag n's EPC is n, as a 32-bit big-endian
+ *     number, followed by the performance counter, as a 64-bit big-endian
+ *     number, at which its inventory packet was made, so that a receiver can
+ *     tell how long the read took to reach it.
+ *
+ *
+ *****************************************************************************
+ */
+
+#ifndef MAC_TRANSPORT_SYNTHETIC_H_INCLUDED
+#define MAC_TRANSPORT_SYNTHETIC_H_INCLUDED
+
+#include <map>
+#include <vector>
+#include "mac_transport.h"
+#include "radio.h"
+#include "compat_mutex.h"
+#include "auto_handle_compat.h"
+
+namespace rfid
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: MacTransportSynthetic
+//
+// Description: This class is used to provide an abstraction of the MAC
+//     transport for synthetic MACs
+////////////////////////////////////////////////////////////////////////////////
+class MacTransportSynthetic : public MacTransport
+{
+public:
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        ~MacTransportSynthetic
+    // Description: Cleans up the MAC transport object.
+    // Parameters:  None
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    ~MacTransportSynthetic();
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        GetTransportCharacteristics
+    // Description: Retrieves the transport characteristics for the underlying
+    //              transport.
+    // Parameters:  pDriverVersion - pointer to structure that upon return will
+    //              contain the driver version information
+    //              pMaxBufferSize - pointer to 32-bit unsigned integer that
+    //              upon return will contain the maximum transfer buffer size
+    //              pMaxPacketSize - pointer to 32-bit unsigned integer that
+    //              upon return will contain the maximum transfer packet size
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void GetTransportCharacteristics(
+        RFID_VERSION*   pDriverVersion,
+        INT32U*         pMaxBufferSize,
+        INT32U*         pMaxPacketSize
+        ) const;
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        WriteRadio
+    // Description: Passes register accesses to the synthetic MAC.  A write to
+    //              HST_CMD starts the MAC answering the command.
+    // Parameters:  pBuffer - pointer to the register access requests.  Must
+    //              not be NULL.
+    //              bufferSize - the number of bytes in the buffer
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void WriteRadio(
+        const INT8U*    pBuffer,
+        INT32U          bufferSize
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        ReadRadio
+    // Description: Reads what the synthetic MAC has sent, making the packets
+    //              of the command it is answering as they are needed
+    // Parameters:  pBuffer - pointer to buffer into which data will be placed.
+    //                May be NULL if bufferSize is zero.  Must not be NULL if
+    //                bufferSize is non-zero.
+    //              bufferSize - the size of the buffer to fill.  If zero,
+    //                simply determines how many bytes are available.
+    // Returns:     The number of bytes that can be retrieved without blocking
+    ////////////////////////////////////////////////////////////////////////////
+    INT32U ReadRadio(
+        INT8U*  pBuffer,
+        INT32U  bufferSize
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        CancelRadio
+    // Description: Cuts the command short: no more tags are read, but the
+    //              command ends with its usual packets.
+    // Parameters:  None
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void CancelRadio();
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        AbortRadio
+    // Description: Stops the command and discards what has not been read
+    // Parameters:  None
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void AbortRadio();
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        ResetRadio
+    // Description: Stops the command, discards what has not been read and
+    //              puts the registers back to their reset values
+    // Parameters:  resetType - the type of reset (i.e., soft, etc.)
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void ResetRadio(
+        RFID_MAC_RESET_TYPE resetType
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        EnumerateAttachedRadios
+    // Description: Enumerates the synthetic radios
+    // Parameters:  pEnum - a pointer to an enumeration buffer that is to be
+    //              filled in as per the RFID Radio Libary EAS
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    static void EnumerateAttachedRadios(
+        RFID_RADIO_ENUM*    pEnum
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        OpenRadio
+    // Description: Requests that a synthetic radio be opened.
+    // Parameters:  transportHandle - the cookie that was returned in the
+    //              enumeration data that corresponds to the radio to open
+    // Returns:     An auto_ptr-wrapped pointer to a new radio object.
+    ////////////////////////////////////////////////////////////////////////////
+    static std::auto_ptr<Radio> OpenRadio(
+        INT32U  transportHandle
+        );
+
+private:
+    // Where the MAC is in answering a command
+    enum STAGE
+    {
+        STAGE_IDLE,     // Not answering a command
+        STAGE_TAGS,     // Reading the tag population
+        STAGE_END       // Sending the packets that end the command
+    };
+
+    // The MAC's registers.  Those that have never been written read as zero.
+    std::map<INT16U, INT32U>    m_registers;
+    // What the MAC has sent and has not been read, from m_outputHead on
+    std::vector<INT8U>          m_output;
+    INT32U                      m_outputHead;
+    // The command being answered and how far it has got
+    STAGE                       m_stage;
+    INT32U                      m_command;
+    bool                        m_statusPackets;
+    INT32U                      m_nextTag;
+    // The number of tags an inventory reads
+    INT32U                      m_tagPopulation;
+    // When the MAC's millisecond counter was zero
+    INT64U                      m_clockStart;
+    // Protects the above from a cancel or an abort issued by another thread
+    CPL_Mutex                   m_lock;
+    CplMutexAutoHandle          m_lockWrapper;
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        MacTransportSynthetic
+    // Description: Initializes a synthetic MAC transport object
+    // Parameters:  transportHandle - the radio's cookie
+    //              tagPopulation - the number of tags an inventory reads
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    MacTransportSynthetic(
+        INT32U  transportHandle,
+        INT32U  tagPopulation
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        ResetRegisters
+    // Description: Puts the registers the library depends on to the values
+    //              a MAC has after a reset
+    // Parameters:  None
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void ResetRegisters();
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        BeginCommand
+    // Description: Starts answering a command written to HST_CMD
+    // Parameters:  command - the command
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void BeginCommand(
+        INT32U  command
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        Generate
+    // Description: Makes packets of the command being answered until the
+    //              given number of bytes is waiting or the command has ended
+    // Parameters:  bytesWanted - the number of bytes that should be waiting
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void Generate(
+        INT32U  bytesWanted
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        AppendPacket
+    // Description: Adds a packet to what the MAC has sent
+    // Parameters:  packetType - the packet's type
+    //              pFields - the fields after the common preamble, in MAC
+    //              byte order.  May be NULL if fieldsSize is zero.
+    //              fieldsSize - the number of bytes of fields, which must be
+    //              a multiple of four
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void AppendPacket(
+        INT16U          packetType,
+        const void*     pFields,
+        INT32U          fieldsSize
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        AppendInventory
+    // Description: Adds the inventory packet of a tag to what the MAC has sent
+    // Parameters:  tag - the tag's number in the population
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void AppendInventory(
+        INT32U  tag
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        GetMillisecondCounter
+    // Description: Reads the MAC's millisecond counter
+    // Parameters:  None
+    // Returns:     The counter, in MAC byte order
+    ////////////////////////////////////////////////////////////////////////////
+    INT32U GetMillisecondCounter() const;
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        GetBytesWaiting
+    // Description: Determines how many bytes the MAC has sent and have not
+    //              been read
+    // Parameters:  None
+    // Returns:     The number of bytes
+    ////////////////////////////////////////////////////////////////////////////
+    INT32U GetBytesWaiting() const
+    {
+        return static_cast<INT32U>(m_output.size()) - m_outputHead;
+    } // GetBytesWaiting
+
+    // Prevent copying of transports
+    MacTransportSynthetic(const MacTransportSynthetic&);
+    const MacTransportSynthetic& operator = (const MacTransportSynthetic&);
+}; // class MacTransportSynthetic
+
+} // namespace rfid
+
+#endif // #ifndef MAC_TRANSPORT_SYNTHETIC_H_INCLUDED
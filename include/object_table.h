@@ -19,7 +19,8 @@
  * 
  * Description:
  *     This header presents a template class that can be used to store object
- *     pointers and receive handles in return.
+ *     pointers and receive handles in return.  Handles may be looked up
+ *     without holding the lock that serializes changes to the table.
  *     
  *
  *****************************************************************************
@@ -28,9 +29,11 @@
 #ifndef OBJECT_TABLE_H_INCLUDED
 #define OBJECT_TABLE_H_INCLUDED
 
-#include <vector>
+#include <new>
 #include <stdexcept>
 #include "rfid_platform_types.h"
+#include "compat_atomic.h"
+#include "compat_time.h"
 
 namespace rfid
 {
@@ -42,6 +45,18 @@ namespace rfid
 //     will issue a handle that can be used for subsequent retrieval.  The table
 //     does NOT provide cleanup of the objects.
 //
+//     Add, Get, Retire, Reinstate, Drain, Remove and ForEach change or walk
+//     the table and must be serialized by the caller.  Acquire and Release may
+//     be called from any thread at any time: the entries are never moved once
+//     allocated, and each entry holds its signature, an in-use flag and a
+//     count of references in a single word that is updated atomically.
+//
+//     Removing an object is done in two steps so that the caller can work on
+//     it in between: Retire stops new references from being acquired, and
+//     Drain waits until the references already acquired have been released.
+//     Remove does both and frees the entry, so an object is never handed out
+//     after it has been removed.
+//
 // Template Parameters:
 //      Object - the type of objects that will have pointers stored in this
 //        table
@@ -77,6 +92,14 @@ public:
         INT16U growSize    = DEFAULT_GROW_SIZE
         );
 
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        ~ObjectTable
+    // Description: Frees the table entries.  Does not delete the objects.
+    // Parameters:  None
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    ~ObjectTable();
+
     ////////////////////////////////////////////////////////////////////////////
     // Name:        Add
     // Description: Adds a new object to the table.  If the table is full, it
@@ -101,16 +124,83 @@ public:
         TableHandle handle
         );
 
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        Acquire
+    // Description: Retrieves an object pointer from the table and takes a
+    //              reference to its entry, which keeps the entry from being
+    //              removed until the reference is released.  Does not need to
+    //              be serialized with the other methods.
+    // Parameters:  handle - the handle, received from a previous call to Add,
+    //              of the object pointer to retrieve
+    // Returns:     The object pointer, or NULL if the handle doesn't reference
+    //              a valid object.  If not NULL, the caller must call Release
+    //              with the same handle when it is done with the object.
+    ////////////////////////////////////////////////////////////////////////////
+    Object* Acquire(
+        TableHandle handle
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        Release
+    // Description: Releases a reference taken by a successful call to Acquire.
+    //              Does not need to be serialized with the other methods.
+    // Parameters:  handle - the handle that was passed to Acquire
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void Release(
+        TableHandle handle
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        Retire
+    // Description: Stops new references to an object from being acquired.
+    //              The references already acquired are not affected, and the
+    //              entry stays in the table until it is removed.  Get and
+    //              Acquire treat the handle as invalid from now on.
+    // Parameters:  handle - the handle, received from a previous call to Add,
+    //              of the object pointer to retire
+    // Returns:     The object pointer, or NULL if the handle doesn't reference
+    //              a valid object.
+    ////////////////////////////////////////////////////////////////////////////
+    Object* Retire(
+        TableHandle handle
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        Reinstate
+    // Description: Undoes a call to Retire for an entry that has not been
+    //              removed, so that references can be acquired again.
+    // Parameters:  handle - the handle that was passed to Retire
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void Reinstate(
+        TableHandle handle
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        Drain
+    // Description: Waits until the references to a retired entry have all
+    //              been released.  As no new ones can be acquired, nothing
+    //              else is using the object when it returns.
+    // Parameters:  handle - the handle that was passed to Retire
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void Drain(
+        TableHandle handle
+        );
+
     ////////////////////////////////////////////////////////////////////////////
     // Name:        Remove
     // Description: Removes an object pointer from the table.  Note that removal
     //              does not cause the object to be deleted.  It is the
     //              responsibility of the caller to ensure that the object is
-    //              cleaned up.
+    //              cleaned up.  The entry is retired, if it hasn't been
+    //              already, and drained before it is freed, so the caller may
+    //              delete the object when it returns.
     // Parameters:  handle - the handle, received from a previous call to Add,
     //              of the object pointer to remove
     // Returns:     The object pointer, or NULL if the handle doesn't reference
-    //              a valid object.
+    //              a valid or retired object.
     ////////////////////////////////////////////////////////////////////////////
     Object* Remove(
         TableHandle handle
@@ -173,7 +263,18 @@ public:
 private:
     enum {
         // A signature that will never be used for a table entry
-        INVALID_SIGNATURE = 0
+        INVALID_SIGNATURE = 0,
+        // The entries are allocated in segments of this many so that they
+        // never move, and a 16-bit index needs at most this many segments
+        SEGMENT_SIZE      = 64,
+        MAX_SEGMENTS      = 0x10000 / SEGMENT_SIZE
+    };
+
+    enum {
+        // The bits of an entry's state: the signature in the upper 16 bits,
+        // an in-use flag and the number of references held
+        ENTRY_IN_USE      = 0x00008000,
+        ENTRY_REFERENCES  = 0x00007FFF
     };
 
     ////////////////////////////////////////////////////////////////////////////
@@ -185,45 +286,64 @@ private:
     {
         ////////////////////////////////////////////////////////////////////////
         // Name: ObjectEntry
-        // Description: Initializes an object table entry
-        // Parameters:  signature - the signature for the entry.  This helps to
-        //              detect when an application is using a stale handle.
-        //              nextFree - the index of the next free table entry.
-        //              pObject - the object pointer to be held in the entry
+        // Description: Initializes an unused object table entry
+        // Parameters:  None
         // Returns:     Nothing
         ////////////////////////////////////////////////////////////////////////
-        ObjectEntry(
-            INT16U  signature = INVALID_SIGNATURE,
-            INT16U  nextFree  = 0,
-            Object* pObject   = NULL
-            ) :
-            m_signature(signature),
-            m_nextFree(nextFree),
-            m_pObject(pObject),
-            m_used(false)
+        ObjectEntry() :
+            m_state(INVALID_SIGNATURE),
+            m_nextFree(0),
+            m_pObject(NULL)
         {
         } // ObjectEntry::ObjectEntry
 
-        // The table entry's signature
-        INT16U  m_signature;
+        // The table entry's signature, which helps to detect when an
+        // application is using a stale handle, the in-use flag and the
+        // number of references.  Only changed with atomic operations.
+        volatile CPL_Atomic32   m_state;
         // The index of the next free entry.  This is only useful if the entry
         // is currently unused.
-        INT16U  m_nextFree;
-        // A pointer to the object for the table entry
-        Object* m_pObject;
-        // A flag to indicate if the table entry is in use or not
-        bool    m_used;
+        INT16U                  m_nextFree;
+        // A pointer to the object for the table entry.  NULL once the entry
+        // has been freed, which tells a retired entry from a free one.
+        Object*                 m_pObject;
     } ObjectEntry;
 
-    // The underlying data structure that holds the table entries
-    std::vector<ObjectEntry>    m_objectTable;
+    // The segments that hold the table entries.  A segment, once published,
+    // is not freed until the table is destroyed.
+    ObjectEntry* volatile       m_segments[MAX_SEGMENTS];
+    // The number of entries in the allocated segments
+    INT32U                      m_size;
     // The first free entry in the table
     INT16U                      m_firstFree;
     // The number of free entries in the table
-    INT16U                      m_numberFree;
+    INT32U                      m_numberFree;
     // The amount to grow the table on resize
     INT16U                      m_growSize;
 
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        Grow
+    // Description: Allocates segments for at least count more entries and
+    //              links the new entries onto the free list.
+    // Parameters:  count - the number of entries to add
+    // Returns:     Nothing.  Throws std::bad_alloc if the memory cannot be
+    //              allocated or the table cannot grow any larger.
+    ////////////////////////////////////////////////////////////////////////////
+    void Grow(
+        INT32U count
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        LocateEntry
+    // Description: Finds the entry for a table index
+    // Parameters:  index - the table index
+    // Returns:     A pointer to the entry, or NULL if the index is not within
+    //              the table
+    ////////////////////////////////////////////////////////////////////////////
+    ObjectEntry* LocateEntry(
+        INT16U index
+        ) const;
+
     ////////////////////////////////////////////////////////////////////////////
     // Name:        TableHandleIsValid
     // Description: Determines if the table handle references a valid entry in
@@ -238,6 +358,22 @@ private:
         INT32U handle
         ) const;
 
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        LocateRetiredEntry
+    // Description: Finds the entry for a table handle that has been retired
+    //              but not removed
+    // Parameters:  handle - the handle that was passed to Retire
+    // Returns:     A pointer to the entry, or NULL if the handle doesn't
+    //              reference a retired entry
+    ////////////////////////////////////////////////////////////////////////////
+    ObjectEntry* LocateRetiredEntry(
+        TableHandle handle
+        ) const;
+
+    // Prevent copying of the table
+    ObjectTable(const ObjectTable&);
+    const ObjectTable& operator = (const ObjectTable&);
+
 // Useful macros for dealing with handles
 // CREATE_HANDLE - takes a signature (s) and a table index (i) and creates a
 // table handle
@@ -258,9 +394,9 @@ ObjectTable<Object>::ObjectTable(
     INT16U initialSize,
     INT16U growSize
     ) :
-    m_objectTable(initialSize),
+    m_size(0),
     m_firstFree(0),
-    m_numberFree(initialSize),
+    m_numberFree(0),
     m_growSize(growSize)
 {
     // Verify that the grow size > 0
@@ -269,14 +405,41 @@ ObjectTable<Object>::ObjectTable(
         throw std::invalid_argument("Object table grow size == 0");
     }
 
-    // Go through and initialize the entries; next free fields "link"
-    // together the table entries
-    for (INT16U index = 0; index < initialSize; ++index)
+    for (INT32U segment = 0; segment < MAX_SEGMENTS; ++segment)
     {
-        m_objectTable[index].m_nextFree = index + 1;
+        m_segments[segment] = NULL;
+    }
+
+    // Allocate the initial entries; next free fields "link" together the
+    // table entries
+    try
+    {
+        this->Grow(initialSize);
+    }
+    catch (...)
+    {
+        for (INT32U segment = 0; segment < MAX_SEGMENTS; ++segment)
+        {
+            delete [] m_segments[segment];
+        }
+        throw;
     }
 } // ObjectTable::ObjectTable
 
+////////////////////////////////////////////////////////////////////////////////
+// Name:        ~ObjectTable
+// Description: Frees the table entries.  Does not delete the objects.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Object>
+ObjectTable<Object>::~ObjectTable()
+{
+    for (INT32U segment = 0; segment < MAX_SEGMENTS; ++segment)
+    {
+        delete [] m_segments[segment];
+        m_segments[segment] = NULL;
+    }
+} // ObjectTable::~ObjectTable
+
 ////////////////////////////////////////////////////////////////////////////////
 // Name:        Add
 // Description: Adds a new object to the table.  If the table is full, it
@@ -290,40 +453,29 @@ typename ObjectTable<Object>::TableHandle ObjectTable<Object>::Add(
     // If the table is full, then we need to expand it
     if (!m_numberFree)
     {
-        INT16U oldSize = (INT16U) m_objectTable.size();
-        INT16U newSize = oldSize + m_growSize;
-
-        // Reserve space for the new entries
-        m_objectTable.reserve(newSize);
-
-        // Create and initialize the new entries
-        for (INT16U index = oldSize; index < newSize; ++index)
-        {
-            m_objectTable.push_back(
-                ObjectEntry(INVALID_SIGNATURE, index + 1, NULL));
-        }
-
-        m_firstFree     = oldSize;
-        m_numberFree    = m_growSize;
+        this->Grow(m_growSize);
     }
 
     // Take the first free entry for this object
-    INT16U index = m_firstFree;
+    INT16U          index  = m_firstFree;
+    ObjectEntry*    pEntry = this->LocateEntry(index);
 
     // Fix up the first and number free
-    m_firstFree = m_objectTable[index].m_nextFree;
+    m_firstFree = pEntry->m_nextFree;
     --m_numberFree;
 
-    // Fix the table entry
-    ++(m_objectTable[index].m_signature);
-    if (INVALID_SIGNATURE == m_objectTable[index].m_signature)
+    // Fix the table entry.  The object pointer must be in place before the
+    // entry is marked used, as from then on it can be acquired.
+    INT16U signature = EXTRACT_SIGNATURE(pEntry->m_state) + 1;
+    if (INVALID_SIGNATURE == signature)
     {
-        ++(m_objectTable[index].m_signature);
+        ++signature;
     }
-    m_objectTable[index].m_pObject = pObject;
-    m_objectTable[index].m_used    = true;
+    pEntry->m_pObject = pObject;
+    CPL_AtomicExchange32(&pEntry->m_state,
+                         CREATE_HANDLE(signature, ENTRY_IN_USE));
 
-    return CREATE_HANDLE(m_objectTable[index].m_signature, index);
+    return CREATE_HANDLE(signature, index);
 } // ObjectTable::Add
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -336,9 +488,115 @@ Object* ObjectTable<Object>::Get(
     )
 {
     return (this->TableHandleIsValid(handle) ?
-            m_objectTable[EXTRACT_INDEX(handle)].m_pObject : NULL);
+            this->LocateEntry(EXTRACT_INDEX(handle))->m_pObject : NULL);
 } // ObjectTable::Get
 
+////////////////////////////////////////////////////////////////////////////////
+// Name:        Acquire
+// Description: Retrieves an object pointer from the table and takes a
+//              reference to its entry
+////////////////////////////////////////////////////////////////////////////////
+template <typename Object>
+Object* ObjectTable<Object>::Acquire(
+    TableHandle handle
+    )
+{
+    ObjectEntry* pEntry = this->LocateEntry(EXTRACT_INDEX(handle));
+    if (NULL == pEntry)
+    {
+        return NULL;
+    }
+
+    // Count the reference only if the entry is still in use with the same
+    // signature.  If the state changed under us, look again.
+    for (;;)
+    {
+        CPL_Atomic32 state = pEntry->m_state;
+
+        if ((EXTRACT_SIGNATURE(state) != EXTRACT_SIGNATURE(handle)) ||
+            !(state & ENTRY_IN_USE))
+        {
+            return NULL;
+        }
+        if (CPL_AtomicCompareExchange32(&pEntry->m_state, state + 1, state) ==
+            state)
+        {
+            return pEntry->m_pObject;
+        }
+    }
+} // ObjectTable::Acquire
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        Release
+// Description: Releases a reference taken by a successful call to Acquire
+////////////////////////////////////////////////////////////////////////////////
+template <typename Object>
+void ObjectTable<Object>::Release(
+    TableHandle handle
+    )
+{
+    CPL_AtomicDecrement32(&this->LocateEntry(EXTRACT_INDEX(handle))->m_state);
+} // ObjectTable::Release
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        Retire
+// Description: Stops new references to an object from being acquired
+////////////////////////////////////////////////////////////////////////////////
+template <typename Object>
+Object* ObjectTable<Object>::Retire(
+    TableHandle handle
+    )
+{
+    if (!this->TableHandleIsValid(handle))
+    {
+        return NULL;
+    }
+
+    // Once the entry is marked as unused it can no longer be acquired
+    ObjectEntry* pEntry = this->LocateEntry(EXTRACT_INDEX(handle));
+    CPL_AtomicAdd32(&pEntry->m_state, -ENTRY_IN_USE);
+
+    return pEntry->m_pObject;
+} // ObjectTable::Retire
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        Reinstate
+// Description: Undoes a call to Retire for an entry that has not been removed
+////////////////////////////////////////////////////////////////////////////////
+template <typename Object>
+void ObjectTable<Object>::Reinstate(
+    TableHandle handle
+    )
+{
+    ObjectEntry* pEntry = this->LocateRetiredEntry(handle);
+
+    if (NULL != pEntry)
+    {
+        CPL_AtomicAdd32(&pEntry->m_state, ENTRY_IN_USE);
+    }
+} // ObjectTable::Reinstate
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        Drain
+// Description: Waits until the references to a retired entry have all been
+//              released
+////////////////////////////////////////////////////////////////////////////////
+template <typename Object>
+void ObjectTable<Object>::Drain(
+    TableHandle handle
+    )
+{
+    ObjectEntry* pEntry = this->LocateRetiredEntry(handle);
+
+    if (NULL != pEntry)
+    {
+        while (pEntry->m_state & ENTRY_REFERENCES)
+        {
+            CPL_MillisecondSleep(1);
+        }
+    }
+} // ObjectTable::Drain
+
 ////////////////////////////////////////////////////////////////////////////////
 // Name:        Remove
 // Description: Removes an object pointer from the table.  Note that removal
@@ -353,19 +611,24 @@ Object* ObjectTable<Object>::Remove(
 {
     Object* pObject   = NULL;
 
-    if (this->TableHandleIsValid(handle))
+    // Retire the entry, unless the caller already did, and wait for the
+    // references already taken to be released
+    this->Retire(handle);
+
+    ObjectEntry* pEntry = this->LocateRetiredEntry(handle);
+    if (NULL != pEntry)
     {
         INT16U index = EXTRACT_INDEX(handle);
 
-        // Mark the entry as unused
-        m_objectTable[index].m_used = false;
+        this->Drain(handle);
 
         // Get object pointer for caller
-        pObject = m_objectTable[index].m_pObject;
+        pObject = pEntry->m_pObject;
+        pEntry->m_pObject = NULL;
 
         // Fix up the free entry list
-        m_objectTable[index].m_nextFree = m_firstFree;
-        m_firstFree                     = index;
+        pEntry->m_nextFree = m_firstFree;
+        m_firstFree        = index;
         ++m_numberFree;
     }
 
@@ -384,17 +647,19 @@ void ObjectTable<Object>::ForEach(
     INT64U           context
     )
 {
-    INT16U index;
+    INT32U index;
 
     // For each used entry, invoke the callback
-    for (index = 0; index < m_objectTable.size(); ++index)
+    for (index = 0; index < m_size; ++index)
     {
-        if (m_objectTable[index].m_used)
+        ObjectEntry* pEntry = this->LocateEntry((INT16U) index);
+
+        if (pEntry->m_state & ENTRY_IN_USE)
         {
-            INT32U handle = CREATE_HANDLE(m_objectTable[index].m_signature,
+            INT32U handle = CREATE_HANDLE(EXTRACT_SIGNATURE(pEntry->m_state),
                                           index);
             CALLBACK_STATUS status = 
-                pCallback(handle, m_objectTable[index].m_pObject, context);
+                pCallback(handle, pEntry->m_pObject, context);
 
             // If we are supposed to remove the object from the table, do so
             if ((CALLBACK_STATUS_REMOVE_AND_CONTINUE == status) ||
@@ -413,6 +678,60 @@ void ObjectTable<Object>::ForEach(
     }
 } // ObjectTable::ForEach
 
+////////////////////////////////////////////////////////////////////////////////
+// Name:        Grow
+// Description: Allocates segments for at least count more entries and links
+//              the new entries onto the free list.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Object>
+void ObjectTable<Object>::Grow(
+    INT32U count
+    )
+{
+    INT32U oldSize = m_size;
+    INT32U newSize = oldSize + count;
+
+    while (m_size < newSize)
+    {
+        if (m_size >= MAX_SEGMENTS * SEGMENT_SIZE)
+        {
+            throw std::bad_alloc();
+        }
+
+        ObjectEntry* pSegment = new ObjectEntry[SEGMENT_SIZE];
+        for (INT32U entry = 0; entry < SEGMENT_SIZE; ++entry)
+        {
+            pSegment[entry].m_nextFree = (INT16U) (m_size + entry + 1);
+        }
+
+        // Publish the segment only once its entries are initialized
+        CPL_AtomicExchangePointer(
+            reinterpret_cast<void* volatile*>(
+                &m_segments[m_size / SEGMENT_SIZE]),
+            pSegment);
+        m_size += SEGMENT_SIZE;
+    }
+
+    // The table only grows when it has no free entries, so the new entries
+    // make up the free list
+    m_firstFree  = (INT16U) oldSize;
+    m_numberFree = m_size - oldSize;
+} // ObjectTable::Grow
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        LocateEntry
+// Description: Finds the entry for a table index
+////////////////////////////////////////////////////////////////////////////////
+template <typename Object>
+typename ObjectTable<Object>::ObjectEntry* ObjectTable<Object>::LocateEntry(
+    INT16U index
+    ) const
+{
+    ObjectEntry* pSegment = m_segments[index / SEGMENT_SIZE];
+
+    return (NULL == pSegment) ? NULL : &pSegment[index % SEGMENT_SIZE];
+} // ObjectTable::LocateEntry
+
 ////////////////////////////////////////////////////////////////////////////////
 // Name:        TableHandleIsValid
 // Description: Determines if the table handle references a valid entry in
@@ -427,18 +746,39 @@ bool ObjectTable<Object>::TableHandleIsValid(
     ) const
 {
     // Get the signature and table index from the handle
-    INT16U  signature = EXTRACT_SIGNATURE(handle);
-    INT16U  index     = EXTRACT_INDEX(handle);
+    INT16U          signature = EXTRACT_SIGNATURE(handle);
+    ObjectEntry*    pEntry    = this->LocateEntry(EXTRACT_INDEX(handle));
 
     // A table handle has the following properties:
     // - the index is within the table
     // - the table entry is used
     // - the signature matches the signature in the entry
-    return ((index < m_objectTable.size()) &&
-            m_objectTable[index].m_used    &&
-            (m_objectTable[index].m_signature == signature));
+    return ((NULL != pEntry)                    &&
+            (pEntry->m_state & ENTRY_IN_USE)    &&
+            (EXTRACT_SIGNATURE(pEntry->m_state) == signature));
 } // ObjectTable::TableHandleIsValid
 
+////////////////////////////////////////////////////////////////////////////////
+// Name:        LocateRetiredEntry
+// Description: Finds the entry for a table handle that has been retired but
+//              not removed
+////////////////////////////////////////////////////////////////////////////////
+template <typename Object>
+typename ObjectTable<Object>::ObjectEntry* ObjectTable<Object>::LocateRetiredEntry(
+    TableHandle handle
+    ) const
+{
+    ObjectEntry* pEntry = this->LocateEntry(EXTRACT_INDEX(handle));
+
+    // The signature stays with the entry until it is reused, but only an
+    // entry that hasn't been freed still has its object
+    return ((NULL != pEntry)                                            &&
+            !(pEntry->m_state & ENTRY_IN_USE)                           &&
+            (EXTRACT_SIGNATURE(pEntry->m_state) ==
+                EXTRACT_SIGNATURE(handle))                              &&
+            (NULL != pEntry->m_pObject)) ? pEntry : NULL;
+} // ObjectTable::LocateRetiredEntry
+
 } // namespace rfid
 
 #endif // #ifndef OBJECT_TABLE_H_INCLUDED
@@ -0,0 +1,38 @@
+/*
+ *****************************************************************************
+ *                                                                           *
+ *                 IMPINJ CONFIDENTIAL AND PROPRIETARY                       *
+ *                                                                           *
+ * This source code is the sole property of Impinj, Inc.  Reproduction or    *
+ * utilization of this source code in whole or in part is forbidden without  *
+ * the prior written consent of Impinj, Inc.                                 *
+ *                                                                           *
+ * (c) Copyright Impinj, Inc. 2009. All rights reserved.                     *
+ *                                                                           *
+ *****************************************************************************
+ */
+
+/*
+ *****************************************************************************
+ *
+ * $Id$
+ *
+ * Description:
+ *     The operating system definitions that the transport library's public
+ *     header needs when it is used by a client of the transport library
+ *     (i.e., rfidtx.dll) rather than to build the transport library itself
+ *
+ *****************************************************************************
+ */
+
+#ifndef OSWRAPPERS_H_
+#define OSWRAPPERS_H_
+
+#include <windows.h>
+
+/* The transport library's routines are imported from rfidtx.dll */
+#ifndef TRANSLIBAPI
+#define TRANSLIBAPI __declspec(dllimport)
+#endif /* TRANSLIBAPI */
+
+#endif /* OSWRAPPERS_H_ */
@@ -0,0 +1,558 @@
+/*
+ *****************************************************************************
+ *                                                                           *
+ *                 IMPINJ CONFIDENTIAL AND PROPRIETARY                       *
+ *                                                                           *
+ * This source code is the sole property of Impinj, Inc.  Reproduction or    *
+ * utilization of this source code in whole or in part is forbidden without  *
+ * the prior written consent of Impinj, Inc.                                 *
+ *                                                                           *
+ * (c) Copyright Impinj, Inc. 2009. All rights reserved.                     *
+ *                                                                           *
+ *****************************************************************************
+ */
+
+/*
+ *****************************************************************************
+ *
+ * $Id$
+ *
+ * Description:
+ *     This file contains the implementation for the packet capture.
+ *
+ *
+ *****************************************************************************
+ */
+
+#include <string.h>
+#include <new>
+#include <algorithm>
+#include "packet_capture.h"
+#include "rfid_exceptions.h"
+#include "rfid_packets.h"
+#include "auto_lock_compat.h"
+#include "compat_lib.h"
+
+namespace
+{
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: GetMicroseconds
+    //
+    // Description:
+    //   Converts a timestamp to the microseconds the capture file holds
+    ////////////////////////////////////////////////////////////////////////////
+    INT64U GetMicroseconds(
+        const CPL_TimeSpec& time
+        )
+    {
+        return static_cast<INT64U>(time.seconds) * 1000000 +
+            time.nanoseconds / 1000;
+    } // GetMicroseconds
+}
+
+namespace rfid
+{
+
+////////////////////////////////////////////////////////////////////////////
+// Name: PacketCapture
+//
+// Description:
+//   Creates the capture file and starts the thread that writes it
+////////////////////////////////////////////////////////////////////////////
+PacketCapture::PacketCapture(
+    const char*         fileName
+    ) :
+    m_captureFileWrapper(
+        CPL_FileOpen(fileName, CPL_WRITE, CPL_CREAT | CPL_TRUNC)),
+    m_chunkRecordCount(0),
+    m_chunkDropped(0),
+    m_chunkFirstTime(0),
+    m_chunkLastTime(0),
+    m_stopWriter(0)
+{
+    // Verify that the capture file was created properly
+    if (-1 == m_captureFileWrapper.Get())
+    {
+        throw RfidErrorException(RFID_ERROR_FAILURE, __FUNCTION__);
+    }
+
+    // Create the mutex that is used to lock the list of rings
+    if (CPL_MutexInit(&m_ringsLock))
+    {
+        throw RfidErrorException(RFID_ERROR_FAILURE, __FUNCTION__);
+    }
+    m_ringsLockWrapper.Assume(&m_ringsLock);
+
+    PacketCaptureFile::FILE_HEADER header;
+    header.magic   = PacketCaptureFile::MAGIC;
+    header.version = PacketCaptureFile::VERSION;
+    if (sizeof(header) !=
+        CPL_FileWrite(m_captureFileWrapper, &header, sizeof(header)))
+    {
+        throw RfidErrorException(RFID_ERROR_FAILURE, __FUNCTION__);
+    }
+
+    m_chunkRecords.reserve(CHUNK_SIZE);
+
+    if (CPL_ThreadKeyCreate(&m_ringKey, PacketCapture::RingThreadExited))
+    {
+        throw RfidErrorException(RFID_ERROR_FAILURE, __FUNCTION__);
+    }
+
+    if (CPL_ThreadCreate(&m_writerThread, PacketCapture::WriterThread, this))
+    {
+        CPL_ThreadKeyDelete(m_ringKey);
+        throw RfidErrorException(RFID_ERROR_FAILURE, __FUNCTION__);
+    }
+} // PacketCapture::PacketCapture
+
+////////////////////////////////////////////////////////////////////////////
+// Name: ~PacketCapture
+//
+// Description:
+//   Writes the packets that are still queued and closes the capture file
+////////////////////////////////////////////////////////////////////////////
+PacketCapture::~PacketCapture()
+{
+    // The writer makes a last pass before it exits
+    CPL_AtomicExchange32(&m_stopWriter, 1);
+    CPL_ThreadJoin(&m_writerThread, NULL);
+
+    // Deleting the key only marks the rings of the threads still running
+    CPL_ThreadKeyDelete(m_ringKey);
+    for (CAPTURE_RINGS::iterator ring = m_rings.begin();
+         ring != m_rings.end();
+         ++ring)
+    {
+        delete *ring;
+    }
+} // PacketCapture::~PacketCapture
+
+////////////////////////////////////////////////////////////////////////////
+// Name: Capture
+//
+// Description:
+//   Queues a copy of a packet on the calling thread's queue.  A packet
+//   longer than a queue slot is truncated; if the queue is full, the
+//   packet is dropped and counted.  Never blocks.
+////////////////////////////////////////////////////////////////////////////
+void PacketCapture::Capture(
+    INT32U              radio,
+    const INT8U*        pPacket,
+    INT32U              length
+    )
+{
+    CAPTURE_RING* pRing = this->GetRing();
+    if (NULL == pRing)
+    {
+        return;
+    }
+
+    // Only this thread moves the head, so only the tail can have changed
+    INT32U head = static_cast<INT32U>(pRing->head);
+    if (head - static_cast<INT32U>(pRing->tail) >= RING_SLOTS)
+    {
+        CPL_AtomicIncrement32(&pRing->dropped);
+        return;
+    }
+
+    CAPTURE_SLOT* pSlot = &pRing->slots[head % RING_SLOTS];
+    CPL_TimeSpecGet(&pSlot->time);
+    pSlot->radio        = radio;
+    pSlot->flags        = 0;
+    pSlot->packetLength = static_cast<INT16U>(length);
+    if (length > SLOT_PACKET_BYTES)
+    {
+        pSlot->flags |= PacketCaptureFile::PACKET_TRUNCATED;
+        length        = SLOT_PACKET_BYTES;
+    }
+    pSlot->storedLength = static_cast<INT16U>(length);
+    memcpy(pSlot->packet, pPacket, length);
+
+    // Hand the slot to the writer
+    CPL_AtomicExchange32(&pRing->head, static_cast<CPL_Atomic32>(head + 1));
+} // PacketCapture::Capture
+
+////////////////////////////////////////////////////////////////////////////
+// Name: GetRing
+//
+// Description:
+//   Retrieves the calling thread's ring, creating it on first use
+////////////////////////////////////////////////////////////////////////////
+PacketCapture::CAPTURE_RING* PacketCapture::GetRing()
+{
+    CAPTURE_RING* pRing =
+        static_cast<CAPTURE_RING*>(CPL_ThreadKeyGet(m_ringKey));
+    if (NULL != pRing)
+    {
+        return pRing;
+    }
+
+    if (NULL == (pRing = new (std::nothrow) CAPTURE_RING))
+    {
+        return NULL;
+    }
+    pRing->head    = 0;
+    pRing->tail    = 0;
+    pRing->dropped = 0;
+    pRing->exited  = 0;
+
+    try
+    {
+        CplMutexAutoLock ringsGuard(&m_ringsLock);
+        m_rings.push_back(pRing);
+    }
+    catch (...)
+    {
+        delete pRing;
+        return NULL;
+    }
+    CPL_ThreadKeySet(m_ringKey, pRing);
+
+    return pRing;
+} // PacketCapture::GetRing
+
+////////////////////////////////////////////////////////////////////////////
+// Name: RingThreadExited
+//
+// Description:
+//   Called when a thread that has a ring exits, to let the writer free the
+//   ring once it has written the ring's packets
+////////////////////////////////////////////////////////////////////////////
+void CPL_THREAD_KEY_CALLBACK PacketCapture::RingThreadExited(
+    void*               pRing
+    )
+{
+    // The writer may free the ring as soon as this is set
+    CPL_AtomicExchange32(&static_cast<CAPTURE_RING*>(pRing)->exited, 1);
+} // PacketCapture::RingThreadExited
+
+////////////////////////////////////////////////////////////////////////////
+// Name: WriteQueuedPackets
+//
+// Description:
+//   Adds every packet queued on the rings, oldest first, to the chunk being
+//   built, and writes the chunk out whenever it is full or spans
+//   CHUNK_INTERVAL
+////////////////////////////////////////////////////////////////////////////
+void PacketCapture::WriteQueuedPackets(
+    bool                flush
+    )
+{
+    // Threads only take the lock to add their ring and only this thread
+    // frees one, so the packets are merged and the chunks written (which
+    // can take a while) without holding it
+    CAPTURE_RINGS rings;
+    {
+        CplMutexAutoLock ringsGuard(&m_ringsLock);
+        rings = m_rings;
+    }
+
+    std::vector<INT32U> heads(rings.size());
+    std::vector<bool>   exited(rings.size());
+    bool                anyExited = false;
+    size_t              index;
+
+    for (index = 0; index < rings.size(); ++index)
+    {
+        CAPTURE_RING* pRing = rings[index];
+
+        // A thread that had exited before its head is read has queued all
+        // it ever will
+        exited[index]   = (0 != CPL_AtomicCompareExchange32(&pRing->exited, 0, 0));
+        anyExited       = anyExited || exited[index];
+        heads[index]    = static_cast<INT32U>(pRing->head);
+        m_chunkDropped += CPL_AtomicExchange32(&pRing->dropped, 0);
+    }
+
+    // Merge the rings' packets into time order
+    for (;;)
+    {
+        CAPTURE_RING*       pOldest = NULL;
+        const CAPTURE_SLOT* pSlot   = NULL;
+
+        for (index = 0; index < rings.size(); ++index)
+        {
+            CAPTURE_RING*   pRing = rings[index];
+            INT32U          tail  = static_cast<INT32U>(pRing->tail);
+
+            if (tail == heads[index])
+            {
+                continue;
+            }
+
+            const CAPTURE_SLOT* pCandidate = &pRing->slots[tail % RING_SLOTS];
+            if ((NULL == pSlot) ||
+                (pCandidate->time.seconds < pSlot->time.seconds) ||
+                ((pCandidate->time.seconds == pSlot->time.seconds) &&
+                 (pCandidate->time.nanoseconds < pSlot->time.nanoseconds)))
+            {
+                pOldest = pRing;
+                pSlot   = pCandidate;
+            }
+        }
+        if (NULL == pSlot)
+        {
+            break;
+        }
+
+        this->AddPacket(pSlot);
+
+        // Hand the slot back to its thread
+        CPL_AtomicExchange32(
+            &pOldest->tail,
+            static_cast<CPL_Atomic32>(static_cast<INT32U>(pOldest->tail) + 1));
+    }
+
+    // Free the rings of the threads that have exited, which are now empty
+    if (anyExited)
+    {
+        CplMutexAutoLock ringsGuard(&m_ringsLock);
+        for (index = 0; index < rings.size(); ++index)
+        {
+            if (exited[index])
+            {
+                m_rings.erase(
+                    std::find(m_rings.begin(), m_rings.end(), rings[index]));
+                delete rings[index];
+            }
+        }
+    }
+
+    // A quiet radio's packets are still written within about a chunk interval
+    CPL_TimeSpec now;
+    CPL_TimeSpecGet(&now);
+    if (m_chunkRecordCount &&
+        (flush || (GetMicroseconds(now) - m_chunkFirstTime >= CHUNK_INTERVAL)))
+    {
+        this->WriteChunk();
+    }
+} // PacketCapture::WriteQueuedPackets
+
+////////////////////////////////////////////////////////////////////////////
+// Name: AddPacket
+//
+// Description:
+//   Adds a packet to the chunk being built, preceded by a radio record if
+//   it is the first from its radio in the chunk, and notes the antenna the
+//   radio is now using
+////////////////////////////////////////////////////////////////////////////
+void PacketCapture::AddPacket(
+    const CAPTURE_SLOT* pSlot
+    )
+{
+    INT64U time = GetMicroseconds(pSlot->time);
+
+    // Start a new chunk if this one is full or old
+    if (m_chunkRecordCount &&
+        ((m_chunkRecords.size() + sizeof(PacketCaptureFile::RADIO_RECORD) +
+          sizeof(PacketCaptureFile::PACKET_RECORD) + pSlot->storedLength >
+            CHUNK_SIZE) ||
+         (time >= m_chunkFirstTime + CHUNK_INTERVAL)))
+    {
+        this->WriteChunk();
+    }
+
+    // Each pass merges the packets it finds into time order, but a packet
+    // queued just after a pass can be older than the last one it wrote, so
+    // the chunk and index times are the earliest and latest, not the first
+    // and last
+    if (!m_chunkRecordCount)
+    {
+        m_chunkFirstTime = time;
+        m_chunkLastTime  = time;
+    }
+    else if (time < m_chunkFirstTime)
+    {
+        m_chunkFirstTime = time;
+    }
+    else if (time > m_chunkLastTime)
+    {
+        m_chunkLastTime = time;
+    }
+
+    // The chunk says which antenna the radio was using, so that it can be
+    // decoded on its own
+    if (m_chunkRadios.insert(pSlot->radio).second)
+    {
+        std::map<INT32U, INT32U>::const_iterator antenna =
+            m_antennas.find(pSlot->radio);
+
+        PacketCaptureFile::RADIO_RECORD record;
+        record.header.type   = PacketCaptureFile::RECORD_RADIO;
+        record.header.length = sizeof(record);
+        record.radio         = pSlot->radio;
+        record.antenna       = (m_antennas.end() == antenna) ?
+            PacketCaptureFile::ANTENNA_UNKNOWN : antenna->second;
+        this->AppendRecord(&record, sizeof(record), NULL, 0);
+    }
+
+    const RFID_PACKET_COMMON* pCommon =
+        reinterpret_cast<const RFID_PACKET_COMMON*>(pSlot->packet);
+    INT16U packetType = (pSlot->storedLength >= sizeof(RFID_PACKET_COMMON)) ?
+        CPL_MacToHost16(pCommon->pkt_type) : 0xFFFF;
+
+    if ((RFID_PACKET_TYPE_ANTENNA_BEGIN == packetType) &&
+        (pSlot->storedLength >= sizeof(RFID_PACKET_ANTENNA_BEGIN)))
+    {
+        m_antennas[pSlot->radio] = CPL_MacToHost32(
+            reinterpret_cast<const RFID_PACKET_ANTENNA_BEGIN*>(
+                pSlot->packet)->antenna);
+    }
+
+    PacketCaptureFile::PACKET_RECORD record;
+    record.header.type   = PacketCaptureFile::RECORD_PACKET;
+    record.header.length =
+        static_cast<INT16U>(sizeof(record) + pSlot->storedLength);
+    record.radio         = pSlot->radio;
+    record.time          = time;
+    record.flags         = pSlot->flags;
+    record.packetLength  = pSlot->packetLength;
+    this->AppendRecord(
+        &record,
+        sizeof(record),
+        pSlot->packet,
+        pSlot->storedLength);
+
+    CHUNK_INDEX::iterator entry = m_chunkIndex.find(packetType);
+    if (m_chunkIndex.end() == entry)
+    {
+        PacketCaptureFile::INDEX_ENTRY newEntry;
+        newEntry.packetType = packetType;
+        newEntry.reserved   = 0;
+        newEntry.count      = 0;
+        newEntry.firstTime  = time;
+        newEntry.lastTime   = time;
+        entry = m_chunkIndex.insert(std::make_pair(packetType, newEntry)).first;
+    }
+    ++entry->second.count;
+    if (time < entry->second.firstTime)
+    {
+        entry->second.firstTime = time;
+    }
+    else if (time > entry->second.lastTime)
+    {
+        entry->second.lastTime = time;
+    }
+} // PacketCapture::AddPacket
+
+////////////////////////////////////////////////////////////////////////////
+// Name: AppendRecord
+//
+// Description:
+//   Appends a record to the chunk being built
+////////////////////////////////////////////////////////////////////////////
+void PacketCapture::AppendRecord(
+    const void*         pHeader,
+    INT32U              headerLength,
+    const void*         pBody,
+    INT32U              bodyLength
+    )
+{
+    const INT8U* pHeaderBytes = static_cast<const INT8U*>(pHeader);
+    const INT8U* pBodyBytes   = static_cast<const INT8U*>(pBody);
+    m_chunkRecords.insert(
+        m_chunkRecords.end(),
+        pHeaderBytes,
+        pHeaderBytes + headerLength);
+    m_chunkRecords.insert(
+        m_chunkRecords.end(),
+        pBodyBytes,
+        pBodyBytes + bodyLength);
+    ++m_chunkRecordCount;
+} // PacketCapture::AppendRecord
+
+////////////////////////////////////////////////////////////////////////////
+// Name: WriteChunk
+//
+// Description:
+//   Writes the chunk being built out to the file, with its header and
+//   index, and starts a new one
+////////////////////////////////////////////////////////////////////////////
+void PacketCapture::WriteChunk()
+{
+    std::vector<PacketCaptureFile::INDEX_ENTRY> index;
+    index.reserve(m_chunkIndex.size());
+    for (CHUNK_INDEX::const_iterator entry = m_chunkIndex.begin();
+         entry != m_chunkIndex.end();
+         ++entry)
+    {
+        index.push_back(entry->second);
+    }
+
+    INT32U indexLength = static_cast<INT32U>(
+        index.size() * sizeof(PacketCaptureFile::INDEX_ENTRY));
+
+    PacketCaptureFile::CHUNK_HEADER header;
+    header.magic        = PacketCaptureFile::CHUNK_MAGIC;
+    header.length       = static_cast<INT32U>(
+        sizeof(header) + indexLength + m_chunkRecords.size());
+    header.indexEntries = static_cast<INT32U>(index.size());
+    header.records      = m_chunkRecordCount;
+    header.dropped      = m_chunkDropped;
+    header.reserved     = 0;
+    header.firstTime    = m_chunkFirstTime;
+    header.lastTime     = m_chunkLastTime;
+
+    // A chunk cut short by a crash is shorter than its header says, which
+    // the decoder notices
+    CPL_FileWrite(m_captureFileWrapper, &header, sizeof(header));
+    if (indexLength)
+    {
+        CPL_FileWrite(m_captureFileWrapper, &index[0], indexLength);
+    }
+    if (!m_chunkRecords.empty())
+    {
+        CPL_FileWrite(
+            m_captureFileWrapper,
+            &m_chunkRecords[0],
+            static_cast<INT32U>(m_chunkRecords.size()));
+    }
+    CPL_FileFlush(m_captureFileWrapper);
+
+    m_chunkRadios.clear();
+    m_chunkIndex.clear();
+    m_chunkRecords.clear();
+    m_chunkRecordCount = 0;
+    m_chunkDropped     = 0;
+} // PacketCapture::WriteChunk
+
+////////////////////////////////////////////////////////////////////////////
+// Name: WriterThread
+//
+// Description:
+//   Writes queued packets every WRITE_INTERVAL milliseconds until the
+//   capture is destroyed
+////////////////////////////////////////////////////////////////////////////
+void* PacketCapture::WriterThread(
+    void*               context
+    )
+{
+    PacketCapture* pCapture = static_cast<PacketCapture*>(context);
+
+    while (!pCapture->m_stopWriter)
+    {
+        CPL_MillisecondSleep(WRITE_INTERVAL);
+        try
+        {
+            pCapture->WriteQueuedPackets(false);
+        }
+        catch (...)
+        {
+            // Try again next time
+        }
+    }
+
+    // Pick up whatever was queued while the capture was being destroyed
+    try
+    {
+        pCapture->WriteQueuedPackets(true);
+    }
+    catch (...)
+    {
+    }
+
+    return NULL;
+} // PacketCapture::WriterThread
+
+} // namespace rfid
@@ -0,0 +1,390 @@
+/*
+ *****************************************************************************
+ *                                                                           *
+ *                 IMPINJ CONFIDENTIAL AND PROPRIETARY                       *
+ *                                                                           *
+ * This source code is the sole property of Impinj, Inc.  Reproduction or    *
+ * utilization of this source code in whole or in part is forbidden without  *
+ * the prior written consent of Impinj, Inc.                                 *
+ *                                                                           *
+ * (c) Copyright Impinj, Inc. 2009. All rights reserved.                     *
+ *                                                                           *
+ *****************************************************************************
+ */
+
+/*
+ *****************************************************************************
+ *
+ * $Id$
+ *
+ * Description:
+ *     This header presents the interface for the class that captures the
+ *     packets the radios send, as they come off the transport, to a binary
+ *     file.  A packet is copied, with the host time and the radio it came
+ *     from, onto a per-thread queue, and a background thread writes the
+ *     queued packets to the file in chunks that each carry an index by time
+ *     and packet type.  The layout of the file is described here so that
+ *     the offline decoder can read it.
+ *
+ *
+ *****************************************************************************
+ */
+
+#ifndef PACKET_CAPTURE_H_INCLUDED
+#define PACKET_CAPTURE_H_INCLUDED
+
+#include <vector>
+#include <map>
+#include <set>
+#include "rfid_platform_types.h"
+#include "auto_handle_compat.h"
+#include "compat_atomic.h"
+#include "compat_fildes.h"
+#include "compat_mutex.h"
+#include "compat_thread.h"
+#include "compat_time.h"
+
+namespace rfid
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: PacketCaptureFile
+//
+// Description: The layout of a packet capture file.  The file starts with a
+//              header, which is followed by chunks.  A chunk is a chunk
+//              header, an index entry for each packet type in the chunk and
+//              then records that each start with a record header.  A chunk
+//              can be decoded without the chunks before it: the first packet
+//              from a radio in each chunk is preceded by a radio record that
+//              carries the antenna the radio was last using.  Packets are as
+//              the MAC sent them (i.e., in MAC byte order); everything else
+//              is in host byte order.  Times are microseconds since midnight
+//              GMT, January 1, 1970.
+////////////////////////////////////////////////////////////////////////////////
+namespace PacketCaptureFile
+{
+    enum
+    {
+        MAGIC               = 0x50414352,   // "RCAP"
+        CHUNK_MAGIC         = 0x4B484352,   // "RCHK"
+        VERSION             = 1,
+        ANTENNA_UNKNOWN     = 0xFFFFFFFF
+    };
+
+    enum
+    {
+        RECORD_RADIO        = 1,            // The state of a radio
+        RECORD_PACKET       = 2             // A packet
+    };
+
+    enum
+    {
+        PACKET_TRUNCATED    = 0x0001        // The packet didn't all fit
+    };
+
+#pragma pack(push, 1)
+    struct FILE_HEADER
+    {
+        INT32U  magic;
+        INT32U  version;
+    };
+
+    // Followed by the index entries and then the records
+    struct CHUNK_HEADER
+    {
+        INT32U  magic;
+        INT32U  length;                     // Including this header
+        INT32U  indexEntries;
+        INT32U  records;
+        INT32U  dropped;                    // Packets that didn't fit on a
+                                            // queue since the last chunk
+        INT32U  reserved;
+        INT64U  firstTime;                  // Of the earliest packet
+        INT64U  lastTime;                   // Of the latest packet
+    };
+
+    struct INDEX_ENTRY
+    {
+        INT16U  packetType;
+        INT16U  reserved;
+        INT32U  count;
+        INT64U  firstTime;
+        INT64U  lastTime;
+    };
+
+    struct RECORD_HEADER
+    {
+        INT16U  type;
+        INT16U  length;                     // Including this header
+    };
+
+    struct RADIO_RECORD
+    {
+        RECORD_HEADER   header;
+        INT32U          radio;
+        INT32U          antenna;
+    };
+
+    // Followed by the packet's bytes
+    struct PACKET_RECORD
+    {
+        RECORD_HEADER   header;
+        INT32U          radio;
+        INT64U          time;
+        INT16U          flags;
+        INT16U          packetLength;       // As the MAC sent it
+    };
+#pragma pack(pop)
+} // namespace PacketCaptureFile
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: PacketCapture
+//
+// Description: The packet capture class (i.e., queues copies of the packets
+//              the radios send and writes them to a capture file in the
+//              background)
+////////////////////////////////////////////////////////////////////////////////
+class PacketCapture
+{
+public:
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: PacketCapture
+    //
+    // Description:
+    //   Creates the capture file and starts the thread that writes it
+    //
+    // Parameters:
+    //   fileName - name of the capture file
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    explicit PacketCapture(
+        const char*         fileName
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: ~PacketCapture
+    //
+    // Description:
+    //   Writes the packets that are still queued and closes the capture file
+    //
+    // Parameters:
+    //   None
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    ~PacketCapture();
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: Capture
+    //
+    // Description:
+    //   Queues a copy of a packet on the calling thread's queue.  A packet
+    //   longer than a queue slot is truncated; if the queue is full, the
+    //   packet is dropped and counted.  Never blocks.
+    //
+    // Parameters:
+    //   radio - the radio the packet came from (its transport handle)
+    //   pPacket - the packet, in MAC byte order
+    //   length - the length of the packet, in bytes
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void Capture(
+        INT32U              radio,
+        const INT8U*        pPacket,
+        INT32U              length
+        );
+
+private:
+    enum {
+        RING_SLOTS          = 2048,         // Packets queued per thread
+        SLOT_PACKET_BYTES   = 256,          // Packet bytes kept per packet
+        CHUNK_SIZE          = 1048576,      // Record bytes per chunk
+        CHUNK_INTERVAL      = 1000000,      // Microseconds per chunk
+        WRITE_INTERVAL      = 50            // Milliseconds between batches
+    };
+
+    // A packet waiting to be written
+    struct CAPTURE_SLOT
+    {
+        CPL_TimeSpec    time;
+        INT32U          radio;
+        INT16U          flags;
+        INT16U          packetLength;
+        INT16U          storedLength;
+        INT8U           packet[SLOT_PACKET_BYTES];
+    };
+
+    // The packets of one thread.  The thread only advances the head and the
+    // writer only advances the tail, so neither needs a lock.  Once the
+    // thread has exited, the writer frees the ring after emptying it.
+    struct CAPTURE_RING
+    {
+        volatile CPL_Atomic32   head;
+        volatile CPL_Atomic32   tail;
+        volatile CPL_Atomic32   dropped;
+        volatile CPL_Atomic32   exited;
+        CAPTURE_SLOT            slots[RING_SLOTS];
+    };
+    typedef std::vector<CAPTURE_RING*>  CAPTURE_RINGS;
+
+    // The index of the chunk being built, by packet type
+    typedef std::map<INT16U, PacketCaptureFile::INDEX_ENTRY>    CHUNK_INDEX;
+
+    CplFileAutoHandle   m_captureFileWrapper;   // A wrapper around the capture
+                                                // file handle that ensures that
+                                                // it is automatically destroyed
+    CPL_ThreadKey       m_ringKey;              // Holds each thread's ring
+    CAPTURE_RINGS       m_rings;                // Every thread's ring
+    CPL_Mutex           m_ringsLock;            // A lock to protect the list
+                                                // of rings (only the writer
+                                                // frees a ring)
+    CplMutexAutoHandle  m_ringsLockWrapper;     // A wrapper around the lock
+                                                // to ensure automatic cleanup
+    std::map<INT32U, INT32U>    m_antennas;     // Each radio's last antenna
+    std::set<INT32U>    m_chunkRadios;          // Radios with a radio record
+                                                // in the chunk being built
+    CHUNK_INDEX         m_chunkIndex;           // The chunk's index
+    std::vector<INT8U>  m_chunkRecords;         // The chunk's records
+    INT32U              m_chunkRecordCount;     // The records in the chunk
+    INT32U              m_chunkDropped;         // Packets dropped since the
+                                                // last chunk
+    INT64U              m_chunkFirstTime;       // The chunk's earliest packet
+    INT64U              m_chunkLastTime;        // The chunk's latest packet
+    volatile CPL_Atomic32   m_stopWriter;       // Tells the writer to finish
+    CPL_Thread          m_writerThread;         // Writes the file
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: GetRing
+    //
+    // Description:
+    //   Retrieves the calling thread's ring, creating it on first use
+    //
+    // Parameters:
+    //   None
+    //
+    // Returns:
+    //   The ring, or NULL if it could not be created
+    ////////////////////////////////////////////////////////////////////////////
+    CAPTURE_RING* GetRing();
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: RingThreadExited
+    //
+    // Description:
+    //   Called when a thread that has a ring exits, to let the writer free
+    //   the ring once it has written the ring's packets
+    //
+    // Parameters:
+    //   pRing - the thread's ring
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    static void CPL_THREAD_KEY_CALLBACK RingThreadExited(
+        void*               pRing
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: WriteQueuedPackets
+    //
+    // Description:
+    //   Adds every packet queued on the rings, oldest first, to the chunk
+    //   being built, and writes the chunk out whenever it is full or spans
+    //   CHUNK_INTERVAL
+    //
+    // Parameters:
+    //   flush - write out the chunk being built even if it is neither full
+    //     nor old
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void WriteQueuedPackets(
+        bool                flush
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: AddPacket
+    //
+    // Description:
+    //   Adds a packet to the chunk being built, preceded by a radio record if
+    //   it is the first from its radio in the chunk, and notes the antenna
+    //   the radio is now using
+    //
+    // Parameters:
+    //   pSlot - the queued packet
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void AddPacket(
+        const CAPTURE_SLOT* pSlot
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: AppendRecord
+    //
+    // Description:
+    //   Appends a record to the chunk being built
+    //
+    // Parameters:
+    //   pHeader - the record's fixed part
+    //   headerLength - the length of the fixed part
+    //   pBody - the record's variable part
+    //   bodyLength - the length of the variable part
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void AppendRecord(
+        const void*         pHeader,
+        INT32U              headerLength,
+        const void*         pBody,
+        INT32U              bodyLength
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: WriteChunk
+    //
+    // Description:
+    //   Writes the chunk being built out to the file, with its header and
+    //   index, and starts a new one
+    //
+    // Parameters:
+    //   None
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void WriteChunk();
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: WriterThread
+    //
+    // Description:
+    //   Writes queued packets every WRITE_INTERVAL milliseconds until the
+    //   capture is destroyed
+    //
+    // Parameters:
+    //   context - the capture
+    //
+    // Returns:
+    //   NULL
+    ////////////////////////////////////////////////////////////////////////////
+    static void* WriterThread(
+        void*               context
+        );
+
+    // Prevent copying of capture objects
+    PacketCapture(const PacketCapture&);
+    const PacketCapture& operator = (const PacketCapture&);
+}; // class PacketCapture
+
+} // namespace rfid
+
+#endif // PACKET_CAPTURE_H_INCLUDED
@@ -0,0 +1,761 @@
+/*
+ *****************************************************************************
+ *                                                                           *
+ *                 IMPINJ CONFIDENTIAL AND PROPRIETARY                       *
+ *                                                                           *
+ * This source code is the sole property of Impinj, Inc.  Reproduction or    *
+ * utilization of this source code in whole or in part is forbidden without  *
+ * the prior written consent of Impinj, Inc.                                 *
+ *                                                                           *
+ * (c) Copyright Impinj, Inc. 2009. All rights reserved.                     *
+ *                                                                           *
+ *****************************************************************************
+ */
+
+/*
+ *****************************************************************************
+ *
+ * $Id$
+ *
+ * Description:
+ *     This file contains the offline decoder for packet capture files.  It
+ *     uses the chunk headers and indexes to pick out the chunks that can
+ *     hold the packets asked for, decodes those chunks on several threads
+ *     and either summarizes them (packets per type and tag reads per radio,
+ *     antenna and second, as CSV) or dumps the packets in time order.  It
+ *     is a standalone program that is not part of the library, e.g.:
+ *
+ *         cl /EHsc packet_capture_decode.cpp
+ *         packet_capture_decode -from 1262304000 -radio 1 rfid_library.rcap
+ *
+ *
+ *****************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "packet_capture.h"
+#include "rfid_packets.h"
+#include "byte_swap.h"
+
+#ifdef _MSC_VER
+#define snprintf _snprintf
+#endif
+
+namespace
+{
+    namespace CaptureFile = rfid::PacketCaptureFile;
+
+    enum
+    {
+        CHUNKS_PER_THREAD   = 4,            // Chunks each thread decodes
+                                            // before the results are merged
+        MAX_THREADS         = 64,
+        MAX_BUFFER_SIZE     = 64
+    };
+
+    // What the user asked for
+    struct OPTIONS
+    {
+        INT32U              threads;
+        INT64U              fromTime;
+        INT64U              toTime;
+        std::set<INT16U>    types;
+        bool                filterRadio;
+        INT32U              radio;
+        bool                dump;
+    };
+
+    // A chunk that can hold packets that were asked for
+    struct CHUNK
+    {
+        INT64S                  offset;
+        CaptureFile::CHUNK_HEADER   header;
+    };
+
+    // Tag reads are counted by second, radio and antenna
+    struct READ_KEY
+    {
+        INT64U  second;
+        INT32U  radio;
+        INT32U  antenna;
+
+        bool operator < (const READ_KEY& rhs) const
+        {
+            if (second != rhs.second)
+            {
+                return second < rhs.second;
+            }
+            if (radio != rhs.radio)
+            {
+                return radio < rhs.radio;
+            }
+            return antenna < rhs.antenna;
+        }
+    };
+    typedef std::map<READ_KEY, INT64U>  READS;
+    typedef std::map<INT16U, INT64U>    TYPE_COUNTS;
+
+    // What decoding a chunk found
+    struct CHUNK_RESULT
+    {
+        bool            corrupt;
+        INT64U          packets;
+        INT64U          truncated;
+        INT64U          firstTime;
+        INT64U          lastTime;
+        TYPE_COUNTS     types;
+        READS           reads;
+        std::string     dump;
+    };
+
+    // The chunks a batch of threads decodes.  Each thread takes the next
+    // chunk until there are none left and stores what it found at the
+    // chunk's place in the results, so no locks are needed.
+    struct BATCH
+    {
+        const char*                 fileName;
+        const OPTIONS*              pOptions;
+        const CHUNK*                pChunks;
+        CHUNK_RESULT*               pResults;
+        LONG                        chunks;
+        volatile LONG               next;
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: GetPacketTypeName
+    //
+    // Description:
+    //   Returns the name of a packet type, without the RFID_PACKET_TYPE_
+    //   prefix
+    ////////////////////////////////////////////////////////////////////////////
+    std::string GetPacketTypeName(
+        INT16U  packetType
+        )
+    {
+        switch (packetType)
+        {
+            case RFID_PACKET_TYPE_COMMAND_BEGIN:
+                return "COMMAND_BEGIN";
+            case RFID_PACKET_TYPE_COMMAND_END:
+                return "COMMAND_END";
+            case RFID_PACKET_TYPE_ANTENNA_CYCLE_BEGIN:
+                return "ANTENNA_CYCLE_BEGIN";
+            case RFID_PACKET_TYPE_ANTENNA_BEGIN:
+                return "ANTENNA_BEGIN";
+            case RFID_PACKET_TYPE_18K6C_INVENTORY_ROUND_BEGIN:
+                return "18K6C_INVENTORY_ROUND_BEGIN";
+            case RFID_PACKET_TYPE_18K6C_INVENTORY:
+                return "18K6C_INVENTORY";
+            case RFID_PACKET_TYPE_18K6C_TAG_ACCESS:
+                return "18K6C_TAG_ACCESS";
+            case RFID_PACKET_TYPE_ANTENNA_CYCLE_END:
+                return "ANTENNA_CYCLE_END";
+            case RFID_PACKET_TYPE_ANTENNA_END:
+                return "ANTENNA_END";
+            case RFID_PACKET_TYPE_18K6C_INVENTORY_ROUND_END:
+                return "18K6C_INVENTORY_ROUND_END";
+            case RFID_PACKET_TYPE_INVENTORY_CYCLE_BEGIN:
+                return "INVENTORY_CYCLE_BEGIN";
+            case RFID_PACKET_TYPE_INVENTORY_CYCLE_END:
+                return "INVENTORY_CYCLE_END";
+            case RFID_PACKET_TYPE_CARRIER_INFO:
+                return "CARRIER_INFO";
+            case RFID_PACKET_TYPE_COMMAND_ACTIVE:
+                return "COMMAND_ACTIVE";
+            case RFID_PACKET_TYPE_18K6C_INVENTORY_ROUND_BEGIN_DIAGS:
+                return "18K6C_INVENTORY_ROUND_BEGIN_DIAGS";
+            case RFID_PACKET_TYPE_18K6C_INVENTORY_ROUND_END_DIAGS:
+                return "18K6C_INVENTORY_ROUND_END_DIAGS";
+            case RFID_PACKET_TYPE_18K6C_INVENTORY_DIAGS:
+                return "18K6C_INVENTORY_DIAGS";
+            case RFID_PACKET_TYPE_INVENTORY_CYCLE_END_DIAGS:
+                return "INVENTORY_CYCLE_END_DIAGS";
+            case RFID_PACKET_TYPE_SJC_SCANRESULT:
+                return "SJC_SCANRESULT";
+            case RFID_PACKET_TYPE_TX_RANDOM_DATA_STATUS:
+                return "TX_RANDOM_DATA_STATUS";
+            case RFID_PACKET_TYPE_CSM_PROTSCHED_SM_STATUS:
+                return "CSM_PROTSCHED_SM_STATUS";
+            case RFID_PACKET_TYPE_CSM_PROTSCHED_LBT_STATUS:
+                return "CSM_PROTSCHED_LBT_STATUS";
+            case RFID_PACKET_TYPE_NONCRITICAL_FAULT:
+                return "NONCRITICAL_FAULT";
+            case RFID_PACKET_TYPE_DEBUG:
+                return "DEBUG";
+            default:
+            {
+                char buffer[MAX_BUFFER_SIZE];
+                snprintf(buffer, sizeof(buffer), "0x%.4x", packetType);
+                buffer[sizeof(buffer) - 1] = '\0';
+                return buffer;
+            }
+        }
+    } // GetPacketTypeName
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: ParseTime
+    //
+    // Description:
+    //   Converts seconds since midnight GMT, January 1, 1970, which may have
+    //   a fraction, to the microseconds the capture file holds
+    ////////////////////////////////////////////////////////////////////////////
+    INT64U ParseTime(
+        const char* pText
+        )
+    {
+        return static_cast<INT64U>(strtod(pText, NULL) * 1000000.0);
+    } // ParseTime
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: IsChunkWanted
+    //
+    // Description:
+    //   Uses a chunk's header and index to tell whether it can hold any of the
+    //   packets that were asked for
+    ////////////////////////////////////////////////////////////////////////////
+    bool IsChunkWanted(
+        const CaptureFile::CHUNK_HEADER&                header,
+        const std::vector<CaptureFile::INDEX_ENTRY>&    index,
+        const OPTIONS&                                  options
+        )
+    {
+        if ((header.lastTime < options.fromTime) ||
+            (header.firstTime > options.toTime))
+        {
+            return false;
+        }
+        if (options.types.empty())
+        {
+            return true;
+        }
+
+        for (size_t entry = 0; entry < index.size(); ++entry)
+        {
+            if (options.types.count(index[entry].packetType) &&
+                (index[entry].lastTime >= options.fromTime) &&
+                (index[entry].firstTime <= options.toTime))
+            {
+                return true;
+            }
+        }
+        return false;
+    } // IsChunkWanted
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: DecodeChunk
+    //
+    // Description:
+    //   Reads a chunk and counts, or dumps, the packets in it that were asked
+    //   for
+    ////////////////////////////////////////////////////////////////////////////
+    void DecodeChunk(
+        FILE*           pCapture,
+        const CHUNK&    chunk,
+        const OPTIONS&  options,
+        CHUNK_RESULT&   result
+        )
+    {
+        result.corrupt   = false;
+        result.packets   = 0;
+        result.truncated = 0;
+        result.firstTime = 0;
+        result.lastTime  = 0;
+
+        std::vector<INT8U> bytes(chunk.header.length);
+        if ((NULL == pCapture) ||
+            _fseeki64(pCapture, chunk.offset, SEEK_SET) ||
+            (1 != fread(&bytes[0], bytes.size(), 1, pCapture)))
+        {
+            result.corrupt = true;
+            return;
+        }
+
+        // Each chunk says which antenna each of its radios was using
+        std::map<INT32U, INT32U>    antennas;
+        size_t                      offset =
+            sizeof(CaptureFile::CHUNK_HEADER) +
+            chunk.header.indexEntries * sizeof(CaptureFile::INDEX_ENTRY);
+
+        while (offset + sizeof(CaptureFile::RECORD_HEADER) <= bytes.size())
+        {
+            CaptureFile::RECORD_HEADER header;
+            memcpy(&header, &bytes[offset], sizeof(header));
+            if ((header.length < sizeof(header)) ||
+                (offset + header.length > bytes.size()))
+            {
+                result.corrupt = true;
+                return;
+            }
+            const INT8U* pRecord = &bytes[offset];
+            offset += header.length;
+
+            if (CaptureFile::RECORD_RADIO == header.type)
+            {
+                CaptureFile::RADIO_RECORD radio;
+                if (header.length >= sizeof(radio))
+                {
+                    memcpy(&radio, pRecord, sizeof(radio));
+                    antennas[radio.radio] = radio.antenna;
+                }
+                continue;
+            }
+            if ((CaptureFile::RECORD_PACKET != header.type) ||
+                (header.length < sizeof(CaptureFile::PACKET_RECORD)))
+            {
+                // Skip records from a newer capture
+                continue;
+            }
+
+            CaptureFile::PACKET_RECORD record;
+            memcpy(&record, pRecord, sizeof(record));
+            const INT8U*    pPacket      = pRecord + sizeof(record);
+            INT32U          storedLength = header.length - sizeof(record);
+
+            RFID_PACKET_COMMON common;
+            INT16U             packetType = 0xFFFF;
+            if (storedLength >= sizeof(common))
+            {
+                memcpy(&common, pPacket, sizeof(common));
+                packetType = MacToHost16(common.pkt_type);
+            }
+
+            // The antenna changes whether or not the packet was asked for
+            if ((RFID_PACKET_TYPE_ANTENNA_BEGIN == packetType) &&
+                (storedLength >= sizeof(RFID_PACKET_ANTENNA_BEGIN)))
+            {
+                RFID_PACKET_ANTENNA_BEGIN antennaBegin;
+                memcpy(&antennaBegin, pPacket, sizeof(antennaBegin));
+                antennas[record.radio] = MacToHost32(antennaBegin.antenna);
+            }
+
+            if ((record.time < options.fromTime) ||
+                (record.time > options.toTime) ||
+                (options.filterRadio && (options.radio != record.radio)) ||
+                (!options.types.empty() && !options.types.count(packetType)))
+            {
+                continue;
+            }
+
+            std::map<INT32U, INT32U>::const_iterator antenna =
+                antennas.find(record.radio);
+            INT32U antennaId = (antennas.end() == antenna) ?
+                CaptureFile::ANTENNA_UNKNOWN : antenna->second;
+
+            // Packets are only roughly in time order within a chunk
+            if (!result.packets || (record.time < result.firstTime))
+            {
+                result.firstTime = record.time;
+            }
+            if (!result.packets || (record.time > result.lastTime))
+            {
+                result.lastTime = record.time;
+            }
+            ++result.packets;
+            if (record.flags & CaptureFile::PACKET_TRUNCATED)
+            {
+                ++result.truncated;
+            }
+
+            if (options.dump)
+            {
+                char buffer[MAX_BUFFER_SIZE];
+                snprintf(buffer, sizeof(buffer), "%I64u.%.6u,0x%.8x,",
+                    static_cast<INT64U>(record.time / 1000000),
+                    static_cast<INT32U>(record.time % 1000000),
+                    record.radio);
+                buffer[sizeof(buffer) - 1] = '\0';
+                result.dump += buffer;
+                if (CaptureFile::ANTENNA_UNKNOWN == antennaId)
+                {
+                    result.dump += "-";
+                }
+                else
+                {
+                    snprintf(buffer, sizeof(buffer), "%u", antennaId);
+                    buffer[sizeof(buffer) - 1] = '\0';
+                    result.dump += buffer;
+                }
+                snprintf(buffer, sizeof(buffer), ",%u%s,",
+                    record.packetLength,
+                    (record.flags & CaptureFile::PACKET_TRUNCATED) ?
+                        "+" : "");
+                buffer[sizeof(buffer) - 1] = '\0';
+                result.dump += ',';
+                result.dump += GetPacketTypeName(packetType);
+                result.dump += buffer;
+                for (INT32U index = 0; index < storedLength; ++index)
+                {
+                    snprintf(buffer, sizeof(buffer), "%.2x", pPacket[index]);
+                    result.dump += buffer;
+                }
+                result.dump += '\n';
+                continue;
+            }
+
+            ++result.types[packetType];
+
+            // A read is an inventory packet with a good CRC
+            if ((RFID_PACKET_TYPE_18K6C_INVENTORY == packetType) &&
+                RFID_18K6C_INVENTORY_CRC_IS_VALID(common.flags))
+            {
+                READ_KEY key;
+                key.second  = record.time / 1000000;
+                key.radio   = record.radio;
+                key.antenna = antennaId;
+                ++result.reads[key];
+            }
+        }
+    } // DecodeChunk
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: DecodeThread
+    //
+    // Description:
+    //   Decodes the batch's chunks, one at a time, until there are none left
+    ////////////////////////////////////////////////////////////////////////////
+    DWORD WINAPI DecodeThread(
+        LPVOID  context
+        )
+    {
+        BATCH*  pBatch   = static_cast<BATCH*>(context);
+        FILE*   pCapture = fopen(pBatch->fileName, "rb");
+
+        for (;;)
+        {
+            LONG chunk = InterlockedIncrement(&pBatch->next) - 1;
+            if (chunk >= pBatch->chunks)
+            {
+                break;
+            }
+            DecodeChunk(
+                pCapture,
+                pBatch->pChunks[chunk],
+                *pBatch->pOptions,
+                pBatch->pResults[chunk]);
+        }
+
+        if (NULL != pCapture)
+        {
+            fclose(pCapture);
+        }
+        return 0;
+    } // DecodeThread
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: PrintUsage
+    //
+    // Description:
+    //   Explains the command line
+    ////////////////////////////////////////////////////////////////////////////
+    void PrintUsage(
+        const char* program
+        )
+    {
+        fprintf(stderr,
+            "usage: %s [<options>] <capture file>\n"
+            "  -from <seconds>   skip packets before this time (seconds since\n"
+            "                    1970, e.g., 1262304000.5)\n"
+            "  -to <seconds>     skip packets after this time\n"
+            "  -type <type>      keep only this packet type (e.g., 0x0005); may\n"
+            "                    be repeated\n"
+            "  -radio <cookie>   keep only this radio's packets\n"
+            "  -threads <n>      decode on n threads (default: one per\n"
+            "                    processor)\n"
+            "  -dump             print the packets instead of a summary\n",
+            program);
+    } // PrintUsage
+}
+
+int main(
+    int     argc,
+    char*   argv[]
+    )
+{
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+
+    OPTIONS     options;
+    const char* fileName = NULL;
+    options.threads     = systemInfo.dwNumberOfProcessors;
+    options.fromTime    = 0;
+    options.toTime      = ~static_cast<INT64U>(0);
+    options.filterRadio = false;
+    options.radio       = 0;
+    options.dump        = false;
+
+    for (int arg = 1; arg < argc; ++arg)
+    {
+        bool hasValue = (arg + 1 < argc);
+        if (!strcmp(argv[arg], "-from") && hasValue)
+        {
+            options.fromTime = ParseTime(argv[++arg]);
+        }
+        else if (!strcmp(argv[arg], "-to") && hasValue)
+        {
+            options.toTime = ParseTime(argv[++arg]);
+        }
+        else if (!strcmp(argv[arg], "-type") && hasValue)
+        {
+            options.types.insert(
+                static_cast<INT16U>(strtoul(argv[++arg], NULL, 0)));
+        }
+        else if (!strcmp(argv[arg], "-radio") && hasValue)
+        {
+            options.filterRadio = true;
+            options.radio       = strtoul(argv[++arg], NULL, 0);
+        }
+        else if (!strcmp(argv[arg], "-threads") && hasValue)
+        {
+            options.threads = strtoul(argv[++arg], NULL, 0);
+        }
+        else if (!strcmp(argv[arg], "-dump"))
+        {
+            options.dump = true;
+        }
+        else if (('-' != argv[arg][0]) && (NULL == fileName))
+        {
+            fileName = argv[arg];
+        }
+        else
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (NULL == fileName)
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    options.threads = (options.threads < 1) ? 1 :
+        (options.threads > MAX_THREADS) ?
+            static_cast<INT32U>(MAX_THREADS) : options.threads;
+
+    FILE* pCapture = fopen(fileName, "rb");
+    if (NULL == pCapture)
+    {
+        fprintf(stderr, "ERROR: cannot open %s\n", fileName);
+        return 1;
+    }
+
+    CaptureFile::FILE_HEADER fileHeader;
+    if ((1 != fread(&fileHeader, sizeof(fileHeader), 1, pCapture)) ||
+        (CaptureFile::MAGIC != fileHeader.magic) ||
+        (CaptureFile::VERSION != fileHeader.version))
+    {
+        fprintf(stderr, "ERROR: %s is not a packet capture file\n", fileName);
+        fclose(pCapture);
+        return 1;
+    }
+
+    // Walk the chunk headers, without reading the records, to find the
+    // chunks that can hold the packets asked for
+    _fseeki64(pCapture, 0, SEEK_END);
+    INT64S  fileLength = _ftelli64(pCapture);
+    INT64S  offset     = sizeof(fileHeader);
+    INT32U  chunkCount = 0;
+    INT64U  dropped    = 0;
+    int     result     = 0;
+
+    std::vector<CHUNK>                      chunks;
+    std::vector<CaptureFile::INDEX_ENTRY>   index;
+
+    while (offset < fileLength)
+    {
+        CHUNK chunk;
+        chunk.offset = offset;
+        if (_fseeki64(pCapture, offset, SEEK_SET) ||
+            (1 != fread(&chunk.header, sizeof(chunk.header), 1, pCapture)) ||
+            (offset + chunk.header.length > fileLength))
+        {
+            // The capture was stopped part way through a write
+            fprintf(stderr, "WARNING: capture file ends part way through a "
+                "chunk\n");
+            break;
+        }
+        if ((CaptureFile::CHUNK_MAGIC != chunk.header.magic) ||
+            (chunk.header.length < sizeof(chunk.header) +
+                chunk.header.indexEntries * sizeof(CaptureFile::INDEX_ENTRY)))
+        {
+            fprintf(stderr, "ERROR: corrupt chunk after %u chunks\n",
+                chunkCount);
+            result = 1;
+            break;
+        }
+
+        index.resize(chunk.header.indexEntries);
+        if (!index.empty() &&
+            (1 != fread(&index[0],
+                        index.size() * sizeof(CaptureFile::INDEX_ENTRY),
+                        1,
+                        pCapture)))
+        {
+            fprintf(stderr, "ERROR: corrupt chunk after %u chunks\n",
+                chunkCount);
+            result = 1;
+            break;
+        }
+
+        if ((chunk.header.lastTime >= options.fromTime) &&
+            (chunk.header.firstTime <= options.toTime))
+        {
+            dropped += chunk.header.dropped;
+        }
+        if (IsChunkWanted(chunk.header, index, options))
+        {
+            chunks.push_back(chunk);
+        }
+        ++chunkCount;
+        offset += chunk.header.length;
+    }
+    fclose(pCapture);
+
+    // Decode the chunks a batch at a time, so that the output stays in order
+    // without holding the whole capture's results
+    TYPE_COUNTS types;
+    READS       reads;
+    INT64U      packets   = 0;
+    INT64U      truncated = 0;
+    INT64U      firstTime = 0;
+    INT64U      lastTime  = 0;
+
+    size_t batchSize = options.threads * CHUNKS_PER_THREAD;
+    for (size_t first = 0; first < chunks.size(); first += batchSize)
+    {
+        size_t                      count =
+            (chunks.size() - first < batchSize) ?
+                chunks.size() - first : batchSize;
+        std::vector<CHUNK_RESULT>   results(count);
+
+        BATCH batch;
+        batch.fileName = fileName;
+        batch.pOptions = &options;
+        batch.pChunks  = &chunks[first];
+        batch.pResults = &results[0];
+        batch.chunks   = static_cast<LONG>(count);
+        batch.next     = 0;
+
+        std::vector<HANDLE> threads;
+        for (INT32U thread = 1; thread < options.threads; ++thread)
+        {
+            HANDLE handle =
+                CreateThread(NULL, 0, DecodeThread, &batch, 0, NULL);
+            if (NULL != handle)
+            {
+                threads.push_back(handle);
+            }
+        }
+        DecodeThread(&batch);
+        if (!threads.empty())
+        {
+            WaitForMultipleObjects(
+                static_cast<DWORD>(threads.size()),
+                &threads[0],
+                TRUE,
+                INFINITE);
+        }
+        for (size_t thread = 0; thread < threads.size(); ++thread)
+        {
+            CloseHandle(threads[thread]);
+        }
+
+        for (size_t chunk = 0; chunk < count; ++chunk)
+        {
+            const CHUNK_RESULT& chunkResult = results[chunk];
+            if (chunkResult.corrupt)
+            {
+                fprintf(stderr, "WARNING: chunk at offset %I64d is corrupt\n",
+                    static_cast<INT64S>(chunks[first + chunk].offset));
+            }
+            if (!chunkResult.packets)
+            {
+                continue;
+            }
+
+            if (!packets || (chunkResult.firstTime < firstTime))
+            {
+                firstTime = chunkResult.firstTime;
+            }
+            if (!packets || (chunkResult.lastTime > lastTime))
+            {
+                lastTime = chunkResult.lastTime;
+            }
+            packets   += chunkResult.packets;
+            truncated += chunkResult.truncated;
+
+            if (options.dump)
+            {
+                fputs(chunkResult.dump.c_str(), stdout);
+                continue;
+            }
+            for (TYPE_COUNTS::const_iterator type = chunkResult.types.begin();
+                 type != chunkResult.types.end();
+                 ++type)
+            {
+                types[type->first] += type->second;
+            }
+            for (READS::const_iterator read = chunkResult.reads.begin();
+                 read != chunkResult.reads.end();
+                 ++read)
+            {
+                reads[read->first] += read->second;
+            }
+        }
+    }
+
+    if (options.dump)
+    {
+        return result;
+    }
+
+    printf("chunks,%u,%u\n", static_cast<INT32U>(chunks.size()), chunkCount);
+    printf("packets,%I64u\n", static_cast<INT64U>(packets));
+    printf("truncated,%I64u\n", static_cast<INT64U>(truncated));
+    printf("dropped,%I64u\n", static_cast<INT64U>(dropped));
+    printf("first,%I64u.%.6u\n",
+        static_cast<INT64U>(firstTime / 1000000),
+        static_cast<INT32U>(firstTime % 1000000));
+    printf("last,%I64u.%.6u\n",
+        static_cast<INT64U>(lastTime / 1000000),
+        static_cast<INT32U>(lastTime % 1000000));
+
+    printf("\ntype,packets\n");
+    for (TYPE_COUNTS::const_iterator type = types.begin();
+         type != types.end();
+         ++type)
+    {
+        printf("%s,%I64u\n",
+            GetPacketTypeName(type->first).c_str(),
+            static_cast<INT64U>(type->second));
+    }
+
+    printf("\nsecond,radio,antenna,reads\n");
+    for (READS::const_iterator read = reads.begin();
+         read != reads.end();
+         ++read)
+    {
+        if (CaptureFile::ANTENNA_UNKNOWN == read->first.antenna)
+        {
+            printf("%I64u,0x%.8x,-,%I64u\n",
+                static_cast<INT64U>(read->first.second),
+                read->first.radio,
+                static_cast<INT64U>(read->second));
+        }
+        else
+        {
+            printf("%I64u,0x%.8x,%u,%I64u\n",
+                static_cast<INT64U>(read->first.second),
+                read->first.radio,
+                read->first.antenna,
+                static_cast<INT64U>(read->second));
+        }
+    }
+
+    return result;
+} // main
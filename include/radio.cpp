@@ -38,8 +38,11 @@
 #include "auto_lock_compat.h"
 #include "auto_handle_compat.h"
 #include "rfid_extern.h"
+#include "rfid_probes.h"
+#include "packet_capture.h"
 #include "tracer.h"
 #include "nvmemupd.h"
+#include "crc32.h"
 
 
 // Constants we don't want to see outside this file
@@ -49,78 +52,21 @@ const INT32U BITS_PER_BYTE                    = 8;
 const INT32U BYTES_PER_REGISTER               = 4;
 const INT32U BITS_PER_REGISTER                = BITS_PER_BYTE * BYTES_PER_REGISTER;
 const INT32U MAC_SLEEP_MILLIS                 = 10;
+// How long, after a cancel is issued, the remaining packets of the operation
+// are waited for before it is aborted
+const INT32U CANCEL_DRAIN_MILLIS              = 100;
 const INT32U RFID_NUM_TAGWRDAT_REGS_PER_BANK  = 16;
-
-
-const INT32U crc32_table[256] = 
-    {
-      0x00000000, 0x04c11db7, 0x09823b6e, 0x0d4326d9,
-      0x130476dc, 0x17c56b6b, 0x1a864db2, 0x1e475005, 
-      0x2608edb8, 0x22c9f00f, 0x2f8ad6d6, 0x2b4bcb61, 
-      0x350c9b64, 0x31cd86d3, 0x3c8ea00a, 0x384fbdbd, 
-      0x4c11db70, 0x48d0c6c7, 0x4593e01e, 0x4152fda9, 
-      0x5f15adac, 0x5bd4b01b, 0x569796c2, 0x52568b75,
-      0x6a1936c8, 0x6ed82b7f, 0x639b0da6, 0x675a1011, 
-      0x791d4014, 0x7ddc5da3, 0x709f7b7a, 0x745e66cd, 
-      0x9823b6e0, 0x9ce2ab57, 0x91a18d8e, 0x95609039, 
-      0x8b27c03c, 0x8fe6dd8b, 0x82a5fb52, 0x8664e6e5, 
-      0xbe2b5b58, 0xbaea46ef, 0xb7a96036, 0xb3687d81,
-      0xad2f2d84, 0xa9ee3033, 0xa4ad16ea, 0xa06c0b5d, 
-      0xd4326d90, 0xd0f37027, 0xddb056fe, 0xd9714b49, 
-      0xc7361b4c, 0xc3f706fb, 0xceb42022, 0xca753d95, 
-      0xf23a8028, 0xf6fb9d9f, 0xfbb8bb46, 0xff79a6f1, 
-      0xe13ef6f4, 0xe5ffeb43, 0xe8bccd9a, 0xec7dd02d,
-      0x34867077, 0x30476dc0, 0x3d044b19, 0x39c556ae, 
-      0x278206ab, 0x23431b1c, 0x2e003dc5, 0x2ac12072, 
-      0x128e9dcf, 0x164f8078, 0x1b0ca6a1, 0x1fcdbb16, 
-      0x018aeb13, 0x054bf6a4, 0x0808d07d, 0x0cc9cdca, 
-      0x7897ab07, 0x7c56b6b0, 0x71159069, 0x75d48dde,
-      0x6b93dddb, 0x6f52c06c, 0x6211e6b5, 0x66d0fb02, 
-      0x5e9f46bf, 0x5a5e5b08, 0x571d7dd1, 0x53dc6066, 
-      0x4d9b3063, 0x495a2dd4, 0x44190b0d, 0x40d816ba, 
-      0xaca5c697, 0xa864db20, 0xa527fdf9, 0xa1e6e04e, 
-      0xbfa1b04b, 0xbb60adfc, 0xb6238b25, 0xb2e29692,
-      0x8aad2b2f, 0x8e6c3698, 0x832f1041, 0x87ee0df6, 
-      0x99a95df3, 0x9d684044, 0x902b669d, 0x94ea7b2a, 
-      0xe0b41de7, 0xe4750050, 0xe9362689, 0xedf73b3e, 
-      0xf3b06b3b, 0xf771768c, 0xfa325055, 0xfef34de2, 
-      0xc6bcf05f, 0xc27dede8, 0xcf3ecb31, 0xcbffd686,
-      0xd5b88683, 0xd1799b34, 0xdc3abded, 0xd8fba05a, 
-      0x690ce0ee, 0x6dcdfd59, 0x608edb80, 0x644fc637, 
-      0x7a089632, 0x7ec98b85, 0x738aad5c, 0x774bb0eb, 
-      0x4f040d56, 0x4bc510e1, 0x46863638, 0x42472b8f, 
-      0x5c007b8a, 0x58c1663d, 0x558240e4, 0x51435d53,
-      0x251d3b9e, 0x21dc2629, 0x2c9f00f0, 0x285e1d47, 
-      0x36194d42, 0x32d850f5, 0x3f9b762c, 0x3b5a6b9b, 
-      0x0315d626, 0x07d4cb91, 0x0a97ed48, 0x0e56f0ff, 
-      0x1011a0fa, 0x14d0bd4d, 0x19939b94, 0x1d528623, 
-      0xf12f560e, 0xf5ee4bb9, 0xf8ad6d60, 0xfc6c70d7,
-      0xe22b20d2, 0xe6ea3d65, 0xeba91bbc, 0xef68060b, 
-      0xd727bbb6, 0xd3e6a601, 0xdea580d8, 0xda649d6f, 
-      0xc423cd6a, 0xc0e2d0dd, 0xcda1f604, 0xc960ebb3, 
-      0xbd3e8d7e, 0xb9ff90c9, 0xb4bcb610, 0xb07daba7, 
-      0xae3afba2, 0xaafbe615, 0xa7b8c0cc, 0xa379dd7b,
-      0x9b3660c6, 0x9ff77d71, 0x92b45ba8, 0x9675461f, 
-      0x8832161a, 0x8cf30bad, 0x81b02d74, 0x857130c3, 
-      0x5d8a9099, 0x594b8d2e, 0x5408abf7, 0x50c9b640, 
-      0x4e8ee645, 0x4a4ffbf2, 0x470cdd2b, 0x43cdc09c, 
-      0x7b827d21, 0x7f436096, 0x7200464f, 0x76c15bf8,
-      0x68860bfd, 0x6c47164a, 0x61043093, 0x65c52d24, 
-      0x119b4be9, 0x155a565e, 0x18197087, 0x1cd86d30, 
-      0x029f3d35, 0x065e2082, 0x0b1d065b, 0x0fdc1bec, 
-      0x3793a651, 0x3352bbe6, 0x3e119d3f, 0x3ad08088, 
-      0x2497d08d, 0x2056cd3a, 0x2d15ebe3, 0x29d4f654,
-      0xc5a92679, 0xc1683bce, 0xcc2b1d17, 0xc8ea00a0, 
-      0xd6ad50a5, 0xd26c4d12, 0xdf2f6bcb, 0xdbee767c, 
-      0xe3a1cbc1, 0xe760d676, 0xea23f0af, 0xeee2ed18, 
-      0xf0a5bd1d, 0xf464a0aa, 0xf9278673, 0xfde69bc4, 
-      0x89b8fd09, 0x8d79e0be, 0x803ac667, 0x84fbdbd0,
-      0x9abc8bd5, 0x9e7d9662, 0x933eb0bb, 0x97ffad0c, 
-      0xafb010b1, 0xab710d06, 0xa6322bdf, 0xa2f33668, 
-      0xbcb4666d, 0xb8757bda, 0xb5365d03, 0xb1f740b4 
-    };
-
-    #define MAX_NV_ATTEMPTS 2
+const INT32U MAX_MASK_REGISTERS               =
+    (RFID_18K6C_SINGULATION_MASK_BYTE_LEN + BYTES_PER_REGISTER - 1) /
+    BYTES_PER_REGISTER;
+// Offsets of the registers within a select descriptor register image
+const INT32U SELECT_CFG_REGISTER_INDEX        = 0;
+const INT32U SELECT_BANK_REGISTER_INDEX       = HST_TAGMSK_BANK - HST_TAGMSK_DESC_CFG;
+const INT32U SELECT_PTR_REGISTER_INDEX        = HST_TAGMSK_PTR - HST_TAGMSK_DESC_CFG;
+const INT32U SELECT_LEN_REGISTER_INDEX        = HST_TAGMSK_LEN - HST_TAGMSK_DESC_CFG;
+const INT32U SELECT_MASK_REGISTER_INDEX       = HST_TAGMSK_0_3 - HST_TAGMSK_DESC_CFG;
+
+#define MAX_NV_ATTEMPTS 2
 } // namespace
 
 namespace rfid
@@ -138,21 +84,76 @@ Radio::Radio(
     m_shouldCancel(false),
     m_shouldAbort(false),
     m_operationCancelled(false),
+    m_reissuingAccess(false),
+    m_isRetired(0),
     m_preTwoTwoFirmware(false),
     m_preTwoFourFirmware(false),
-    m_bytesAvailable(0)
+    m_cancelState(CANCEL_STATE_IDLE),
+    m_bytesAvailable(0),
+    m_selectBankSize(0),
+    m_accessOutcome(ACCESS_OUTCOME_NONE),
+    m_commandEndStatus(0),
+    m_tunerPopulation(0),
+    m_tunerReadRate(0),
+    m_tunerCycleBegin(0),
+    m_tunerCycleTime(0),
+    m_tunerInventory(false),
+    m_tunerDiagsBits(0),
+    m_scheduleCaptured(false),
+    m_schedulerInventory(false),
+    m_currentAntenna(RFID_MAX_ANTENNA_PORT + 1),
+    m_pSubscription(NULL),
+    m_unsubscribedDiagsBits(0),
+    m_suppressedDiagsBits(0),
+    m_responseTimeout((RFID_CMD_RESPONSE_TIMEOUT + 1) * 1000)
 {
     INT32U  result;
     INT32U  macInfo;
 
     assert(NULL != m_pMac.get());
 
+    // The MAC counts what it does in the radio's statistics
+    m_pMac->SetStatistics(&m_statistics);
+
+    // By default, tag accesses are issued once (i.e., no retries)
+    memset(&m_accessRetryPolicy, 0, sizeof(m_accessRetryPolicy));
+    m_accessRetryPolicy.length      = sizeof(m_accessRetryPolicy);
+    m_accessRetryPolicy.maxAttempts = 1;
+
+    // The dynamic-Q tuner is off until the application asks for it
+    memset(&m_dynamicQTuner, 0, sizeof(m_dynamicQTuner));
+    m_dynamicQTuner.length              = sizeof(m_dynamicQTuner);
+    m_dynamicQTuner.maxQValue           = RFID_18K6C_MAX_Q;
+    m_dynamicQTuner.thresholdMultiplier = 4;
+    m_dynamicQTuner.responsiveness      = 50;
+    memset(&m_dynamicQStatus, 0, sizeof(m_dynamicQStatus));
+    m_dynamicQStatus.length             = sizeof(m_dynamicQStatus);
+
+    // Likewise the antenna scheduler
+    memset(&m_antennaScheduler, 0, sizeof(m_antennaScheduler));
+    m_antennaScheduler.length             = sizeof(m_antennaScheduler);
+    m_antennaScheduler.minDwellTime       = 50;
+    m_antennaScheduler.maxDwellTime       = 2000;
+    m_antennaScheduler.minInventoryCycles = 1;
+    m_antennaScheduler.maxInventoryCycles = 64;
+    m_antennaScheduler.responsiveness     = 30;
+
+    // Every operation passes every packet on until told otherwise
+    memset(m_packetSubscriptions, 0xFF, sizeof(m_packetSubscriptions));
+    for (INT32U operation = 0;
+         operation < RFID_18K6C_OPERATION_LAST;
+         ++operation)
+    {
+        m_packetSubscriptions[operation].length =
+            sizeof(m_packetSubscriptions[operation]);
+    }
+
     // Create the lock that is used to synchronize access to the state of the
     // radio object and then wrap it so that it will be automatically cleaned up
     result = CPL_MutexInit(&m_cancelAbortLock);
     if (result)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_ERROR,
             "%s: Failed to create mutex.  Result = 0x%.8x\n",
             __FUNCTION__,
@@ -161,6 +162,39 @@ Radio::Radio(
     }
     m_cancelAbortLockWrapper.Assume(&m_cancelAbortLock);
 
+    // Create the signal that wakes the thread waiting for the MAC when a
+    // cancel or abort is requested
+    result = CPL_CondInit(&m_cancelSignal);
+    if (result)
+    {
+        RFID_TRACE(
+            Tracer::RFID_LOG_SEVERITY_ERROR,
+            "%s: Failed to create condition variable.  Result = 0x%.8x\n",
+            __FUNCTION__,
+            result);
+        throw RfidErrorException(RFID_ERROR_FAILURE, __FUNCTION__);
+    }
+    m_cancelSignalWrapper.Assume(&m_cancelSignal);
+
+    // Likewise the lock that protects the snapshot of the radio's state
+    result = CPL_MutexInit(&m_snapshotLock);
+    if (result)
+    {
+        RFID_TRACE(
+            Tracer::RFID_LOG_SEVERITY_ERROR,
+            "%s: Failed to create mutex.  Result = 0x%.8x\n",
+            __FUNCTION__,
+            result);
+        throw RfidErrorException(RFID_ERROR_FAILURE, __FUNCTION__);
+    }
+    m_snapshotLockWrapper.Assume(&m_snapshotLock);
+
+    CACHED_ANTENNA_PORT uncachedPort;
+    memset(&uncachedPort, 0, sizeof(uncachedPort));
+    m_snapshot.macVersionValid = false;
+    m_snapshot.antennaPorts.assign(RFID_MAX_ANTENNA_PORT + 1, uncachedPort);
+    this->PublishSnapshot();
+
     // To ensure that the MAC is in an idle state, issue a cancel that will
     // result in the driver giving it an abort
     m_pMac->AbortOperation();
@@ -200,6 +234,18 @@ Radio::Radio(
             throw;
         }
     }
+
+    // Capture the MAC version in the snapshot so that it can be queried while
+    // the radio is busy.  A radio running its bootloader doesn't have one.
+    try
+    {
+        RFID_VERSION macVersion;
+        this->GetMacVersion(&macVersion);
+    }
+    catch (rfid::RfidErrorException&)
+    {
+        this->ClearMacError();
+    }
 } // Radio::Radio
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -251,7 +297,7 @@ void Radio::WriteMacRegister(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -261,19 +307,43 @@ void Radio::WriteMacRegister(
     // We cannot allow the command register to be written
     if (HST_CMD == address)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Reject request to write MAC's HST_CMD virtual register\n",
             __FUNCTION__);
         throw RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
     }
 
+    // A direct write to the select registers leaves our idea of what the MAC
+    // holds out of date
+    if ((HST_TAGMSK_DESC_SEL <= address) && (HST_TAGMSK_28_31 >= address))
+    {
+        m_selectShadow.clear();
+    }
+    else if (HST_CMNDIAGS == address)
+    {
+        m_tunerDiagsBits        = 0;
+        m_unsubscribedDiagsBits = 0;
+        m_suppressedDiagsBits   = 0;
+    }
+    // Before the application touches the antenna descriptors, give them back
+    // the values it configured.  The snapshot no longer knows them.
+    else if ((HST_ANT_DESC_SEL <= address) && (HST_ANT_DESC_INV_CNT >= address))
+    {
+        this->ReleaseAntennaSchedule();
+        this->ForgetAntennaPortConfigurations();
+    }
+    else if (HST_RFTC_ANTSENSRESTHRSH == address)
+    {
+        this->ForgetAntennaPortConfigurations();
+    }
+
     m_pMac->WriteRegister(address, value); // Generic Write
 
     macError = m_pMac->ReadRegister(MAC_ERROR);
     if (MACERR_SUCCESS != macError)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_ERROR,
             "%s: WriteRegister generated MAC error %d\n",
             __FUNCTION__,
@@ -295,7 +365,7 @@ INT32U Radio::ReadMacRegister(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -323,7 +393,7 @@ void Radio::ReadMacRegisterInfo(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -335,7 +405,7 @@ void Radio::ReadMacRegisterInfo(
     //
     if (m_preTwoTwoFirmware)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_ERROR,
             "%s: Feature not supported by MAC firmware prior to 2.2\n",
             __FUNCTION__);
@@ -421,7 +491,7 @@ INT32U Radio::ReadMacBankedRegister(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -432,7 +502,7 @@ INT32U Radio::ReadMacBankedRegister(
     this->ReadMacRegisterInfo(address, &info);
     if (RFID_REGISTER_BANKED != info.type)
     {        
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Reject request to get banked register on non-banked address\n",
             __FUNCTION__);
@@ -446,7 +516,7 @@ INT32U Radio::ReadMacBankedRegister(
     // confirm the bankSelector is less than the bankSize for the selector
     if (bankSelector >= info.bankSize)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Reject request to get banked register, over indexed bank selector=%d, bankSize=%d\n",
             __FUNCTION__, bankSelector, info.bankSize);
@@ -477,7 +547,7 @@ void Radio::WriteMacBankedRegister(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -488,7 +558,7 @@ void Radio::WriteMacBankedRegister(
     this->ReadMacRegisterInfo(address, &info);
     if (RFID_REGISTER_BANKED != info.type)
     {        
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Reject request to set banked register on non-banked address\n",
             __FUNCTION__);
@@ -502,13 +572,25 @@ void Radio::WriteMacBankedRegister(
     // confirm the bankSelector is less than the bankSize for the selector
     if (bankSelector >= info.bankSize)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Reject request to set banked register, over indexed bank selector=%d, bankSize=%d\n",
             __FUNCTION__, bankSelector, info.bankSize);
         throw RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
     }
 
+    // A direct write to the select registers leaves our idea of what the MAC
+    // holds out of date
+    if ((HST_TAGMSK_DESC_SEL <= address) && (HST_TAGMSK_28_31 >= address))
+    {
+        m_selectShadow.clear();
+    }
+    else if ((HST_ANT_DESC_SEL <= address) && (HST_ANT_DESC_INV_CNT >= address))
+    {
+        this->ReleaseAntennaSchedule();
+        this->ForgetAntennaPortConfigurations();
+    }
+
     // write the selector
     m_pMac->WriteRegister(selector, bankSelector); // Generic Write
 
@@ -529,7 +611,7 @@ void Radio::SetOperationMode(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -555,7 +637,7 @@ RFID_RADIO_OPERATION_MODE Radio::GetOperationMode()
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -580,14 +662,14 @@ void Radio::SetPowerState(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
         throw RfidErrorException(RFID_ERROR_RADIO_BUSY, __FUNCTION__);
     }
 
-    g_pTracer->PrintMessage(
+    RFID_TRACE(
         Tracer::RFID_LOG_SEVERITY_DEBUG,
         "%s: Change the power state of radio to %u\n",
         __FUNCTION__,
@@ -614,7 +696,7 @@ void Radio::SetPowerState(
     // If the command failed, clear the MAC error and return an error
     if (callbackData.status)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_ERROR,
             "%s: Setting radio power state failed with status 0x%.8x\n",
             __FUNCTION__,
@@ -637,7 +719,7 @@ RFID_RADIO_POWER_STATE Radio::GetPowerState()
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -680,7 +762,7 @@ void Radio::SetCurrentLinkProfile(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -715,7 +797,7 @@ void Radio::SetCurrentLinkProfile(
         // If the command failed, clear the MAC error and return an error
         if (callbackData.status)
         {
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_ERROR,
                 "%s: Setting radio current link profile failed with status "
                 "0x%.8x\n",
@@ -754,7 +836,7 @@ INT32U Radio::GetCurrentLinkProfile()
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -784,7 +866,7 @@ void Radio::GetLinkProfile(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -797,7 +879,7 @@ void Radio::GetLinkProfile(
                           HST_RFTC_PROF_SEL_RFU1(0));
     if (HOSTIF_ERR_SELECTORBNDS == m_pMac->ReadRegister(MAC_ERROR))
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Link profile %u is invalid\n",
             __FUNCTION__,
@@ -901,7 +983,7 @@ void Radio::WriteLinkProfileRegister(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -936,7 +1018,7 @@ void Radio::WriteLinkProfileRegister(
     // If the command failed, clear the MAC error and return an error
     if (callbackData.status)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_ERROR,
             "%s: Write to link profile register failed with status 0x%.8x\n",
             __FUNCTION__,
@@ -977,7 +1059,7 @@ INT16U Radio::ReadLinkProfileRegister(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -1009,7 +1091,7 @@ INT16U Radio::ReadLinkProfileRegister(
     // If the command failed, clear the MAC error and return an error
     if (callbackData.status)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_ERROR,
             "%s: Read of link profile register failed with status 0x%.8x\n",
             __FUNCTION__,
@@ -1057,7 +1139,7 @@ void Radio::GetAntennaPortStatus(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -1069,7 +1151,7 @@ void Radio::GetAntennaPortStatus(
     m_pMac->WriteRegister(HST_ANT_DESC_SEL, antennaPort);
     if (HOSTIF_ERR_SELECTORBNDS == m_pMac->ReadRegister(MAC_ERROR))
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Antenna port %u is invalid\n",
             __FUNCTION__,
@@ -1101,19 +1183,23 @@ void Radio::SetAntennaPortState(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
         throw RfidErrorException(RFID_ERROR_RADIO_BUSY, __FUNCTION__);
     }
 
+    // The antenna scheduler captures the new configuration before the next
+    // inventory
+    this->ReleaseAntennaSchedule();
+
     // First, tell the MAC which antenna descriptors we'll be reading and
     // verify that it was a valid selector
     m_pMac->WriteRegister(HST_ANT_DESC_SEL, antennaPort);
     if (HOSTIF_ERR_SELECTORBNDS == m_pMac->ReadRegister(MAC_ERROR))
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Antenna port %u is invalid\n",
             __FUNCTION__,
@@ -1164,19 +1250,23 @@ void Radio::SetAntennaPortConfiguration(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
         throw RfidErrorException(RFID_ERROR_RADIO_BUSY, __FUNCTION__);
     }
 
+    // The antenna scheduler captures the new configuration before the next
+    // inventory
+    this->ReleaseAntennaSchedule();
+
     // First, tell the MAC which antenna descriptors we'll be reading and
     // verify that it was a valid selector
     m_pMac->WriteRegister(HST_ANT_DESC_SEL, antennaPort);
     if (HOSTIF_ERR_SELECTORBNDS == m_pMac->ReadRegister(MAC_ERROR))
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Antenna port %u is invalid\n",
             __FUNCTION__,
@@ -1199,6 +1289,8 @@ void Radio::SetAntennaPortConfiguration(
     m_pMac->WriteRegister(HST_ANT_DESC_RFPOWER, pConfig->powerLevel);
     m_pMac->WriteRegister(HST_ANT_DESC_INV_CNT, pConfig->numberInventoryCycles);
     m_pMac->WriteRegister(HST_RFTC_ANTSENSRESTHRSH, pConfig->antennaSenseThreshold);
+
+    this->CacheAntennaPortConfiguration(antennaPort, pConfig);
 } // Radio::SetAntennaPortConfiguration
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1215,7 +1307,7 @@ void Radio::GetAntennaPortConfiguration(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -1227,7 +1319,7 @@ void Radio::GetAntennaPortConfiguration(
     m_pMac->WriteRegister(HST_ANT_DESC_SEL, antennaPort);
     if (HOSTIF_ERR_SELECTORBNDS == m_pMac->ReadRegister(MAC_ERROR))
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Antenna port %u is invalid\n",
             __FUNCTION__,
@@ -1253,8 +1345,44 @@ void Radio::GetAntennaPortConfiguration(
         m_pMac->ReadRegister(HST_ANT_DESC_INV_CNT);
     pConfig->antennaSenseThreshold  = 
         m_pMac->ReadRegister(HST_RFTC_ANTSENSRESTHRSH);
+
+    // While the antenna scheduler has its values in the MAC, report those the
+    // application configured
+    if (m_scheduleCaptured && (antennaPort < m_scheduledAntennas.size()))
+    {
+        pConfig->dwellTime             =
+            m_scheduledAntennas[antennaPort].baseDwellTime;
+        pConfig->numberInventoryCycles =
+            m_scheduledAntennas[antennaPort].baseInventoryCycles;
+    }
+
+    this->CacheAntennaPortConfiguration(antennaPort, pConfig);
 } // Radio::GetAntennaPortConfiguration
 
+////////////////////////////////////////////////////////////////////////////////
+// Name:        GetCachedAntennaPortConfiguration
+// Description: Retrieves the configuration for an antenna port from the
+//              radio's snapshot
+////////////////////////////////////////////////////////////////////////////////
+bool Radio::GetCachedAntennaPortConfiguration(
+    INT32U                      antennaPort,
+    RFID_ANTENNA_PORT_CONFIG*   pConfig
+    )
+{
+    assert(NULL != pConfig);
+
+    CplMutexAutoLock snapshotLock(&m_snapshotLock);
+
+    if ((antennaPort >= m_snapshot.antennaPorts.size()) ||
+        !m_snapshot.antennaPorts[antennaPort].valid)
+    {
+        return false;
+    }
+
+    *pConfig = m_snapshot.antennaPorts[antennaPort].config;
+    return true;
+} // Radio::GetCachedAntennaPortConfiguration
+
 ////////////////////////////////////////////////////////////////////////////////
 // Name:        Set18K6CSelectCriteria
 // Description: Sets the ISO 18000-6C tag-selection criteria.
@@ -1263,96 +1391,128 @@ void Radio::Set18K6CSelectCriteria(
     const RFID_18K6C_SELECT_CRITERIA* pCriteria
     )
 {
-    INT32U                             index;
-    const RFID_18K6C_SELECT_CRITERION* pCriterion;
-    RFID_REGISTER_INFO                 info;
-    INT16U                             bankSize = RFID_18K6C_MAX_SELECT_CRITERIA_CNT;
+    SELECT_CRITERIA_IMAGE image;
 
     assert(NULL != pCriteria);
 
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
         throw RfidErrorException(RFID_ERROR_RADIO_BUSY, __FUNCTION__);
     }
 
+    // Build the register image for the criteria and then write whatever the
+    // MAC doesn't already hold
+    this->CompileSelectCriteria(pCriteria, image);
+    this->ApplySelectCriteria(image);
+} // Radio::Set18K6CSelectCriteria
 
-    // Use select register info to get bank size, if its supported
-    // 
-    if (!m_preTwoTwoFirmware)
+////////////////////////////////////////////////////////////////////////////////
+// Name:        Define18K6CSelectCriteriaSet
+// Description: Compiles a set of ISO 18000-6C tag-selection criteria and
+//              caches it under an ID.
+////////////////////////////////////////////////////////////////////////////////
+void Radio::Define18K6CSelectCriteriaSet(
+    INT32U                              setId,
+    const RFID_18K6C_SELECT_CRITERIA*   pCriteria
+    )
+{
+    assert(NULL != pCriteria);
+
+    // If the radio is busy, don't allow this operation
+    if (m_isBusy)
     {
-        this->ReadMacRegisterInfo(HST_TAGMSK_DESC_SEL, &info);
-        bankSize = info.bankSize;
+        RFID_TRACE(
+            Tracer::RFID_LOG_SEVERITY_INFO,
+            "%s: Cannot complete request as radio is busy\n",
+            __FUNCTION__);
+        throw RfidErrorException(RFID_ERROR_RADIO_BUSY, __FUNCTION__);
     }
 
-    // ensure the countCriteria does not excced bank size
-    if (pCriteria->countCriteria > bankSize)
+    // Don't let the cache grow without bound, but always allow a set to be
+    // redefined
+    if ((m_selectCriteriaSets.end() == m_selectCriteriaSets.find(setId)) &&
+        (RFID_18K6C_MAX_SELECT_CRITERIA_SETS <= m_selectCriteriaSets.size()))
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
-            "%s: Select countCriteria %u is invalid\n",
+            "%s: Cannot define more than %u select criteria sets\n",
             __FUNCTION__,
-            pCriteria->countCriteria);
-        throw RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+            RFID_18K6C_MAX_SELECT_CRITERIA_SETS);
+        throw RfidErrorException(RFID_ERROR_OUT_OF_MEMORY, __FUNCTION__);
     }
 
-    // Set up the selection criteria
-    pCriterion = pCriteria->pCriteria;
-    for (index = 0; index < pCriteria->countCriteria; index++)
-    {
-        INT32U                          registerValue;
-        const RFID_18K6C_SELECT_MASK*   pMask   = &pCriterion->mask;
-        const RFID_18K6C_SELECT_ACTION* pAction = &pCriterion->action;
-
-        // Instruct the MAC as to which select mask we want to work with
-        m_pMac->WriteRegister(HST_TAGMSK_DESC_SEL, index);
+    // Compile first so that a bad set leaves any existing one untouched
+    SELECT_CRITERIA_IMAGE image;
+    this->CompileSelectCriteria(pCriteria, image);
+    m_selectCriteriaSets[setId].swap(image);
+} // Radio::Define18K6CSelectCriteriaSet
 
-        // Create the HST_TAGMSK_DESC_CFG register value and write it to the MAC
-        registerValue = HST_TAGMSK_DESC_CFG_ENABLED                 |
-                        HST_TAGMSK_DESC_CFG_TARGET(pAction->target) |
-                        HST_TAGMSK_DESC_CFG_ACTION(pAction->action) |
-                        (pAction->enableTruncate ? 
-                            HST_TAGMSK_DESC_CFG_TRUNC_ENABLED :
-                            HST_TAGMSK_DESC_CFG_TRUNC_DISABLED)     |
-                        HST_TAGMSK_DESC_CFG_RFU1(0);
-        m_pMac->WriteRegister(HST_TAGMSK_DESC_CFG, registerValue);
-
-        // Create the HST_TAGMSK_BANK register value and write it to the MAC
-        registerValue = HST_TAGMSK_BANK_BANK(pMask->bank)   |
-                        HST_TAGMSK_BANK_RFU1(0);
-        m_pMac->WriteRegister(HST_TAGMSK_BANK, registerValue);
-
-        // Write the mask offset to the HST_TAGMSK_PTR register
-        m_pMac->WriteRegister(HST_TAGMSK_PTR, pMask->offset);
-
-        // Create the HST_TAGMSK_LEN register and write it to the MAC
-        registerValue = HST_TAGMSK_LEN_LEN(pMask->count) |
-                        HST_TAGMSK_LEN_RFU1(0);
-        m_pMac->WriteRegister(HST_TAGMSK_LEN, registerValue);
+////////////////////////////////////////////////////////////////////////////////
+// Name:        Activate18K6CSelectCriteriaSet
+// Description: Makes a previously-defined criteria set the radio's selection
+//              criteria.
+////////////////////////////////////////////////////////////////////////////////
+void Radio::Activate18K6CSelectCriteriaSet(
+    INT32U  setId
+    )
+{
+    // If the radio is busy, don't allow this operation
+    if (m_isBusy)
+    {
+        RFID_TRACE(
+            Tracer::RFID_LOG_SEVERITY_INFO,
+            "%s: Cannot complete request as radio is busy\n",
+            __FUNCTION__);
+        throw RfidErrorException(RFID_ERROR_RADIO_BUSY, __FUNCTION__);
+    }
 
-        // Now write the MAC's mask registers
-        this->WriteMacMaskRegisters(HST_TAGMSK_0_3, pMask->count, pMask->mask);
+    SELECT_CRITERIA_SETS::const_iterator set = m_selectCriteriaSets.find(setId);
+    if (m_selectCriteriaSets.end() == set)
+    {
+        RFID_TRACE(
+            Tracer::RFID_LOG_SEVERITY_INFO,
+            "%s: Select criteria set %u is not defined\n",
+            __FUNCTION__,
+            setId);
+        throw RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+    }
 
-        // advance to next criterion
-        pCriterion++;
-    } // for (each criterion)
+    this->ApplySelectCriteria(set->second);
+} // Radio::Activate18K6CSelectCriteriaSet
 
-    // Turn off select for the remainder of the select mask registers
-    while (index < bankSize)
+////////////////////////////////////////////////////////////////////////////////
+// Name:        Delete18K6CSelectCriteriaSet
+// Description: Removes a previously-defined criteria set.
+////////////////////////////////////////////////////////////////////////////////
+void Radio::Delete18K6CSelectCriteriaSet(
+    INT32U  setId
+    )
+{
+    // If the radio is busy, don't allow this operation
+    if (m_isBusy)
     {
-        // Instruct the MAC as to which select mask we want to work with
-        m_pMac->WriteRegister(HST_TAGMSK_DESC_SEL, index);
-
-        // Set the descriptor to disabled
-        m_pMac->WriteRegister(HST_TAGMSK_DESC_CFG, HST_TAGMSK_DESC_CFG_DISABLED);
+        RFID_TRACE(
+            Tracer::RFID_LOG_SEVERITY_INFO,
+            "%s: Cannot complete request as radio is busy\n",
+            __FUNCTION__);
+        throw RfidErrorException(RFID_ERROR_RADIO_BUSY, __FUNCTION__);
+    }
 
-        index++;
+    if (!m_selectCriteriaSets.erase(setId))
+    {
+        RFID_TRACE(
+            Tracer::RFID_LOG_SEVERITY_INFO,
+            "%s: Select criteria set %u is not defined\n",
+            __FUNCTION__,
+            setId);
+        throw RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
     }
-} // Radio::Set18K6CSelectCriteria
+} // Radio::Delete18K6CSelectCriteriaSet
 
 ////////////////////////////////////////////////////////////////////////////////
 // Name:        Get18K6CSelectCriteria
@@ -1365,15 +1525,14 @@ void Radio::Get18K6CSelectCriteria(
     INT32U                            index;
     INT32U                            countCriteria;
     bool                              arrayIsTooSmall  = false;
-    RFID_REGISTER_INFO                info;
-    INT16U                            bankSize         = RFID_18K6C_MAX_SELECT_CRITERIA_CNT;
+    INT16U                            bankSize;
 
     assert(NULL != pCriteria);
 
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -1382,14 +1541,7 @@ void Radio::Get18K6CSelectCriteria(
 
     assert(!pCriteria->countCriteria || pCriteria->pCriteria);
 
-    // Use select register info to get bank size, if its supported
-    // 
-    if (!m_preTwoTwoFirmware)
-    {
-        this->ReadMacRegisterInfo(HST_TAGMSK_DESC_SEL, &info);
-        bankSize = info.bankSize;
-    }
-
+    bankSize = this->GetSelectBankSize();
 
     countCriteria = 0;
     // Go through the criteria and pick out the enabled ones
@@ -1454,7 +1606,7 @@ void Radio::Get18K6CSelectCriteria(
     // Check to see if the array was not large enough
     if (arrayIsTooSmall)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_DEBUG,
             "%s: Caller's select criteria buffer too small\n",
             __FUNCTION__);
@@ -1481,7 +1633,7 @@ void Radio::Set18K6CPostSingulationMatchCriteria(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -1538,7 +1690,7 @@ void Radio::Get18K6CPostSingulationMatchCriteria(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -1585,7 +1737,7 @@ void Radio::Get18K6CPostSingulationMatchCriteria(
     // Check to see if the array was not large enough
     if (arrayIsTooSmall)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_DEBUG,
             "%s: Caller's post-singualation criteria buffer too small\n",
             __FUNCTION__);
@@ -1608,7 +1760,7 @@ void Radio::Set18K6CQueryTagGroup(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -1640,7 +1792,7 @@ void Radio::Get18K6CQueryTagGroup(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -1674,7 +1826,7 @@ void Radio::SetCurrentSingulationAlgorithm(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -1701,7 +1853,7 @@ RFID_18K6C_SINGULATION_ALGORITHM Radio::GetCurrentSingulationAlgorithm()
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -1715,7 +1867,7 @@ RFID_18K6C_SINGULATION_ALGORITHM Radio::GetCurrentSingulationAlgorithm()
     if (!((RFID_18K6C_SINGULATION_ALGORITHM_FIXEDQ == algorithm)   ||
           (RFID_18K6C_SINGULATION_ALGORITHM_DYNAMICQ == algorithm)))
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_ERROR,
             "%s: Invalid singulation algorithm found (%d)\n",
             __FUNCTION__, algorithm);
@@ -1739,7 +1891,7 @@ void Radio::SetSingulationAlgorithmParameters(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -1780,7 +1932,7 @@ void Radio::SetSingulationAlgorithmParameters(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -1822,7 +1974,7 @@ void Radio::GetSingulationAlgorithmParameters(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -1864,7 +2016,7 @@ void Radio::GetSingulationAlgorithmParameters(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -1912,7 +2064,20 @@ void Radio::Start18K6CInventory(
     assert(NULL != pParms);
 
     // Perform the common 18K6C tag-operation request setup
-    this->Start18K6CRequest(&pParms->common, flags);
+    this->Start18K6CRequest(&pParms->common, flags,
+        RFID_18K6C_OPERATION_INVENTORY);
+
+    // Let the dynamic-Q tuner apply what it learned from the last inventory
+    if (m_dynamicQTuner.enabled)
+    {
+        this->PrepareDynamicQTuner();
+    }
+
+    // Likewise the antenna scheduler with the airtime it shared out
+    if (m_antennaScheduler.enabled)
+    {
+        this->PrepareAntennaScheduler();
+    }
 
     // Issue the inventory command to the MAC
     m_pMac->WriteRegister(HST_CMD, CMD_18K6CINV);
@@ -1958,7 +2123,8 @@ void Radio::Start18K6CRead(
     assert(NULL != pParms);
 
     // Perform the common 18K6C tag operation setup
-    this->Start18K6CRequest(&pParms->common, flags);
+    this->Start18K6CRequest(&pParms->common, flags,
+        RFID_18K6C_OPERATION_READ);
 
     this->Setup18K6CReadRegisters(&pParms->readCmdParms);
 
@@ -2104,7 +2270,8 @@ void Radio::Start18K6CWrite(
     assert(NULL != pParms);
 
     // Perform the common 18K6C tag operation setup
-    this->Start18K6CRequest(&pParms->common, flags);
+    this->Start18K6CRequest(&pParms->common, flags,
+        RFID_18K6C_OPERATION_WRITE);
 
     // Based upon the type of write, set up the locals accordingly
     switch (pParms->writeType)
@@ -2152,7 +2319,8 @@ void Radio::Start18K6CKill(
     assert(NULL != pParms);
 
     // Perform the common 18K6C tag operation setup
-    this->Start18K6CRequest(&pParms->common, flags);
+    this->Start18K6CRequest(&pParms->common, flags,
+        RFID_18K6C_OPERATION_KILL);
 
     // Set up the access password register
     m_pMac->WriteRegister(HST_TAGACC_ACCPWD, pParms->accessPassword);
@@ -2182,7 +2350,8 @@ void Radio::Start18K6CLock(
     assert(NULL != pParms);
 
     // Perform the common 18K6C tag operation setup
-    this->Start18K6CRequest(&pParms->common, flags);
+    this->Start18K6CRequest(&pParms->common, flags,
+        RFID_18K6C_OPERATION_LOCK);
 
     // If the kill password access permissions are not to change, then indicate
     // to ignore those bits.
@@ -2310,7 +2479,8 @@ void Radio::Start18K6CBlockWrite(
     assert(NULL != pBWParms);
 
     // Perform the common 18K6C tag operation setup
-    this->Start18K6CRequest(&pBWParms->common, flags);
+    this->Start18K6CRequest(&pBWParms->common, flags,
+        RFID_18K6C_OPERATION_BLOCK_WRITE);
 
     // NOTE: The Verify bit is deprecated, and is forced here only for backward 
     //       compatibility with earlier versions of the MAC firmware.
@@ -2404,7 +2574,8 @@ void Radio::Start18K6CQT(
     assert(NULL != pParms);
 
     // Perform the common 18K6C tag operation setup
-    this->Start18K6CRequest(&pParms->common, flags);
+    this->Start18K6CRequest(&pParms->common, flags,
+        RFID_18K6C_OPERATION_QT);
 
     // If an optional access command is provided, ensure the relevant 
     // registers for that command are setup
@@ -2508,7 +2679,8 @@ void Radio::Start18K6CBlockErase(
     assert(NULL != pParms);
 
     // Perform the common 18K6C tag operation setup
-    this->Start18K6CRequest(&pParms->common, flags);
+    this->Start18K6CRequest(&pParms->common, flags,
+        RFID_18K6C_OPERATION_BLOCK_ERASE);
 
     this->Setup18K6CBlockEraseRegisters(&pParms->blockEraseCmdParms);
 
@@ -2544,6 +2716,14 @@ void Radio::ProcessOperationData(
     bool                sawCommandEnd = false;
     INT32S              status;
     RFID_STATUS         result = RFID_STATUS_OK;
+    RadioStatistics&    statistics = m_statistics;
+    INT64U              lastPacketTime = 0;
+
+    // The packet subscription belongs to the 18K6C operation just started.
+    // The library's own operations always see every packet.
+    const RFID_PACKET_SUBSCRIPTION* pSubscription =
+        (Radio::PacketCallbackFunction != pCallback) ? m_pSubscription : NULL;
+    m_pSubscription = NULL;
 
     // If we can be cancelled, grab the abort/cancel lock again (a precondition
     // to being able to be cancelled is that the lock is already held).
@@ -2572,6 +2752,33 @@ void Radio::ProcessOperationData(
             // Check for 32-bit alignment.
             assert(!(reinterpret_cast<INT32U>(&buffer[0]) & 0x00000003));
 
+            INT16U packetType =
+                CPL_MacToHost16(
+                    reinterpret_cast<RFID_PACKET_COMMON *>(
+                        &buffer[0])->pkt_type);
+            RFID_PROBE3(packet_received,
+                handle, handle,
+                packetType, packetType,
+                length, bufferSize);
+
+            INT64U packetTime = StatisticsClock::Now();
+            if (lastPacketTime)
+            {
+                statistics.RecordPacketInterarrival(packetTime - lastPacketTime);
+            }
+            lastPacketTime = packetTime;
+            statistics.CountPacket(packetType);
+
+            // Keep a copy of the packet if the application asked for a
+            // capture
+            if (NULL != g_pPacketCapture.get())
+            {
+                g_pPacketCapture->Capture(
+                    m_pMac->GetTransportHandle(),
+                    &buffer[0],
+                    bufferSize);
+            }
+
             // Check to see if this is the end packet
             sawCommandEnd = 
                 (RFID_PACKET_TYPE_COMMAND_END == 
@@ -2579,16 +2786,52 @@ void Radio::ProcessOperationData(
                     reinterpret_cast<RFID_PACKET_COMMON *>(
                         &buffer[0])->pkt_type));
 
-            // If a callback was provided, invoke it
-            if (NULL != pCallback)
+            // Note the command status and any tag-access results so that a
+            // failed access can be retried
+            this->TrackAccessOutcome(
+                reinterpret_cast<RFID_PACKET_COMMON *>(&buffer[0]));
+
+            // Tie the MAC's millisecond counter to the host clock
+            this->TrackMacClock(
+                reinterpret_cast<RFID_PACKET_COMMON *>(&buffer[0]));
+
+            // Let the dynamic-Q tuner see the inventory-cycle packets.  Those
+            // the application didn't ask for are not passed on.
+            bool tunerOnly = this->TrackInventoryCycle(
+                reinterpret_cast<RFID_PACKET_COMMON *>(&buffer[0]));
+
+            // Let the antenna scheduler count the new tags each port reads
+            this->TrackAntennaYield(
+                reinterpret_cast<RFID_PACKET_COMMON *>(&buffer[0]));
+
+            // If a callback was provided, invoke it for the packets the
+            // application subscribed to (the command-end and any errors have
+            // been noted above regardless)
+            if ((NULL != pCallback) && !tunerOnly &&
+                ((NULL == pSubscription) ||
+                 this->IsPacketSubscribed(
+                    *pSubscription,
+                    reinterpret_cast<RFID_PACKET_COMMON *>(&buffer[0]))))
             {
                 // If the application callback returned a non-zero value, then it
                 // doesn't care to receive any more packets...that includes the
                 // command-end packet.
+                RFID_PROBE3(callback_entry,
+                    handle, handle,
+                    packetType, packetType,
+                    length, bufferSize);
+                INT64U callbackTime = StatisticsClock::Now();
                 status = pCallback(handle, bufferSize, &buffer[0], context);
+                statistics.Count(RadioStatistics::COUNTER_CALLBACKS);
+                statistics.RecordCallbackDuration(
+                    StatisticsClock::Now() - callbackTime);
+                RFID_PROBE3(callback_exit,
+                    handle, handle,
+                    packetType, packetType,
+                    status, status);
                 if (status)
                 {
-                    g_pTracer->PrintMessage(
+                    RFID_TRACE(
                         Tracer::RFID_LOG_SEVERITY_INFO,
                         "%s: Packet callback returned %d\n",
                         __FUNCTION__,
@@ -2607,7 +2850,7 @@ void Radio::ProcessOperationData(
         catch (RfidErrorException& exception)
         {
             result = exception.GetError();
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_INFO,
                 "%s: Caught an exection with error 0x%.8x\n",
                 __FUNCTION__,
@@ -2616,7 +2859,7 @@ void Radio::ProcessOperationData(
         }
         catch (...)
         {
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_ERROR,
                 "%s: Caught an unexpected exception\n",
                 __FUNCTION__);
@@ -2625,6 +2868,21 @@ void Radio::ProcessOperationData(
         }
     } // while (!sawCommandEnd)
 
+    // The command is over.  If a cancel is being issued to the MAC, let it
+    // finish first so that it cannot land on the next command.
+    while (CANCEL_STATE_ISSUING ==
+        CPL_AtomicCompareExchange32(
+            &m_cancelState,
+            CANCEL_STATE_IDLE,
+            CANCEL_STATE_RUNNING))
+    {
+        CPL_MillisecondSleep(1);
+    }
+    CPL_AtomicExchange32(&m_cancelState, CANCEL_STATE_IDLE);
+
+    // Let the queries made while we were busy see how the command left things
+    this->PublishSnapshot();
+
     // Indicate not busy any more
     m_isBusy = false;
 
@@ -2635,7 +2893,7 @@ void Radio::ProcessOperationData(
         if ((RFID_ERROR_OPERATION_CANCELLED  != result) &&
             (RFID_ERROR_RADIO_NOT_RESPONDING != result))
         {
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_INFO,
                 "%s: Send an ABORT request to radio\n",
                 __FUNCTION__);
@@ -2663,23 +2921,54 @@ void Radio::CancelOperation()
     // is performing the packet callback
     if (m_isBusy && (CPL_ThreadGetID() == m_busyThread))
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot cancel operation on callback thread\n",
             __FUNCTION__);
         throw RfidErrorException(RFID_ERROR_CURRENTLY_NOT_ALLOWED, __FUNCTION__);
     }
 
-    // Indicate that a cancel is to be issued
-    g_pTracer->PrintMessage(
+    // If the command is running, issue the cancel to the MAC from here rather
+    // than wait for the thread processing the packets to notice it.
+    // Otherwise, indicate that a cancel is to be issued; if the command is
+    // still being set up, the flag is kept until the command has been issued
+    // and the thread processing the packets sends the cancel then.
+    RFID_TRACE(
         Tracer::RFID_LOG_SEVERITY_DEBUG,
         "%s: Cancel operation and wait until cancel completed\n",
         __FUNCTION__);
-    m_shouldCancel = true;
+    m_statistics.Count(RadioStatistics::COUNTER_CANCELS);
+    if (CANCEL_STATE_RUNNING ==
+        CPL_AtomicCompareExchange32(
+            &m_cancelState,
+            CANCEL_STATE_ISSUING,
+            CANCEL_STATE_RUNNING))
+    {
+        try
+        {
+            m_pMac->CancelOperation();
+            CPL_TimeSpecGet(&m_cancelTime);
+            m_operationCancelled = true;
+        }
+        catch (...)
+        {
+            // Let the thread processing the packets try
+            m_shouldCancel = true;
+        }
+        CPL_AtomicExchange32(&m_cancelState, CANCEL_STATE_ISSUED);
+    }
+    else
+    {
+        m_shouldCancel = true;
+    }
+
+    // Wake the thread processing the packets so that it starts draining the
+    // remaining packets now
+    CPL_CondSignal(&m_cancelSignal);
 
     // Wait until the radio has completed the processing of the cancel
     CplMutexAutoLock cancelGuard(&m_cancelAbortLock);
-    g_pTracer->PrintMessage(
+    RFID_TRACE(
         Tracer::RFID_LOG_SEVERITY_DEBUG,
         "%s: Cancel has completed\n",
         __FUNCTION__);
@@ -2697,7 +2986,7 @@ void Radio::AbortOperation()
     // is performing the packet callback
     if (m_isBusy && (CPL_ThreadGetID() == m_busyThread))
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot abort operation on callback thread\n",
             __FUNCTION__);
@@ -2705,20 +2994,59 @@ void Radio::AbortOperation()
     }
 
     // Indicate that an abort is to be issued
-    g_pTracer->PrintMessage(
+    RFID_TRACE(
         Tracer::RFID_LOG_SEVERITY_DEBUG,
         "%s: Abort operation and wait until abort completed\n",
         __FUNCTION__);
+    m_statistics.Count(RadioStatistics::COUNTER_ABORTS);
     m_shouldAbort = true;
 
+    // Wake the thread processing the packets so that it aborts now
+    CPL_CondSignal(&m_cancelSignal);
+
     // Wait until the radio has completed the processing of the abort
     CplMutexAutoLock abortGuard(&m_cancelAbortLock);
-    g_pTracer->PrintMessage(
+    RFID_TRACE(
         Tracer::RFID_LOG_SEVERITY_DEBUG,
         "%s: Abort has completed\n",
         __FUNCTION__);
 } // Radio::AbortOperation
 
+////////////////////////////////////////////////////////////////////////////////
+// Name:        Retire
+// Description: Takes the radio out of service before it is closed or reset.
+////////////////////////////////////////////////////////////////////////////////
+void Radio::Retire()
+{
+    // Set the flag before aborting, so that an operation started by a thread
+    // that acquired the radio before it was retired is aborted as well
+    CPL_AtomicExchange32(&m_isRetired, 1);
+
+    // A radio cannot be retired from its own packet callback, so it stays in
+    // service
+    try
+    {
+        this->AbortOperation();
+    }
+    catch (RfidErrorException& error)
+    {
+        if (RFID_ERROR_CURRENTLY_NOT_ALLOWED == error.GetError())
+        {
+            CPL_AtomicExchange32(&m_isRetired, 0);
+        }
+        throw;
+    }
+} // Radio::Retire
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        Reinstate
+// Description: Puts a radio that was retired back in service.
+////////////////////////////////////////////////////////////////////////////////
+void Radio::Reinstate()
+{
+    CPL_AtomicExchange32(&m_isRetired, 0);
+} // Radio::Reinstate
+
 ////////////////////////////////////////////////////////////////////////////////
 // Name:        SetResponseDataMode
 // Description: Sets the response date mode (i.e., compact, etc.) for the
@@ -2735,7 +3063,7 @@ void Radio::SetResponseDataMode(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -2772,8 +3100,13 @@ void Radio::SetResponseDataMode(
         } // default
     } // switch (mode)
 
-    // Write the common diagnostics register
+    // Write the common diagnostics register.  The dynamic-Q tuner turns its
+    // diagnostics back on, and the packet subscriptions turn off what they
+    // don't need, before the next operation.
     m_pMac->WriteRegister(HST_CMNDIAGS, registerValue);
+    m_tunerDiagsBits        = 0;
+    m_unsubscribedDiagsBits = 0;
+    m_suppressedDiagsBits   = 0;
 } // Radio::SetResponseDataMode
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2792,15 +3125,19 @@ RFID_RESPONSE_MODE Radio::GetResponseDataMode(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
         throw RfidErrorException(RFID_ERROR_RADIO_BUSY, __FUNCTION__);
     }
 
-    // Read the common diagnostics register
-    INT32U registerValue = m_pMac->ReadRegister(HST_CMNDIAGS);
+    // Read the common diagnostics register, ignoring the diagnostics that the
+    // dynamic-Q tuner turned on and counting those that the packet
+    // subscriptions turned off
+    INT32U registerValue =
+        (m_pMac->ReadRegister(HST_CMNDIAGS) & ~m_tunerDiagsBits) |
+        m_suppressedDiagsBits;
 
     // DMS Bug 9035:  Changing the logic to require specific complement of bits 
     // to be set for each mode, otherwise throw an exception. 
@@ -2829,7 +3166,7 @@ RFID_RESPONSE_MODE Radio::GetResponseDataMode(
     }
     else
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_ERROR,
             "%s: Non-predefined set of packets are enabled\n",
             __FUNCTION__);
@@ -2862,13 +3199,19 @@ void Radio::UpdateMacNonvolatileMemory(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
         throw RfidErrorException(RFID_ERROR_RADIO_BUSY, __FUNCTION__);
     }
 
+    // New firmware may not leave the select registers (or the antenna
+    // descriptors) as we last wrote them
+    m_selectShadow.clear();
+    m_selectBankSize = 0;
+    m_scheduleCaptured = false;
+
     // Send the MAC the command to put it into the nonvolatile memory update
     // state
     m_pMac->WriteRegister(HST_CMD, CMD_NV_MEM_UPDATE);
@@ -2888,7 +3231,7 @@ void Radio::UpdateMacNonvolatileMemory(
     // If the command failed, clear the MAC error and return an error
     if (callbackData.status)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_ERROR,
             "%s: Initiating nonvolatile memory update failed with status "
             "0x%.8x\n",
@@ -2912,7 +3255,7 @@ void Radio::UpdateMacNonvolatileMemory(
 
     if (NVMEMUPD_STAT_ENTRY_OK != packetStatus)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_ERROR,
             "%s: MAC failed to enter non-volatile update mode (status=0x%.8x, error=0x%.8x)\n",
              __FUNCTION__, packetStatus, packetError);
@@ -2990,14 +3333,14 @@ void Radio::UpdateMacNonvolatileMemory(
 
                 packetCrc = 0;
                 // first get the crc upto but not including the crc field
-                packetCrc = this->FastCrc32(packetCrc, 
-                                            reinterpret_cast<unsigned char *>(&pUpdatePacket->cmn), 
-                                            (sizeof(pUpdatePacket->cmn) + sizeof(pUpdatePacket->abs_addr)));
+                packetCrc = FastCrc32(packetCrc, 
+                                      reinterpret_cast<unsigned char *>(&pUpdatePacket->cmn), 
+                                      (sizeof(pUpdatePacket->cmn) + sizeof(pUpdatePacket->abs_addr)));
 
                 // now complete the CRC from the first byte after the crc up through the last byte of data
-                packetCrc = this->FastCrc32(packetCrc, 
-                                            reinterpret_cast<unsigned char *>(&pUpdatePacket->flags), 
-                                            (sizeof(pUpdatePacket->flags) + chunkSize));
+                packetCrc = FastCrc32(packetCrc, 
+                                      reinterpret_cast<unsigned char *>(&pUpdatePacket->flags), 
+                                      (sizeof(pUpdatePacket->flags) + chunkSize));
 
                 // now store it in the crc in MAC format
                 pUpdatePacket->crc          = CPL_HostToMac32(packetCrc);
@@ -3043,7 +3386,7 @@ void Radio::UpdateMacNonvolatileMemory(
                             /* these are fatal/critical errors and the firmware will is going
                                to reset, so we error out here to let the application reconnect.
                                No retries on critical errors. */
-                            g_pTracer->PrintMessage(
+                            RFID_TRACE(
                                 Tracer::RFID_LOG_SEVERITY_ERROR,
                                 "%s: Critical error on write to nonvolatile memory (status=0x%.8x, error=0x%.8x), MAC will reset\n",
                                  __FUNCTION__, packetStatus, packetError);
@@ -3056,7 +3399,7 @@ void Radio::UpdateMacNonvolatileMemory(
                         
                         case NVMEMUPD_STAT_CRC_ERR:
                         {
-                            g_pTracer->PrintMessage(
+                            RFID_TRACE(
                                 Tracer::RFID_LOG_SEVERITY_ERROR,
                                 "%s: CRC Error on MAC write to nonvolatile memory (status=0x%.8x, error=0x%.8x)\n",
                                  __FUNCTION__, packetStatus, packetError);
@@ -3069,7 +3412,7 @@ void Radio::UpdateMacNonvolatileMemory(
                         
                         case NVMEMUPD_STAT_BNDS:
                         {
-                            g_pTracer->PrintMessage(
+                            RFID_TRACE(
                                     Tracer::RFID_LOG_SEVERITY_ERROR,
                                 "%s: Attempted to write to invalid nonvolatile "
                                     "memory address (address=0x%.8x, length=%d, status=0x%.8x, error=0x%.8x)\n",
@@ -3081,7 +3424,7 @@ void Radio::UpdateMacNonvolatileMemory(
                             
                         case NVMEMUPD_STAT_RXPKT_MAX:
                         {
-                            g_pTracer->PrintMessage(
+                            RFID_TRACE(
                                     Tracer::RFID_LOG_SEVERITY_ERROR,
                                 "%s: Exceeded max packet size "
                                     "(status=0x%.8x, error=0x%.8x)\n",
@@ -3096,7 +3439,7 @@ void Radio::UpdateMacNonvolatileMemory(
                         case NVMEMUPD_STAT_MAGIC:
                         case NVMEMUPD_STAT_PKTLEN:
                         {
-                            g_pTracer->PrintMessage(
+                            RFID_TRACE(
                                     Tracer::RFID_LOG_SEVERITY_ERROR,
                                 "%s: Unexpected values in the packet header "
                                     "(status=0x%.8x, error=0x%.8x)\n",
@@ -3108,7 +3451,7 @@ void Radio::UpdateMacNonvolatileMemory(
                         
                         default:
                         {
-                            g_pTracer->PrintMessage(
+                            RFID_TRACE(
                                 Tracer::RFID_LOG_SEVERITY_ERROR,
                                     "%s: MAC returned unexpected status (status=0x%.8x, error=0x%.8x)\n",
                                  __FUNCTION__,
@@ -3123,7 +3466,7 @@ void Radio::UpdateMacNonvolatileMemory(
 
                 if (packetRetries >= MAX_NV_ATTEMPTS)
                 {
-                    g_pTracer->PrintMessage(
+                    RFID_TRACE(
                         Tracer::RFID_LOG_SEVERITY_ERROR,
                         "%s: MAC exceeded NV Update retries\n",
                          __FUNCTION__);
@@ -3202,7 +3545,7 @@ void Radio::UpdateMacNonvolatileMemory(
                     if (NVMEMUPD_CMD_UPD_COMPLETE == 
                         CPL_MacToHost32(responsePacket.re_cmd))
                     {
-                        g_pTracer->PrintMessage(
+                        RFID_TRACE(
                             Tracer::RFID_LOG_SEVERITY_INFO,
                             "%s: MAC's nonvolatile memory updated successfully\n",
                             __FUNCTION__);
@@ -3214,7 +3557,7 @@ void Radio::UpdateMacNonvolatileMemory(
                 }
                 default:
                 {
-                    g_pTracer->PrintMessage(
+                    RFID_TRACE(
                         Tracer::RFID_LOG_SEVERITY_ERROR,
                         "%s: MAC returned unexpected status or reponse to update "
                         "complete (status=0x%.8x, error=0x%.8x, re_cmd=0x%.8x)\n",
@@ -3244,7 +3587,7 @@ void Radio::GetMacVersion(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -3260,7 +3603,7 @@ void Radio::GetMacVersion(
     // the MAC firmware version.
     if (macVersion == 0xFFFFFFFF)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Invalid MAC Firmware Version\n",
             __FUNCTION__);
@@ -3272,8 +3615,34 @@ void Radio::GetMacVersion(
     pVersion->minor       = MAC_VER_GET_MIN(macVersion);
     pVersion->maintenance = MAC_VER_GET_MAINT(macVersion);
     pVersion->release     = MAC_VER_GET_REL(macVersion);
+
+    // The version only changes with the firmware, which takes a reset
+    CplMutexAutoLock snapshotLock(&m_snapshotLock);
+    m_snapshot.macVersion      = *pVersion;
+    m_snapshot.macVersionValid = true;
 } // Radio::GetMacVersion
 
+////////////////////////////////////////////////////////////////////////////////
+// Name:        GetCachedMacVersion
+// Description: Retrieves the MAC firmware version from the radio's snapshot
+////////////////////////////////////////////////////////////////////////////////
+bool Radio::GetCachedMacVersion(
+    RFID_VERSION* pVersion
+    )
+{
+    assert(NULL != pVersion);
+
+    CplMutexAutoLock snapshotLock(&m_snapshotLock);
+
+    if (!m_snapshot.macVersionValid)
+    {
+        return false;
+    }
+
+    *pVersion = m_snapshot.macVersion;
+    return true;
+} // Radio::GetCachedMacVersion
+
 
 ////////////////////////////////////////////////////////////////////////////////
 // Name:        GetMacBootLoaderVersion
@@ -3291,7 +3660,7 @@ void Radio::GetMacBootLoaderVersion(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -3325,7 +3694,7 @@ void Radio::GetMacBootLoaderVersion(
     // the BootLoader version.
     if (blVersion == 0xFFFFFFFF)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Invalid BootLoader Version\n",
             __FUNCTION__);
@@ -3359,7 +3728,7 @@ void Radio::ReadMacOemData(
         // If the radio is busy, don't allow this operation
         if (m_isBusy)
         {
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_INFO,
                 "%s: Cannot complete request as radio is busy\n",
                 __FUNCTION__);
@@ -3393,7 +3762,7 @@ void Radio::ReadMacOemData(
             // If the command failed, clear the MAC error and return an error
             if (callbackData.status)
             {
-                g_pTracer->PrintMessage(
+                RFID_TRACE(
                     Tracer::RFID_LOG_SEVERITY_ERROR,
                     "%s: OEM read failed with status 0x%.8x\n",
                     __FUNCTION__,
@@ -3448,7 +3817,7 @@ void Radio::WriteMacOemData(
         // If the radio is busy, don't allow this operation
         if (m_isBusy)
         {
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_INFO,
                 "%s: Cannot complete request as radio is busy\n",
                 __FUNCTION__);
@@ -3488,7 +3857,7 @@ void Radio::WriteMacOemData(
             // If the command failed, clear the MAC error and return an error
             if (callbackData.status)
             {
-                g_pTracer->PrintMessage(
+                RFID_TRACE(
                     Tracer::RFID_LOG_SEVERITY_ERROR,
                     "%s: OEM write failed with status 0x%.8x\n",
                     __FUNCTION__,
@@ -3568,6 +3937,19 @@ void Radio::ResetMac(
     // Cancel any current operation
     this->AbortOperation();
     
+    // After a reset, the select registers are back to their defaults (and a
+    // reset to the bootloader may bring up different firmware).  So are the
+    // diagnostics the dynamic-Q tuner turned on (or the packet subscriptions
+    // turned off) and the antenna descriptors.
+    m_selectShadow.clear();
+    m_selectBankSize = 0;
+    m_tunerDiagsBits = 0;
+    m_unsubscribedDiagsBits = 0;
+    m_suppressedDiagsBits = 0;
+    m_scheduleCaptured = false;
+    // The millisecond counter starts again too
+    m_macClock.Reset();
+
     // Simply tell the MAC to reset
     m_pMac->Reset(type);
 } // Radio::ResetMac
@@ -3581,7 +3963,7 @@ void Radio::ClearMacError()
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -3619,7 +4001,7 @@ void Radio::GetMacError(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -3657,7 +4039,7 @@ RFID_MAC_REGION Radio::GetMacRegion(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -3671,7 +4053,7 @@ RFID_MAC_REGION Radio::GetMacRegion(
     // test against the highest defined region value
     if (RFID_MAC_REGION_ETSI_LBT < currentRegion)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_ERROR,
             "%s: Unexpected value returned for HST_REGULATORY_REGION (%d)\n",
             __FUNCTION__, currentRegion);
@@ -3692,7 +4074,7 @@ void Radio::SetGpioPinsConfiguration(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -3728,7 +4110,7 @@ void Radio::SetGpioPinsConfiguration(
     // If the command failed, clear the MAC error and return an error
     if (callbackData.status)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_ERROR,
             "%s: Setting GPIO configuration failed with status 0x%.8x\n",
             __FUNCTION__,
@@ -3747,7 +4129,7 @@ INT32U Radio::GetGpioPinsConfiguration()
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -3769,7 +4151,7 @@ INT32U Radio::ReadGpioPins(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -3799,7 +4181,7 @@ INT32U Radio::ReadGpioPins(
     // If the command failed, clear the MAC error and return an error
     if (callbackData.status)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_ERROR,
             "%s: GPIO read failed with status 0x%.8x\n",
             __FUNCTION__,
@@ -3835,7 +4217,7 @@ void Radio::WriteGpioPins(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -3869,7 +4251,7 @@ void Radio::WriteGpioPins(
     // If the command failed, clear the MAC error and return an error
     if (callbackData.status)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_ERROR,
             "%s: GPIO write failed with status 0x%.8x\n",
             __FUNCTION__,
@@ -3896,7 +4278,7 @@ void Radio::WriteRadioRegister(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -3928,7 +4310,7 @@ void Radio::WriteRadioRegister(
     // If the command failed, clear the MAC error and return an error
     if (callbackData.status)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_ERROR,
             "%s: Radio bypass register write failed with status 0x%.8x\n",
             __FUNCTION__,
@@ -3954,7 +4336,7 @@ INT16U Radio::ReadRadioRegister(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -3983,7 +4365,7 @@ INT16U Radio::ReadRadioRegister(
     // If the command failed, clear the MAC error and return an error
     if (callbackData.status)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_ERROR,
             "%s: Radio bypass register write failed with status 0x%.8x\n",
             __FUNCTION__,
@@ -4017,7 +4399,7 @@ void Radio::ToggleCarrierWave(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -4043,7 +4425,7 @@ void Radio::ToggleCarrierWave(
     // If the command failed, clear the MAC error and return an error
     if (callbackData.status)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_ERROR,
             "%s: Toggle carrier wave failed with status 0x%.8x\n",
             __FUNCTION__,
@@ -4063,7 +4445,7 @@ void Radio::IssueCommand(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -4089,7 +4471,7 @@ void Radio::RandomCarrierWave(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -4123,7 +4505,7 @@ void Radio::SetImpinjExtensions(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -4155,7 +4537,7 @@ void Radio::GetImpinjExtensions(
     // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
@@ -4172,7 +4554,7 @@ void Radio::GetImpinjExtensions(
 
     if (pExtensions->blockWriteMode > BLOCKWRITE_MODE_FORCE_TWO_WORD)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Invalid block write mode found (%d)\n",
             __FUNCTION__,pExtensions->blockWriteMode);
@@ -4181,355 +4563,2433 @@ void Radio::GetImpinjExtensions(
 } // Radio::GetImpinjExtensions
 
 ////////////////////////////////////////////////////////////////////////////////
-// Name:        Start18K6CRequest
-// Description: Performs the generic configuration setting needed for
-//              supporting the ISO 18000-6C tag operations.
+// Name:        Set18K6CAccessRetryPolicy
+// Description: Sets the policy used to reissue failed tag accesses
 ////////////////////////////////////////////////////////////////////////////////
-void Radio::Start18K6CRequest(
-    const RFID_18K6C_COMMON_PARMS* pParms,
-    INT32U                         flags
+void Radio::Set18K6CAccessRetryPolicy(
+    const RFID_18K6C_ACCESS_RETRY_POLICY*   pPolicy
     )
 {
-    assert(NULL != pParms);
+    assert(NULL != pPolicy);
 
-    // If the radio is already busy, then don't allow another operation
+    // If the radio is busy, don't allow this operation
     if (m_isBusy)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Cannot complete request as radio is busy\n",
             __FUNCTION__);
         throw RfidErrorException(RFID_ERROR_RADIO_BUSY, __FUNCTION__);
     }
 
-    // Set up the rest of the HST_INV_CFG register.  First, we have to read its
-    // current value
-    INT32U registerValue = m_pMac->ReadRegister(HST_INV_CFG);
+    m_accessRetryPolicy = *pPolicy;
+    this->PublishSnapshot();
+} // Radio::Set18K6CAccessRetryPolicy
 
-    // TBD - an optimization could be to only write back the register if
-    // the value changes
+////////////////////////////////////////////////////////////////////////////////
+// Name:        Get18K6CAccessRetryPolicy
+// Description: Retrieves the policy used to reissue failed tag accesses
+////////////////////////////////////////////////////////////////////////////////
+void Radio::Get18K6CAccessRetryPolicy(
+    RFID_18K6C_ACCESS_RETRY_POLICY*     pPolicy
+    )
+{
+    assert(NULL != pPolicy);
 
-    // Set the tag stop count and enabled flags and then write the register
-    // back
-    if (flags & RFID_FLAG_PERFORM_SELECT)
-    {
-        HST_INV_CFG_SET_AUTOSEL_ENABLED(registerValue);
-    }
-    else
-    {
-        HST_INV_CFG_SET_AUTOSEL_DISABLED(registerValue);
-    }
-    HST_INV_CFG_SET_REP(registerValue, pParms->tagStopCount);
-    m_pMac->WriteRegister(HST_INV_CFG, registerValue);
+    // Served from the snapshot so that it can be read while the radio is busy
+    CplMutexAutoLock snapshotLock(&m_snapshotLock);
+    *pPolicy = m_snapshot.accessRetryPolicy;
+} // Radio::Get18K6CAccessRetryPolicy
 
-    // Set the enabled flag in the HST_INV_EPC_MATCH_CFG register properly.  To
-    // do so, have to read the register value first.  Then set the bit properly
-    // and then write the register value back to the MAC.
-    registerValue = m_pMac->ReadRegister(HST_INV_EPC_MATCH_CFG);
-    if (flags & RFID_FLAG_PERFORM_POST_MATCH)
-    {
-        HST_INV_EPC_MATCH_CFG_SET_ENABLED(registerValue);
-    }
-    else
+////////////////////////////////////////////////////////////////////////////////
+// Name:        Process18K6CAccessData
+// Description: Processes the operation response packets for a tag access
+//              and reissues the access while the retry policy allows it and
+//              the failure is one that a retry can fix.
+////////////////////////////////////////////////////////////////////////////////
+void Radio::Process18K6CAccessData(
+    RFID_RADIO_HANDLE   handle,
+    ACCESS_OPERATION    operation,
+    const void*         pParms,
+    INT32U              flags
+    )
+{
+    assert(NULL != pParms);
+
+    const RFID_18K6C_COMMON_PARMS* pCommon =
+        (ACCESS_OPERATION_READ == operation) ?
+        &static_cast<const RFID_18K6C_READ_PARMS *>(pParms)->common :
+        &static_cast<const RFID_18K6C_WRITE_PARMS *>(pParms)->common;
+
+    ACCESS_RETRY_ANTENNAS   savedAntennas;
+    INT32S                  callbackCode = 0;
+    INT32U                  attempt      = 1;
+
+    try
     {
-        HST_INV_EPC_MATCH_CFG_SET_DISABLED(registerValue);
-    }
-    m_pMac->WriteRegister(HST_INV_EPC_MATCH_CFG, registerValue);
-} // Radio::Start18K6CRequest
+        for (;;)
+        {
+            this->ProcessOperationData(
+                handle,
+                pCommon->pCallback,
+                pCommon->context,
+                &callbackCode);
+
+            // We are done if a tag was accessed, if the failure is not one a
+            // retry will fix, if the application asked us to stop, or if the
+            // policy does not allow any more attempts.  Not seeing any
+            // tag-access packet means that the tag was not singulated, which
+            // is worth another try.
+            if ((ACCESS_OUTCOME_SUCCESS == m_accessOutcome)    ||
+                (ACCESS_OUTCOME_FATAL   == m_accessOutcome)    ||
+                callbackCode                                   ||
+                (attempt >= m_accessRetryPolicy.maxAttempts))
+            {
+                break;
+            }
+
+            RFID_TRACE(
+                Tracer::RFID_LOG_SEVERITY_DEBUG,
+                "%s: Access attempt %u of %u failed (outcome %u), retrying\n",
+                __FUNCTION__,
+                attempt,
+                m_accessRetryPolicy.maxAttempts,
+                m_accessOutcome);
+
+            this->PrepareAccessRetry(attempt, savedAntennas);
+            ++attempt;
+
+            // A cancel or abort that arrived between attempts (e.g., during
+            // the backoff) would be lost when the access is reissued, so end
+            // the access here instead
+            if (m_shouldCancel || m_shouldAbort)
+            {
+                RFID_TRACE(
+                    Tracer::RFID_LOG_SEVERITY_INFO,
+                    "%s: Access cancelled before attempt %u\n",
+                    __FUNCTION__,
+                    attempt);
+                m_shouldCancel = false;
+                m_shouldAbort  = false;
+                throw RfidErrorException(RFID_ERROR_OPERATION_CANCELLED, __FUNCTION__);
+            }
+
+            // Reissue the access with the original parameters.  A cancel or
+            // abort that arrives while it is set up is kept for it.
+            m_reissuingAccess = true;
+            switch (operation)
+            {
+                case ACCESS_OPERATION_READ:
+                {
+                    this->Start18K6CRead(
+                        static_cast<const RFID_18K6C_READ_PARMS *>(pParms),
+                        flags);
+                    break;
+                } // case ACCESS_OPERATION_READ
+                case ACCESS_OPERATION_WRITE:
+                {
+                    this->Start18K6CWrite(
+                        static_cast<const RFID_18K6C_WRITE_PARMS *>(pParms),
+                        flags);
+                    break;
+                } // case ACCESS_OPERATION_WRITE
+                default:
+                {
+                    throw RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+                    break;
+                } // default
+            } // switch (operation)
+            m_reissuingAccess = false;
+        }
+    }
+    catch (...)
+    {
+        m_reissuingAccess = false;
+
+        if (NULL != pCommon->pCallbackCode)
+        {
+            *pCommon->pCallbackCode = callbackCode;
+        }
+
+        // Give the application back its antenna configuration before letting
+        // the original failure propagate
+        try
+        {
+            this->RestoreAccessRetryAntennas(savedAntennas);
+        }
+        catch (...)
+        {
+        }
+        throw;
+    }
+
+    if (NULL != pCommon->pCallbackCode)
+    {
+        *pCommon->pCallbackCode = callbackCode;
+    }
+
+    this->RestoreAccessRetryAntennas(savedAntennas);
+} // Radio::Process18K6CAccessData
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        SetDynamicQTuner
+// Description: Configures the closed-loop tuning of the dynamic-Q
+//              singulation algorithm parameters
+////////////////////////////////////////////////////////////////////////////////
+void Radio::SetDynamicQTuner(
+    const RFID_18K6C_DYNAMICQ_TUNER_PARMS*  pParms
+    )
+{
+    assert(NULL != pParms);
+
+    // If the radio is busy, don't allow this operation
+    if (m_isBusy)
+    {
+        RFID_TRACE(
+            Tracer::RFID_LOG_SEVERITY_INFO,
+            "%s: Cannot complete request as radio is busy\n",
+            __FUNCTION__);
+        throw RfidErrorException(RFID_ERROR_RADIO_BUSY, __FUNCTION__);
+    }
+
+    if (pParms->enabled)
+    {
+        // When first enabled, start from whatever the application configured
+        // and assume the population its starting Q was chosen for
+        if (!m_dynamicQTuner.enabled)
+        {
+            RFID_18K6C_SINGULATION_DYNAMICQ_PARMS dynamicQParms;
+
+            this->GetSingulationAlgorithmParameters(&dynamicQParms);
+
+            memset(&m_dynamicQStatus, 0, sizeof(m_dynamicQStatus));
+            m_dynamicQStatus.length      = sizeof(m_dynamicQStatus);
+            m_dynamicQStatus.startQValue = dynamicQParms.startQValue;
+            m_tunerPopulation            = 1 << dynamicQParms.startQValue;
+            m_tunerReadRate              = 0;
+        }
+
+        // Keep the tuned parameters within the (possibly new) bounds
+        if (m_dynamicQStatus.startQValue < pParms->minQValue)
+        {
+            m_dynamicQStatus.startQValue = pParms->minQValue;
+        }
+        else if (m_dynamicQStatus.startQValue > pParms->maxQValue)
+        {
+            m_dynamicQStatus.startQValue = pParms->maxQValue;
+        }
+        m_dynamicQStatus.minQValue           = pParms->minQValue;
+        m_dynamicQStatus.maxQValue           = pParms->maxQValue;
+        m_dynamicQStatus.thresholdMultiplier = pParms->thresholdMultiplier;
+        m_dynamicQStatus.populationEstimate  =
+            static_cast<INT32U>(m_tunerPopulation + 0.5);
+    }
+    else if (m_tunerDiagsBits)
+    {
+        // Give the application back the packets it asked for
+        m_pMac->WriteRegister(HST_CMNDIAGS,
+            m_pMac->ReadRegister(HST_CMNDIAGS) & ~m_tunerDiagsBits);
+        m_tunerDiagsBits = 0;
+    }
+
+    m_dynamicQTuner = *pParms;
+    this->PublishSnapshot();
+} // Radio::SetDynamicQTuner
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        GetDynamicQTuner
+// Description: Retrieves the dynamic-Q tuner configuration and state
+////////////////////////////////////////////////////////////////////////////////
+void Radio::GetDynamicQTuner(
+    RFID_18K6C_DYNAMICQ_TUNER_PARMS*    pParms,
+    RFID_18K6C_DYNAMICQ_TUNER_STATUS*   pStatus
+    )
+{
+    assert(NULL != pParms);
+
+    // Served from the snapshot so that it can be read while the radio is busy
+    CplMutexAutoLock snapshotLock(&m_snapshotLock);
+    *pParms = m_snapshot.dynamicQTuner;
+    if (NULL != pStatus)
+    {
+        *pStatus = m_snapshot.dynamicQStatus;
+    }
+} // Radio::GetDynamicQTuner
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        SetAntennaScheduler
+// Description: Configures the yield-weighted scheduling of the antenna ports'
+//              dwell times and inventory cycle counts
+////////////////////////////////////////////////////////////////////////////////
+void Radio::SetAntennaScheduler(
+    const RFID_ANTENNA_SCHEDULER_PARMS* pParms
+    )
+{
+    assert(NULL != pParms);
+
+    // If the radio is busy, don't allow this operation
+    if (m_isBusy)
+    {
+        RFID_TRACE(
+            Tracer::RFID_LOG_SEVERITY_INFO,
+            "%s: Cannot complete request as radio is busy\n",
+            __FUNCTION__);
+        throw RfidErrorException(RFID_ERROR_RADIO_BUSY, __FUNCTION__);
+    }
+
+    if (pParms->enabled)
+    {
+        // When first enabled, forget the yields from any earlier schedule
+        if (!m_antennaScheduler.enabled)
+        {
+            m_scheduledAntennas.clear();
+        }
+    }
+    else
+    {
+        // Put back the airtime the application configured
+        this->ReleaseAntennaSchedule();
+    }
+
+    m_antennaScheduler = *pParms;
+    this->PublishSnapshot();
+} // Radio::SetAntennaScheduler
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        GetAntennaScheduler
+// Description: Retrieves the antenna scheduler configuration
+////////////////////////////////////////////////////////////////////////////////
+void Radio::GetAntennaScheduler(
+    RFID_ANTENNA_SCHEDULER_PARMS*   pParms
+    )
+{
+    assert(NULL != pParms);
+
+    // Served from the snapshot so that it can be read while the radio is busy
+    CplMutexAutoLock snapshotLock(&m_snapshotLock);
+    *pParms = m_snapshot.antennaScheduler;
+} // Radio::GetAntennaScheduler
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        GetAntennaPortYield
+// Description: Retrieves the tag yield the antenna scheduler has measured for
+//              an antenna port and the airtime it has scheduled
+////////////////////////////////////////////////////////////////////////////////
+bool Radio::GetAntennaPortYield(
+    INT32U                      antennaPort,
+    RFID_ANTENNA_PORT_YIELD*    pYield
+    )
+{
+    assert(NULL != pYield);
+
+    // Until the scheduler has seen an inventory, the port gets the airtime
+    // the application configured.  The port must have been validated by
+    // reading its configuration.
+    RFID_ANTENNA_PORT_CONFIG config;
+    if (!this->GetCachedAntennaPortConfiguration(antennaPort, &config))
+    {
+        return false;
+    }
+
+    // Served from the snapshot so that it can be read while the radio is busy
+    CplMutexAutoLock snapshotLock(&m_snapshotLock);
+
+    memset(pYield, 0, sizeof(*pYield));
+    pYield->length                = sizeof(*pYield);
+    pYield->dwellTime             = config.dwellTime;
+    pYield->numberInventoryCycles = config.numberInventoryCycles;
+
+    if (antennaPort < m_snapshot.scheduledAntennas.size())
+    {
+        const SCHEDULED_ANTENNA& antenna =
+            m_snapshot.scheduledAntennas[antennaPort];
+
+        pYield->visits                = antenna.visits;
+        pYield->newTags               = antenna.newTags;
+        pYield->averageNewTags        =
+            static_cast<INT32U>(antenna.averageNewTags * 100 + 0.5);
+        pYield->dwellTime             = antenna.dwellTime;
+        pYield->numberInventoryCycles = antenna.numberInventoryCycles;
+    }
+
+    return true;
+} // Radio::GetAntennaPortYield
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        SetPacketSubscription
+// Description: Sets the packet types that an ISO 18000-6C operation passes to
+//              the application's packet callback
+////////////////////////////////////////////////////////////////////////////////
+void Radio::SetPacketSubscription(
+    RFID_18K6C_OPERATION            operation,
+    const RFID_PACKET_SUBSCRIPTION* pSubscription
+    )
+{
+    assert(operation < RFID_18K6C_OPERATION_LAST);
+
+    // If the radio is busy, don't allow this operation
+    if (m_isBusy)
+    {
+        RFID_TRACE(
+            Tracer::RFID_LOG_SEVERITY_INFO,
+            "%s: Cannot complete request as radio is busy\n",
+            __FUNCTION__);
+        throw RfidErrorException(RFID_ERROR_RADIO_BUSY, __FUNCTION__);
+    }
+
+    // No subscription means every packet.  The packets the MAC produces are
+    // brought in line when the operation is next started.
+    if (NULL == pSubscription)
+    {
+        memset(&m_packetSubscriptions[operation],
+               0xFF,
+               sizeof(m_packetSubscriptions[operation]));
+        m_packetSubscriptions[operation].length =
+            sizeof(m_packetSubscriptions[operation]);
+    }
+    else
+    {
+        m_packetSubscriptions[operation] = *pSubscription;
+    }
+    this->PublishSnapshot();
+} // Radio::SetPacketSubscription
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        GetPacketSubscription
+// Description: Retrieves the packet types that an ISO 18000-6C operation
+//              passes to the application's packet callback
+////////////////////////////////////////////////////////////////////////////////
+void Radio::GetPacketSubscription(
+    RFID_18K6C_OPERATION        operation,
+    RFID_PACKET_SUBSCRIPTION*   pSubscription
+    )
+{
+    assert(operation < RFID_18K6C_OPERATION_LAST);
+    assert(NULL != pSubscription);
+
+    // Served from the snapshot so that it can be read while the radio is busy
+    CplMutexAutoLock snapshotLock(&m_snapshotLock);
+    *pSubscription = m_snapshot.packetSubscriptions[operation];
+} // Radio::GetPacketSubscription
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        GetClockModel
+// Description: Retrieves the model of the host time at which the MAC's
+//              millisecond counter had a value
+////////////////////////////////////////////////////////////////////////////////
+void Radio::GetClockModel(
+    RFID_RADIO_CLOCK_MODEL* pModel
+    )
+{
+    assert(NULL != pModel);
+
+    // A packet callback wants the latest model; any other thread gets the
+    // one published at the last command boundary
+    if (m_isBusy && (CPL_ThreadGetID() == m_busyThread))
+    {
+        m_macClock.GetModel(pModel);
+    }
+    else
+    {
+        CplMutexAutoLock snapshotLock(&m_snapshotLock);
+        *pModel = m_snapshot.clockModel;
+    }
+} // Radio::GetClockModel
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        SetResponseTimeout
+// Description: Sets how long the radio may stay silent before it is
+//              considered to have stopped responding
+////////////////////////////////////////////////////////////////////////////////
+void Radio::SetResponseTimeout(
+    INT32U  timeout
+    )
+{
+    // If the radio is busy, don't allow this operation
+    if (m_isBusy)
+    {
+        RFID_TRACE(
+            Tracer::RFID_LOG_SEVERITY_INFO,
+            "%s: Cannot complete request as radio is busy\n",
+            __FUNCTION__);
+        throw RfidErrorException(RFID_ERROR_RADIO_BUSY, __FUNCTION__);
+    }
+
+    m_responseTimeout = timeout;
+    this->PublishSnapshot();
+} // Radio::SetResponseTimeout
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        GetResponseTimeout
+// Description: Retrieves how long the radio may stay silent before it is
+//              considered to have stopped responding
+////////////////////////////////////////////////////////////////////////////////
+INT32U Radio::GetResponseTimeout()
+{
+    CplMutexAutoLock snapshotLock(&m_snapshotLock);
+    return m_snapshot.responseTimeout;
+} // Radio::GetResponseTimeout
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        SaveConfiguration
+// Description: Captures the radio's host-configurable registers and link
+//              profile in a versioned binary blob
+////////////////////////////////////////////////////////////////////////////////
+void Radio::SaveConfiguration(
+    INT8U*  pBuffer,
+    INT32U* pLength
+    )
+{
+    assert(NULL != pLength);
+
+    // If the radio is busy, don't allow this operation
+    if (m_isBusy)
+    {
+        RFID_TRACE(
+            Tracer::RFID_LOG_SEVERITY_INFO,
+            "%s: Cannot complete request as radio is busy\n",
+            __FUNCTION__);
+        throw RfidErrorException(RFID_ERROR_RADIO_BUSY, __FUNCTION__);
+    }
+
+    CONFIGURATION_REGISTERS registers;
+    INT32U                  linkProfile = this->GetCurrentLinkProfile();
+
+    this->CaptureConfigurationRegisters(registers);
+
+    // Tell the caller how big the blob is, even if it won't fit
+    INT32U registersSize = static_cast<INT32U>(
+        registers.size() * sizeof(CONFIGURATION_REGISTER));
+    INT32U bufferSize    = *pLength;
+
+    *pLength = sizeof(CONFIGURATION_HEADER) + registersSize;
+    if ((NULL == pBuffer) || (bufferSize < *pLength))
+    {
+        throw RfidErrorException(RFID_ERROR_BUFFER_TOO_SMALL, __FUNCTION__);
+    }
+
+    // Lay the register writes out in the MAC's byte order and then put the
+    // header in front of them
+    for (CONFIGURATION_REGISTERS::iterator entry = registers.begin();
+         entry != registers.end();
+         ++entry)
+    {
+        entry->address = CPL_HostToMac16(entry->address);
+        entry->value   = CPL_HostToMac32(entry->value);
+    }
+
+    CONFIGURATION_HEADER header;
+    header.magic         = CPL_HostToMac32(CONFIGURATION_MAGIC);
+    header.version       = CPL_HostToMac16(CONFIGURATION_VERSION);
+    header.registerCount =
+        CPL_HostToMac16(static_cast<INT16U>(registers.size()));
+    header.linkProfile   = CPL_HostToMac32(linkProfile);
+    header.crc           = 0;
+    if (registersSize)
+    {
+        header.crc = CPL_HostToMac32(FastCrc32(
+            0,
+            reinterpret_cast<unsigned char *>(&registers[0]),
+            registersSize));
+        memcpy(pBuffer + sizeof(header), &registers[0], registersSize);
+    }
+    memcpy(pBuffer, &header, sizeof(header));
+} // Radio::SaveConfiguration
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        RestoreConfiguration
+// Description: Puts back a configuration captured by SaveConfiguration
+////////////////////////////////////////////////////////////////////////////////
+void Radio::RestoreConfiguration(
+    const INT8U*    pBuffer,
+    INT32U          length
+    )
+{
+    assert(NULL != pBuffer);
+
+    // If the radio is busy, don't allow this operation
+    if (m_isBusy)
+    {
+        RFID_TRACE(
+            Tracer::RFID_LOG_SEVERITY_INFO,
+            "%s: Cannot complete request as radio is busy\n",
+            __FUNCTION__);
+        throw RfidErrorException(RFID_ERROR_RADIO_BUSY, __FUNCTION__);
+    }
+
+    CONFIGURATION_HEADER header;
+    INT32U               count = 0;
+
+    if (length >= sizeof(header))
+    {
+        memcpy(&header, pBuffer, sizeof(header));
+        count = CPL_MacToHost16(header.registerCount);
+    }
+
+    // Make sure that it is a blob we wrote and that it arrived intact
+    INT32U registersSize = count * sizeof(CONFIGURATION_REGISTER);
+    if ((length < sizeof(header))                                   ||
+        (CONFIGURATION_MAGIC != CPL_MacToHost32(header.magic))      ||
+        (CONFIGURATION_VERSION != CPL_MacToHost16(header.version))  ||
+        (length != sizeof(header) + registersSize)                  ||
+        (CPL_MacToHost32(header.crc) != FastCrc32(
+            0,
+            const_cast<unsigned char *>(pBuffer + sizeof(header)),
+            registersSize)))
+    {
+        RFID_TRACE(
+            Tracer::RFID_LOG_SEVERITY_INFO,
+            "%s: Configuration is not valid\n",
+            __FUNCTION__);
+        throw RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+    }
+
+    std::vector<INT16U> addresses(count);
+    std::vector<INT32U> values(count);
+
+    for (INT32U index = 0; index < count; ++index)
+    {
+        CONFIGURATION_REGISTER entry;
+        memcpy(&entry,
+               pBuffer + sizeof(header) + index * sizeof(entry),
+               sizeof(entry));
+
+        addresses[index] = CPL_MacToHost16(entry.address);
+        values[index]    = CPL_MacToHost32(entry.value);
+
+        // Never let a blob write anything but configuration (e.g., HST_CMD)
+        if (!IsConfigurationRegister(addresses[index]))
+        {
+            RFID_TRACE(
+                Tracer::RFID_LOG_SEVERITY_INFO,
+                "%s: Configuration contains register 0x%.4x\n",
+                __FUNCTION__,
+                addresses[index]);
+            throw RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+        }
+    }
+
+    // Changing the link profile is a MAC command that takes a while, so only
+    // do it if the radio isn't already using the profile
+    INT32U linkProfile = CPL_MacToHost32(header.linkProfile);
+    if (this->GetCurrentLinkProfile() != linkProfile)
+    {
+        this->SetCurrentLinkProfile(linkProfile);
+    }
+
+    // The antenna descriptors and select registers are about to change
+    // behind the scheduler's, the select shadow's and the snapshot's backs
+    this->ReleaseAntennaSchedule();
+    m_selectShadow.clear();
+    this->ForgetAntennaPortConfigurations();
+
+    // Send all of the writes together and check the MAC took them once at
+    // the end instead of after each
+    if (count)
+    {
+        m_pMac->WriteRegisters(&addresses[0], &values[0], count);
+    }
+
+    INT32U macError = m_pMac->ReadRegister(MAC_ERROR);
+    if (MACERR_SUCCESS != macError)
+    {
+        RFID_TRACE(
+            Tracer::RFID_LOG_SEVERITY_ERROR,
+            "%s: Restoring configuration generated MAC error %d\n",
+            __FUNCTION__,
+            macError);
+
+        this->ClearMacError();
+        throw RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+    }
+} // Radio::RestoreConfiguration
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        Start18K6CRequest
+// Description: Performs the generic configuration setting needed for
+//              supporting the ISO 18000-6C tag operations.
+////////////////////////////////////////////////////////////////////////////////
+void Radio::Start18K6CRequest(
+    const RFID_18K6C_COMMON_PARMS* pParms,
+    INT32U                         flags,
+    RFID_18K6C_OPERATION           operation
+    )
+{
+    assert(NULL != pParms);
+
+    // If the radio is already busy, then don't allow another operation
+    if (m_isBusy)
+    {
+        RFID_TRACE(
+            Tracer::RFID_LOG_SEVERITY_INFO,
+            "%s: Cannot complete request as radio is busy\n",
+            __FUNCTION__);
+        throw RfidErrorException(RFID_ERROR_RADIO_BUSY, __FUNCTION__);
+    }
+
+    // If the radio is being closed or reset, then don't start an operation
+    if (m_isRetired)
+    {
+        RFID_TRACE(
+            Tracer::RFID_LOG_SEVERITY_INFO,
+            "%s: Cannot complete request as radio is being closed\n",
+            __FUNCTION__);
+        throw RfidErrorException(RFID_ERROR_INVALID_HANDLE, __FUNCTION__);
+    }
+
+    // A cancel or abort requested before the operation started was meant for
+    // an earlier one.  One requested from here on is kept until the command
+    // has been issued, so that it cannot be lost while the command is set up.
+    if (!m_reissuingAccess)
+    {
+        m_shouldCancel = false;
+        m_shouldAbort  = false;
+    }
+
+    // Only an inventory feeds the dynamic-Q tuner and the antenna scheduler
+    m_tunerInventory     = false;
+    m_schedulerInventory = false;
+
+    // Pass the application only the packets it subscribed to for this
+    // operation, and don't have the MAC produce those nobody needs
+    assert(operation < RFID_18K6C_OPERATION_LAST);
+    m_pSubscription = &m_packetSubscriptions[operation];
+    this->ApplyPacketSubscription(operation);
+
+    // Set up the rest of the HST_INV_CFG register.  First, we have to read its
+    // current value
+    INT32U registerValue = m_pMac->ReadRegister(HST_INV_CFG);
+
+    // TBD - an optimization could be to only write back the register if
+    // the value changes
+
+    // Set the tag stop count and enabled flags and then write the register
+    // back
+    if (flags & RFID_FLAG_PERFORM_SELECT)
+    {
+        HST_INV_CFG_SET_AUTOSEL_ENABLED(registerValue);
+    }
+    else
+    {
+        HST_INV_CFG_SET_AUTOSEL_DISABLED(registerValue);
+    }
+    HST_INV_CFG_SET_REP(registerValue, pParms->tagStopCount);
+    m_pMac->WriteRegister(HST_INV_CFG, registerValue);
+
+    // Set the enabled flag in the HST_INV_EPC_MATCH_CFG register properly.  To
+    // do so, have to read the register value first.  Then set the bit properly
+    // and then write the register value back to the MAC.
+    registerValue = m_pMac->ReadRegister(HST_INV_EPC_MATCH_CFG);
+    if (flags & RFID_FLAG_PERFORM_POST_MATCH)
+    {
+        HST_INV_EPC_MATCH_CFG_SET_ENABLED(registerValue);
+    }
+    else
+    {
+        HST_INV_EPC_MATCH_CFG_SET_DISABLED(registerValue);
+    }
+    m_pMac->WriteRegister(HST_INV_EPC_MATCH_CFG, registerValue);
+} // Radio::Start18K6CRequest
+
+////////////////////////////////////////////////////////////////////////////
+// Name:        PostMacCommandIssue
+// Description: Performs any post-request work needed for the ISO 18000-6C
+//              tag-protocol operation.
+// Parameters:  None
+// Returns:     Nothing
+////////////////////////////////////////////////////////////////////////////
+void Radio::PostMacCommandIssue()
+{
+    // Grab the cancel/abort lock
+    CplMutexAutoLock    lockIt(&m_cancelAbortLock);
+
+    // Now that everything is okay, indicate that the radio is busy
+    m_isBusy                = true;
+    m_operationCancelled    = false;
+    m_accessOutcome         = ACCESS_OUTCOME_NONE;
+    m_commandEndStatus      = 0;
+
+    // Save off the thread ID of this thread so that we can avoid deadlock
+    // issues associated with certain functions (specifically, those involving
+    // a radio cancel) being called from the packet callback
+    m_busyThread = CPL_ThreadGetID();
+
+    // The command has been issued, so from now on a cancel can go straight
+    // to the MAC
+    CPL_AtomicExchange32(&m_cancelState, CANCEL_STATE_RUNNING);
+
+    // If the radio was retired after the request was started, the abort that
+    // retired it may have been cleared, so abort the command now.  The radio
+    // is retired before it is aborted, and the lock above is a barrier, so
+    // the abort is either still set or the flag is seen here.
+    if (m_isRetired)
+    {
+        m_shouldAbort = true;
+    }
+
+    // Now that we are ready to finish everything, let the auto-lock relinquish
+    // the lock.  We'll re-wrap the lock when we start processing packets.
+    lockIt.Transfer();
+} // Radio::Finish18K6CRequest
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        Radio::WriteMacMaskRegisters
+// Description: Writes the MAC mask registers (select or post-singulation).
+////////////////////////////////////////////////////////////////////////////////
+void Radio::WriteMacMaskRegisters(
+    INT16U          registerAddress,
+    INT32U          bitCount,
+    const INT8U*    pMask
+    )
+{
+    INT32U registers[MAX_MASK_REGISTERS];
+    INT32U registerCount = this->PackMacMaskRegisters(bitCount, pMask, registers);
+
+    // Now write each MAC mask register
+    for (INT32U index = 0; index < registerCount; ++index)
+    {
+        m_pMac->WriteRegister(registerAddress++, registers[index]); // Generic Write
+    }
+} // Radio::WriteMacMaskRegisters
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        Radio::PackMacMaskRegisters
+// Description: Packs a mask into MAC mask register values (select or
+//              post-singulation).
+////////////////////////////////////////////////////////////////////////////////
+INT32U Radio::PackMacMaskRegisters(
+    INT32U          bitCount,
+    const INT8U*    pMask,
+    INT32U*         pRegisters
+    )
+{
+    // Figure out how many bytes are in the mask
+    INT32U byteCount     = (bitCount + BITS_PER_BYTE - 1) / BITS_PER_BYTE;
+    INT32U registerCount = 0;
+
+    assert(byteCount <= MAX_MASK_REGISTERS * BYTES_PER_REGISTER);
+
+    // Now build each MAC mask register
+    while (byteCount)
+    {
+        INT32U registerValue = 0;
+        INT32U leftShift     = 0;
+        INT32U loopCount     = (byteCount > BYTES_PER_REGISTER ?
+                                    BYTES_PER_REGISTER : byteCount);
+
+        // Decrement the byte count by the number of bytes put into the register
+        byteCount -= loopCount;
+
+        // Build up the register value
+        for ( ; loopCount; --loopCount, leftShift += BITS_PER_BYTE, ++pMask)
+        {
+            registerValue |= (static_cast<INT32U>(*pMask) << leftShift);
+        }
+
+        // If it is the last byte of the mask, then we are going to zero out
+        // any bits not in the mask
+        if (!byteCount && (bitCount % BITS_PER_BYTE))
+        {
+            INT32U mask = 0xFFFFFFFF;
+            mask          <<= (BITS_PER_REGISTER - (BITS_PER_BYTE - (bitCount % BITS_PER_BYTE)));
+            mask          >>= (BITS_PER_REGISTER - (leftShift - (bitCount % BITS_PER_BYTE)));
+            registerValue &=  ~mask;
+        }
+
+        pRegisters[registerCount++] = registerValue;
+    }
+
+    return registerCount;
+} // Radio::PackMacMaskRegisters
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        GetSelectBankSize
+// Description: Retrieves the number of select descriptors the MAC has.
+////////////////////////////////////////////////////////////////////////////////
+INT16U Radio::GetSelectBankSize()
+{
+    // Use select register info to get bank size, if its supported.  The
+    // answer can't change for the firmware we are talking to, so only ask
+    // once.
+    if (!m_selectBankSize)
+    {
+        if (m_preTwoTwoFirmware)
+        {
+            m_selectBankSize = RFID_18K6C_MAX_SELECT_CRITERIA_CNT;
+        }
+        else
+        {
+            RFID_REGISTER_INFO info;
+
+            this->ReadMacRegisterInfo(HST_TAGMSK_DESC_SEL, &info);
+            m_selectBankSize = info.bankSize;
+        }
+    }
+
+    return m_selectBankSize;
+} // Radio::GetSelectBankSize
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        CompileSelectCriteria
+// Description: Builds the select descriptor register image for a set of
+//              selection criteria.
+////////////////////////////////////////////////////////////////////////////////
+void Radio::CompileSelectCriteria(
+    const RFID_18K6C_SELECT_CRITERIA*   pCriteria,
+    SELECT_CRITERIA_IMAGE&              image
+    )
+{
+    INT16U bankSize = this->GetSelectBankSize();
+
+    // ensure the countCriteria does not excced bank size
+    if (pCriteria->countCriteria > bankSize)
+    {
+        RFID_TRACE(
+            Tracer::RFID_LOG_SEVERITY_INFO,
+            "%s: Select countCriteria %u is invalid\n",
+            __FUNCTION__,
+            pCriteria->countCriteria);
+        throw RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+    }
+
+    image.resize(bankSize);
+
+    const RFID_18K6C_SELECT_CRITERION* pCriterion = pCriteria->pCriteria;
+    for (INT32U index = 0; index < bankSize; ++index)
+    {
+        SELECT_DESCRIPTOR& descriptor = image[index];
+
+        // Descriptors past the criteria are simply disabled; the MAC ignores
+        // the rest of their registers
+        if (index >= pCriteria->countCriteria)
+        {
+            descriptor.registers[SELECT_CFG_REGISTER_INDEX] =
+                HST_TAGMSK_DESC_CFG_DISABLED;
+            descriptor.validRegisters = 1 << SELECT_CFG_REGISTER_INDEX;
+            continue;
+        }
+
+        const RFID_18K6C_SELECT_MASK*   pMask   = &pCriterion->mask;
+        const RFID_18K6C_SELECT_ACTION* pAction = &pCriterion->action;
+
+        // The HST_TAGMSK_DESC_CFG register value
+        descriptor.registers[SELECT_CFG_REGISTER_INDEX] =
+            HST_TAGMSK_DESC_CFG_ENABLED                 |
+            HST_TAGMSK_DESC_CFG_TARGET(pAction->target) |
+            HST_TAGMSK_DESC_CFG_ACTION(pAction->action) |
+            (pAction->enableTruncate ? 
+                HST_TAGMSK_DESC_CFG_TRUNC_ENABLED :
+                HST_TAGMSK_DESC_CFG_TRUNC_DISABLED)     |
+            HST_TAGMSK_DESC_CFG_RFU1(0);
+
+        // The HST_TAGMSK_BANK, HST_TAGMSK_PTR and HST_TAGMSK_LEN register
+        // values
+        descriptor.registers[SELECT_BANK_REGISTER_INDEX] =
+            HST_TAGMSK_BANK_BANK(pMask->bank)   |
+            HST_TAGMSK_BANK_RFU1(0);
+        descriptor.registers[SELECT_PTR_REGISTER_INDEX] =
+            pMask->offset;
+        descriptor.registers[SELECT_LEN_REGISTER_INDEX] =
+            HST_TAGMSK_LEN_LEN(pMask->count) |
+            HST_TAGMSK_LEN_RFU1(0);
+
+        // And the mask registers that the mask actually covers
+        INT32U maskRegisters = this->PackMacMaskRegisters(
+            pMask->count,
+            pMask->mask,
+            &descriptor.registers[SELECT_MASK_REGISTER_INDEX]);
+
+        descriptor.validRegisters =
+            (1 << (SELECT_MASK_REGISTER_INDEX + maskRegisters)) - 1;
+
+        // advance to next criterion
+        pCriterion++;
+    } // for (each descriptor)
+} // Radio::CompileSelectCriteria
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        ApplySelectCriteria
+// Description: Writes a select descriptor register image to the MAC, skipping
+//              registers already known to hold the value.
+////////////////////////////////////////////////////////////////////////////////
+void Radio::ApplySelectCriteria(
+    const SELECT_CRITERIA_IMAGE&    image
+    )
+{
+    // Anything we haven't written ourselves is unknown
+    if (m_selectShadow.size() != image.size())
+    {
+        SELECT_DESCRIPTOR unknown;
+        unknown.validRegisters = 0;
+        m_selectShadow.assign(image.size(), unknown);
+    }
+
+    for (INT32U index = 0; index < image.size(); ++index)
+    {
+        const SELECT_DESCRIPTOR&    descriptor = image[index];
+        SELECT_DESCRIPTOR&          shadow     = m_selectShadow[index];
+        bool                        selected   = false;
+
+        for (INT32U offset = 0; offset < SELECT_DESCRIPTOR_REGISTER_COUNT; ++offset)
+        {
+            INT32U bit = 1 << offset;
+
+            // Skip registers the image doesn't care about and those that
+            // already hold the value
+            if (!(descriptor.validRegisters & bit) ||
+                ((shadow.validRegisters & bit) &&
+                 (shadow.registers[offset] == descriptor.registers[offset])))
+            {
+                continue;
+            }
+
+            // Instruct the MAC as to which select mask we want to work with,
+            // but only once per descriptor
+            if (!selected)
+            {
+                m_pMac->WriteRegister(HST_TAGMSK_DESC_SEL, index);
+                selected = true;
+            }
+
+            // If the write fails part way, don't trust the shadow anymore
+            shadow.validRegisters &= ~bit;
+            m_pMac->WriteRegister(HST_TAGMSK_DESC_CFG + offset,
+                                  descriptor.registers[offset]);
+            shadow.registers[offset]  = descriptor.registers[offset];
+            shadow.validRegisters    |= bit;
+        }
+    } // for (each descriptor)
+} // Radio::ApplySelectCriteria
+
+////////////////////////////////////////////////////////////////////////////
+// Name:        ReadMacMaskRegisters
+// Description: Reads the MAC mask registers (select or post-singulation).
+////////////////////////////////////////////////////////////////////////////
+void Radio::ReadMacMaskRegisters(
+    INT16U  registerAddress,
+    INT32U  bitCount,
+    INT8U*  pMask
+    )
+{
+    // Figure out how many bytes are in the mask
+    INT32U byteCount = (bitCount + BITS_PER_BYTE - 1) / BITS_PER_BYTE;
+
+    // Read the mask registers and build the mask
+    while (byteCount)
+    {
+        INT32U registerValue = m_pMac->ReadRegister(registerAddress++); // Generic Read
+        INT32U rightShift     = 0;
+        INT32U loopCount     = (byteCount > BYTES_PER_REGISTER ?
+                                    BYTES_PER_REGISTER : byteCount);
+
+        // Decrement the byte count by the number of bytes to extract from the
+        // register
+        byteCount -= loopCount;
+
+        // Add the register bytes to the mask
+        for ( ; loopCount; --loopCount, rightShift += BITS_PER_BYTE, ++pMask)
+        {
+            *pMask = (INT8U)((registerValue >> rightShift) & 0x000000FF);
+        }
+    }
+
+    // If the last byte isn't complete, mask off the unneeded bits
+    if (bitCount % BITS_PER_BYTE)
+    {
+        *pMask &= 0xFF << (BITS_PER_BYTE - (bitCount % BITS_PER_BYTE));
+    }
+} // Radio::ReadMacMaskRegisters
 
 ////////////////////////////////////////////////////////////////////////////
-// Name:        PostMacCommandIssue
-// Description: Performs any post-request work needed for the ISO 18000-6C
-//              tag-protocol operation.
-// Parameters:  None
-// Returns:     Nothing
+// Name:        RetrieveNextPacket
+// Description: Retrieves the next packet from the MAC.
 ////////////////////////////////////////////////////////////////////////////
-void Radio::PostMacCommandIssue()
+void Radio::RetrieveNextPacket(
+    INT32U          &bufferSize,
+    PACKET_BUFFER   &buffer,
+    bool            canBeCancelled
+    )
+{
+    // Start out by only retrieving the common packet header
+    bufferSize = sizeof(hostpkt_cmn);
+    if (buffer.size() < bufferSize)
+    {
+        buffer.resize(bufferSize);
+    }
+
+    // Retrieve the common packet header first
+    this->RetrieveBuffer(bufferSize, &buffer[0], canBeCancelled);
+
+    // Now that we have the common header, figure out how many bytes remain
+    // in the packet
+    INT32U  remainingSize =
+        RFID_PACKET_PKT_BYTE_LEN(
+            CPL_MacToHost16(
+                reinterpret_cast<RFID_PACKET_COMMON *>(&buffer[0])->pkt_len));
+
+    // Increase the buffer size if necessary
+    if (buffer.size() < (bufferSize + remainingSize))
+    {
+        buffer.resize(bufferSize + remainingSize);
+    }
+
+    // If there is data beyond the common header, retrieve it as
+    // well
+    if (remainingSize)
+    {
+        this->RetrieveBuffer(
+            remainingSize,
+            &buffer[bufferSize],
+            canBeCancelled);
+    }
+
+    // Set the total buffer size appropriately
+    bufferSize += remainingSize;
+} // Radio::RetrieveNextPacket
+
+////////////////////////////////////////////////////////////////////////////
+// Name:        RetrieveBuffer
+// Description: Retrieves a buffer of the specified size from the MAC.
+////////////////////////////////////////////////////////////////////////////
+void Radio::RetrieveBuffer(
+    INT32U  bufferSize,
+    INT8U*  buffer,
+    bool    canBeCancelled
+    )
+{
+    CPL_TimeSpec startTime;
+    CPL_TimeSpec currentTime;
+    INT32U       last_bytesAvailable;
+
+    // Keep checking until there are enough bytes to fulfill the request.  If
+    // we already know that there are enough bytes available, we aren't even
+    // going to poll the transport layer.  
+    // 
+    // Add a timeout so we don't get stuck here. This is unlikely to ever happen
+    // with USB transport, but with serial we may since there is no way to know 
+    // that the radio may be disconnected.  Only timeout if  we go for 3 seconds 
+    // and m_bytesAvailable is not changing.  So long as we are receiving bytes,
+    // then the 3 second timeout window should be reset.
+    //
+    // Timeout logic was added as of v2.4.0 and depends on the MAC Firmware providing
+    // the Command Active packet during long running command operations when there 
+    // is no other packet traffic.  For backward compatibility, we only enable the
+    // timeout checks if we are running v2.4.0 firmware or later.
+    // 
+    // snapshot current value of bytesAvailable and capture the startTime
+    last_bytesAvailable = m_bytesAvailable;
+    CPL_TimeSpecGet(&startTime);
+
+    RFID_PROBE3(buffer_wait_begin,
+        radio, this,
+        wanted, bufferSize,
+        available, m_bytesAvailable);
+
+    while (m_bytesAvailable < bufferSize)
+    {   
+
+        // Figure out how many bytes are available to consume
+        m_bytesAvailable = this->RetrieveRawBytes(0, NULL, canBeCancelled);
+
+        // if we are running against 2.4.0 firmware or later
+        if (m_preTwoFourFirmware == 0)
+        {
+            if (m_bytesAvailable != last_bytesAvailable) 
+            {
+                // value was updated, so reset startTime and refresh snapshot
+                last_bytesAvailable = m_bytesAvailable;
+                CPL_TimeSpecGet(&startTime);
+            }
+            else
+            {
+                // value remains unchanged, check for timeout
+                CPL_TimeSpecGet(&currentTime);
+                CPL_TimeSpecDiff(&currentTime,&startTime);
+                if (static_cast<INT32U>(currentTime.seconds) * 1000 +
+                    currentTime.nanoseconds / 1000000 >= m_responseTimeout)
+                {
+                    m_statistics.Count(
+                        RadioStatistics::COUNTER_RESPONSE_TIMEOUTS);
+                    throw RfidErrorException(RFID_ERROR_RADIO_NOT_RESPONDING, __FUNCTION__);
+                }
+            }
+        }
+        if (m_bytesAvailable < bufferSize)
+        {
+            // A cancel or abort cuts the wait short
+            if (canBeCancelled)
+            {
+                CPL_TimeSpec interval = { 0, MAC_SLEEP_MILLIS * 1000000 };
+                CPL_CondRelTimedWait(&m_cancelSignal, &interval);
+            }
+            else
+            {
+                CPL_MillisecondSleep(MAC_SLEEP_MILLIS);
+            }
+        }
+    }
+
+    RFID_PROBE3(buffer_wait_end,
+        radio, this,
+        wanted, bufferSize,
+        available, m_bytesAvailable);
+
+    // At this point, we know that there are enough bytes to fulfill the
+    // request
+    m_bytesAvailable = this->RetrieveRawBytes(bufferSize, buffer, canBeCancelled);
+
+} // Radio::RetrieveBuffer
+
+////////////////////////////////////////////////////////////////////////////
+// Name:        RetrieveRawBytes
+// Description: Retrieves raw bytes from the MAC.  Also will indicate how
+//              many bytes are remaining for retrieval without blocking.
+////////////////////////////////////////////////////////////////////////////
+INT32U Radio::RetrieveRawBytes(
+    INT32U  bufferSize,
+    INT8U*  buffer,
+    bool    canBeCancelled
+    )
+{
+    assert(!bufferSize || (NULL != buffer));
+
+    // If allowed to do so, detect to see if a cancel or an abort should
+    // be issued to the MAC
+    if (canBeCancelled)
+    {
+        if (m_shouldCancel)
+        {
+            RFID_TRACE(
+                Tracer::RFID_LOG_SEVERITY_INFO,
+                "%s: Radio operation has been cancelled\n",
+                __FUNCTION__);
+
+            // For a cancel, since we are to receive a command-end, issue
+            // the cancel and then we'll continue on our merry way
+            m_pMac->CancelOperation();
+            CPL_TimeSpecGet(&m_cancelTime);
+            m_shouldCancel       = false;
+            m_operationCancelled = true;
+            CPL_AtomicExchange32(&m_cancelState, CANCEL_STATE_ISSUED);
+        }
+        else if (m_shouldAbort || this->HasCancelDrainExpired())
+        {
+            RFID_TRACE(
+                Tracer::RFID_LOG_SEVERITY_INFO,
+                "%s: Radio operation has been aborted\n",
+                __FUNCTION__);
+
+            // Since we are clearing out the pipeline, we know that there
+            // will not be any bytes immediately available for consumption
+            m_bytesAvailable = 0;
+
+            // For an abort, once that is done, we want to blast out of the
+            // packet receive loop
+            m_pMac->AbortOperation();
+            throw RfidErrorException(RFID_ERROR_OPERATION_CANCELLED, __FUNCTION__);
+        }
+    }
+
+    // Now receive the bytes from the MAC
+    return m_pMac->RetrieveData(buffer, bufferSize);
+} // Radio::RetrieveRawBytes
+
+////////////////////////////////////////////////////////////////////////////
+// Name:        HasCancelDrainExpired
+// Description: Determines if the remaining packets of a cancelled operation
+//              have taken too long to arrive.
+////////////////////////////////////////////////////////////////////////////
+bool Radio::HasCancelDrainExpired()
+{
+    if (CANCEL_STATE_ISSUED != m_cancelState)
+    {
+        return false;
+    }
+
+    CPL_TimeSpec currentTime;
+    CPL_TimeSpecGet(&currentTime);
+    CPL_TimeSpecDiff(&currentTime, &m_cancelTime);
+    if (static_cast<INT32U>(currentTime.seconds) * 1000 +
+        currentTime.nanoseconds / 1000000 < CANCEL_DRAIN_MILLIS)
+    {
+        return false;
+    }
+
+    RFID_TRACE(
+        Tracer::RFID_LOG_SEVERITY_INFO,
+        "%s: No command-end within %u ms of the cancel\n",
+        __FUNCTION__,
+        CANCEL_DRAIN_MILLIS);
+    m_statistics.Count(RadioStatistics::COUNTER_CANCEL_TIMEOUTS);
+    return true;
+} // Radio::HasCancelDrainExpired
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        TrackAccessOutcome
+// Description: Records the command status and tag-access results carried by
+//              an operation response packet.
+////////////////////////////////////////////////////////////////////////////////
+void Radio::TrackAccessOutcome(
+    const RFID_PACKET_COMMON*   pPacket
+    )
+{
+    switch (CPL_MacToHost16(pPacket->pkt_type))
+    {
+        case RFID_PACKET_TYPE_18K6C_TAG_ACCESS:
+        {
+            ACCESS_OUTCOME outcome = Radio::ClassifyTagAccess(
+                reinterpret_cast<const RFID_PACKET_18K6C_TAG_ACCESS *>(pPacket));
+
+            // One successful access is enough.  Otherwise, remember the worst
+            // failure so that an unfixable failure is never retried.
+            if ((ACCESS_OUTCOME_SUCCESS == outcome) ||
+                ((ACCESS_OUTCOME_SUCCESS != m_accessOutcome) &&
+                 (outcome > m_accessOutcome)))
+            {
+                m_accessOutcome = outcome;
+            }
+            break;
+        } // case RFID_PACKET_TYPE_18K6C_TAG_ACCESS
+        case RFID_PACKET_TYPE_COMMAND_END:
+        {
+            m_commandEndStatus = CPL_MacToHost32(
+                reinterpret_cast<const RFID_PACKET_COMMAND_END *>(
+                    pPacket)->status);
+            break;
+        } // case RFID_PACKET_TYPE_COMMAND_END
+        default:
+        {
+            break;
+        } // default
+    } // switch (pkt_type)
+} // Radio::TrackAccessOutcome
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        ClassifyTagAccess
+// Description: Determines whether a tag-access result is a success, a failure
+//              worth retrying or a failure that retrying won't fix.
+////////////////////////////////////////////////////////////////////////////////
+Radio::ACCESS_OUTCOME Radio::ClassifyTagAccess(
+    const RFID_PACKET_18K6C_TAG_ACCESS* pPacket
+    )
+{
+    if (!RFID_18K6C_TAG_ACCESS_ANY_ERROR(pPacket->cmn.flags))
+    {
+        return ACCESS_OUTCOME_SUCCESS;
+    }
+
+    // The tag answered with an error code.  Only the tag running short of
+    // power (or not saying why) may go away on another attempt; overruns and
+    // locked memory will not.
+    if (RFID_18K6C_TAG_ACCESS_BACKSCATTER_ERROR(pPacket->cmn.flags))
+    {
+        switch (pPacket->tag_error_code)
+        {
+            case BACKSCATTER_INSUFFICIENT_POWER:
+            case BACKSCATTER_NONSPECIFIC_ERROR:
+            {
+                return ACCESS_OUTCOME_RECOVERABLE;
+            }
+            default:
+            {
+                return ACCESS_OUTCOME_FATAL;
+            }
+        } // switch (pPacket->tag_error_code)
+    }
+
+    // The MAC attributed the failure to the air protocol.  Lost or garbled
+    // replies are worth retrying; bad passwords and malformed commands are not.
+    switch (CPL_MacToHost16(pPacket->prot_error_code))
+    {
+        case PROT_ACCESS_ERROR_FAIL:
+        case PROT_ACCESS_ERROR_HANDLE_MISMATCH:
+        case PROT_ACCESS_ERROR_BAD_CRC:
+        case PROT_ACCESS_ERROR_NO_REPLY:
+        case PROT_ACCESS_ERROR_TAG_LOST:
+        case PROT_ACCESS_ERROR_RETRY_COUNT_EXCEEDED:
+        {
+            return ACCESS_OUTCOME_RECOVERABLE;
+        }
+        default:
+        {
+            return ACCESS_OUTCOME_FATAL;
+        }
+    } // switch (prot_error_code)
+} // Radio::ClassifyTagAccess
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        PrepareAccessRetry
+// Description: Clears a MAC error if the last attempt ended with one and
+//              applies the backoff, power step and antenna switch for the next
+//              attempt.
+////////////////////////////////////////////////////////////////////////////////
+void Radio::PrepareAccessRetry(
+    INT32U                  retry,
+    ACCESS_RETRY_ANTENNAS&  savedAntennas
+    )
+{
+    // A tag that didn't answer does not put the MAC in an error state, so
+    // only pay for the clear-error command when the command failed
+    if (m_commandEndStatus)
+    {
+        this->ClearMacError();
+    }
+
+    // Back off, doubling the delay for each retry (but don't let the shift run
+    // away for large attempt counts)
+    if (m_accessRetryPolicy.backoffTime)
+    {
+        CPL_MillisecondSleep(
+            m_accessRetryPolicy.backoffTime << ((retry < 5 ? retry : 5) - 1));
+    }
+
+    if (!m_accessRetryPolicy.powerStep && !m_accessRetryPolicy.antennaPortMask)
+    {
+        return;
+    }
+
+    // The first time we touch the antenna ports, remember how the application
+    // had them configured
+    if (savedAntennas.empty())
+    {
+        for (INT32U port = 0; port <= RFID_MAX_ANTENNA_PORT; ++port)
+        {
+            ACCESS_RETRY_ANTENNA antenna;
+
+            m_pMac->WriteRegister(HST_ANT_DESC_SEL, port);
+            antenna.config     = m_pMac->ReadRegister(HST_ANT_DESC_CFG);
+            antenna.powerLevel = m_pMac->ReadRegister(HST_ANT_DESC_RFPOWER);
+            savedAntennas.push_back(antenna);
+        }
+    }
+
+    // If switching antennas, pick the port from the mask for this retry
+    INT32U targetPort = 0;
+    if (m_accessRetryPolicy.antennaPortMask)
+    {
+        INT32U portCount = 0;
+        for (INT32U port = 0; port <= RFID_MAX_ANTENNA_PORT; ++port)
+        {
+            if (m_accessRetryPolicy.antennaPortMask & (1 << port))
+            {
+                ++portCount;
+            }
+        }
+
+        INT32U skip = (retry - 1) % portCount;
+        for (targetPort = 0; targetPort <= RFID_MAX_ANTENNA_PORT; ++targetPort)
+        {
+            if ((m_accessRetryPolicy.antennaPortMask & (1 << targetPort)) &&
+                !skip--)
+            {
+                break;
+            }
+        }
+    }
+
+    for (INT32U port = 0; port < savedAntennas.size(); ++port)
+    {
+        const ACCESS_RETRY_ANTENNA& original = savedAntennas[port];
+        INT32U                      config   = original.config;
+
+        if (m_accessRetryPolicy.antennaPortMask)
+        {
+            if (port == targetPort)
+            {
+                HST_ANT_DESC_CFG_SET_ENABLED(config);
+            }
+            else
+            {
+                HST_ANT_DESC_CFG_SET_DISABLED(config);
+            }
+        }
+
+        // Nothing to do for a port that stays disabled
+        if (!HST_ANT_DESC_CFG_IS_ENABLED(config) && (config == original.config))
+        {
+            continue;
+        }
+
+        m_pMac->WriteRegister(HST_ANT_DESC_SEL, port);
+        m_pMac->WriteRegister(HST_ANT_DESC_CFG, config);
+
+        // Step the power up from the original level, but never past the
+        // policy's ceiling (and never below what the application chose)
+        if (m_accessRetryPolicy.powerStep && HST_ANT_DESC_CFG_IS_ENABLED(config))
+        {
+            INT32U powerLevel =
+                original.powerLevel + (m_accessRetryPolicy.powerStep * retry);
+            if (powerLevel > m_accessRetryPolicy.maxPowerLevel)
+            {
+                powerLevel =
+                    (original.powerLevel > m_accessRetryPolicy.maxPowerLevel) ?
+                    original.powerLevel : m_accessRetryPolicy.maxPowerLevel;
+            }
+            m_pMac->WriteRegister(HST_ANT_DESC_RFPOWER, powerLevel);
+        }
+    }
+} // Radio::PrepareAccessRetry
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        RestoreAccessRetryAntennas
+// Description: Restores the antenna port state modified by PrepareAccessRetry.
+////////////////////////////////////////////////////////////////////////////////
+void Radio::RestoreAccessRetryAntennas(
+    const ACCESS_RETRY_ANTENNAS&    savedAntennas
+    )
 {
-    // Grab the cancel/abort lock
-    CplMutexAutoLock    lockIt(&m_cancelAbortLock);
+    for (INT32U port = 0; port < savedAntennas.size(); ++port)
+    {
+        m_pMac->WriteRegister(HST_ANT_DESC_SEL, port);
+        m_pMac->WriteRegister(HST_ANT_DESC_CFG, savedAntennas[port].config);
+        m_pMac->WriteRegister(HST_ANT_DESC_RFPOWER,
+                              savedAntennas[port].powerLevel);
+    }
+} // Radio::RestoreAccessRetryAntennas
 
-    // Now that everything is okay, indicate that the radio is busy
-    m_isBusy                = true;
-    m_shouldCancel          = false;
-    m_shouldAbort           = false;
-    m_operationCancelled    = false;
+////////////////////////////////////////////////////////////////////////////////
+// Name:        PrepareDynamicQTuner
+// Description: Before an inventory, ensures the diagnostics the tuner needs
+//              are enabled and writes the tuned dynamic-Q parameters.
+////////////////////////////////////////////////////////////////////////////////
+void Radio::PrepareDynamicQTuner()
+{
+    const INT32U tunerDiags =
+        HST_CMNDIAGS_DIAGS_ENABLED | HST_CMNDIAGS_CYCLE_ENABLED;
 
-    // Save off the thread ID of this thread so that we can avoid deadlock
-    // issues associated with certain functions (specifically, those involving
-    // a radio cancel) being called from the packet callback
-    m_busyThread = CPL_ThreadGetID();
+    m_tunerInventory  = true;
+    m_tunerCycleBegin = 0;
+    m_tunerCycleTime  = 0;
 
-    // Now that we are ready to finish everything, let the auto-lock relinquish
-    // the lock.  We'll re-wrap the lock when we start processing packets.
-    lockIt.Transfer();
-} // Radio::Finish18K6CRequest
+    // The inventory-cycle-end diagnostics packet needs both the diagnostics
+    // and the cycle packets enabled.  Remember which of them the application
+    // didn't enable itself.
+    INT32U registerValue = m_pMac->ReadRegister(HST_CMNDIAGS);
+    if ((registerValue & tunerDiags) != tunerDiags)
+    {
+        m_tunerDiagsBits |= tunerDiags & ~registerValue;
+        m_pMac->WriteRegister(HST_CMNDIAGS, registerValue | tunerDiags);
+    }
+
+    // Nothing to tune if the MAC isn't going to use dynamic Q
+    if (RFID_18K6C_SINGULATION_ALGORITHM_DYNAMICQ !=
+        HST_INV_CFG_GET_ALGO(m_pMac->ReadRegister(HST_INV_CFG)))
+    {
+        return;
+    }
+
+    // Update only the Q and threshold fields of the dynamic-Q parameters,
+    // leaving those the tuner doesn't own as the application set them
+    m_pMac->WriteRegister(HST_INV_SEL,
+        RFID_18K6C_SINGULATION_ALGORITHM_DYNAMICQ);
+    INT32U parm0Register = m_pMac->ReadRegister(HST_INV_ALG_PARM_0);
+    INT32U tunedRegister = parm0Register;
+
+    HST_INV_ALG_PARM_0_ALGO1_SET_STARTQ(tunedRegister,
+        m_dynamicQStatus.startQValue);
+    HST_INV_ALG_PARM_0_ALGO1_SET_MINQ(tunedRegister,
+        m_dynamicQStatus.minQValue);
+    HST_INV_ALG_PARM_0_ALGO1_SET_MAXQ(tunedRegister,
+        m_dynamicQStatus.maxQValue);
+    HST_INV_ALG_PARM_0_ALGO1_SET_TMULT(tunedRegister,
+        m_dynamicQStatus.thresholdMultiplier);
+
+    if (tunedRegister != parm0Register)
+    {
+        m_pMac->WriteRegister(HST_INV_ALG_PARM_0, tunedRegister);
+    }
+} // Radio::PrepareDynamicQTuner
 
 ////////////////////////////////////////////////////////////////////////////////
-// Name:        Radio::WriteMacMaskRegisters
-// Description: Writes the MAC mask registers (select or post-singulation).
+// Name:        TrackInventoryCycle
+// Description: Feeds the inventory-cycle packets to the dynamic-Q tuner.
 ////////////////////////////////////////////////////////////////////////////////
-void Radio::WriteMacMaskRegisters(
-    INT16U          registerAddress,
-    INT32U          bitCount,
-    const INT8U*    pMask
+bool Radio::TrackInventoryCycle(
+    const RFID_PACKET_COMMON*   pPacket
     )
 {
-    // Figure out how many bytes are in the mask
-    INT32U byteCount = (bitCount + BITS_PER_BYTE - 1) / BITS_PER_BYTE;
+    INT16U packetType = CPL_MacToHost16(pPacket->pkt_type);
 
-    // Now write each MAC mask register
-    while (byteCount)
+    switch (packetType)
     {
-        INT32U registerValue = 0;
-        INT32U leftShift     = 0;
-        INT32U loopCount     = (byteCount > BYTES_PER_REGISTER ?
-                                    BYTES_PER_REGISTER : byteCount);
+        case RFID_PACKET_TYPE_INVENTORY_CYCLE_BEGIN:
+        {
+            m_tunerCycleBegin = CPL_MacToHost32(
+                reinterpret_cast<const RFID_PACKET_INVENTORY_CYCLE_BEGIN *>(
+                    pPacket)->ms_ctr);
+            m_tunerCycleTime  = 0;
+            return (m_tunerDiagsBits & HST_CMNDIAGS_CYCLE_ENABLED) != 0;
+        } // case RFID_PACKET_TYPE_INVENTORY_CYCLE_BEGIN
+        case RFID_PACKET_TYPE_INVENTORY_CYCLE_END:
+        {
+            if (m_tunerCycleBegin)
+            {
+                m_tunerCycleTime = CPL_MacToHost32(
+                    reinterpret_cast<const RFID_PACKET_INVENTORY_CYCLE_END *>(
+                        pPacket)->ms_ctr) - m_tunerCycleBegin;
+            }
+            return (m_tunerDiagsBits & HST_CMNDIAGS_CYCLE_ENABLED) != 0;
+        } // case RFID_PACKET_TYPE_INVENTORY_CYCLE_END
+        case RFID_PACKET_TYPE_INVENTORY_CYCLE_END_DIAGS:
+        {
+            if (m_dynamicQTuner.enabled && m_tunerInventory)
+            {
+                this->TuneDynamicQ(
+                    reinterpret_cast<const RFID_PACKET_INVENTORY_CYCLE_END_DIAGS *>(
+                        pPacket));
+            }
+            return m_tunerDiagsBits != 0;
+        } // case RFID_PACKET_TYPE_INVENTORY_CYCLE_END_DIAGS
+        default:
+        {
+            // Any other diagnostics are a side effect of the tuner turning on
+            // the diagnostics packets
+            return (m_tunerDiagsBits & HST_CMNDIAGS_DIAGS_ENABLED) &&
+                   (RFID_PACKET_CLASS_DIAGNOSTICS ==
+                    EXTRACT_RFID_PACKET_CLASS(packetType));
+        } // default
+    } // switch (packetType)
+} // Radio::TrackInventoryCycle
 
-        // Decrement the byte count by the number of bytes put into the register
-        byteCount -= loopCount;
+////////////////////////////////////////////////////////////////////////////////
+// Name:        TuneDynamicQ
+// Description: Updates the population estimate from one inventory cycle's
+//              diagnostics and derives the dynamic-Q parameters for the next
+//              inventory.
+////////////////////////////////////////////////////////////////////////////////
+void Radio::TuneDynamicQ(
+    const RFID_PACKET_INVENTORY_CYCLE_END_DIAGS*    pDiags
+    )
+{
+    INT32U slots = CPL_MacToHost32(pDiags->querys);
 
-        // Build up the register value
-        for ( ; loopCount; --loopCount, leftShift += BITS_PER_BYTE, ++pMask)
+    // A cycle without any slots (e.g., cancelled right away) says nothing
+    if (!slots)
+    {
+        return;
+    }
+
+    // Classify the slots.  An RN16 that was received but didn't lead to a
+    // good EPC is taken to be a collision.
+    INT32U empty     = CPL_MacToHost32(pDiags->rn16to);
+    INT32U goodReads = CPL_MacToHost32(pDiags->good_reads);
+    INT32U collided  = CPL_MacToHost32(pDiags->epcto) +
+                       CPL_MacToHost32(pDiags->crc_failures);
+
+    empty    = (empty > slots ? slots : empty);
+    collided = (collided > slots - empty ? slots - empty : collided);
+
+    // Estimate the tags that took part in the cycle: each collided slot hides
+    // 2.39 tags on average when the frame size matches the population
+    // (Schoute's estimate for framed ALOHA)
+    double observed   = goodReads + 2.39 * collided;
+    double weight     = m_dynamicQTuner.responsiveness / 100.0;
+    double previous   = m_tunerPopulation;
+    m_tunerPopulation = previous + weight * (observed - previous);
+
+    // The population is swinging if this cycle is more than twice, or less
+    // than half, of what we expected
+    bool swinging = (observed > 2 * previous + 1) || (2 * observed + 1 < previous);
+
+    // Throughput peaks when the number of slots matches the population, so
+    // start at the Q nearest log2(population)
+    INT32U startQ = 0;
+    while ((startQ < RFID_18K6C_MAX_Q) &&
+           ((1 << startQ) * 1.41421356 < m_tunerPopulation))
+    {
+        ++startQ;
+    }
+    INT32U minQ  = m_dynamicQTuner.minQValue;
+    INT32U maxQ  = m_dynamicQTuner.maxQValue;
+    INT32U tmult = m_dynamicQTuner.thresholdMultiplier;
+
+    startQ = (startQ < minQ ? minQ : (startQ > maxQ ? maxQ : startQ));
+
+    // While the population is steady, keep the MAC close to that Q.  When it
+    // is swinging, give the MAC the full range and have it react sooner.
+    if (swinging)
+    {
+        tmult = (tmult > 1 ? tmult / 2 : 1);
+    }
+    else
+    {
+        minQ = (startQ > minQ + 1 ? startQ - 1 : minQ);
+        maxQ = (startQ + 2 < maxQ ? startQ + 2 : maxQ);
+    }
+
+    if (m_tunerCycleTime)
+    {
+        double readRate = goodReads * 1000.0 / m_tunerCycleTime;
+        m_tunerReadRate = m_dynamicQStatus.cycles ?
+            m_tunerReadRate + weight * (readRate - m_tunerReadRate) : readRate;
+    }
+
+    m_dynamicQStatus.cycles++;
+    m_dynamicQStatus.populationEstimate  =
+        static_cast<INT32U>(m_tunerPopulation + 0.5);
+    m_dynamicQStatus.startQValue         = startQ;
+    m_dynamicQStatus.minQValue           = minQ;
+    m_dynamicQStatus.maxQValue           = maxQ;
+    m_dynamicQStatus.thresholdMultiplier = tmult;
+    m_dynamicQStatus.collisionRatio      = collided * 100 / slots;
+    m_dynamicQStatus.emptyRatio          = empty * 100 / slots;
+    m_dynamicQStatus.readRate            =
+        static_cast<INT32U>(m_tunerReadRate + 0.5);
+
+    RFID_TRACE(
+        Tracer::RFID_LOG_SEVERITY_DEBUG,
+        "%s: slots=%u empty=%u collided=%u good=%u population=%u Q=%u (%u-%u)\n",
+        __FUNCTION__,
+        slots,
+        empty,
+        collided,
+        goodReads,
+        m_dynamicQStatus.populationEstimate,
+        startQ,
+        minQ,
+        maxQ);
+} // Radio::TuneDynamicQ
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        PrepareAntennaScheduler
+// Description: Before an inventory, captures the antenna ports' configuration
+//              (if not already done) and writes the scheduled dwell times and
+//              inventory cycle counts that differ from what the MAC holds.
+////////////////////////////////////////////////////////////////////////////////
+void Radio::PrepareAntennaScheduler()
+{
+    m_schedulerInventory = true;
+    m_currentAntenna     = RFID_MAX_ANTENNA_PORT + 1;
+    m_cycleTags.clear();
+
+    // The MAC holds what the application configured, so remember it.  A port
+    // whose configuration changed starts over from it.
+    if (!m_scheduleCaptured)
+    {
+        bool fresh = m_scheduledAntennas.empty();
+        if (fresh)
         {
-            registerValue |= (static_cast<INT32U>(*pMask) << leftShift);
+            SCHEDULED_ANTENNA antenna;
+
+            memset(&antenna, 0, sizeof(antenna));
+            m_scheduledAntennas.resize(RFID_MAX_ANTENNA_PORT + 1, antenna);
+        }
+
+        for (INT32U port = 0; port < m_scheduledAntennas.size(); ++port)
+        {
+            SCHEDULED_ANTENNA& antenna = m_scheduledAntennas[port];
+
+            m_pMac->WriteRegister(HST_ANT_DESC_SEL, port);
+            INT32U dwellTime = m_pMac->ReadRegister(HST_ANT_DESC_DWELL);
+            INT32U cycles    = m_pMac->ReadRegister(HST_ANT_DESC_INV_CNT);
+
+            antenna.enabled =
+                HST_ANT_DESC_CFG_IS_ENABLED(m_pMac->ReadRegister(HST_ANT_DESC_CFG));
+            if (fresh                                 ||
+                (antenna.baseDwellTime != dwellTime)  ||
+                (antenna.baseInventoryCycles != cycles))
+            {
+                antenna.baseDwellTime         = dwellTime;
+                antenna.baseInventoryCycles   = cycles;
+                antenna.dwellTime             = dwellTime;
+                antenna.numberInventoryCycles = cycles;
+            }
+            antenna.writtenDwellTime       = dwellTime;
+            antenna.writtenInventoryCycles = cycles;
+        }
+
+        m_scheduleCaptured = true;
+    }
+
+    // Only pay for the ports whose airtime has changed
+    for (INT32U port = 0; port < m_scheduledAntennas.size(); ++port)
+    {
+        SCHEDULED_ANTENNA& antenna = m_scheduledAntennas[port];
+
+        if (!antenna.enabled                                       ||
+            ((antenna.dwellTime == antenna.writtenDwellTime)        &&
+             (antenna.numberInventoryCycles == antenna.writtenInventoryCycles)))
+        {
+            continue;
+        }
+
+        m_pMac->WriteRegister(HST_ANT_DESC_SEL, port);
+        if (antenna.dwellTime != antenna.writtenDwellTime)
+        {
+            m_pMac->WriteRegister(HST_ANT_DESC_DWELL, antenna.dwellTime);
+            antenna.writtenDwellTime = antenna.dwellTime;
+        }
+        if (antenna.numberInventoryCycles != antenna.writtenInventoryCycles)
+        {
+            m_pMac->WriteRegister(HST_ANT_DESC_INV_CNT,
+                antenna.numberInventoryCycles);
+            antenna.writtenInventoryCycles = antenna.numberInventoryCycles;
+        }
+    }
+} // Radio::PrepareAntennaScheduler
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        ReleaseAntennaSchedule
+// Description: Writes back the dwell times and inventory cycle counts the
+//              application configured, so that the MAC's antenna descriptors
+//              may be read or modified directly.
+////////////////////////////////////////////////////////////////////////////////
+void Radio::ReleaseAntennaSchedule()
+{
+    if (!m_scheduleCaptured)
+    {
+        return;
+    }
+
+    // Leave the descriptor selector as we found it in case the application
+    // is in the middle of configuring a port
+    INT32U selector = m_pMac->ReadRegister(HST_ANT_DESC_SEL);
+
+    for (INT32U port = 0; port < m_scheduledAntennas.size(); ++port)
+    {
+        SCHEDULED_ANTENNA& antenna = m_scheduledAntennas[port];
+
+        if ((antenna.writtenDwellTime == antenna.baseDwellTime) &&
+            (antenna.writtenInventoryCycles == antenna.baseInventoryCycles))
+        {
+            continue;
+        }
+
+        m_pMac->WriteRegister(HST_ANT_DESC_SEL, port);
+        m_pMac->WriteRegister(HST_ANT_DESC_DWELL, antenna.baseDwellTime);
+        m_pMac->WriteRegister(HST_ANT_DESC_INV_CNT, antenna.baseInventoryCycles);
+        antenna.writtenDwellTime       = antenna.baseDwellTime;
+        antenna.writtenInventoryCycles = antenna.baseInventoryCycles;
+    }
+
+    m_pMac->WriteRegister(HST_ANT_DESC_SEL, selector);
+    m_scheduleCaptured = false;
+    this->PublishSnapshot();
+} // Radio::ReleaseAntennaSchedule
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        TrackAntennaYield
+// Description: Feeds the antenna and inventory packets to the antenna
+//              scheduler.
+////////////////////////////////////////////////////////////////////////////////
+void Radio::TrackAntennaYield(
+    const RFID_PACKET_COMMON*   pPacket
+    )
+{
+    if (!m_antennaScheduler.enabled || !m_schedulerInventory)
+    {
+        return;
+    }
+
+    switch (CPL_MacToHost16(pPacket->pkt_type))
+    {
+        case RFID_PACKET_TYPE_ANTENNA_CYCLE_BEGIN:
+        {
+            // A tag is new to a port if no port has read it this cycle
+            m_cycleTags.clear();
+            break;
+        } // case RFID_PACKET_TYPE_ANTENNA_CYCLE_BEGIN
+        case RFID_PACKET_TYPE_ANTENNA_BEGIN:
+        {
+            m_currentAntenna = CPL_MacToHost32(
+                reinterpret_cast<const RFID_PACKET_ANTENNA_BEGIN *>(
+                    pPacket)->antenna);
+            if (m_currentAntenna < m_scheduledAntennas.size())
+            {
+                m_scheduledAntennas[m_currentAntenna].newTags = 0;
+            }
+            break;
+        } // case RFID_PACKET_TYPE_ANTENNA_BEGIN
+        case RFID_PACKET_TYPE_18K6C_INVENTORY:
+        {
+            if ((m_currentAntenna >= m_scheduledAntennas.size()) ||
+                RFID_18K6C_INVENTORY_CRC_IS_INVALID(pPacket->flags))
+            {
+                break;
+            }
+
+            // Identify the tag by a hash of its PC, EPC and CRC
+            const INT8U* pData = reinterpret_cast<const INT8U *>(
+                reinterpret_cast<const RFID_PACKET_18K6C_INVENTORY *>(
+                    pPacket)->inv_data);
+            INT32S length =
+                static_cast<INT32S>((CPL_MacToHost16(pPacket->pkt_len) - 3) *
+                                    BYTES_PER_REGISTER) -
+                RFID_18K6C_INVENTORY_PADDING_BYTES(pPacket->flags);
+            INT32U hash = 2166136261u;
+            while (length-- > 0)
+            {
+                hash = (hash ^ *pData++) * 16777619u;
+            }
+
+            if (m_cycleTags.insert(hash).second)
+            {
+                m_scheduledAntennas[m_currentAntenna].newTags++;
+            }
+            break;
+        } // case RFID_PACKET_TYPE_18K6C_INVENTORY
+        case RFID_PACKET_TYPE_ANTENNA_END:
+        {
+            if (m_currentAntenna >= m_scheduledAntennas.size())
+            {
+                break;
+            }
+
+            // Weigh the new tags against the airtime the port was given
+            SCHEDULED_ANTENNA& antenna = m_scheduledAntennas[m_currentAntenna];
+            INT32U airtime = antenna.baseDwellTime ?
+                antenna.writtenDwellTime : antenna.writtenInventoryCycles;
+            double weight  = m_antennaScheduler.responsiveness / 100.0;
+            double density = airtime ?
+                static_cast<double>(antenna.newTags) / airtime : 0.0;
+
+            if (antenna.visits++)
+            {
+                antenna.averageNewTags +=
+                    weight * (antenna.newTags - antenna.averageNewTags);
+                antenna.density += weight * (density - antenna.density);
+            }
+            else
+            {
+                antenna.averageNewTags = antenna.newTags;
+                antenna.density        = density;
+            }
+
+            m_currentAntenna = RFID_MAX_ANTENNA_PORT + 1;
+            break;
+        } // case RFID_PACKET_TYPE_ANTENNA_END
+        case RFID_PACKET_TYPE_ANTENNA_CYCLE_END:
+        {
+            this->ScheduleAntennas();
+            break;
+        } // case RFID_PACKET_TYPE_ANTENNA_CYCLE_END
+        default:
+        {
+            break;
+        } // default
+    } // switch (pPacket->pkt_type)
+} // Radio::TrackAntennaYield
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        ScheduleAntennas
+// Description: At the end of an antenna cycle, shares the configured airtime
+//              among the enabled ports in proportion to their new-tag yield,
+//              within the scheduler's floor and ceiling.
+////////////////////////////////////////////////////////////////////////////////
+void Radio::ScheduleAntennas()
+{
+    // The dwell times and the inventory cycle counts are shared out
+    // separately, each among the ports that have a non-zero value configured
+    const struct
+    {
+        INT32U SCHEDULED_ANTENNA::* base;
+        INT32U SCHEDULED_ANTENNA::* scheduled;
+        INT32U                      floor;
+        INT32U                      ceiling;
+    } budgets[] =
+    {
+        {
+            &SCHEDULED_ANTENNA::baseDwellTime,
+            &SCHEDULED_ANTENNA::dwellTime,
+            m_antennaScheduler.minDwellTime,
+            m_antennaScheduler.maxDwellTime
+        },
+        {
+            &SCHEDULED_ANTENNA::baseInventoryCycles,
+            &SCHEDULED_ANTENNA::numberInventoryCycles,
+            m_antennaScheduler.minInventoryCycles,
+            m_antennaScheduler.maxInventoryCycles
+        }
+    };
+
+    for (INT32U budget = 0; budget < sizeof(budgets) / sizeof(budgets[0]); ++budget)
+    {
+        double airtime     = 0;
+        double totalWeight = 0;
+
+        for (INT32U port = 0; port < m_scheduledAntennas.size(); ++port)
+        {
+            const SCHEDULED_ANTENNA& antenna = m_scheduledAntennas[port];
+
+            if (antenna.enabled && (antenna.*budgets[budget].base))
+            {
+                airtime     += antenna.*budgets[budget].base;
+                totalWeight += antenna.density;
+            }
+        }
+
+        for (INT32U port = 0; port < m_scheduledAntennas.size(); ++port)
+        {
+            SCHEDULED_ANTENNA& antenna = m_scheduledAntennas[port];
+
+            if (!antenna.enabled || !(antenna.*budgets[budget].base))
+            {
+                continue;
+            }
+
+            // With no tags anywhere, there is nothing to steer by
+            double share = (totalWeight > 0) ?
+                airtime * antenna.density / totalWeight :
+                antenna.*budgets[budget].base;
+            INT32U value = static_cast<INT32U>(share + 0.5);
+
+            value = (value < budgets[budget].floor ? budgets[budget].floor :
+                     (value > budgets[budget].ceiling ? budgets[budget].ceiling :
+                      value));
+            if (value != antenna.*budgets[budget].scheduled)
+            {
+                RFID_TRACE(
+                    Tracer::RFID_LOG_SEVERITY_DEBUG,
+                    "%s: port=%u %s %u -> %u (%.2f new tags/visit)\n",
+                    __FUNCTION__,
+                    port,
+                    budget ? "cycles" : "dwell",
+                    antenna.*budgets[budget].scheduled,
+                    value,
+                    antenna.averageNewTags);
+                antenna.*budgets[budget].scheduled = value;
+            }
         }
+    }
+} // Radio::ScheduleAntennas
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        PublishSnapshot
+// Description: Copies the host-side state into the snapshot that is served to
+//              queries made while the radio is busy.
+////////////////////////////////////////////////////////////////////////////////
+void Radio::PublishSnapshot()
+{
+    CplMutexAutoLock snapshotLock(&m_snapshotLock);
+
+    m_snapshot.accessRetryPolicy = m_accessRetryPolicy;
+    m_snapshot.dynamicQTuner     = m_dynamicQTuner;
+    m_snapshot.dynamicQStatus    = m_dynamicQStatus;
+    m_snapshot.antennaScheduler  = m_antennaScheduler;
+    m_snapshot.scheduledAntennas = m_scheduledAntennas;
+    memcpy(
+        m_snapshot.packetSubscriptions,
+        m_packetSubscriptions,
+        sizeof(m_snapshot.packetSubscriptions));
+    m_macClock.GetModel(&m_snapshot.clockModel);
+    m_snapshot.responseTimeout   = m_responseTimeout;
+} // Radio::PublishSnapshot
+
+////////////////////////////////////////////////////////////////////////////////
+// Name:        CacheAntennaPortConfiguration
+// Description: Records an antenna port's configuration in the snapshot.
+////////////////////////////////////////////////////////////////////////////////
+void Radio::CacheAntennaPortConfiguration(
+    INT32U                          antennaPort,
+    const RFID_ANTENNA_PORT_CONFIG* pConfig
+    )
+{
+    CplMutexAutoLock snapshotLock(&m_snapshotLock);
 
-        // If it is the last byte of the mask, then we are going to zero out
-        // any bits not in the mask
-        if (!byteCount && (bitCount % BITS_PER_BYTE))
-        {
-            INT32U mask = 0xFFFFFFFF;
-            mask          <<= (BITS_PER_REGISTER - (BITS_PER_BYTE - (bitCount % BITS_PER_BYTE)));
-            mask          >>= (BITS_PER_REGISTER - (leftShift - (bitCount % BITS_PER_BYTE)));
-            registerValue &=  ~mask;
-        }
+    if (antennaPort >= m_snapshot.antennaPorts.size())
+    {
+        return;
+    }
+
+    m_snapshot.antennaPorts[antennaPort].config = *pConfig;
+    m_snapshot.antennaPorts[antennaPort].valid  = true;
 
-        // Write the register
-        m_pMac->WriteRegister(registerAddress++, registerValue); // Generic Write
+    // The sense threshold is shared by all of the ports
+    CACHED_ANTENNA_PORTS::iterator port;
+    for (port = m_snapshot.antennaPorts.begin();
+         port != m_snapshot.antennaPorts.end();
+         ++port)
+    {
+        port->config.antennaSenseThreshold = pConfig->antennaSenseThreshold;
     }
-} // Radio::WriteMacMaskRegisters
+} // Radio::CacheAntennaPortConfiguration
 
-////////////////////////////////////////////////////////////////////////////
-// Name:        ReadMacMaskRegisters
-// Description: Reads the MAC mask registers (select or post-singulation).
-////////////////////////////////////////////////////////////////////////////
-void Radio::ReadMacMaskRegisters(
-    INT16U  registerAddress,
-    INT32U  bitCount,
-    INT8U*  pMask
-    )
+////////////////////////////////////////////////////////////////////////////////
+// Name:        ForgetAntennaPortConfigurations
+// Description: Drops the antenna port configurations from the snapshot.
+////////////////////////////////////////////////////////////////////////////////
+void Radio::ForgetAntennaPortConfigurations()
 {
-    // Figure out how many bytes are in the mask
-    INT32U byteCount = (bitCount + BITS_PER_BYTE - 1) / BITS_PER_BYTE;
+    CplMutexAutoLock snapshotLock(&m_snapshotLock);
 
-    // Read the mask registers and build the mask
-    while (byteCount)
+    CACHED_ANTENNA_PORTS::iterator port;
+    for (port = m_snapshot.antennaPorts.begin();
+         port != m_snapshot.antennaPorts.end();
+         ++port)
     {
-        INT32U registerValue = m_pMac->ReadRegister(registerAddress++); // Generic Read
-        INT32U rightShift     = 0;
-        INT32U loopCount     = (byteCount > BYTES_PER_REGISTER ?
-                                    BYTES_PER_REGISTER : byteCount);
+        port->valid = false;
+    }
+} // Radio::ForgetAntennaPortConfigurations
 
-        // Decrement the byte count by the number of bytes to extract from the
-        // register
-        byteCount -= loopCount;
+////////////////////////////////////////////////////////////////////////////////
+// Name:        TrackMacClock
+// Description: Feeds the MAC time of the command packets, and the host time
+//              they arrived at, to the clock model.
+////////////////////////////////////////////////////////////////////////////////
+void Radio::TrackMacClock(
+    const RFID_PACKET_COMMON*   pPacket
+    )
+{
+    INT32U macTime;
 
-        // Add the register bytes to the mask
-        for ( ; loopCount; --loopCount, rightShift += BITS_PER_BYTE, ++pMask)
+    // Only the command packets are looked at, so the host clock is read a
+    // handful of times per operation rather than once per tag
+    switch (CPL_MacToHost16(pPacket->pkt_type))
+    {
+        case RFID_PACKET_TYPE_COMMAND_BEGIN:
         {
-            *pMask = (INT8U)((registerValue >> rightShift) & 0x000000FF);
-        }
-    }
+            macTime = CPL_MacToHost32(
+                reinterpret_cast<const RFID_PACKET_COMMAND_BEGIN *>(
+                    pPacket)->ms_ctr);
+            break;
+        } // case RFID_PACKET_TYPE_COMMAND_BEGIN
+        case RFID_PACKET_TYPE_COMMAND_ACTIVE:
+        {
+            macTime = CPL_MacToHost32(
+                reinterpret_cast<const RFID_PACKET_COMMAND_ACTIVE *>(
+                    pPacket)->ms_ctr);
+            break;
+        } // case RFID_PACKET_TYPE_COMMAND_ACTIVE
+        case RFID_PACKET_TYPE_COMMAND_END:
+        {
+            macTime = CPL_MacToHost32(
+                reinterpret_cast<const RFID_PACKET_COMMAND_END *>(
+                    pPacket)->ms_ctr);
+            break;
+        } // case RFID_PACKET_TYPE_COMMAND_END
+        default:
+        {
+            return;
+        } // default
+    } // switch (CPL_MacToHost16(pPacket->pkt_type))
 
-    // If the last byte isn't complete, mask off the unneeded bits
-    if (bitCount % BITS_PER_BYTE)
+    CPL_TimeSpec now;
+    if (CPL_TimeSpecGet(&now))
     {
-        *pMask &= 0xFF << (BITS_PER_BYTE - (bitCount % BITS_PER_BYTE));
+        return;
     }
-} // Radio::ReadMacMaskRegisters
+    m_macClock.AddSample(
+        macTime,
+        static_cast<INT64U>(now.seconds) * 1000 + now.nanoseconds / 1000000);
+} // Radio::TrackMacClock
 
-////////////////////////////////////////////////////////////////////////////
-// Name:        RetrieveNextPacket
-// Description: Retrieves the next packet from the MAC.
-////////////////////////////////////////////////////////////////////////////
-void Radio::RetrieveNextPacket(
-    INT32U          &bufferSize,
-    PACKET_BUFFER   &buffer,
-    bool            canBeCancelled
+////////////////////////////////////////////////////////////////////////////////
+// Name:        ApplyPacketSubscription
+// Description: Before an 18K6C operation, turns off the HST_CMNDIAGS packets
+//              that the application enabled but neither its subscription nor
+//              the library needs, and turns back on those that are needed
+//              again.
+////////////////////////////////////////////////////////////////////////////////
+void Radio::ApplyPacketSubscription(
+    RFID_18K6C_OPERATION    operation
     )
 {
-    // Start out by only retrieving the common packet header
-    bufferSize = sizeof(hostpkt_cmn);
-    if (buffer.size() < bufferSize)
+    const RFID_PACKET_SUBSCRIPTION& subscription =
+        m_packetSubscriptions[operation];
+    const INT32U roundPackets =
+        RFID_PACKET_SUBSCRIPTION_BIT(
+            RFID_PACKET_TYPE_18K6C_INVENTORY_ROUND_BEGIN) |
+        RFID_PACKET_SUBSCRIPTION_BIT(
+            RFID_PACKET_TYPE_18K6C_INVENTORY_ROUND_END);
+    const INT32U roundDiags =
+        RFID_PACKET_SUBSCRIPTION_BIT(
+            RFID_PACKET_TYPE_18K6C_INVENTORY_ROUND_BEGIN_DIAGS) |
+        RFID_PACKET_SUBSCRIPTION_BIT(
+            RFID_PACKET_TYPE_18K6C_INVENTORY_ROUND_END_DIAGS);
+    const INT32U cyclePackets =
+        RFID_PACKET_SUBSCRIPTION_BIT(RFID_PACKET_TYPE_INVENTORY_CYCLE_BEGIN) |
+        RFID_PACKET_SUBSCRIPTION_BIT(RFID_PACKET_TYPE_INVENTORY_CYCLE_END);
+    const INT32U cycleDiags =
+        RFID_PACKET_SUBSCRIPTION_BIT(
+            RFID_PACKET_TYPE_INVENTORY_CYCLE_END_DIAGS);
+    const INT32U inventoryPackets =
+        RFID_PACKET_SUBSCRIPTION_BIT(RFID_PACKET_TYPE_18K6C_INVENTORY);
+    const INT32U inventoryDiags =
+        RFID_PACKET_SUBSCRIPTION_BIT(RFID_PACKET_TYPE_18K6C_INVENTORY_DIAGS);
+
+    // The dynamic-Q tuner and the antenna scheduler only follow inventories
+    bool libraryNeedsPackets =
+        (RFID_18K6C_OPERATION_INVENTORY == operation) &&
+        (m_dynamicQTuner.enabled || m_antennaScheduler.enabled);
+
+    // Work out which packets nobody needs.  The status and command-active
+    // packets are left alone as they report problems with the operation.
+    INT32U unsubscribed = 0;
+    if (!libraryNeedsPackets)
+    {
+        if (0 == subscription.diagnosticsPackets)
+        {
+            HST_CMNDIAGS_SET_DIAGS_ENABLED(unsubscribed);
+        }
+        if (!(subscription.commonPackets & cyclePackets) &&
+            !(subscription.diagnosticsPackets & cycleDiags))
+        {
+            HST_CMNDIAGS_SET_CYCLE_ENABLED(unsubscribed);
+        }
+        // A tag access is reported after the inventory response of the tag
+        // accessed, so only an inventory can do without them
+        if ((RFID_18K6C_OPERATION_INVENTORY == operation) &&
+            !(subscription.commonPackets & inventoryPackets) &&
+            !(subscription.diagnosticsPackets & inventoryDiags))
+        {
+            HST_CMNDIAGS_SET_INVRESP_ENABLED(unsubscribed);
+        }
+    }
+    if (!(subscription.commonPackets & roundPackets) &&
+        !(subscription.diagnosticsPackets & roundDiags))
     {
-        buffer.resize(bufferSize);
+        HST_CMNDIAGS_SET_ROUND_ENABLED(unsubscribed);
     }
 
-    // Retrieve the common packet header first
-    this->RetrieveBuffer(bufferSize, &buffer[0], canBeCancelled);
+    // Nothing to do if the last operation could do without the same packets
+    if (unsubscribed == m_unsubscribedDiagsBits)
+    {
+        return;
+    }
 
-    // Now that we have the common header, figure out how many bytes remain
-    // in the packet
-    INT32U  remainingSize =
-        RFID_PACKET_PKT_BYTE_LEN(
-            CPL_MacToHost16(
-                reinterpret_cast<RFID_PACKET_COMMON *>(&buffer[0])->pkt_len));
+    // Of the packets the application enabled (not counting those the tuner
+    // turned on), turn off those nobody needs and give back the rest
+    INT32U registerValue = m_pMac->ReadRegister(HST_CMNDIAGS);
+    INT32U suppressed    =
+        ((registerValue & ~m_tunerDiagsBits) | m_suppressedDiagsBits) &
+        unsubscribed;
+    INT32U newValue      =
+        (registerValue | m_suppressedDiagsBits) & ~suppressed;
 
-    // Increase the buffer size if necessary
-    if (buffer.size() < (bufferSize + remainingSize))
+    if (newValue != registerValue)
     {
-        buffer.resize(bufferSize + remainingSize);
+        m_pMac->WriteRegister(HST_CMNDIAGS, newValue);
     }
+    m_unsubscribedDiagsBits = unsubscribed;
+    m_suppressedDiagsBits   = suppressed;
+} // Radio::ApplyPacketSubscription
 
-    // If there is data beyond the common header, retrieve it as
-    // well
-    if (remainingSize)
+////////////////////////////////////////////////////////////////////////////////
+// Name:        IsPacketSubscribed
+// Description: Determines if a packet subscription passes a packet to the
+//              application.
+////////////////////////////////////////////////////////////////////////////////
+bool Radio::IsPacketSubscribed(
+    const RFID_PACKET_SUBSCRIPTION& subscription,
+    const RFID_PACKET_COMMON*       pPacket
+    )
+{
+    INT16U packetType = CPL_MacToHost16(pPacket->pkt_type);
+    INT32U mask;
+
+    switch (EXTRACT_RFID_PACKET_CLASS(packetType))
     {
-        this->RetrieveBuffer(
-            remainingSize,
-            &buffer[bufferSize],
-            canBeCancelled);
+        case RFID_PACKET_CLASS_COMMON:
+        {
+            mask = subscription.commonPackets;
+            break;
+        } // case RFID_PACKET_CLASS_COMMON
+        case RFID_PACKET_CLASS_DIAGNOSTICS:
+        {
+            mask = subscription.diagnosticsPackets;
+            break;
+        } // case RFID_PACKET_CLASS_DIAGNOSTICS
+        case RFID_PACKET_CLASS_STATUS:
+        {
+            mask = subscription.statusPackets;
+            break;
+        } // case RFID_PACKET_CLASS_STATUS
+        case RFID_PACKET_CLASS_RESERVED:
+        {
+            mask = subscription.reservedPackets;
+            break;
+        } // case RFID_PACKET_CLASS_RESERVED
+        case RFID_PACKET_CLASS_DEBUG:
+        {
+            mask = subscription.debugPackets;
+            break;
+        } // case RFID_PACKET_CLASS_DEBUG
+        default:
+        {
+            return true;
+        } // default
+    } // switch (EXTRACT_RFID_PACKET_CLASS(packetType))
+
+    // Packet numbers without a bit are always passed on
+    if (EXTRACT_RFID_PACKET_NUMBER(packetType) >= 32)
+    {
+        return true;
     }
 
-    // Set the total buffer size appropriately
-    bufferSize += remainingSize;
-} // Radio::RetrieveNextPacket
+    return (mask & RFID_PACKET_SUBSCRIPTION_BIT(packetType)) != 0;
+} // Radio::IsPacketSubscribed
 
-////////////////////////////////////////////////////////////////////////////
-// Name:        RetrieveBuffer
-// Description: Retrieves a buffer of the specified size from the MAC.
-////////////////////////////////////////////////////////////////////////////
-void Radio::RetrieveBuffer(
-    INT32U  bufferSize,
-    INT8U*  buffer,
-    bool    canBeCancelled
+////////////////////////////////////////////////////////////////////////////////
+// Name:        CaptureConfigurationRegisters
+// Description: Reads the host-configurable registers and records the writes
+//              that would restore them
+////////////////////////////////////////////////////////////////////////////////
+void Radio::CaptureConfigurationRegisters(
+    CONFIGURATION_REGISTERS&    registers
     )
 {
-    CPL_TimeSpec startTime;
-    CPL_TimeSpec currentTime;
-    INT32U       last_bytesAvailable;
+    CONFIGURATION_REGISTER  entry;
+    INT32U                  selector;
+    INT16U                  address;
 
-    // Keep checking until there are enough bytes to fulfill the request.  If
-    // we already know that there are enough bytes available, we aren't even
-    // going to poll the transport layer.  
-    // 
-    // Add a timeout so we don't get stuck here. This is unlikely to ever happen
-    // with USB transport, but with serial we may since there is no way to know 
-    // that the radio may be disconnected.  Only timeout if  we go for 3 seconds 
-    // and m_bytesAvailable is not changing.  So long as we are receiving bytes,
-    // then the 3 second timeout window should be reset.
-    //
-    // Timeout logic was added as of v2.4.0 and depends on the MAC Firmware providing
-    // the Command Active packet during long running command operations when there 
-    // is no other packet traffic.  For backward compatibility, we only enable the
-    // timeout checks if we are running v2.4.0 firmware or later.
-    // 
-    // snapshot current value of bytesAvailable and capture the startTime
-    last_bytesAvailable = m_bytesAvailable;
-    CPL_TimeSpecGet(&startTime);
+    registers.clear();
+    entry.reserved = 0;
 
-    while (m_bytesAvailable < bufferSize)
-    {   
+    // Each antenna descriptor the MAC has, preceded by the write of its
+    // selector.  Once done, put the selector back as it was.
+    selector = m_pMac->ReadRegister(HST_ANT_DESC_SEL);
+    for (INT32U port = 0; port <= RFID_MAX_ANTENNA_PORT; ++port)
+    {
+        m_pMac->WriteRegister(HST_ANT_DESC_SEL, port);
+        if (HOSTIF_ERR_SELECTORBNDS == m_pMac->ReadRegister(MAC_ERROR))
+        {
+            this->ClearMacError();
+            break;
+        }
 
-        // Figure out how many bytes are available to consume
-        m_bytesAvailable = this->RetrieveRawBytes(0, NULL, canBeCancelled);
+        entry.address = HST_ANT_DESC_SEL;
+        entry.value   = port;
+        registers.push_back(entry);
 
-        // if we are running against 2.4.0 firmware or later
-        if (m_preTwoFourFirmware == 0)
+        for (address = HST_ANT_DESC_CFG;
+             address <= HST_ANT_DESC_INV_CNT;
+             ++address)
         {
-            if (m_bytesAvailable != last_bytesAvailable) 
+            if (MAC_ANT_DESC_STAT == address)
             {
-                // value was updated, so reset startTime and refresh snapshot
-                last_bytesAvailable = m_bytesAvailable;
-                CPL_TimeSpecGet(&startTime);
+                continue;
             }
-            else
+
+            entry.address = address;
+            entry.value   = m_pMac->ReadRegister(address);
+
+            // While the antenna scheduler has its values in the MAC, keep
+            // those the application configured
+            if (m_scheduleCaptured && (port < m_scheduledAntennas.size()))
             {
-                // value remains unchanged, check for timeout
-                CPL_TimeSpecGet(&currentTime);
-                CPL_TimeSpecDiff(&currentTime,&startTime);
-                if (currentTime.seconds > RFID_CMD_RESPONSE_TIMEOUT)
+                if (HST_ANT_DESC_DWELL == address)
                 {
-                    throw RfidErrorException(RFID_ERROR_RADIO_NOT_RESPONDING, __FUNCTION__);
+                    entry.value = m_scheduledAntennas[port].baseDwellTime;
+                }
+                else if (HST_ANT_DESC_INV_CNT == address)
+                {
+                    entry.value = m_scheduledAntennas[port].baseInventoryCycles;
                 }
             }
-        }
-        if (m_bytesAvailable < bufferSize)
-        {
-            CPL_MillisecondSleep(MAC_SLEEP_MILLIS);
+            registers.push_back(entry);
         }
     }
+    m_pMac->WriteRegister(HST_ANT_DESC_SEL, selector);
+    entry.address = HST_ANT_DESC_SEL;
+    entry.value   = selector;
+    registers.push_back(entry);
 
-    // At this point, we know that there are enough bytes to fulfill the
-    // request
-    m_bytesAvailable = this->RetrieveRawBytes(bufferSize, buffer, canBeCancelled);
-
-} // Radio::RetrieveBuffer
+    // Each select descriptor, the same way
+    INT16U bankSize = this->GetSelectBankSize();
+    selector = m_pMac->ReadRegister(HST_TAGMSK_DESC_SEL);
+    for (INT16U index = 0; index < bankSize; ++index)
+    {
+        m_pMac->WriteRegister(HST_TAGMSK_DESC_SEL, index);
 
-////////////////////////////////////////////////////////////////////////////
-// Name:        RetrieveRawBytes
-// Description: Retrieves raw bytes from the MAC.  Also will indicate how
-//              many bytes are remaining for retrieval without blocking.
-////////////////////////////////////////////////////////////////////////////
-INT32U Radio::RetrieveRawBytes(
-    INT32U  bufferSize,
-    INT8U*  buffer,
-    bool    canBeCancelled
-    )
-{
-    assert(!bufferSize || (NULL != buffer));
+        entry.address = HST_TAGMSK_DESC_SEL;
+        entry.value   = index;
+        registers.push_back(entry);
 
-    // If allowed to do so, detect to see if a cancel or an abort should
-    // be issued to the MAC
-    if (canBeCancelled)
-    {
-        if (m_shouldCancel)
+        for (INT32U offset = 0; offset < SELECT_DESCRIPTOR_REGISTER_COUNT; ++offset)
         {
-            g_pTracer->PrintMessage(
-                Tracer::RFID_LOG_SEVERITY_INFO,
-                "%s: Radio operation has been cancelled\n",
-                __FUNCTION__);
-
-            // For a cancel, since we are to receive a command-end, issue
-            // the cancel and then we'll continue on our merry way
-            m_pMac->CancelOperation();
-            m_shouldCancel       = false;
-            m_operationCancelled = true;
+            entry.address = static_cast<INT16U>(HST_TAGMSK_DESC_CFG + offset);
+            entry.value   = m_pMac->ReadRegister(entry.address);
+            registers.push_back(entry);
         }
-        else if (m_shouldAbort)
-        {
-            g_pTracer->PrintMessage(
-                Tracer::RFID_LOG_SEVERITY_INFO,
-                "%s: Radio operation has been aborted\n",
-                __FUNCTION__);
+    }
+    m_pMac->WriteRegister(HST_TAGMSK_DESC_SEL, selector);
+    entry.address = HST_TAGMSK_DESC_SEL;
+    entry.value   = selector;
+    registers.push_back(entry);
 
-            // Since we are clearing out the pipeline, we know that there
-            // will not be any bytes immediately available for consumption
-            m_bytesAvailable = 0;
+    // The parameters of both singulation algorithms
+    selector = m_pMac->ReadRegister(HST_INV_SEL);
+    for (INT32U algorithm = RFID_18K6C_SINGULATION_ALGORITHM_FIXEDQ;
+         algorithm <= RFID_18K6C_SINGULATION_ALGORITHM_DYNAMICQ;
+         ++algorithm)
+    {
+        m_pMac->WriteRegister(HST_INV_SEL, algorithm);
 
-            // For an abort, once that is done, we want to blast out of the
-            // packet receive loop
-            m_pMac->AbortOperation();
-            throw RfidErrorException(RFID_ERROR_OPERATION_CANCELLED, __FUNCTION__);
+        entry.address = HST_INV_SEL;
+        entry.value   = algorithm;
+        registers.push_back(entry);
+
+        for (address = HST_INV_ALG_PARM_0;
+             address <= HST_INV_ALG_PARM_3;
+             ++address)
+        {
+            entry.address = address;
+            entry.value   = m_pMac->ReadRegister(address);
+            registers.push_back(entry);
         }
     }
+    m_pMac->WriteRegister(HST_INV_SEL, selector);
+    entry.address = HST_INV_SEL;
+    entry.value   = selector;
+    registers.push_back(entry);
+
+    // And the registers that aren't banked: the antenna cycle count and sense
+    // threshold, the query group and singulation algorithm, the
+    // post-singulation match mask and the Impinj extensions
+    static const INT16U plainRegisters[] =
+    {
+        HST_ANT_CYCLES,
+        HST_RFTC_ANTSENSRESTHRSH,
+        HST_QUERY_CFG,
+        HST_INV_CFG,
+        HST_INV_EPC_MATCH_CFG,
+        HST_INV_EPCDAT_0_3,
+        HST_INV_EPCDAT_4_7,
+        HST_INV_EPCDAT_8_11,
+        HST_INV_EPCDAT_12_15,
+        HST_INV_EPCDAT_16_19,
+        HST_INV_EPCDAT_20_23,
+        HST_INV_EPCDAT_24_27,
+        HST_INV_EPCDAT_28_31,
+        HST_INV_EPCDAT_32_35,
+        HST_INV_EPCDAT_36_39,
+        HST_INV_EPCDAT_40_43,
+        HST_INV_EPCDAT_44_47,
+        HST_INV_EPCDAT_48_51,
+        HST_INV_EPCDAT_52_55,
+        HST_INV_EPCDAT_56_59,
+        HST_INV_EPCDAT_60_63,
+        HST_IMPINJ_EXTENSIONS
+    };
 
-    // Now receive the bytes from the MAC
-    return m_pMac->RetrieveData(buffer, bufferSize);
-} // Radio::RetrieveRawBytes
-
+    for (INT32U index = 0;
+         index < sizeof(plainRegisters) / sizeof(plainRegisters[0]);
+         ++index)
+    {
+        entry.address = plainRegisters[index];
+        entry.value   = m_pMac->ReadRegister(entry.address);
+        registers.push_back(entry);
+    }
+} // Radio::CaptureConfigurationRegisters
 
-////////////////////////////////////////////////////////////////////////////
-// Name:        FastCrc32
-// Description: Calculates the CRC for the NV Update packets
-////////////////////////////////////////////////////////////////////////////
-INT32U Radio::FastCrc32(INT32U sum, unsigned char *p, INT32U len)
+////////////////////////////////////////////////////////////////////////////////
+// Name:        IsConfigurationRegister
+// Description: Determines if a register may appear in a saved configuration
+////////////////////////////////////////////////////////////////////////////////
+bool Radio::IsConfigurationRegister(
+    INT16U  address
+    )
 {
-    while (len--)
-      sum = crc32_table[(sum >> 24) ^ *p++] ^ (sum << 8);
-    return sum;
-}
+    return
+        ((HST_ANT_CYCLES <= address) && (HST_ANT_DESC_INV_CNT >= address) &&
+            (MAC_ANT_DESC_STAT != address))                                 ||
+        ((HST_TAGMSK_DESC_SEL <= address) && (HST_TAGMSK_28_31 >= address)) ||
+        ((HST_QUERY_CFG <= address) && (HST_INV_ALG_PARM_3 >= address))     ||
+        ((HST_INV_EPC_MATCH_CFG <= address) &&
+            (HST_INV_EPCDAT_60_63 >= address))                              ||
+        (HST_RFTC_ANTSENSRESTHRSH == address)                               ||
+        (HST_IMPINJ_EXTENSIONS == address);
+} // Radio::IsConfigurationRegister
 
 ////////////////////////////////////////////////////////////////////////////
 // Name:        PacketCallbackFunction
@@ -4589,7 +7049,7 @@ void Radio::ProcessMacPacket(
             // packet
             if (RFID_RADIO_STATE_EXPECT_COMMAND_BEGIN != pData->state)
             {
-                g_pTracer->PrintMessage(
+                RFID_TRACE(
                     Tracer::RFID_LOG_SEVERITY_ERROR,
                     "%s: Received command begin packet, but in state %u\n",
                     __FUNCTION__,
@@ -4617,7 +7077,7 @@ void Radio::ProcessMacPacket(
             // configuration read
             if (RFID_RADIO_STATE_EXPECT_OEMCFG_READ != pData->state)
             {
-                g_pTracer->PrintMessage(
+                RFID_TRACE(
                     Tracer::RFID_LOG_SEVERITY_ERROR,
                     "%s: Received OEM read packet, but in state %u\n",
                     __FUNCTION__,
@@ -4637,7 +7097,7 @@ void Radio::ProcessMacPacket(
             // bypass read register
             if (RFID_RADIO_STATE_EXPECT_MBP_READ_REG != pData->state)
             {
-                g_pTracer->PrintMessage(
+                RFID_TRACE(
                     Tracer::RFID_LOG_SEVERITY_ERROR,
                     "%s: Received radio bypass register read packet, but in "
                     "state %u\n",
@@ -4658,7 +7118,7 @@ void Radio::ProcessMacPacket(
             // read packet
             if (RFID_RADIO_STATE_EXPECT_GPIO_READ != pData->state)
             {
-                g_pTracer->PrintMessage(
+                RFID_TRACE(
                     Tracer::RFID_LOG_SEVERITY_ERROR,
                     "%s: Received GPIO read packet, but in state %u\n",
                     __FUNCTION__,
@@ -4678,7 +7138,7 @@ void Radio::ProcessMacPacket(
             // nonvolatile memory update configuration packet
             if (RFID_RADIO_STATE_EXPECT_NVMEMUPDCFG_READ != pData->state)
             {
-                g_pTracer->PrintMessage(
+                RFID_TRACE(
                     Tracer::RFID_LOG_SEVERITY_ERROR,
                     "%s: Received NVMEM update packet, but in state %u\n",
                     __FUNCTION__,
@@ -4698,7 +7158,7 @@ void Radio::ProcessMacPacket(
             // link profile register read packet
             if (RFID_RADIO_STATE_EXPECT_LINKPROFILE_READ_REG != pData->state)
             {
-                g_pTracer->PrintMessage(
+                RFID_TRACE(
                     Tracer::RFID_LOG_SEVERITY_ERROR,
                     "%s: Received link profile register read packet, but in "
                     "state %u\n",
@@ -4716,7 +7176,7 @@ void Radio::ProcessMacPacket(
         case RFID_PACKET_TYPE_DEBUG:
         {
             // allow debug packets in all states
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_INFO,
                 "%s: Received debug packet while in "
                 "state %u\n",
@@ -4726,7 +7186,7 @@ void Radio::ProcessMacPacket(
         }
         default:
         {
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_ERROR,
                 "%s: Received unexpected packet 0x%.4x\n",
                 __FUNCTION__,
@@ -4751,7 +7211,7 @@ void Radio::ProcessCommandBeginPacket(
     // Ensure that the reponse is for the command we issued
     if (command != pData->command)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             Tracer::RFID_LOG_SEVERITY_ERROR,
             "%s: Received response for command 0x%.8x, but expected 0x%.8x\n",
             __FUNCTION__,
@@ -4810,7 +7270,7 @@ void Radio::ProcessCommandBeginPacket(
         } // case CMD_WROEM, etc.
         default:
         {
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_ERROR,
                 "%s: Received unexpected command response 0x%.8x\n",
                 __FUNCTION__,
@@ -4853,7 +7313,7 @@ void Radio::ProcessOemcfgReadPacket(
     {
         if (CMD_RDOEM != pData->command)
         {
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_ERROR,
                 "%s: Received OEM read packet, but didn't issue an OEM read "
                 "request\n",
@@ -4861,7 +7321,7 @@ void Radio::ProcessOemcfgReadPacket(
         }
         else
         {
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_ERROR,
                 "%s: Received OEM read packet, but in state %u\n",
                 __FUNCTION__,
@@ -4898,7 +7358,7 @@ void Radio::ProcessMbpReadRegPacket(
     {
         if (CMD_MBPRDREG != pData->command)
         {
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_ERROR,
                 "%s: Received radio bypass register read packet, but didn't "
                 "issue a radio bypass register read request\n",
@@ -4906,7 +7366,7 @@ void Radio::ProcessMbpReadRegPacket(
         }
         else
         {
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_ERROR,
                 "%s: Received radio bypass register read packet, but in state "
                 "%u\n",
@@ -4941,7 +7401,7 @@ void Radio::ProcessGpioReadPacket(
     {
         if (CMD_RDGPIO != pData->command)
         {
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_ERROR,
                 "%s: Received GPIO read packet, but didn't issue a GPIO read "
                 "request\n",
@@ -4949,7 +7409,7 @@ void Radio::ProcessGpioReadPacket(
         }
         else
         {
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_ERROR,
                 "%s: Received GPIO read packet, but in state %u\n",
                 __FUNCTION__,
@@ -4982,7 +7442,7 @@ void Radio::ProcessNonvolatileMemoryUpdateConfigPacket(
     {
         if (CMD_NV_MEM_UPDATE != pData->command)
         {
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_ERROR,
                 "%s: Received NVMEM update packet, but didn't issue a NVMEM "
                 "update request\n",
@@ -4990,7 +7450,7 @@ void Radio::ProcessNonvolatileMemoryUpdateConfigPacket(
         }
         else
         {
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_ERROR,
                 "%s: Received NVMEM update packet, but in state %u\n",
                 __FUNCTION__,
@@ -5024,7 +7484,7 @@ void Radio::ProcessLinkProfileRegisterReadPacket(
     {
         if (CMD_LPROF_RDXCVRREG != pData->command)
         {
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_ERROR,
                 "%s: Received link profile register read packet, but didn't "
                 "issue a NVMEM update request\n",
@@ -5032,7 +7492,7 @@ void Radio::ProcessLinkProfileRegisterReadPacket(
         }
         else
         {
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_ERROR,
                 "%s: Received link profile register read packet, but in state "
                 "%u\n",
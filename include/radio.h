@@ -30,13 +30,19 @@
 
 #include <memory>
 #include <vector>
+#include <map>
+#include <set>
 #include "rfid_platform_types.h"
 #include "rfid_structs.h"
 #include "hostpkts.h"
 #include "mac.h"
+#include "mac_clock.h"
 #include "auto_handle_compat.h"
+#include "compat_atomic.h"
 #include "compat_thread.h"
 #include "compat_mutex.h"
+#include "compat_cond.h"
+#include "compat_time.h"
 
 
 namespace rfid
@@ -292,6 +298,24 @@ public:
         RFID_ANTENNA_PORT_CONFIG*   pConfig
         );
 
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        GetCachedAntennaPortConfiguration
+    // Description: Retrieves the configuration for an antenna port from the
+    //              radio's snapshot, i.e., as it was last read or set.  May be
+    //              called without the radio lock, while an operation is
+    //              running.
+    // Parameters:  antennaPort - the antenna port for which to retrieve
+    //                configuration
+    //              pConfig - a pointer to a structure which receives the
+    //                antenna-port configuration
+    // Returns:     true if the snapshot holds the port's configuration, false
+    //              if it has to be read with GetAntennaPortConfiguration
+    ////////////////////////////////////////////////////////////////////////////
+    bool GetCachedAntennaPortConfiguration(
+        INT32U                      antennaPort,
+        RFID_ANTENNA_PORT_CONFIG*   pConfig
+        );
+
     ////////////////////////////////////////////////////////////////////////////
     // Name:        Set18K6CSelectCriteria
     // Description: Sets the ISO 18000-6C tag-selection criteria.
@@ -303,6 +327,44 @@ public:
         const RFID_18K6C_SELECT_CRITERIA* pCriteria
         );
 
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        Define18K6CSelectCriteriaSet
+    // Description: Compiles a set of ISO 18000-6C tag-selection criteria into
+    //              its MAC register image and caches it under an ID so that it
+    //              can later be activated without recompiling.
+    // Parameters:  setId - the ID of the criteria set.  An existing set with
+    //              the same ID is replaced.
+    //              pCriteria - a pointer to the selection criteria
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void Define18K6CSelectCriteriaSet(
+        INT32U                              setId,
+        const RFID_18K6C_SELECT_CRITERIA*   pCriteria
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        Activate18K6CSelectCriteriaSet
+    // Description: Makes a previously-defined criteria set the radio's
+    //              ISO 18000-6C tag-selection criteria, writing only the MAC
+    //              registers whose values differ.
+    // Parameters:  setId - the ID of the criteria set
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void Activate18K6CSelectCriteriaSet(
+        INT32U  setId
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        Delete18K6CSelectCriteriaSet
+    // Description: Removes a previously-defined criteria set.  The radio's
+    //              current selection criteria are not affected.
+    // Parameters:  setId - the ID of the criteria set
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void Delete18K6CSelectCriteriaSet(
+        INT32U  setId
+        );
+
     ////////////////////////////////////////////////////////////////////////////
     // Name:        Get18K6CSelectCriteria
     // Description: Gets the ISO 18000-6C tag-selection criteria.
@@ -583,6 +645,25 @@ public:
     ////////////////////////////////////////////////////////////////////////////
     void AbortOperation();
 
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        Retire
+    // Description: Takes the radio out of service before it is closed or
+    //              reset: aborts the operation in progress, and any that is
+    //              started from now on, until the radio is reinstated.
+    // Parameters:  None.
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void Retire();
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        Reinstate
+    // Description: Puts a radio that was retired back in service, so that
+    //              operations can be started on it again.
+    // Parameters:  None.
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void Reinstate();
+
     ////////////////////////////////////////////////////////////////////////////
     // Name:        SetResponseDataMode
     // Description: Sets the response date mode (i.e., compact, etc.) for the
@@ -636,6 +717,20 @@ public:
         RFID_VERSION* pVersion
         );
 
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        GetCachedMacVersion
+    // Description: Retrieves the MAC firmware version from the radio's
+    //              snapshot.  May be called without the radio lock, while an
+    //              operation is running.
+    // Parameters:  pVersion - a pointer to a structure that upon return will
+    //              contain the MAC's version.
+    // Returns:     true if the snapshot holds the version, false if it has to
+    //              be read with GetMacVersion
+    ////////////////////////////////////////////////////////////////////////////
+    bool GetCachedMacVersion(
+        RFID_VERSION* pVersion
+        );
+
     ////////////////////////////////////////////////////////////////////////////
     // Name:        GetMacBootLoaderVersion
     // Description: Request to retrieve the version for the BootLoader image on 
@@ -856,7 +951,235 @@ public:
     void Radio::GetImpinjExtensions(
         RFID_IMPINJ_EXTENSIONS*     pExtensions);
 
+    // The ISO 18000-6C tag-access operations that the access retry policy
+    // applies to
+    typedef enum
+    {
+        ACCESS_OPERATION_READ,
+        ACCESS_OPERATION_WRITE
+    } ACCESS_OPERATION;
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        Set18K6CAccessRetryPolicy
+    // Description: Sets the policy used to reissue failed tag accesses
+    // Parameters:  pPolicy - a pointer to the access retry policy
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void Set18K6CAccessRetryPolicy(
+        const RFID_18K6C_ACCESS_RETRY_POLICY*   pPolicy
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        Get18K6CAccessRetryPolicy
+    // Description: Retrieves the policy used to reissue failed tag accesses.
+    //              May be called without the radio lock.
+    // Parameters:  pPolicy - a pointer to a structure that will receive the
+    //              access retry policy
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void Get18K6CAccessRetryPolicy(
+        RFID_18K6C_ACCESS_RETRY_POLICY*     pPolicy
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        Process18K6CAccessData
+    // Description: Processes the operation response packets for a tag access
+    //              that has already been started and, as allowed by the
+    //              access retry policy, reissues the access while its failure
+    //              is recoverable.
+    // Parameters:  handle - the radio handle that will be supplied to the
+    //              callback
+    //              operation - the type of access that was started
+    //              pParms - a pointer to the parameters the access was
+    //              started with (i.e., RFID_18K6C_READ_PARMS or
+    //              RFID_18K6C_WRITE_PARMS as indicated by operation)
+    //              flags - the flags the access was started with
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void Process18K6CAccessData(
+        RFID_RADIO_HANDLE   handle,
+        ACCESS_OPERATION    operation,
+        const void*         pParms,
+        INT32U              flags
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        SetDynamicQTuner
+    // Description: Configures the closed-loop tuning of the dynamic-Q
+    //              singulation algorithm parameters
+    // Parameters:  pParms - a pointer to the tuner configuration
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void SetDynamicQTuner(
+        const RFID_18K6C_DYNAMICQ_TUNER_PARMS*  pParms
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        GetDynamicQTuner
+    // Description: Retrieves the dynamic-Q tuner configuration and state.  May
+    //              be called without the radio lock, in which case the state
+    //              is as of the last command boundary.
+    // Parameters:  pParms - a pointer to a structure that will receive the
+    //              tuner configuration
+    //              pStatus - a pointer to a structure that will receive the
+    //              tuner state, or NULL
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void GetDynamicQTuner(
+        RFID_18K6C_DYNAMICQ_TUNER_PARMS*    pParms,
+        RFID_18K6C_DYNAMICQ_TUNER_STATUS*   pStatus
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        SetAntennaScheduler
+    // Description: Configures the yield-weighted scheduling of the antenna
+    //              ports' dwell times and inventory cycle counts
+    // Parameters:  pParms - a pointer to the scheduler configuration
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void SetAntennaScheduler(
+        const RFID_ANTENNA_SCHEDULER_PARMS* pParms
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        GetAntennaScheduler
+    // Description: Retrieves the antenna scheduler configuration.  May be
+    //              called without the radio lock.
+    // Parameters:  pParms - a pointer to a structure that will receive the
+    //              scheduler configuration
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void GetAntennaScheduler(
+        RFID_ANTENNA_SCHEDULER_PARMS*   pParms
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        GetAntennaPortYield
+    // Description: Retrieves the tag yield the antenna scheduler has measured
+    //              for an antenna port, as of the last command boundary, and
+    //              the airtime it has scheduled.  May be called without the
+    //              radio lock.
+    // Parameters:  antennaPort - the antenna port
+    //              pYield - a pointer to a structure that will receive the
+    //              yield
+    // Returns:     true if the yield was retrieved, false if the port's
+    //              configuration has to be read with
+    //              GetAntennaPortConfiguration first
+    ////////////////////////////////////////////////////////////////////////////
+    bool GetAntennaPortYield(
+        INT32U                      antennaPort,
+        RFID_ANTENNA_PORT_YIELD*    pYield
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        SetPacketSubscription
+    // Description: Sets the packet types that an ISO 18000-6C operation
+    //              passes to the application's packet callback
+    // Parameters:  operation - the tag-protocol operation
+    //              pSubscription - a pointer to the packet types wanted, or
+    //              NULL for all of them
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void SetPacketSubscription(
+        RFID_18K6C_OPERATION            operation,
+        const RFID_PACKET_SUBSCRIPTION* pSubscription
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        GetPacketSubscription
+    // Description: Retrieves the packet types that an ISO 18000-6C operation
+    //              passes to the application's packet callback.  May be
+    //              called without the radio lock.
+    // Parameters:  operation - the tag-protocol operation
+    //              pSubscription - a pointer to a structure that will receive
+    //              the packet types
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void GetPacketSubscription(
+        RFID_18K6C_OPERATION        operation,
+        RFID_PACKET_SUBSCRIPTION*   pSubscription
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        GetClockModel
+    // Description: Retrieves the model of the host time at which the MAC's
+    //              millisecond counter had a value.  May be called without the
+    //              radio lock, in which case the model is as of the last
+    //              command boundary.
+    // Parameters:  pModel - a pointer to a structure that will receive the
+    //              model
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void GetClockModel(
+        RFID_RADIO_CLOCK_MODEL* pModel
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        GetStatistics
+    // Description: Retrieves the radio's statistics, which may be used
+    //              without the radio lock
+    // Parameters:  None
+    // Returns:     The statistics
+    ////////////////////////////////////////////////////////////////////////////
+    RadioStatistics& GetStatistics()
+    {
+        return m_statistics;
+    } // GetStatistics
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        SetResponseTimeout
+    // Description: Sets how long the radio may stay silent before it is
+    //              considered to have stopped responding
+    // Parameters:  timeout - the timeout, in milliseconds
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void SetResponseTimeout(
+        INT32U  timeout
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        GetResponseTimeout
+    // Description: Retrieves how long the radio may stay silent before it is
+    //              considered to have stopped responding.  May be called
+    //              without the radio lock.
+    // Parameters:  None
+    // Returns:     The timeout, in milliseconds
+    ////////////////////////////////////////////////////////////////////////////
+    INT32U GetResponseTimeout();
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        SaveConfiguration
+    // Description: Captures the radio's host-configurable registers and link
+    //              profile in a versioned binary blob
+    // Parameters:  pBuffer - the buffer that will receive the blob.  May be
+    //              NULL if *pLength is zero.
+    //              pLength - on entry, the size of the buffer; on return, the
+    //              size of the blob (even if the buffer is too small)
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void SaveConfiguration(
+        INT8U*  pBuffer,
+        INT32U* pLength
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        RestoreConfiguration
+    // Description: Puts back a configuration captured by SaveConfiguration,
+    //              writing the registers in one pipelined sequence
+    // Parameters:  pBuffer - the blob
+    //              length - the size of the blob
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void RestoreConfiguration(
+        const INT8U*    pBuffer,
+        INT32U          length
+        );
+
 private:
+    // What has been done with the radio.  The radio rather than the Mac object
+    // holds them so that they can be used until the radio is destroyed, even
+    // after it has been closed.
+    RadioStatistics             m_statistics;
     // A pointer to the Mac object for this radio object
     std::auto_ptr<Mac>          m_pMac;
     // A flag to indicate if the radio has been previously closed
@@ -869,6 +1192,12 @@ private:
     bool                        m_shouldAbort;
     // A flag used to indicate if the operation was truly cancelled
     bool                        m_operationCancelled;
+    // A flag used to indicate that a failed access is being reissued, so a
+    // cancel or abort issued between the attempts applies to the next one
+    bool                        m_reissuingAccess;
+    // A flag used to indicate that the radio is being closed or reset, so no
+    // operation may start and one that does is aborted
+    volatile CPL_Atomic32       m_isRetired;
     // A flag used to indicate if the radio firmware is a pre-2.2 version
     bool                        m_preTwoTwoFirmware;
     // A flag used to indicate if the radio firmware is a pre-2.4 version
@@ -881,10 +1210,252 @@ private:
     CPL_Mutex                   m_cancelAbortLock;
     // A wrapper around the mutex so that it is automatically cleaned up
     CplMutexAutoHandle          m_cancelAbortLockWrapper;
+    // Signalled on a cancel or abort so that the thread waiting for the MAC
+    // notices it at once, and a wrapper so that it is automatically cleaned up
+    CPL_Cond                    m_cancelSignal;
+    CplCondAutoHandle           m_cancelSignalWrapper;
+
+    // Where a cancelable command is with respect to a cancel.  A cancel is
+    // issued to the MAC by the thread that requests it, unless the command
+    // hasn't been issued yet or is over.
+    enum
+    {
+        CANCEL_STATE_IDLE,      // no command that can be cancelled
+        CANCEL_STATE_RUNNING,   // the command can be cancelled
+        CANCEL_STATE_ISSUING,   // a cancel is being issued to the MAC
+        CANCEL_STATE_ISSUED     // the cancel has been issued
+    };
+    volatile CPL_Atomic32       m_cancelState;
+    // When the cancel was issued.  If the command-end doesn't follow in time
+    // the operation is aborted.
+    CPL_TimeSpec                m_cancelTime;
     // The number of bytes that were still waiting for retrieval on the last
     // time we retrieved bytes from the transport layer
     INT32U                      m_bytesAvailable;
 
+    // The classification of the tag accesses seen during an operation
+    typedef enum
+    {
+        ACCESS_OUTCOME_NONE,
+        ACCESS_OUTCOME_SUCCESS,
+        ACCESS_OUTCOME_RECOVERABLE,
+        ACCESS_OUTCOME_FATAL
+    } ACCESS_OUTCOME;
+
+    // The saved state of a logical antenna port that the access retry policy
+    // may modify between attempts
+    typedef struct
+    {
+        // The HST_ANT_DESC_CFG register value
+        INT32U  config;
+        // The HST_ANT_DESC_RFPOWER register value
+        INT32U  powerLevel;
+    } ACCESS_RETRY_ANTENNA;
+
+    typedef std::vector<ACCESS_RETRY_ANTENNA>  ACCESS_RETRY_ANTENNAS;
+
+    // The number of consecutive select registers, starting at
+    // HST_TAGMSK_DESC_CFG, that describe one select descriptor (i.e.,
+    // configuration, bank, pointer, length and eight mask registers)
+    enum { SELECT_DESCRIPTOR_REGISTER_COUNT = 12 };
+
+    // The register image of one select descriptor.  registers[i] is the value
+    // of register HST_TAGMSK_DESC_CFG + i and is only meaningful if bit i of
+    // validRegisters is set.
+    typedef struct
+    {
+        INT32U  registers[SELECT_DESCRIPTOR_REGISTER_COUNT];
+        INT32U  validRegisters;
+    } SELECT_DESCRIPTOR;
+
+    typedef std::vector<SELECT_DESCRIPTOR>              SELECT_CRITERIA_IMAGE;
+    typedef std::map<INT32U, SELECT_CRITERIA_IMAGE>     SELECT_CRITERIA_SETS;
+
+    // The number of select descriptors the MAC has (zero until first needed)
+    INT16U                      m_selectBankSize;
+    // What we know the MAC's select descriptors to hold.  Emptied whenever
+    // the registers may have been changed behind our back.
+    SELECT_CRITERIA_IMAGE       m_selectShadow;
+    // The compiled criteria sets defined by the application
+    SELECT_CRITERIA_SETS        m_selectCriteriaSets;
+
+    // The policy applied to failed tag reads and writes
+    RFID_18K6C_ACCESS_RETRY_POLICY  m_accessRetryPolicy;
+    // The outcome of the tag accesses seen during the last operation
+    ACCESS_OUTCOME              m_accessOutcome;
+    // The status reported in the command-end packet of the last operation
+    INT32U                      m_commandEndStatus;
+
+    // The dynamic-Q tuner configuration and the parameters/statistics it has
+    // arrived at
+    RFID_18K6C_DYNAMICQ_TUNER_PARMS     m_dynamicQTuner;
+    RFID_18K6C_DYNAMICQ_TUNER_STATUS    m_dynamicQStatus;
+    // The unrounded population and read rate estimates
+    double                      m_tunerPopulation;
+    double                      m_tunerReadRate;
+    // The millisecond counter from the last inventory-cycle-begin packet and
+    // the duration of the last inventory cycle (zero if not reported)
+    INT32U                      m_tunerCycleBegin;
+    INT32U                      m_tunerCycleTime;
+    // A flag to indicate if the current operation is an inventory, the only
+    // operation whose inventory cycles are representative of the tag
+    // population
+    bool                        m_tunerInventory;
+    // The HST_CMNDIAGS bits that the tuner, rather than the application,
+    // turned on.  Packets that only those bits produce are hidden from the
+    // application.
+    INT32U                      m_tunerDiagsBits;
+
+    // What the antenna scheduler knows about one logical antenna port
+    typedef struct
+    {
+        // Whether the port was enabled when the schedule was captured
+        bool    enabled;
+        // The dwell time and inventory cycle count the application configured
+        INT32U  baseDwellTime;
+        INT32U  baseInventoryCycles;
+        // The dwell time and inventory cycle count the scheduler has chosen
+        // and those last written to the MAC
+        INT32U  dwellTime;
+        INT32U  numberInventoryCycles;
+        INT32U  writtenDwellTime;
+        INT32U  writtenInventoryCycles;
+        // The number of completed visits to the port, the new tags read
+        // during the last (or current) visit and the smoothed new tags per
+        // visit
+        INT32U  visits;
+        INT32U  newTags;
+        double  averageNewTags;
+        // The smoothed new tags per unit of scheduled airtime (a millisecond
+        // of dwell or, for ports without a dwell time, an inventory cycle)
+        double  density;
+    } SCHEDULED_ANTENNA;
+
+    typedef std::vector<SCHEDULED_ANTENNA>  SCHEDULED_ANTENNAS;
+
+    // The antenna scheduler configuration and per-port state
+    RFID_ANTENNA_SCHEDULER_PARMS    m_antennaScheduler;
+    SCHEDULED_ANTENNAS          m_scheduledAntennas;
+    // A flag to indicate if the ports' configuration has been captured and
+    // the MAC may hold scheduled, rather than configured, values
+    bool                        m_scheduleCaptured;
+    // A flag to indicate if the current operation is an inventory
+    bool                        m_schedulerInventory;
+    // The logical antenna port being inventoried (past RFID_MAX_ANTENNA_PORT
+    // if none) and hashes of the tags read so far in this antenna cycle
+    INT32U                      m_currentAntenna;
+    std::set<INT32U>            m_cycleTags;
+
+    // The packets each 18K6C operation passes to the application and the
+    // subscription of the operation just started (NULL if none)
+    RFID_PACKET_SUBSCRIPTION    m_packetSubscriptions[RFID_18K6C_OPERATION_LAST];
+    const RFID_PACKET_SUBSCRIPTION* m_pSubscription;
+    // The HST_CMNDIAGS bits that the subscription last allowed us to turn off
+    // and, of those, the ones the application had turned on
+    INT32U                      m_unsubscribedDiagsBits;
+    INT32U                      m_suppressedDiagsBits;
+
+    // The host time at which the MAC's millisecond counter had a value
+    MacClock                    m_macClock;
+
+    // The milliseconds without any data from the MAC after which it is taken
+    // to have stopped responding
+    INT32U                      m_responseTimeout;
+
+    // A copy of the state that can be queried while an operation holds the
+    // radio.  The host-side state is published by the thread that holds the
+    // radio, when it is changed and at the end of every command; the values
+    // read from the MAC are kept from when they were last read or set.
+    typedef struct
+    {
+        bool                        valid;
+        RFID_ANTENNA_PORT_CONFIG    config;
+    } CACHED_ANTENNA_PORT;
+
+    typedef std::vector<CACHED_ANTENNA_PORT>    CACHED_ANTENNA_PORTS;
+
+    typedef struct
+    {
+        bool                                macVersionValid;
+        RFID_VERSION                        macVersion;
+        CACHED_ANTENNA_PORTS                antennaPorts;
+        RFID_18K6C_ACCESS_RETRY_POLICY      accessRetryPolicy;
+        RFID_18K6C_DYNAMICQ_TUNER_PARMS     dynamicQTuner;
+        RFID_18K6C_DYNAMICQ_TUNER_STATUS    dynamicQStatus;
+        RFID_ANTENNA_SCHEDULER_PARMS        antennaScheduler;
+        SCHEDULED_ANTENNAS                  scheduledAntennas;
+        RFID_PACKET_SUBSCRIPTION
+            packetSubscriptions[RFID_18K6C_OPERATION_LAST];
+        RFID_RADIO_CLOCK_MODEL              clockModel;
+        INT32U                              responseTimeout;
+    } RADIO_SNAPSHOT;
+
+    RADIO_SNAPSHOT              m_snapshot;
+    // The lock that protects the snapshot and a wrapper around it so that it
+    // is automatically cleaned up
+    CPL_Mutex                   m_snapshotLock;
+    CplMutexAutoHandle          m_snapshotLockWrapper;
+
+    // A saved configuration is this header followed by registerCount
+    // register writes that, in order, restore it.  Every field is in the
+    // MAC's byte order.  The CRC covers the register writes.
+    enum
+    {
+        CONFIGURATION_MAGIC     = 0x47464352,   // "RCFG"
+        CONFIGURATION_VERSION   = 1
+    };
+
+    typedef struct
+    {
+        INT32U  magic;
+        INT16U  version;
+        INT16U  registerCount;
+        INT32U  linkProfile;
+        INT32U  crc;
+    } CONFIGURATION_HEADER;
+
+    typedef struct
+    {
+        INT16U  address;
+        INT16U  reserved;
+        INT32U  value;
+    } CONFIGURATION_REGISTER;
+
+    typedef std::vector<CONFIGURATION_REGISTER> CONFIGURATION_REGISTERS;
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        PublishSnapshot
+    // Description: Copies the host-side state into the snapshot that is
+    //              served to queries made while the radio is busy.  Must be
+    //              called by the thread that holds the radio.
+    // Parameters:  None
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void PublishSnapshot();
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        CacheAntennaPortConfiguration
+    // Description: Records an antenna port's configuration, as just read from
+    //              or written to the MAC, in the snapshot
+    // Parameters:  antennaPort - the antenna port
+    //              pConfig - the port's configuration
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void CacheAntennaPortConfiguration(
+        INT32U                          antennaPort,
+        const RFID_ANTENNA_PORT_CONFIG* pConfig
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        ForgetAntennaPortConfigurations
+    // Description: Drops the antenna port configurations from the snapshot,
+    //              e.g., because the registers they came from were written
+    //              directly
+    // Parameters:  None
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void ForgetAntennaPortConfigurations();
+
     ////////////////////////////////////////////////////////////////////////////
     // Name:        Start18K6CRequest
     // Description: Performs the generic configuration setting needed for
@@ -892,11 +1463,13 @@ private:
     // Parameters:  pParms - a pointer to a structure that specifies the
     //              common parameters for the operations
     //              flags - flags that control the execution of the operation
+    //              operation - the operation being started
     // Returns:     Nothing
     ////////////////////////////////////////////////////////////////////////////
     void Start18K6CRequest(
         const RFID_18K6C_COMMON_PARMS* pParms,
-        INT32U                         flags
+        INT32U                         flags,
+        RFID_18K6C_OPERATION           operation
         );
 
     ////////////////////////////////////////////////////////////////////////////
@@ -922,6 +1495,56 @@ private:
         const INT8U*    pMask
         );
 
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        PackMacMaskRegisters
+    // Description: Packs a mask into the values of the MAC mask registers
+    //              (select or post-singulation), zeroing bits past the mask.
+    // Parameters:  bitCount - the number of bits in the mask
+    //              pMask - a pointer to an array that contains the mask
+    //              pRegisters - a pointer to an array that will receive the
+    //              register values
+    // Returns:     The number of register values stored in pRegisters
+    ////////////////////////////////////////////////////////////////////////////
+    INT32U PackMacMaskRegisters(
+        INT32U          bitCount,
+        const INT8U*    pMask,
+        INT32U*         pRegisters
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        GetSelectBankSize
+    // Description: Retrieves the number of select descriptors the MAC has,
+    //              asking the MAC only the first time.
+    // Parameters:  None
+    // Returns:     The number of select descriptors
+    ////////////////////////////////////////////////////////////////////////////
+    INT16U GetSelectBankSize();
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        CompileSelectCriteria
+    // Description: Builds the select descriptor register image for a set of
+    //              selection criteria.  Descriptors past the criteria are
+    //              disabled.
+    // Parameters:  pCriteria - a pointer to the selection criteria
+    //              image - on return contains the register image
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void CompileSelectCriteria(
+        const RFID_18K6C_SELECT_CRITERIA*   pCriteria,
+        SELECT_CRITERIA_IMAGE&              image
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        ApplySelectCriteria
+    // Description: Writes a select descriptor register image to the MAC,
+    //              skipping registers already known to hold the value.
+    // Parameters:  image - the register image
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void ApplySelectCriteria(
+        const SELECT_CRITERIA_IMAGE&    image
+        );
+
     ////////////////////////////////////////////////////////////////////////////
     // Name:        ReadMacMaskRegisters
     // Description: Reads the MAC mask registers (select or post-singulation).
@@ -988,14 +1611,197 @@ private:
         );
 
     ////////////////////////////////////////////////////////////////////////////
-    // Name:        FastCrc32
-    // Description: Calculates the CRC for the NV Update packets
-    // Parameters:  sum - the current value of sum
-    //              p   - byte pointer to the data to be summed
-    //              len - the number of bytes to sum starting from p
-    // Returns:     The updated value of sum
+    // Name:        HasCancelDrainExpired
+    // Description: Determines if a cancel has been issued to the MAC and the
+    //              command-end has not followed within the drain time, in
+    //              which case the operation should be aborted.
+    // Parameters:  None
+    // Returns:     true if the operation should be aborted
+    ////////////////////////////////////////////////////////////////////////////
+    bool HasCancelDrainExpired();
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        TrackAccessOutcome
+    // Description: Records the command status and tag-access results carried
+    //              by an operation response packet.
+    // Parameters:  pPacket - pointer to the operation response packet
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void TrackAccessOutcome(
+        const RFID_PACKET_COMMON*   pPacket
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        ClassifyTagAccess
+    // Description: Determines whether a tag-access result is a success, a
+    //              failure worth retrying or a failure that retrying won't fix.
+    // Parameters:  pPacket - pointer to the tag-access packet
+    // Returns:     The outcome of the tag access
+    ////////////////////////////////////////////////////////////////////////////
+    static ACCESS_OUTCOME ClassifyTagAccess(
+        const RFID_PACKET_18K6C_TAG_ACCESS* pPacket
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        PrepareAccessRetry
+    // Description: Clears a MAC error if the last attempt ended with one and
+    //              applies the backoff, power step and antenna switch for the
+    //              next attempt.
+    // Parameters:  retry - the retry about to be issued (1 for the first)
+    //              savedAntennas - on first use receives the original antenna
+    //              port state so that it can be restored afterward
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void PrepareAccessRetry(
+        INT32U                  retry,
+        ACCESS_RETRY_ANTENNAS&  savedAntennas
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        RestoreAccessRetryAntennas
+    // Description: Restores the antenna port state modified by
+    //              PrepareAccessRetry.
+    // Parameters:  savedAntennas - the original antenna port state.  If empty,
+    //              nothing was modified.
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void RestoreAccessRetryAntennas(
+        const ACCESS_RETRY_ANTENNAS&    savedAntennas
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        PrepareDynamicQTuner
+    // Description: Before an inventory, ensures the diagnostics the tuner
+    //              needs are enabled and writes the tuned dynamic-Q
+    //              parameters.
+    // Parameters:  None
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void PrepareDynamicQTuner();
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        TrackInventoryCycle
+    // Description: Feeds the inventory-cycle packets to the dynamic-Q tuner.
+    // Parameters:  pPacket - pointer to the operation response packet
+    // Returns:     true if the packet was only produced for the tuner and
+    //              should not be passed to the application, false otherwise
+    ////////////////////////////////////////////////////////////////////////////
+    bool TrackInventoryCycle(
+        const RFID_PACKET_COMMON*   pPacket
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        TuneDynamicQ
+    // Description: Updates the population estimate from one inventory cycle's
+    //              diagnostics and derives the dynamic-Q parameters for the
+    //              next inventory.
+    // Parameters:  pDiags - pointer to the inventory-cycle-end diagnostics
+    //              packet
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void TuneDynamicQ(
+        const RFID_PACKET_INVENTORY_CYCLE_END_DIAGS*    pDiags
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        PrepareAntennaScheduler
+    // Description: Before an inventory, captures the antenna ports'
+    //              configuration (if not already done) and writes the
+    //              scheduled dwell times and inventory cycle counts that
+    //              differ from what the MAC holds.
+    // Parameters:  None
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void PrepareAntennaScheduler();
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        ReleaseAntennaSchedule
+    // Description: Writes back the dwell times and inventory cycle counts the
+    //              application configured, so that the MAC's antenna
+    //              descriptors may be read or modified directly.
+    // Parameters:  None
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void ReleaseAntennaSchedule();
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        TrackAntennaYield
+    // Description: Feeds the antenna and inventory packets to the antenna
+    //              scheduler.
+    // Parameters:  pPacket - pointer to the operation response packet
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void TrackAntennaYield(
+        const RFID_PACKET_COMMON*   pPacket
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        ScheduleAntennas
+    // Description: At the end of an antenna cycle, shares the configured
+    //              airtime among the enabled ports in proportion to their
+    //              new-tag yield, within the scheduler's floor and ceiling.
+    // Parameters:  None
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void ScheduleAntennas();
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        TrackMacClock
+    // Description: Feeds the MAC time of the command packets, and the host
+    //              time they arrived at, to the clock model.
+    // Parameters:  pPacket - pointer to the operation response packet
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void TrackMacClock(
+        const RFID_PACKET_COMMON*   pPacket
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        ApplyPacketSubscription
+    // Description: Stops the MAC from producing the packets that neither the
+    //              operation's subscription nor the library needs, and gives
+    //              back those that are needed again.
+    // Parameters:  operation - the operation being started
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void ApplyPacketSubscription(
+        RFID_18K6C_OPERATION    operation
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        IsPacketSubscribed
+    // Description: Determines if a packet subscription passes a packet to the
+    //              application.
+    // Parameters:  subscription - the operation's packet subscription
+    //              pPacket - pointer to the operation response packet
+    // Returns:     true if the packet is to be passed on
+    ////////////////////////////////////////////////////////////////////////////
+    static bool IsPacketSubscribed(
+        const RFID_PACKET_SUBSCRIPTION& subscription,
+        const RFID_PACKET_COMMON*       pPacket
+        );
+
     ////////////////////////////////////////////////////////////////////////////
-    INT32U FastCrc32(INT32U sum, unsigned char *p, INT32U len);
+    // Name:        CaptureConfigurationRegisters
+    // Description: Reads the host-configurable registers and records the
+    //              writes, selectors included, that would restore them
+    // Parameters:  registers - receives the register writes
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void CaptureConfigurationRegisters(
+        CONFIGURATION_REGISTERS&    registers
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        IsConfigurationRegister
+    // Description: Determines if a register may appear in a saved
+    //              configuration
+    // Parameters:  address - the register address
+    // Returns:     true if the register may be restored
+    ////////////////////////////////////////////////////////////////////////////
+    static bool IsConfigurationRegister(
+        INT16U  address
+        );
 
     ////////////////////////////////////////////////////////////////////////////
     // Name:        PacketCallbackFunction
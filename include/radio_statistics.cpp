@@ -0,0 +1,368 @@
+/*
+ *****************************************************************************
+ *                                                                           *
+ *                 IMPINJ CONFIDENTIAL AND PROPRIETARY                       *
+ *                                                                           *
+ * This source code is the sole property of Impinj, Inc.  Reproduction or    *
+ * utilization of this source code in whole or in part is forbidden without  *
+ * the prior written consent of Impinj, Inc.                                 *
+ *                                                                           *
+ * (c) Copyright Impinj, Inc. 2009. All rights reserved.                     *
+ *                                                                           *
+ *****************************************************************************
+ */
+
+/*
+ *****************************************************************************
+ *
+ * $Id$
+ *
+ * Description:
+ *     This file contains the implementation for the radio statistics.
+ *
+ *
+ *****************************************************************************
+ */
+
+#include <string.h>
+#include "radio_statistics.h"
+#include "rfid_packets.h"
+
+namespace
+{
+    // The ticks per second of the statistics clock
+    const INT64U    FREQUENCY = CPL_TickFrequencyGet();
+
+    // The buckets below 8 microseconds hold one duration each, and each power
+    // of two above is split into this many
+    const INT32U    SUB_BUCKETS     = 8;
+    const INT32U    SUB_BUCKET_BITS = 3;
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: GetBucketBottom
+    //
+    // Description:
+    //   Determines the shortest duration, in microseconds, that a bucket holds
+    ////////////////////////////////////////////////////////////////////////////
+    INT64U GetBucketBottom(
+        INT32U  bucket
+        )
+    {
+        if (bucket < SUB_BUCKETS)
+        {
+            return bucket;
+        }
+        return static_cast<INT64U>(SUB_BUCKETS + bucket % SUB_BUCKETS) <<
+            (bucket / SUB_BUCKETS - 1);
+    } // GetBucketBottom
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: ReadCounter
+    //
+    // Description:
+    //   Reads a 64-bit counter in one piece, which a plain read does not do
+    //   on a 32-bit host
+    ////////////////////////////////////////////////////////////////////////////
+    INT64U ReadCounter(
+        const volatile CPL_Atomic64&    counter
+        )
+    {
+        return static_cast<INT64U>(CPL_AtomicCompareExchange64(
+            const_cast<volatile CPL_Atomic64*>(&counter), 0, 0));
+    } // ReadCounter
+}
+
+namespace rfid
+{
+
+////////////////////////////////////////////////////////////////////////////
+// Name: ToMicroseconds
+//
+// Description:
+//   Converts a number of ticks to microseconds
+////////////////////////////////////////////////////////////////////////////
+INT64U StatisticsClock::ToMicroseconds(
+    INT64U  ticks
+    )
+{
+    // Whole seconds first, so that long durations don't overflow
+    return (ticks / FREQUENCY) * 1000000 +
+        (ticks % FREQUENCY) * 1000000 / FREQUENCY;
+} // StatisticsClock::ToMicroseconds
+
+////////////////////////////////////////////////////////////////////////////
+// Name: StatisticsHistogram
+//
+// Description:
+//   Initializes an empty histogram
+////////////////////////////////////////////////////////////////////////////
+StatisticsHistogram::StatisticsHistogram()
+{
+    this->Reset();
+} // StatisticsHistogram::StatisticsHistogram
+
+////////////////////////////////////////////////////////////////////////////
+// Name: Record
+//
+// Description:
+//   Adds a duration to the histogram
+////////////////////////////////////////////////////////////////////////////
+void StatisticsHistogram::Record(
+    INT64U  ticks
+    )
+{
+    INT64U microseconds = StatisticsClock::ToMicroseconds(ticks);
+
+    CPL_AtomicIncrement32(
+        &m_buckets[StatisticsHistogram::GetBucket(microseconds)]);
+    CPL_AtomicAdd64(&m_total, static_cast<CPL_Atomic64>(microseconds));
+
+    // The maximum rarely changes, so this seldom goes round more than once
+    CPL_Atomic64 maximum = m_maximum;
+    while (static_cast<CPL_Atomic64>(microseconds) > maximum)
+    {
+        CPL_Atomic64 seen = CPL_AtomicCompareExchange64(
+            &m_maximum,
+            static_cast<CPL_Atomic64>(microseconds),
+            maximum);
+        if (seen == maximum)
+        {
+            break;
+        }
+        maximum = seen;
+    }
+} // StatisticsHistogram::Record
+
+////////////////////////////////////////////////////////////////////////////
+// Name: Get
+//
+// Description:
+//   Retrieves the histogram and its percentiles
+////////////////////////////////////////////////////////////////////////////
+void StatisticsHistogram::Get(
+    RFID_STATISTICS_HISTOGRAM*  pHistogram
+    ) const
+{
+    const INT32U PERCENTILES[] = { 500, 900, 990, 999 };
+    INT64U* pPercentiles[] =
+    {
+        &pHistogram->median,
+        &pHistogram->percentile90,
+        &pHistogram->percentile99,
+        &pHistogram->percentile999
+    };
+    INT32U bucket;
+
+    // The count is taken from the buckets copied so that the percentiles
+    // agree with them
+    pHistogram->count = 0;
+    for (bucket = 0; bucket < RFID_STATISTICS_HISTOGRAM_BUCKETS; ++bucket)
+    {
+        pHistogram->buckets[bucket] = static_cast<INT32U>(m_buckets[bucket]);
+        pHistogram->count += pHistogram->buckets[bucket];
+    }
+    pHistogram->total   = ReadCounter(m_total);
+    pHistogram->maximum = ReadCounter(m_maximum);
+
+    INT64U seen = 0;
+    bucket = 0;
+    for (INT32U index = 0;
+         index < sizeof(PERCENTILES) / sizeof(PERCENTILES[0]);
+         ++index)
+    {
+        // The rank, counting from one, of the duration at the percentile
+        INT64U rank = (pHistogram->count * PERCENTILES[index] + 999) / 1000;
+        rank = rank ? rank : 1;
+
+        while ((bucket < RFID_STATISTICS_HISTOGRAM_BUCKETS - 1) &&
+               (seen + pHistogram->buckets[bucket] < rank))
+        {
+            seen += pHistogram->buckets[bucket++];
+        }
+
+        INT64U top = StatisticsHistogram::GetBucketTop(bucket);
+        *pPercentiles[index] = pHistogram->count ?
+            ((top < pHistogram->maximum) ? top : pHistogram->maximum) : 0;
+    }
+} // StatisticsHistogram::Get
+
+////////////////////////////////////////////////////////////////////////////
+// Name: Reset
+//
+// Description:
+//   Empties the histogram
+////////////////////////////////////////////////////////////////////////////
+void StatisticsHistogram::Reset()
+{
+    for (INT32U bucket = 0; bucket < RFID_STATISTICS_HISTOGRAM_BUCKETS; ++bucket)
+    {
+        CPL_AtomicExchange32(&m_buckets[bucket], 0);
+    }
+    CPL_AtomicExchange64(&m_total, 0);
+    CPL_AtomicExchange64(&m_maximum, 0);
+} // StatisticsHistogram::Reset
+
+////////////////////////////////////////////////////////////////////////////
+// Name: GetBucket
+//
+// Description:
+//   Determines the bucket that holds a duration
+////////////////////////////////////////////////////////////////////////////
+INT32U StatisticsHistogram::GetBucket(
+    INT64U  microseconds
+    )
+{
+    if (microseconds < SUB_BUCKETS)
+    {
+        return static_cast<INT32U>(microseconds);
+    }
+
+    // The power of two the duration falls in
+    DWORD  magnitude;
+    INT32U high = static_cast<INT32U>(microseconds >> 32);
+    if (high)
+    {
+        BitScanReverse(&magnitude, high);
+        magnitude += 32;
+    }
+    else
+    {
+        BitScanReverse(&magnitude, static_cast<INT32U>(microseconds));
+    }
+
+    INT32U bucket = (magnitude - SUB_BUCKET_BITS + 1) * SUB_BUCKETS +
+        static_cast<INT32U>(
+            (microseconds >> (magnitude - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+
+    return (bucket < RFID_STATISTICS_HISTOGRAM_BUCKETS) ?
+        bucket : RFID_STATISTICS_HISTOGRAM_BUCKETS - 1;
+} // StatisticsHistogram::GetBucket
+
+////////////////////////////////////////////////////////////////////////////
+// Name: GetBucketTop
+//
+// Description:
+//   Determines the longest duration that a bucket holds
+////////////////////////////////////////////////////////////////////////////
+INT64U StatisticsHistogram::GetBucketTop(
+    INT32U  bucket
+    )
+{
+    return GetBucketBottom(bucket + 1) - 1;
+} // StatisticsHistogram::GetBucketTop
+
+////////////////////////////////////////////////////////////////////////////
+// Name: RadioStatistics
+//
+// Description:
+//   Initializes statistics that have counted nothing
+////////////////////////////////////////////////////////////////////////////
+RadioStatistics::RadioStatistics()
+{
+    this->Reset();
+} // RadioStatistics::RadioStatistics
+
+////////////////////////////////////////////////////////////////////////////
+// Name: CountPacket
+//
+// Description:
+//   Counts an operation response packet
+////////////////////////////////////////////////////////////////////////////
+void RadioStatistics::CountPacket(
+    INT16U  packetType
+    )
+{
+    INT32U packetClass  = EXTRACT_RFID_PACKET_CLASS(packetType);
+    INT32U packetNumber = EXTRACT_RFID_PACKET_NUMBER(packetType);
+
+    CPL_AtomicIncrement64(&m_packets);
+    if (packetClass < RFID_STATISTICS_PACKET_CLASSES)
+    {
+        packetNumber = (packetNumber < RFID_STATISTICS_PACKET_NUMBERS) ?
+            packetNumber : RFID_STATISTICS_PACKET_NUMBERS - 1;
+        CPL_AtomicIncrement32(&m_packetsByType[packetClass][packetNumber]);
+    }
+} // RadioStatistics::CountPacket
+
+////////////////////////////////////////////////////////////////////////////
+// Name: Get
+//
+// Description:
+//   Retrieves the statistics, except for the library lock wait
+////////////////////////////////////////////////////////////////////////////
+void RadioStatistics::Get(
+    RFID_RADIO_STATISTICS*  pStatistics
+    ) const
+{
+    pStatistics->registerReads    =
+        ReadCounter(m_counters[COUNTER_REGISTER_READS]);
+    pStatistics->registerWrites   =
+        ReadCounter(m_counters[COUNTER_REGISTER_WRITES]);
+    pStatistics->transportReads   =
+        ReadCounter(m_counters[COUNTER_TRANSPORT_READS]);
+    pStatistics->bytesReceived    =
+        ReadCounter(m_counters[COUNTER_BYTES_RECEIVED]);
+    pStatistics->callbacks        =
+        ReadCounter(m_counters[COUNTER_CALLBACKS]);
+    pStatistics->cancels          =
+        ReadCounter(m_counters[COUNTER_CANCELS]);
+    pStatistics->aborts           =
+        ReadCounter(m_counters[COUNTER_ABORTS]);
+    pStatistics->responseTimeouts =
+        ReadCounter(m_counters[COUNTER_RESPONSE_TIMEOUTS]);
+    pStatistics->cancelTimeouts   =
+        ReadCounter(m_counters[COUNTER_CANCEL_TIMEOUTS]);
+
+    pStatistics->packets = ReadCounter(m_packets);
+    for (INT32U packetClass = 0;
+         packetClass < RFID_STATISTICS_PACKET_CLASSES;
+         ++packetClass)
+    {
+        for (INT32U packetNumber = 0;
+             packetNumber < RFID_STATISTICS_PACKET_NUMBERS;
+             ++packetNumber)
+        {
+            pStatistics->packetsByType[packetClass][packetNumber] =
+                static_cast<INT32U>(
+                    m_packetsByType[packetClass][packetNumber]);
+        }
+    }
+
+    m_registerRoundTrip.Get(&pStatistics->registerRoundTrip);
+    m_packetInterarrival.Get(&pStatistics->packetInterarrival);
+    m_callbackDuration.Get(&pStatistics->callbackDuration);
+    m_radioLockWait.Get(&pStatistics->radioLockWait);
+} // RadioStatistics::Get
+
+////////////////////////////////////////////////////////////////////////////
+// Name: Reset
+//
+// Description:
+//   Sets every counter to zero and empties every histogram
+////////////////////////////////////////////////////////////////////////////
+void RadioStatistics::Reset()
+{
+    for (INT32U counter = 0; counter < COUNTER_LAST; ++counter)
+    {
+        CPL_AtomicExchange64(&m_counters[counter], 0);
+    }
+    CPL_AtomicExchange64(&m_packets, 0);
+    for (INT32U packetClass = 0;
+         packetClass < RFID_STATISTICS_PACKET_CLASSES;
+         ++packetClass)
+    {
+        for (INT32U packetNumber = 0;
+             packetNumber < RFID_STATISTICS_PACKET_NUMBERS;
+             ++packetNumber)
+        {
+            CPL_AtomicExchange32(&m_packetsByType[packetClass][packetNumber], 0);
+        }
+    }
+
+    m_registerRoundTrip.Reset();
+    m_packetInterarrival.Reset();
+    m_callbackDuration.Reset();
+    m_radioLockWait.Reset();
+} // RadioStatistics::Reset
+
+} // namespace rfid
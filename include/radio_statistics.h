@@ -0,0 +1,362 @@
+/*
+ *****************************************************************************
+ *                                                                           *
+ *                 IMPINJ CONFIDENTIAL AND PROPRIETARY                       *
+ *                                                                           *
+ * This source code is the sole property of Impinj, Inc.  Reproduction or    *
+ * utilization of this source code in whole or in part is forbidden without  *
+ * the prior written consent of Impinj, Inc.                                 *
+ *                                                                           *
+ * (c) Copyright Impinj, Inc. 2009. All rights reserved.                     *
+ *                                                                           *
+ *****************************************************************************
+ */
+
+/*
+ *****************************************************************************
+ *
+ * $Id$
+ *
+ * Description:
+ *     This header presents the interface for the classes that count what the
+ *     library does with a radio and measure how long it takes.  They are
+ *     always on, so every update is a single interlocked instruction and no
+ *     lock is taken.
+ *
+ *
+ *****************************************************************************
+ */
+
+#ifndef RADIO_STATISTICS_H_INCLUDED
+#define RADIO_STATISTICS_H_INCLUDED
+
+#include "rfid_platform_types.h"
+#include "rfid_structs.h"
+#include "compat_atomic.h"
+#include "compat_time.h"
+
+namespace rfid
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: StatisticsHistogram
+//
+// Description: A histogram of durations with logarithmic buckets, each power
+//   of two split into eight (see RFID_STATISTICS_HISTOGRAM), so that it has a
+//   fixed size and a duration is recorded without searching.
+////////////////////////////////////////////////////////////////////////////////
+class StatisticsHistogram
+{
+public:
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: StatisticsHistogram
+    //
+    // Description:
+    //   Initializes an empty histogram
+    //
+    // Parameters:
+    //   None
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    StatisticsHistogram();
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: Record
+    //
+    // Description:
+    //   Adds a duration to the histogram
+    //
+    // Parameters:
+    //   ticks - the duration, in StatisticsClock ticks
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void Record(
+        INT64U  ticks
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: Get
+    //
+    // Description:
+    //   Retrieves the histogram and its percentiles.  Durations recorded while
+    //   it is retrieved may or may not be included.
+    //
+    // Parameters:
+    //   pHistogram - the structure to fill in
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void Get(
+        RFID_STATISTICS_HISTOGRAM*  pHistogram
+        ) const;
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: Reset
+    //
+    // Description:
+    //   Empties the histogram
+    //
+    // Parameters:
+    //   None
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void Reset();
+
+private:
+    volatile CPL_Atomic32   m_buckets[RFID_STATISTICS_HISTOGRAM_BUCKETS];
+    volatile CPL_Atomic64   m_total;
+    volatile CPL_Atomic64   m_maximum;
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: GetBucket
+    //
+    // Description:
+    //   Determines the bucket that holds a duration
+    //
+    // Parameters:
+    //   microseconds - the duration
+    //
+    // Returns:
+    //   The bucket's index
+    ////////////////////////////////////////////////////////////////////////////
+    static INT32U GetBucket(
+        INT64U  microseconds
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: GetBucketTop
+    //
+    // Description:
+    //   Determines the longest duration that a bucket holds
+    //
+    // Parameters:
+    //   bucket - the bucket's index
+    //
+    // Returns:
+    //   The duration, in microseconds
+    ////////////////////////////////////////////////////////////////////////////
+    static INT64U GetBucketTop(
+        INT32U  bucket
+        );
+
+    // Prevent copying of histograms
+    StatisticsHistogram(const StatisticsHistogram&);
+    const StatisticsHistogram& operator = (const StatisticsHistogram&);
+}; // class StatisticsHistogram
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: StatisticsClock
+//
+// Description: The clock that durations are measured with, the performance
+//   counter, which is cheap enough to read around every packet and callback.
+////////////////////////////////////////////////////////////////////////////////
+namespace StatisticsClock
+{
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: Now
+    //
+    // Description:
+    //   Reads the clock
+    //
+    // Parameters:
+    //   None
+    //
+    // Returns:
+    //   The current time, in ticks
+    ////////////////////////////////////////////////////////////////////////////
+    inline INT64U Now()
+    {
+        return CPL_TickCountGet();
+    } // Now
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: ToMicroseconds
+    //
+    // Description:
+    //   Converts a number of ticks to microseconds
+    //
+    // Parameters:
+    //   ticks - the number of ticks
+    //
+    // Returns:
+    //   The number of microseconds
+    ////////////////////////////////////////////////////////////////////////////
+    INT64U ToMicroseconds(
+        INT64U  ticks
+        );
+} // namespace StatisticsClock
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: RadioStatistics
+//
+// Description: The counters and histograms of one radio.  The thread running
+//   an operation, the threads cancelling it and the threads asking for the
+//   statistics all use them at once.
+////////////////////////////////////////////////////////////////////////////////
+class RadioStatistics
+{
+public:
+    enum COUNTER
+    {
+        COUNTER_REGISTER_READS,
+        COUNTER_REGISTER_WRITES,
+        COUNTER_TRANSPORT_READS,
+        COUNTER_BYTES_RECEIVED,
+        COUNTER_CALLBACKS,
+        COUNTER_CANCELS,
+        COUNTER_ABORTS,
+        COUNTER_RESPONSE_TIMEOUTS,
+        COUNTER_CANCEL_TIMEOUTS,
+        COUNTER_LAST
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: RadioStatistics
+    //
+    // Description:
+    //   Initializes statistics that have counted nothing
+    //
+    // Parameters:
+    //   None
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    RadioStatistics();
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: Count
+    //
+    // Description:
+    //   Adds to a counter
+    //
+    // Parameters:
+    //   counter - the counter to add to
+    //   amount - the amount to add
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void Count(
+        COUNTER counter,
+        INT64U  amount = 1
+        )
+    {
+        CPL_AtomicAdd64(
+            &m_counters[counter],
+            static_cast<CPL_Atomic64>(amount));
+    } // Count
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: CountPacket
+    //
+    // Description:
+    //   Counts an operation response packet
+    //
+    // Parameters:
+    //   packetType - the packet's type, in host byte order
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void CountPacket(
+        INT16U  packetType
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: RecordRegisterRoundTrip, RecordPacketInterarrival,
+    //       RecordCallbackDuration, RecordRadioLockWait
+    //
+    // Description:
+    //   Add a duration to a histogram
+    //
+    // Parameters:
+    //   ticks - the duration, in StatisticsClock ticks
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void RecordRegisterRoundTrip(
+        INT64U  ticks
+        )
+    {
+        m_registerRoundTrip.Record(ticks);
+    } // RecordRegisterRoundTrip
+
+    void RecordPacketInterarrival(
+        INT64U  ticks
+        )
+    {
+        m_packetInterarrival.Record(ticks);
+    } // RecordPacketInterarrival
+
+    void RecordCallbackDuration(
+        INT64U  ticks
+        )
+    {
+        m_callbackDuration.Record(ticks);
+    } // RecordCallbackDuration
+
+    void RecordRadioLockWait(
+        INT64U  ticks
+        )
+    {
+        m_radioLockWait.Record(ticks);
+    } // RecordRadioLockWait
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: Get
+    //
+    // Description:
+    //   Retrieves the statistics.  The library lock wait belongs to the library
+    //   rather than the radio and is left for the caller to fill in.
+    //
+    // Parameters:
+    //   pStatistics - the structure to fill in
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void Get(
+        RFID_RADIO_STATISTICS*  pStatistics
+        ) const;
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: Reset
+    //
+    // Description:
+    //   Sets every counter to zero and empties every histogram
+    //
+    // Parameters:
+    //   None
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void Reset();
+
+private:
+    volatile CPL_Atomic64   m_counters[COUNTER_LAST];
+    volatile CPL_Atomic64   m_packets;
+    volatile CPL_Atomic32   m_packetsByType[RFID_STATISTICS_PACKET_CLASSES]
+                                           [RFID_STATISTICS_PACKET_NUMBERS];
+    StatisticsHistogram     m_registerRoundTrip;
+    StatisticsHistogram     m_packetInterarrival;
+    StatisticsHistogram     m_callbackDuration;
+    StatisticsHistogram     m_radioLockWait;
+
+    // Prevent copying of statistics
+    RadioStatistics(const RadioStatistics&);
+    const RadioStatistics& operator = (const RadioStatistics&);
+}; // class RadioStatistics
+
+} // namespace rfid
+
+#endif // RADIO_STATISTICS_H_INCLUDED
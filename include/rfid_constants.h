@@ -440,6 +440,14 @@ enum {
     RFID_FLAG_NVMEM_UPDATE_TEST = 0x00000001
 };
 
+/******************************************************************************
+ * Flags for the RFID_Startup function
+ ******************************************************************************/
+enum {
+    RFID_FLAG_SYNTHETIC_RADIOS  = 0x00000001,
+    RFID_FLAG_CAPTURE_PACKETS   = 0x00000002
+};
+
 
 /******************************************************************************
  * Name:  RFID_BLOCKWRITE_WORDS - The max words per BlockWrite transaction
@@ -470,6 +478,23 @@ enum {
 };
 typedef INT32U   RFID_FAST_ID;
 
+/******************************************************************************
+ * Name: RFID_18K6C_OPERATION - The ISO 18000-6C tag-protocol operations
+ ******************************************************************************/
+enum {
+    RFID_18K6C_OPERATION_INVENTORY,
+    RFID_18K6C_OPERATION_READ,
+    RFID_18K6C_OPERATION_WRITE,
+    RFID_18K6C_OPERATION_KILL,
+    RFID_18K6C_OPERATION_LOCK,
+    RFID_18K6C_OPERATION_BLOCK_WRITE,
+    RFID_18K6C_OPERATION_QT,
+    RFID_18K6C_OPERATION_BLOCK_ERASE,
+    /* A marker to indicate the end of the list.                              */
+    RFID_18K6C_OPERATION_LAST
+};
+typedef INT32U   RFID_18K6C_OPERATION;
+
 #ifdef __cplusplus
 }
 #endif
@@ -59,7 +59,7 @@ public:
         /* if the tracer pointer has been setup, then go ahead and log the exception */
         if (g_pTracer.get() != 0)
         {
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_INFO,
                 "######## Exception %ld was thrown\n",
                 GetError()
@@ -87,7 +87,7 @@ public:
         /* if the tracer pointer has been setup, then go ahead and log the exception */
         if (g_pTracer.get() != 0)
         {
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 Tracer::RFID_LOG_SEVERITY_INFO,
                 "######## Exception %ld thrown by %s\n",
                 GetError(),
@@ -32,6 +32,11 @@
 #include "rfid_platform_types.h"
 #include "tracer.h"
 
+namespace rfid
+{
+    class PacketCapture;
+}
+
 // Global constants
 const INT32U RFID_MAX_ANTENNA_PORT                   = 15;
 const INT32U RFID_MAX_ANTENNA_PORT_PHYSICAL          = 3;
@@ -50,6 +55,17 @@ const INT32U RFID_18K6C_MAX_WRITE_RETRY              = 7;
 const INT32U RFID_18K6C_MAX_BLOCK_WRITE_COUNT        = 255;
 const INT32U RFID_18K6C_MAX_BLOCK_ERASE_COUNT        = 255;
 const INT32U RFID_18K6C_MAX_BLOCK_WRITE_RETRY        = 7;
+const INT32U RFID_18K6C_MAX_ACCESS_ATTEMPTS          = 16;
+const INT32U RFID_18K6C_MAX_ACCESS_BACKOFF           = 1000;
+const INT32U RFID_18K6C_MAX_ACCESS_POWER_STEP        = 100;
+const INT32U RFID_18K6C_MAX_ACCESS_POWER_LEVEL       = 330;
+const INT32U RFID_18K6C_MAX_SELECT_CRITERIA_SETS     = 64;
+const INT32U RFID_18K6C_MAX_TUNER_RESPONSIVENESS     = 100;
+const INT32U RFID_MAX_SCHEDULER_RESPONSIVENESS       = 100;
+// The MAC sends a command-active packet after 3 seconds (CMD_ACTIVE_TIMEOUT)
+// of silence, so a shorter response timeout would fail healthy operations
+const INT32U RFID_MIN_RESPONSE_TIMEOUT               = 3500;
+const INT32U RFID_MAX_RESPONSE_TIMEOUT               = 60000;
 
 const INT32U RFID_WIDEBAND_RSSI_BASE_SAMPLES         = 32;
 const INT32U RFID_NARROWBAND_RSSI_BASE_SAMPLES       = 8;
@@ -57,4 +73,31 @@ const INT32U RFID_NARROWBAND_RSSI_BASE_SAMPLES       = 8;
 // The tracer object that is used by all parts of library
 extern std::auto_ptr<rfid::Tracer> g_pTracer;
 
+// The capture of the packets the radios send, if the application asked for one
+extern std::auto_ptr<rfid::PacketCapture> g_pPacketCapture;
+
+// The least severe message that is compiled in.  Release builds leave out the
+// DEBUG, INFO and TRACE messages; define RFID_TRACE_MIN_SEVERITY to a severity
+// value (e.g., 0 for DEBUG) to keep them.
+#ifndef RFID_TRACE_MIN_SEVERITY
+#ifdef NDEBUG
+#define RFID_TRACE_MIN_SEVERITY rfid::Tracer::RFID_LOG_SEVERITY_WARNING
+#else
+#define RFID_TRACE_MIN_SEVERITY rfid::Tracer::RFID_LOG_SEVERITY_DEBUG
+#endif
+#endif
+
+// Logs a message with the library's tracer.  The severity must be a constant,
+// so that a message below RFID_TRACE_MIN_SEVERITY compiles to nothing, and the
+// arguments of a message below the tracer's threshold are not evaluated.
+#define RFID_TRACE(severity, ...)                                           \
+    do                                                                      \
+    {                                                                       \
+        if (((severity) >= (RFID_TRACE_MIN_SEVERITY)) &&                    \
+            g_pTracer->IsLogged(severity))                                  \
+        {                                                                   \
+            g_pTracer->PrintMessage((severity), __VA_ARGS__);               \
+        }                                                                   \
+    } while (0)
+
 #endif // #ifndef RFID_EXTERN_H_INCLUDED
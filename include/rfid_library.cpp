@@ -35,19 +35,25 @@
 #include <utility>
 #include "rfid_library.h"
 #include "rfid_exceptions.h"
+#include "compat_cond.h"
 #include "compat_fildes.h"
 #include "compat_mutex.h"
+#include "compat_time.h"
 #include "compat_handles.h"
 #include "compat_error.h"
 #include "auto_handle_compat.h"
 #include "auto_lock_compat.h"
+#include "compat_atomic.h"
 #include "mac_transport_live.h"
+#include "mac_transport_synthetic.h"
 #include "object_table.h"
+#include "packet_capture.h"
 #include "radio.h"
 #include "rfid_extern.h"
 #include "rfid_version.h"
 #include "tracer_null.h"
 #include "tracer_file.h"
+#include "tracer_binary.h"
 #include "tracer_console.h"
 
 
@@ -76,14 +82,19 @@ public:
     //              pRadioLock - an auto_ptr wrapped lock object.  This implies
     //                that the once the constructor returns that the wrapper
     //                is responsible for the lock object's destruction.
+    //              pQueriesDone - an auto_ptr wrapped condition variable
+    //                object, which the wrapper is likewise responsible for
     // Returns:     Nothing
     ////////////////////////////////////////////////////////////////////////////
     RadioWrapper(
         std::auto_ptr<rfid::Radio>  pRadio,
-        std::auto_ptr<CPL_Mutex>    pRadioLock
+        std::auto_ptr<CPL_Mutex>    pRadioLock,
+        std::auto_ptr<CPL_Cond>     pQueriesDone
         ) :
         m_pRadio(pRadio),
-        m_pRadioLock(pRadioLock)
+        m_pRadioLock(pRadioLock),
+        m_pQueriesDone(pQueriesDone),
+        m_queries(0)
     {
     } // RadioWrapper
 
@@ -95,7 +106,9 @@ public:
     ////////////////////////////////////////////////////////////////////////////
     ~RadioWrapper()
     {
-        // Just need to ensure that we clean up the lock
+        // Just need to ensure that we clean up the lock and the condition
+        // variable
+        CPL_CondDestroy(m_pQueriesDone.get());
         CPL_MutexDestroy(m_pRadioLock.get());
     } // ~RadioWrapper
 
@@ -121,9 +134,72 @@ public:
         return m_pRadioLock.get();
     } // GetRadioLockHandle
 
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        BeginQuery
+    // Description: Counts a query that is waiting for, or holds, the radio
+    //              lock.  Operations give way to the queries that are counted.
+    // Parameters:  None
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    inline void BeginQuery()
+    {
+        CPL_AtomicIncrement32(&m_queries);
+    } // BeginQuery
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        EndQuery
+    // Description: Stops counting a query, and wakes an operation that is
+    //              giving way to the queries if it was the last one
+    // Parameters:  None
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    inline void EndQuery()
+    {
+        if (!CPL_AtomicDecrement32(&m_queries))
+        {
+            CPL_CondSignal(m_pQueriesDone.get());
+        }
+    } // EndQuery
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        WaitForQueries
+    // Description: Waits for the last query that is counted to end, or for
+    //              an interval to pass.  The wait may also end early, so the
+    //              caller checks HasQueries again.
+    // Parameters:  interval - the longest time to wait
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    inline void WaitForQueries(
+        const CPL_TimeSpec& interval
+        )
+    {
+        CPL_CondRelTimedWait(m_pQueriesDone.get(), &interval);
+
+        // The signal wakes only one waiter, so pass it on to the next
+        // operation that is giving way, if any
+        if (!this->HasQueries())
+        {
+            CPL_CondSignal(m_pQueriesDone.get());
+        }
+    } // WaitForQueries
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        HasQueries
+    // Description: Indicates if any queries are waiting for, or hold, the
+    //              radio lock
+    // Parameters:  None
+    // Returns:     true if there are queries
+    ////////////////////////////////////////////////////////////////////////////
+    inline bool HasQueries() const
+    {
+        return 0 != m_queries;
+    } // HasQueries
+
 private:
     const std::auto_ptr<rfid::Radio>    m_pRadio;
     const std::auto_ptr<CPL_Mutex>      m_pRadioLock;
+    const std::auto_ptr<CPL_Cond>       m_pQueriesDone;
+    volatile CPL_Atomic32               m_queries;
 
     // Prevent copying of the wrapper
     RadioWrapper(const RadioWrapper&);
@@ -149,8 +225,9 @@ namespace
 // A lock that is used to protect the library from being entered simultaneously
 // by multiple threads.
 std::auto_ptr<CPL_Mutex>        g_libraryLockHandle;
-// A flag to indicate if the library has been successfully initialized
-bool                            g_libraryIsInitialized      = false;
+// A flag to indicate if the library has been successfully initialized.  It is
+// read without the library lock by the functions that operate on a radio.
+volatile bool                   g_libraryIsInitialized      = false;
 // A flag to indicate if the initialization is the very first one
 bool                            g_firstInitialization       = true;
 // A table that will be used for holding active radio objects
@@ -164,11 +241,27 @@ RadioOpenFunction               g_radioOpenFunction         = NULL;
 
 // File name if we are logging to a file
 const std::string               LOG_FILE_NAME("rfid_library.log");
+
+// File name if we are logging to a binary trace file
+const std::string               LOG_BINARY_FILE_NAME("rfid_library.rtrc");
+
+// File name if we are capturing packets
+const std::string               CAPTURE_FILE_NAME("rfid_library.rcap");
+
+// How long, in milliseconds, an operation gives way to queries, so that a
+// steady stream of them doesn't hold it off for good
+const INT32U                    QUERY_GIVE_WAY_MILLIS       = 5000;
+
+// How long calls have waited for the library lock
+rfid::StatisticsHistogram       g_libraryLockWait;
 } // namespace
 
 // The tracer object for library logging
 std::auto_ptr<rfid::Tracer>     g_pTracer;
 
+// The packet capture, if the application asked for one
+std::auto_ptr<rfid::PacketCapture>  g_pPacketCapture;
+
 // Embedded static strings that can be dumped
 const char*                     COPYRIGHT   = VER_LEGALCOPYRIGHT_STR;
 const char*                     VERSION     = VER_PRODUCTVERSION_STR;
@@ -186,6 +279,8 @@ enum {
     // Private bits for the library startup flag
     RFID_FLAG_LOG_FILE          = 0x80000000,   // Flag for logging to file
     RFID_FLAG_LOG_CONS          = 0x40000000,   // Flag for logging to console
+    RFID_FLAG_LOG_BINARY        = 0x20000000,   // Flag for logging to a binary
+                                                // trace file
     RFID_FLAG_LOG_LEVEL_MASK    = 0x0F000000,   // Flag bits for logging level
     RFID_FLAG_LOG_LEVEL_SHIFT   = 24            // Number of bits to shift to
                                                 // get bits into low-order bits
@@ -197,6 +292,124 @@ enum {
 
 namespace
 {
+////////////////////////////////////////////////////////////////////////////////
+// Name: RadioReference
+//
+// Description: This class holds a reference, taken by AcquireRadio, to an
+//   entry in the active radio table and releases it when it goes out of
+//   scope.  While the reference is held, the radio object cannot be deleted.
+////////////////////////////////////////////////////////////////////////////////
+class RadioReference
+{
+public:
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        RadioReference
+    // Description: Initializes an object that holds no reference
+    // Parameters:  None
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    RadioReference() :
+        m_handle(RFID_INVALID_RADIO_HANDLE),
+        m_isHeld(false)
+    {
+    } // RadioReference
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        ~RadioReference
+    // Description: Releases the reference, if one is held
+    // Parameters:  None
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    ~RadioReference()
+    {
+        if (m_isHeld)
+        {
+            g_pActiveRadios->Release(m_handle);
+        }
+    } // ~RadioReference
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        Assume
+    // Description: Takes ownership of a reference that has been acquired
+    // Parameters:  handle - the handle the reference was acquired with
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void Assume(
+        RFID_RADIO_HANDLE   handle
+        )
+    {
+        m_handle = handle;
+        m_isHeld = true;
+    } // Assume
+
+private:
+    RFID_RADIO_HANDLE   m_handle;
+    bool                m_isHeld;
+
+    // Prevent copying of the reference
+    RadioReference(const RadioReference&);
+    const RadioReference& operator = (const RadioReference&);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: RadioQuery
+//
+// Description: This class counts a query, started by RetrieveAndLockRadioForQuery,
+//   against the radio and stops counting it when it goes out of scope.
+//   Operations do not take the radio lock while queries are counted, so the
+//   queries made while an operation holds the radio are served between that
+//   operation and the next.
+////////////////////////////////////////////////////////////////////////////////
+class RadioQuery
+{
+public:
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        RadioQuery
+    // Description: Initializes an object that counts no query
+    // Parameters:  None
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    RadioQuery() :
+        m_pRadioWrapper(NULL)
+    {
+    } // RadioQuery
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        ~RadioQuery
+    // Description: Stops counting the query, if one is counted
+    // Parameters:  None
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    ~RadioQuery()
+    {
+        if (NULL != m_pRadioWrapper)
+        {
+            m_pRadioWrapper->EndQuery();
+        }
+    } // ~RadioQuery
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        Begin
+    // Description: Starts counting a query against a radio
+    // Parameters:  pRadioWrapper - the radio the query is for
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void Begin(
+        RadioWrapper*   pRadioWrapper
+        )
+    {
+        pRadioWrapper->BeginQuery();
+        m_pRadioWrapper = pRadioWrapper;
+    } // Begin
+
+private:
+    RadioWrapper*   m_pRadioWrapper;
+
+    // Prevent copying of the query
+    RadioQuery(const RadioQuery&);
+    const RadioQuery& operator = (const RadioQuery&);
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 // Name: AcquireLibraryLock
 //
@@ -233,22 +446,113 @@ RadioWrapper* GetRadioObject(
     RFID_RADIO_HANDLE   handle
     );
 
+////////////////////////////////////////////////////////////////////////////////
+// Name: AcquireRadio
+//
+// Description:
+//   Gets the radio object without taking the library lock and takes a
+//   reference to it, which keeps the radio object from being deleted until
+//   the reference is released.  Throws an RFID_ERROR_NOT_INITIALIZED or
+//   RFID_ERROR_INVALID_HANDLE exception (rfid::RfidErrorException) on failure.
+//
+// Parameters:
+//   handle - the handle for the radio to find
+//   reference - the reference object that will release the reference when
+//     it goes out of scope
+//
+// Returns:
+//   A pointer to the radio wrapper object for the radio.
+////////////////////////////////////////////////////////////////////////////////
+RadioWrapper* AcquireRadio(
+    RFID_RADIO_HANDLE   handle,
+    RadioReference&     reference
+    );
+
 ////////////////////////////////////////////////////////////////////////////////
 // Name: RetrieveAndLockRadio
 //
 // Description:
-//   Gets the radio object and attempts to acquire the radio lock.  If the lock
-//   is already held the function fails and an exception is thrown
-//   (rfid::RfidErrorException).
+//   Gets the radio object, and a reference to it, and attempts to acquire the
+//   radio lock.  If the lock is already held the function fails and an
+//   exception is thrown (rfid::RfidErrorException).
 //
 // Parameters:
 //   handle - the handle for the radio to lock
+//   reference - the reference object that will release the reference when
+//     it goes out of scope.  It must be declared before the object that
+//     releases the radio lock so that the lock is released first.
 //
 // Returns:
 //   A pointer to the radio wrapper object for the radio.
 ////////////////////////////////////////////////////////////////////////////////
 RadioWrapper* RetrieveAndLockRadio(
-    RFID_RADIO_HANDLE   handle
+    RFID_RADIO_HANDLE   handle,
+    RadioReference&     reference
+    );
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: RetrieveAndLockRadioForQuery
+//
+// Description:
+//   Gets the radio object, and a reference to it, and acquires the radio lock
+//   for a query that needs the MAC.  If an operation holds the lock, the
+//   query waits for the operation to end, ahead of the next operation.
+//   Throws an exception (rfid::RfidErrorException) on failure.
+//
+// Parameters:
+//   handle - the handle for the radio to lock
+//   reference - the reference object that will release the reference when
+//     it goes out of scope
+//   query - the query object that will stop counting the query when it goes
+//     out of scope.  It must be declared after the reference and before the
+//     object that releases the radio lock.
+//
+// Returns:
+//   A pointer to the radio wrapper object for the radio.
+////////////////////////////////////////////////////////////////////////////////
+RadioWrapper* RetrieveAndLockRadioForQuery(
+    RFID_RADIO_HANDLE   handle,
+    RadioReference&     reference,
+    RadioQuery&         query
+    );
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: LockRadioForQuery
+//
+// Description:
+//   Acquires the radio lock for a query that needs the MAC, as
+//   RetrieveAndLockRadioForQuery does, for a radio that the caller has
+//   already acquired.
+//
+// Parameters:
+//   handle - the handle for the radio to lock
+//   pRadioWrapper - the radio wrapper object for the radio
+//   query - the query object that will stop counting the query when it goes
+//     out of scope
+//
+// Returns:
+//   Nothing
+////////////////////////////////////////////////////////////////////////////////
+void LockRadioForQuery(
+    RFID_RADIO_HANDLE   handle,
+    RadioWrapper*       pRadioWrapper,
+    RadioQuery&         query
+    );
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: MillisecondsSince
+//
+// Description:
+//   Determines how much time has passed since a moment
+//
+// Parameters:
+//   startTime - the moment
+//
+// Returns:
+//   The number of milliseconds since startTime
+////////////////////////////////////////////////////////////////////////////////
+INT32U MillisecondsSince(
+    const CPL_TimeSpec& startTime
     );
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -268,7 +572,7 @@ RadioWrapper* RetrieveAndLockRadio(
 //   context - context supplied on call to function.  Ignored.
 //
 // Returns:
-//   CALLBACK_STATUS_REMOVE_AND_CONTINUE
+//   CALLBACK_STATUS_CONTINUE
 ////////////////////////////////////////////////////////////////////////////////
 ActiveRadioTable::CALLBACK_STATUS CloseAndDeleteRadioCallback(
     ActiveRadioTable::TableHandle handle,
@@ -281,14 +585,15 @@ ActiveRadioTable::CALLBACK_STATUS CloseAndDeleteRadioCallback(
 //
 // Description:
 //   This function is the one actually responsible for telling the radio object
-//   it should close and for deleting the object.  Because there are a couple of
-//   instances where we want to do this, we'll consolidate this code in one
-//   place.
+//   it should close, for removing it from the active radio table and for
+//   deleting the object.  Because there are a couple of instances where we
+//   want to do this, we'll consolidate this code in one place.
 //
 //   NOTE: On entry to the function, it is assumed that the library has already
 //   been locked.
 //
 // Parameters:
+//   handle - the radio's handle
 //   pRadioWrapper - a pointer to the radio wrapper object for the radio that
 //     will be closed and deleted
 //
@@ -296,7 +601,37 @@ ActiveRadioTable::CALLBACK_STATUS CloseAndDeleteRadioCallback(
 //   Nothing.
 ////////////////////////////////////////////////////////////////////////////////
 void CloseAndDeleteRadioObject(
-    RadioWrapper*   pRadioWrapper
+    RFID_RADIO_HANDLE   handle,
+    RadioWrapper*       pRadioWrapper
+    );
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: RetireRadio
+//
+// Description:
+//   Takes a radio out of service before it is closed or reset: retires its
+//   handle in the active radio table so that no other thread can acquire it,
+//   aborts the operation in progress and waits for the threads that acquired
+//   it before to release it.  When it returns, nothing else is using the
+//   radio and the caller must either remove the handle from the table or
+//   reinstate it.  Throws an RFID_ERROR_CURRENTLY_NOT_ALLOWED exception
+//   (rfid::RfidErrorException), and leaves the handle in service, if called
+//   from the radio's packet callback.
+//
+//   NOTE: On entry to the function, it is assumed that the library has already
+//   been locked.
+//
+// Parameters:
+//   handle - the radio's handle
+//   pRadioWrapper - a pointer to the radio wrapper object that is associated
+//     with the handle
+//
+// Returns:
+//   Nothing.
+////////////////////////////////////////////////////////////////////////////////
+void RetireRadio(
+    RFID_RADIO_HANDLE   handle,
+    RadioWrapper*       pRadioWrapper
     );
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -367,6 +702,23 @@ void Validate18K6CTagGroup(
     const RFID_18K6C_TAG_GROUP* pGroup
     );
 
+////////////////////////////////////////////////////////////////////////////////
+// Name: Validate18K6CSelectCriteria
+//
+// Description:
+//   Validates the fields in the 18K6C select criteria structures.  Throws an
+//   RFID_ERROR_INVALID_PARAMETER exception of one of the fields is invalid
+//
+// Parameters:
+//   pCriteria - a pointer to the select criteria structure
+//
+// Returns:
+//   Nothing.
+////////////////////////////////////////////////////////////////////////////////
+void Validate18K6CSelectCriteria(
+    const RFID_18K6C_SELECT_CRITERIA*   pCriteria
+    );
+
 ////////////////////////////////////////////////////////////////////////////////
 // Name: Validate18K6CSingulationAlgorithmParameters
 //
@@ -490,7 +842,9 @@ RFID_LIBRARY_API RFID_STATUS RFID_Startup(
         }
 
         // Grab the library lock
+        INT64U waitStart = rfid::StatisticsClock::Now();
         rfid::CplMutexAutoLock libraryLock(g_libraryLockHandle.get());
+        g_libraryLockWait.Record(rfid::StatisticsClock::Now() - waitStart);
 
         // Only do initialization work if the library is not already
         // initialized
@@ -501,7 +855,14 @@ RFID_LIBRARY_API RFID_STATUS RFID_Startup(
 
             // Create the appropriate tracer
             std::auto_ptr<rfid::Tracer> pTracer;
-            if (flags & RFID_FLAG_LOG_FILE)
+            if (flags & RFID_FLAG_LOG_BINARY)
+            {
+                pTracer = std::auto_ptr<rfid::Tracer>(
+                    new rfid::TracerBinary(
+                        LOG_BINARY_FILE_NAME.c_str(),
+                        severityThreshold));
+            }
+            else if (flags & RFID_FLAG_LOG_FILE)
             {
                 pTracer = std::auto_ptr<rfid::Tracer>(
                     new rfid::TracerFile(
@@ -527,14 +888,32 @@ RFID_LIBRARY_API RFID_STATUS RFID_Startup(
                 pLibraryVersion,
                 flags);
 
-            g_radioEnumerationFunction  = 
-                rfid::MacTransportLive::EnumerateAttachedRadios;
-            g_radioOpenFunction         = 
-                rfid::MacTransportLive::OpenRadio;
+            if (flags & RFID_FLAG_SYNTHETIC_RADIOS)
+            {
+                g_radioEnumerationFunction  =
+                    rfid::MacTransportSynthetic::EnumerateAttachedRadios;
+                g_radioOpenFunction         =
+                    rfid::MacTransportSynthetic::OpenRadio;
+            }
+            else
+            {
+                g_radioEnumerationFunction  = 
+                    rfid::MacTransportLive::EnumerateAttachedRadios;
+                g_radioOpenFunction         = 
+                    rfid::MacTransportLive::OpenRadio;
+            }
+
+            std::auto_ptr<rfid::PacketCapture> pPacketCapture;
+            if (flags & RFID_FLAG_CAPTURE_PACKETS)
+            {
+                pPacketCapture = std::auto_ptr<rfid::PacketCapture>(
+                    new rfid::PacketCapture(CAPTURE_FILE_NAME.c_str()));
+            }
 
-            // Now that we are exception-safe, copy the tracer pointer and mark
-            // the library as initialized
+            // Now that we are exception-safe, copy the tracer and capture
+            // pointers and mark the library as initialized
             g_pTracer               = pTracer;
+            g_pPacketCapture        = pPacketCapture;
             g_libraryIsInitialized  = true;
         }
 
@@ -547,7 +926,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_Startup(
             pLibraryVersion->release     = RFID_RELEASE_VERSION;
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Version = %d.%d.%d.%d\n",
             __FUNCTION__,
@@ -589,7 +968,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_Shutdown(void)
         rfid::CplMutexAutoLock libraryLock;
         libraryLock.Assume(AcquireLibraryLock());
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s\n",
             __FUNCTION__);
@@ -597,10 +976,12 @@ RFID_LIBRARY_API RFID_STATUS RFID_Shutdown(void)
         // Delete any radios that are still open - this will also close them
         g_pActiveRadios->ForEach(CloseAndDeleteRadioCallback, 0);
 
-        // Get rid of the tracer object and indicate now that the library
-        // is not initialized and 
-        g_pTracer.reset();
+        // Indicate now that the library is not initialized and get rid of the
+        // packet capture, which writes out what it still holds, and the
+        // tracer object
         g_libraryIsInitialized  = false;
+        g_pPacketCapture.reset();
+        g_pTracer.reset();
     }
     catch (rfid::RfidErrorException& error)
     {
@@ -642,7 +1023,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_RetrieveAttachedRadiosList(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -653,7 +1034,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_RetrieveAttachedRadiosList(
         // Let the MAC transport enumerate the radios
         g_radioEnumerationFunction(pBuffer); 
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: %d radio(s) attached\n",
             __FUNCTION__,
@@ -700,7 +1081,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioOpen(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -719,7 +1100,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioOpen(
         result = CPL_MutexInit(pRadioLock.get());
         if (result)
         {
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 rfid::Tracer::RFID_LOG_SEVERITY_ERROR,
                 "%s: Failed to create radio lock.  Result = 0x%.8x\n",
                 __FUNCTION__,
@@ -727,16 +1108,31 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioOpen(
             throw rfid::RfidErrorException(RFID_ERROR_FAILURE, __FUNCTION__);
         }
 
+        // Create the signal that tells the operations giving way to queries
+        // that the queries have ended
+        std::auto_ptr<CPL_Cond>     pQueriesDone(new CPL_Cond);
+        result = CPL_CondInit(pQueriesDone.get());
+        if (result)
+        {
+            RFID_TRACE(
+                rfid::Tracer::RFID_LOG_SEVERITY_ERROR,
+                "%s: Failed to create condition variable.  Result = 0x%.8x\n",
+                __FUNCTION__,
+                result);
+            CPL_MutexDestroy(pRadioLock.get());
+            throw rfid::RfidErrorException(RFID_ERROR_FAILURE, __FUNCTION__);
+        }
+
         // Now create the radio wrapper
         std::auto_ptr<RadioWrapper> pRadioWrapper(
-            new RadioWrapper(pRadio, pRadioLock));
+            new RadioWrapper(pRadio, pRadioLock, pQueriesDone));
 
         // Add the radio to the active radio table and once we know that
         // we cannot fail, release the auto pointer's ownership of the wrapper
         *pHandle = g_pActiveRadios->Add(pRadioWrapper.get());
         pRadioWrapper.release();
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: Radio with cookie 0x%.8x has handle 0x%.8x\n",
             __FUNCTION__,
@@ -745,7 +1141,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioOpen(
     }
     catch (std::bad_alloc&)
     {
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_ERROR,
             "%s: Error allocating memory\n",
             __FUNCTION__);
@@ -783,18 +1179,15 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioClose(
         rfid::CplMutexAutoLock libraryLock;
         libraryLock.Assume(AcquireLibraryLock());
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x\n",
             __FUNCTION__,
             handle);
 
-        // Get the radio object from the table and then go ahead and close and 
-        // delete it
-        CloseAndDeleteRadioObject(GetRadioObject(handle));
-
-        // Remove the radio from the active radio table
-        g_pActiveRadios->Remove(handle);
+        // Get the radio object from the table and then go ahead and close,
+        // remove and delete it
+        CloseAndDeleteRadioObject(handle, GetRadioObject(handle));
     }
     catch (rfid::RfidErrorException& error)
     {
@@ -824,24 +1217,16 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacWriteRegister(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.4x,0x%.8x\n",
             __FUNCTION__,
@@ -882,22 +1267,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacReadRegister(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, wait for the
+        // operation that holds it, if any, to end and wrap the lock so it is
+        // automatically released
+        pRadioWrapper =
+            RetrieveAndLockRadioForQuery(handle, radioReference, radioQuery);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Verify parameters
         if (NULL == pValue)
@@ -905,7 +1285,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacReadRegister(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.4x\n",
             __FUNCTION__,
@@ -948,22 +1328,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacReadRegisterInfo(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, wait for the
+        // operation that holds it, if any, to end and wrap the lock so it is
+        // automatically released
+        pRadioWrapper =
+            RetrieveAndLockRadioForQuery(handle, radioReference, radioQuery);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Verify parameters
         if ((NULL == pInfo) || 
@@ -972,7 +1347,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacReadRegisterInfo(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.4x\n",
             __FUNCTION__,
@@ -1011,22 +1386,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacReadBankedRegister(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, wait for the
+        // operation that holds it, if any, to end and wrap the lock so it is
+        // automatically released
+        pRadioWrapper =
+            RetrieveAndLockRadioForQuery(handle, radioReference, radioQuery);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Verify parameters
         if (NULL == pValue)
@@ -1034,7 +1404,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacReadBankedRegister(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.4x, 0x%.4X\n",
             __FUNCTION__,
@@ -1076,24 +1446,16 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacWriteBankedRegister(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.4x,0x%.4x,0x%.8x\n",
             __FUNCTION__,
@@ -1137,22 +1499,14 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioSetOperationMode(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate the operation mode
         switch (mode)
@@ -1171,7 +1525,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioSetOperationMode(
             }
         } // switch (mode)
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -1208,21 +1562,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioGetOperationMode(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-        }
+        // Get the radio object, without the library lock, wait for the
+        // operation that holds it, if any, to end and wrap the lock so it is
+        // automatically released
+        pRadioWrapper =
+            RetrieveAndLockRadioForQuery(handle, radioReference, radioQuery);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate parameters
         if (NULL == pMode)
@@ -1230,7 +1580,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioGetOperationMode(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x\n",
             __FUNCTION__,
@@ -1239,7 +1589,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioGetOperationMode(
         // Let the radio object retreive the operation mode
         *pMode = pRadioWrapper->GetRadioPointer()->GetOperationMode();
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s: mode=0x%.8x\n",
             __FUNCTION__,
@@ -1274,21 +1624,14 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioSetPowerState(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-        }
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate the power state
         switch (state)
@@ -1307,7 +1650,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioSetPowerState(
             }
         } // switch (state)
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -1345,22 +1688,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioGetPowerState(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, wait for the
+        // operation that holds it, if any, to end and wrap the lock so it is
+        // automatically released
+        pRadioWrapper =
+            RetrieveAndLockRadioForQuery(handle, radioReference, radioQuery);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate parameters
         if (NULL == pState)
@@ -1368,7 +1706,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioGetPowerState(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x\n",
             __FUNCTION__,
@@ -1404,23 +1742,16 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioSetCurrentLinkProfile(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-        }
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -1457,22 +1788,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioGetCurrentLinkProfile(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, wait for the
+        // operation that holds it, if any, to end and wrap the lock so it is
+        // automatically released
+        pRadioWrapper =
+            RetrieveAndLockRadioForQuery(handle, radioReference, radioQuery);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate parameters
         if (NULL == pCurrentProfile)
@@ -1480,7 +1806,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioGetCurrentLinkProfile(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x\n",
             __FUNCTION__,
@@ -1519,22 +1845,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioGetLinkProfile(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, wait for the
+        // operation that holds it, if any, to end and wrap the lock so it is
+        // automatically released
+        pRadioWrapper =
+            RetrieveAndLockRadioForQuery(handle, radioReference, radioQuery);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate parameters
         if ((NULL == pProfileInfo) ||
@@ -1543,7 +1864,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioGetLinkProfile(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -1584,24 +1905,16 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioWriteLinkProfileRegister(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -1645,22 +1958,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioReadLinkProfileRegister(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, wait for the
+        // operation that holds it, if any, to end and wrap the lock so it is
+        // automatically released
+        pRadioWrapper =
+            RetrieveAndLockRadioForQuery(handle, radioReference, radioQuery);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate parameters
         if (NULL == pValue)
@@ -1668,7 +1976,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioReadLinkProfileRegister(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -1709,22 +2017,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_AntennaPortGetStatus(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, wait for the
+        // operation that holds it, if any, to end and wrap the lock so it is
+        // automatically released
+        pRadioWrapper =
+            RetrieveAndLockRadioForQuery(handle, radioReference, radioQuery);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate parameters
         if ((NULL == pStatus) ||
@@ -1733,7 +2036,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_AntennaPortGetStatus(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8\n",
             __FUNCTION__,
@@ -1773,22 +2076,14 @@ RFID_LIBRARY_API RFID_STATUS RFID_AntennaPortSetState(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate the antenna port state
         switch (state)
@@ -1807,7 +2102,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_AntennaPortSetState(
             }
         } // switch (state)
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -1848,6 +2143,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_AntennaPortSetConfiguration(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
@@ -1857,19 +2153,10 @@ RFID_LIBRARY_API RFID_STATUS RFID_AntennaPortSetConfiguration(
         RFID_ANTENNA_PORT_CONFIG localConfig;
         RFID_ANTENNA_PORT_CONFIG *pLocalConfig = &localConfig;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate parameters
 
@@ -1897,7 +2184,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_AntennaPortSetConfiguration(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x,0x%.8x,0x%.8x,0x%.8x,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -1942,22 +2229,14 @@ RFID_LIBRARY_API RFID_STATUS RFID_AntennaPortGetConfiguration(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock.  The radio is only
+        // locked if the answer isn't in its snapshot.
+        pRadioWrapper = AcquireRadio(handle, radioReference);
 
         // Validate parameters
         if ((NULL == pConfig) ||
@@ -1966,17 +2245,26 @@ RFID_LIBRARY_API RFID_STATUS RFID_AntennaPortGetConfiguration(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x\n",
             __FUNCTION__,
             handle,
             antennaPort);
 
-        // Let the radio object get the antenna-port configuration
-        pRadioWrapper->GetRadioPointer()->GetAntennaPortConfiguration(
-            antennaPort,
-            pConfig);
+        // Let the radio object get the antenna-port configuration, from the
+        // MAC if the snapshot doesn't have it
+        if (!pRadioWrapper->GetRadioPointer()->GetCachedAntennaPortConfiguration(
+                antennaPort,
+                pConfig))
+        {
+            LockRadioForQuery(handle, pRadioWrapper, radioQuery);
+            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
+
+            pRadioWrapper->GetRadioPointer()->GetAntennaPortConfiguration(
+                antennaPort,
+                pConfig);
+        }
 
 
         // Bug 11240 - v2.3.0 backwards compatibility for old host client apps... 
@@ -2020,131 +2308,19 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CSetSelectCriteria(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate the parameters
-        if ((NULL == pCriteria) ||
-            ((0 != pCriteria->countCriteria) && (NULL == pCriteria->pCriteria)))
-        {
-            throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
-        }
-
-
-        // Validate each of the selection criteria
-        INT32U                             index;
-        const RFID_18K6C_SELECT_CRITERION* pCriterion;
-
-        for (index = 0, pCriterion = pCriteria->pCriteria;
-             index < pCriteria->countCriteria;
-             ++index, ++pCriterion)
-        {
-            const RFID_18K6C_SELECT_MASK*   pMask   = &pCriterion->mask;
-            const RFID_18K6C_SELECT_ACTION* pAction = &pCriterion->action;
-
-            // Validate the mask bank
-            switch (pMask->bank)
-            {
-                // Valid memory banks
-                case RFID_18K6C_MEMORY_BANK_EPC:
-                case RFID_18K6C_MEMORY_BANK_TID:
-                case RFID_18K6C_MEMORY_BANK_USER:
-                {
-                    break;
-                }
-                // Invalid memory banks
-                case RFID_18K6C_MEMORY_BANK_RESERVED:
-                default:
-                {
-                    throw rfid::RfidErrorException(
-                        RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
-                    break;
-                }
-            } // switch (pMask->bank)
+        Validate18K6CSelectCriteria(pCriteria);
 
-            // Validate the mask bit count
-            if (RFID_18K6C_MAX_SELECT_MASK_CNT < pMask->count)
-            {
-                throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
-            }
-
-            // Validate the action target
-            switch (pAction->target)
-            {
-                // Valid targets
-                case RFID_18K6C_TARGET_INVENTORY_S0:
-                case RFID_18K6C_TARGET_INVENTORY_S1:
-                case RFID_18K6C_TARGET_INVENTORY_S2:
-                case RFID_18K6C_TARGET_INVENTORY_S3:
-                case RFID_18K6C_TARGET_SELECTED:
-                {
-                    break;
-                }
-                // Invalid targets
-                default:
-                {
-                    throw rfid::RfidErrorException(
-                        RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
-                    break;
-                }
-            } // switch (pAction->target)
-
-            // Validate the matching/non-matching action combination.  We'll
-            // arbitrarily pick the match action and then verify that the
-            // non-matching action is valid when used with the matching action.
-            switch (pAction->action)
-            {
-                // Valid actions
-                case RFID_18K6C_ACTION_ASLINVA_DSLINVB:
-                case RFID_18K6C_ACTION_ASLINVA_NOTHING:
-                case RFID_18K6C_ACTION_NOTHING_DSLINVB: 
-                case RFID_18K6C_ACTION_NSLINVS_NOTHING:
-                case RFID_18K6C_ACTION_DSLINVB_ASLINVA:
-                case RFID_18K6C_ACTION_DSLINVB_NOTHING:
-                case RFID_18K6C_ACTION_NOTHING_ASLINVA:
-                case RFID_18K6C_ACTION_NOTHING_NSLINVS:
-                {
-                    break;
-                }
-                // Invalid actions
-                default:
-                {
-                    throw rfid::RfidErrorException(
-                        RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
-                    break;
-                }
-            } // switch (pAction->action)
-
-            // If truncate was requested, then it is only valid if the
-            // memory bank is EPC, the target is the SL flag, and this is
-            // the last selection criterion
-            //if (pAction->enableTruncate                             &&
-            //    ((RFID_18K6C_MEMORY_BANK_EPC != pMask->bank)     ||
-            //     (RFID_18K6C_TARGET_SELECTED != pAction->target) ||
-            //     ((pCriteria->countCriteria - 1) != index)))
-            // 
-            // DMS:  MAC Firmware does not yest support truncation.
-            if (pAction->enableTruncate)
-            {
-                throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
-            }
-        } // for (...)
-
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -2186,22 +2362,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CGetSelectCriteria(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, wait for the
+        // operation that holds it, if any, to end and wrap the lock so it is
+        // automatically released
+        pRadioWrapper =
+            RetrieveAndLockRadioForQuery(handle, radioReference, radioQuery);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate the parameters
         if ((NULL == pCriteria) ||
@@ -2210,7 +2381,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CGetSelectCriteria(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x\n",
             __FUNCTION__,
@@ -2256,22 +2427,14 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CSetPostMatchCriteria(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate the parameters
         if ((NULL == pParms) ||
@@ -2293,7 +2456,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CSetPostMatchCriteria(
             }
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -2337,22 +2500,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CGetPostMatchCriteria(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, wait for the
+        // operation that holds it, if any, to end and wrap the lock so it is
+        // automatically released
+        pRadioWrapper =
+            RetrieveAndLockRadioForQuery(handle, radioReference, radioQuery);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate the parameters
         if ((NULL == pParms) ||
@@ -2361,7 +2519,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CGetPostMatchCriteria(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x\n",
             __FUNCTION__,
@@ -2400,22 +2558,14 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CSetQueryTagGroup(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate the parameters pointer
         if (NULL == pGroup)
@@ -2426,7 +2576,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CSetQueryTagGroup(
         // Validate the tag group
         Validate18K6CTagGroup(pGroup);
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -2468,22 +2618,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CGetQueryTagGroup(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, wait for the
+        // operation that holds it, if any, to end and wrap the lock so it is
+        // automatically released
+        pRadioWrapper =
+            RetrieveAndLockRadioForQuery(handle, radioReference, radioQuery);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate the parameters pointer
         if (NULL == pGroup)
@@ -2491,7 +2636,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CGetQueryTagGroup(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x\n",
             __FUNCTION__,
@@ -2532,22 +2677,14 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CSetCurrentSingulationAlgorithm(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate the singulation algorithm
         switch (algorithm)
@@ -2566,7 +2703,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CSetCurrentSingulationAlgorithm(
             }
         } // switch (algorithm)
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -2607,22 +2744,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CGetCurrentSingulationAlgorithm(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, wait for the
+        // operation that holds it, if any, to end and wrap the lock so it is
+        // automatically released
+        pRadioWrapper =
+            RetrieveAndLockRadioForQuery(handle, radioReference, radioQuery);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate the singulation algorithm pointer
         if (NULL == pAlgorithm)
@@ -2630,7 +2762,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CGetCurrentSingulationAlgorithm(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x\n",
             __FUNCTION__,
@@ -2670,22 +2802,14 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CSetSingulationAlgorithmParameters(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate the parameters pointer
         if (NULL == pParms)
@@ -2704,7 +2828,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CSetSingulationAlgorithmParameters(
                     static_cast<const RFID_18K6C_SINGULATION_FIXEDQ_PARMS *>(
                         pParms);
 
-                g_pTracer->PrintMessage(
+                RFID_TRACE(
                     rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
                     "%s,0x%.8x,0x%.8x,0x%.8x,0x%.8x,0x%.8x,0x%.8x\n",
                     __FUNCTION__,
@@ -2729,7 +2853,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CSetSingulationAlgorithmParameters(
                             RFID_18K6C_SINGULATION_DYNAMICQ_PARMS *>(
                                 pParms);
 
-                g_pTracer->PrintMessage(
+                RFID_TRACE(
                     rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
                     "%s,0x%.8x,0x%.8x,0x%.8x,0x%.8x,0x%.8x,0x%.8x,0x%.8x,0x%.8x\n",
                     __FUNCTION__,
@@ -2786,22 +2910,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CGetSingulationAlgorithmParameters(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, wait for the
+        // operation that holds it, if any, to end and wrap the lock so it is
+        // automatically released
+        pRadioWrapper =
+            RetrieveAndLockRadioForQuery(handle, radioReference, radioQuery);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate the parameters pointer
         if (NULL == pParms)
@@ -2825,7 +2944,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CGetSingulationAlgorithmParameters(
                         RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
                 }
 
-                g_pTracer->PrintMessage(
+                RFID_TRACE(
                     rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
                     "%s,0x%.8x,0x%.8x\n",
                     __FUNCTION__,
@@ -2855,7 +2974,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CGetSingulationAlgorithmParameters(
                         RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
                 }
 
-                g_pTracer->PrintMessage(
+                RFID_TRACE(
                     rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
                     "%s,0x%.8x,0x%.8x\n",
                     __FUNCTION__,
@@ -2915,21 +3034,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CTagInventory(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create a scope so that the lock is released after the inventory is
-        // started.  Once the inventory is started, we can start processing
-        // packets and know that the radio object will be valid as it cannot
-        // go away until it gets at least a chance to start processing packets.
+        // Create a scope for starting the inventory.  The radio reference keeps
+        // the radio object valid, even if another thread closes the radio,
+        // until the inventory is complete and the radio lock released.
         {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
+            // Get the radio object, without the library lock, and wrap the lock
+            // so it is automatically released
+            pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
             radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
             // Validate the parameters.
@@ -2942,7 +3057,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CTagInventory(
             // Validate the 18K6C common parameters
             Validate18K6CCommonParameters(&pParms->common);
 
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
                 "%s,0x%.8x,0x%.8x,0x%.8x\n",
                 __FUNCTION__,
@@ -3005,21 +3120,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CTagRead(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create a scope so that the lock is released after the read is
-        // started.  Once the read is started, we can start processing
-        // packets and know that the radio object will be valid as it cannot
-        // go away until it gets at least a chance to start processing packets.
+        // Create a scope for starting the read.  The radio reference keeps the
+        // radio object valid, even if another thread closes the radio, until
+        // the read is complete and the radio lock released.
         {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
+            // Get the radio object, without the library lock, and wrap the lock
+            // so it is automatically released
+            pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
             radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
 
@@ -3040,7 +3151,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CTagRead(
             pRadioWrapper->GetRadioPointer()->Start18K6CRead(pParms, flags);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x,0x%.8x,0x%.4x,0x%.4x,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -3052,12 +3163,13 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CTagRead(
             pParms->accessPassword,
             flags);
 
-        // Now process the operation response packets
-        pRadioWrapper->GetRadioPointer()->ProcessOperationData(
+        // Now process the operation response packets, letting the radio
+        // reissue the read if the access retry policy calls for it
+        pRadioWrapper->GetRadioPointer()->Process18K6CAccessData(
             handle,
-            pParms->common.pCallback,
-            pParms->common.context,
-            pParms->common.pCallbackCode);
+            rfid::Radio::ACCESS_OPERATION_READ,
+            pParms,
+            flags);
     }
     catch (rfid::RfidErrorException& error)
     {
@@ -3101,21 +3213,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CTagWrite(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create a scope so that the lock is released after the write is
-        // started.  Once the write is started, we can start processing
-        // packets and know that the radio object will be valid as it cannot
-        // go away until it gets at least a chance to start processing packets.
+        // Create a scope for starting the write.  The radio reference keeps the
+        // radio object valid, even if another thread closes the radio, until
+        // the write is complete and the radio lock released.
         {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
+            // Get the radio object, without the library lock, and wrap the lock
+            // so it is automatically released
+            pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
             radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
             // Validate the parameters that are common to all writes.
@@ -3140,7 +3248,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CTagWrite(
                     // Validate the sequential write parameters
                     Validate18K6CWriteSequentialCmdParms(pWriteParms);
 
-                    g_pTracer->PrintMessage(
+                    RFID_TRACE(
                         rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
                         "%s,0x%.8x,0x%.8x,0x%.8x,0x%.8x,0x%.4x,0x%.4x,"
                         "0x%.8x,0x%.8x\n",
@@ -3165,7 +3273,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CTagWrite(
                     // Validate the random write parameters
                     Validate18K6CWriteRandomCmdParms(pWriteParms);
 
-                    g_pTracer->PrintMessage(
+                    RFID_TRACE(
                         rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
                         "%s,0x%.8x,0x%.8x,0x%.8x,0x%.8x,0x%.4x,"
                         "0x%.8x,0x%.8x\n",
@@ -3192,12 +3300,13 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CTagWrite(
             pRadioWrapper->GetRadioPointer()->Start18K6CWrite(pParms, flags);
         }
 
-        // Now process the operation response packets
-        pRadioWrapper->GetRadioPointer()->ProcessOperationData(
+        // Now process the operation response packets, letting the radio
+        // reissue the write if the access retry policy calls for it
+        pRadioWrapper->GetRadioPointer()->Process18K6CAccessData(
             handle,
-            pParms->common.pCallback,
-            pParms->common.context,
-            pParms->common.pCallbackCode);
+            rfid::Radio::ACCESS_OPERATION_WRITE,
+            pParms,
+            flags);
     }
     catch (rfid::RfidErrorException& error)
     {
@@ -3237,21 +3346,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CTagKill(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create a scope so that the lock is released after the kill is
-        // started.  Once the kill is started, we can start processing
-        // packets and know that the radio object will be valid as it cannot
-        // go away until it gets at least a chance to start processing packets.
+        // Create a scope for starting the kill.  The radio reference keeps the
+        // radio object valid, even if another thread closes the radio, until
+        // the kill is complete and the radio lock released.
         {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
+            // Get the radio object, without the library lock, and wrap the lock
+            // so it is automatically released
+            pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
             radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
 
@@ -3266,7 +3371,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CTagKill(
             // Validate the 18K6C common parameters
             Validate18K6CCommonParameters(&pParms->common);
 
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
                 "%s,0x%.8x,0x%.8x,0x%.8x,0x%.8x,0x%.8x\n",
                 __FUNCTION__,
@@ -3325,21 +3430,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CTagLock(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create a scope so that the lock is released after the lock is
-        // started.  Once the lock is started, we can start processing
-        // packets and know that the radio object will be valid as it cannot
-        // go away until it gets at least a chance to start processing packets.
+        // Create a scope for starting the lock.  The radio reference keeps the
+        // radio object valid, even if another thread closes the radio, until
+        // the lock is complete and the radio lock released.
         {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
+            // Get the radio object, without the library lock, and wrap the lock
+            // so it is automatically released
+            pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
             radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
             // Validate parameters
@@ -3365,7 +3466,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CTagLock(
             // Validate the 18K6C common parameters
             Validate18K6CCommonParameters(&pParms->common);
 
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
                 "%s,0x%.8x,0x%.8x,0x%.8x,0x%.8x,0x%.8x,0x%.8x,0x%.8x,0x%.8x,"
                 "0x%.8x\n",
@@ -3433,21 +3534,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CTagBlockWrite(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create a scope so that the lock is released after the write is
-        // started.  Once the write is started, we can start processing
-        // packets and know that the radio object will be valid as it cannot
-        // go away until it gets at least a chance to start processing packets.
+        // Create a scope for starting the write.  The radio reference keeps the
+        // radio object valid, even if another thread closes the radio, until
+        // the write is complete and the radio lock released.
         {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
+            // Get the radio object, without the library lock, and wrap the lock
+            // so it is automatically released
+            pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
             radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
             // Validate the block write specific parameters.
@@ -3485,7 +3582,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CTagBlockWrite(
                 }
             } // switch (pBWParms->bank)
     
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                     rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
                     "%s,0x%.8x,0x%.8x,0x%.8x,0x%.8x,0x%.4x,"
                     "0x%.8x,0x%.8x\n",
@@ -3553,21 +3650,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CTagQT(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create a scope so that the lock is released after the QT is
-        // started.  Once the QT is started, we can start processing
-        // packets and know that the radio object will be valid as it cannot
-        // go away until it gets at least a chance to start processing packets.
+        // Create a scope for starting the QT.  The radio reference keeps the
+        // radio object valid, even if another thread closes the radio, until
+        // the QT is complete and the radio lock released.
         {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
+            // Get the radio object, without the library lock, and wrap the lock
+            // so it is automatically released
+            pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
             radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
             // Validate the parameters that are common to all QT operations.
@@ -3611,7 +3704,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CTagQT(
                     Validate18K6CReadCmdParms(&pParms->parameters.readCmdParms);
 
 
-                    g_pTracer->PrintMessage(
+                    RFID_TRACE(
                         rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
                         "%s,0x%.8x,0x%.8x,0x%.8x,0x%.4x,0x%.4x\n",
                         __FUNCTION__,
@@ -3632,7 +3725,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CTagQT(
                     // Validate the sequential write parameters
                     Validate18K6CWriteSequentialCmdParms(pWriteParms);
 
-                    g_pTracer->PrintMessage(
+                    RFID_TRACE(
                         rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
                         "%s,0x%.8x,,0x%.8x,0x%.8x,0x%.4x,0x%.4x\n",
                         __FUNCTION__,
@@ -3653,7 +3746,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CTagQT(
                     // Validate the random write parameters
                     Validate18K6CWriteRandomCmdParms(pWriteParms);
 
-                    g_pTracer->PrintMessage(
+                    RFID_TRACE(
                         rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
                         "%s,0x%.8x,0x%.8x,0x%.8x,0x%.4x\n",
                         __FUNCTION__,
@@ -3674,7 +3767,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CTagQT(
 
             // Start the QT operation
             
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
                 "%s,0x%.8x,0x%.8x,0x%.4x,0x%.4x,0x%.4x,0x%.4x,0x%.8x,0x%.8x\n",
                 __FUNCTION__,
@@ -3741,21 +3834,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CTagBlockErase(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create a scope so that the lock is released after the block erase is
-        // started.  Once the read is started, we can start processing
-        // packets and know that the radio object will be valid as it cannot
-        // go away until it gets at least a chance to start processing packets.
+        // Create a scope for starting the block erase.  The radio reference
+        // keeps the radio object valid, even if another thread closes the
+        // radio, until the block erase is complete and the radio lock released.
         {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
+            // Get the radio object, without the library lock, and wrap the lock
+            // so it is automatically released
+            pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
             radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
 
@@ -3776,7 +3865,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_18K6CTagBlockErase(
             pRadioWrapper->GetRadioPointer()->Start18K6CBlockErase(pParms, flags);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x,0x%.8x,0x%.4x,0x%.4x,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -3827,14 +3916,12 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioCancelOperation(
 
     try
     {
-        // Acquire the library lock
-        rfid::CplMutexAutoLock libraryLock;
-        libraryLock.Assume(AcquireLibraryLock());
-
-        // Get the radio object from the table.
-        RadioWrapper* pRadioWrapper = GetRadioObject(handle);
+        // Get the radio object from the table.  Only a reference is taken, as
+        // the radio lock is held by the thread running the operation.
+        RadioReference  radioReference;
+        RadioWrapper*   pRadioWrapper = AcquireRadio(handle, radioReference);
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -3874,14 +3961,12 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioAbortOperation(
 
     try
     {
-        // Acquire the library lock
-        rfid::CplMutexAutoLock libraryLock;
-        libraryLock.Assume(AcquireLibraryLock());
+        // Get the radio object from the table.  Only a reference is taken, as
+        // the radio lock is held by the thread running the operation.
+        RadioReference  radioReference;
+        RadioWrapper*   pRadioWrapper = AcquireRadio(handle, radioReference);
 
-        // Get the radio object from the table.
-        RadioWrapper* pRadioWrapper = GetRadioObject(handle);
-
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -3923,22 +4008,14 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioSetResponseDataMode(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate the response type
         if (RFID_RESPONSE_TYPE_DATA != responseType)
@@ -3964,7 +4041,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioSetResponseDataMode(
             }
         } // switch (responseMode)
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -4006,22 +4083,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioGetResponseDataMode(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, wait for the
+        // operation that holds it, if any, to end and wrap the lock so it is
+        // automatically released
+        pRadioWrapper =
+            RetrieveAndLockRadioForQuery(handle, radioReference, radioQuery);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate parameters
         if ((RFID_RESPONSE_TYPE_DATA != responseType)   ||
@@ -4030,7 +4102,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioGetResponseDataMode(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -4068,26 +4140,23 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacUpdateNonvolatileMemory(
     )
 {
     RFID_STATUS status = RFID_STATUS_OK;
-    RadioWrapper*           pRadioWrapper   = NULL;
+    bool        removeRadio = false;
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
+        RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
+        // no matter what happens (error or success) from here on, we remove
+        // the radio to force the application to reconnect.  This simplifies
+        // behavior in the long run.
+        removeRadio = true;
 
         // Validate parameters
         if (!countBlocks || (NULL == pBlocks))
@@ -4103,7 +4172,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacUpdateNonvolatileMemory(
             }
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -4116,15 +4185,6 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacUpdateNonvolatileMemory(
             countBlocks,
             pBlocks,
             flags);
-
-
-        // no matter what happens (error or success) we remove the radio to force the
-        // application to reconnect.  This simplifies behavior in the long run.
-        //
-        g_pActiveRadios->Remove(handle);
-        delete pRadioWrapper;
-        pRadioWrapper = NULL;
-
     }
     catch (rfid::RfidErrorException& error)
     {
@@ -4135,16 +4195,22 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacUpdateNonvolatileMemory(
         status = RFID_ERROR_FAILURE;
     }
 
-    // if pointer is not NULL, we took an exception path, so need to do the cleanup
-    // that normally happens in the succes path.
-    //
-    if (pRadioWrapper != NULL)
+    // Now that our radio lock and reference are released, remove the radio
+    // and delete it.  Removal waits for any other thread that still holds a
+    // reference.  If another thread closed the radio first there is nothing
+    // left to do.
+    if (removeRadio)
     {
-        // no matter what happens (error or success) we remove the radio to force the
-        // application to reconnect.  This simplifies behavior in the long run.
-        //
-        g_pActiveRadios->Remove(handle);
-        delete pRadioWrapper;
+        try
+        {
+            rfid::CplMutexAutoLock libraryLock;
+            libraryLock.Assume(AcquireLibraryLock());
+
+            delete g_pActiveRadios->Remove(handle);
+        }
+        catch (...)
+        {
+        }
     }
 
     return status;
@@ -4165,22 +4231,14 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacGetVersion(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock.  The radio is only
+        // locked if the answer isn't in its snapshot.
+        pRadioWrapper = AcquireRadio(handle, radioReference);
 
         // Verify the parameters
         if (NULL == pVersion)
@@ -4188,16 +4246,22 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacGetVersion(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x\n",
             __FUNCTION__,
             handle);
 
-        // Get the MAC version
-        pRadioWrapper->GetRadioPointer()->GetMacVersion(pVersion);
+        // Get the MAC version, from the MAC if the snapshot doesn't have it
+        if (!pRadioWrapper->GetRadioPointer()->GetCachedMacVersion(pVersion))
+        {
+            LockRadioForQuery(handle, pRadioWrapper, radioQuery);
+            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
+
+            pRadioWrapper->GetRadioPointer()->GetMacVersion(pVersion);
+        }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: MAC Version = %d.%d.%d.%d\n",
             __FUNCTION__,
@@ -4234,22 +4298,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacGetBootLoaderVersion(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, wait for the
+        // operation that holds it, if any, to end and wrap the lock so it is
+        // automatically released
+        pRadioWrapper =
+            RetrieveAndLockRadioForQuery(handle, radioReference, radioQuery);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Verify the parameters
         if (NULL == pVersion)
@@ -4257,7 +4316,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacGetBootLoaderVersion(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x\n",
             __FUNCTION__,
@@ -4266,7 +4325,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacGetBootLoaderVersion(
         // Get the MAC version
         pRadioWrapper->GetRadioPointer()->GetMacBootLoaderVersion(pVersion);
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_INFO,
             "%s: MAC Version = %d.%d.%d.%d\n",
             __FUNCTION__,
@@ -4308,22 +4367,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacReadOemData(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, wait for the
+        // operation that holds it, if any, to end and wrap the lock so it is
+        // automatically released
+        pRadioWrapper =
+            RetrieveAndLockRadioForQuery(handle, radioReference, radioQuery);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate parameters
         if ((NULL == pCount) || (0 == *pCount) || (NULL == pData))
@@ -4331,7 +4385,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacReadOemData(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -4376,22 +4430,14 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacWriteOemData(
     INT32U      locCount = 0;
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate parameters
         if ((NULL == pCount) || (0 == *pCount) || (NULL == pData))
@@ -4399,7 +4445,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacWriteOemData(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -4466,18 +4512,30 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacReset(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x\n",
             __FUNCTION__,
             handle,
             resetType);
 
-        // Let the radio object reset the MAC
-        pRadioWrapper->GetRadioPointer()->ResetMac(resetType);
+        // Make sure that no other thread is using the radio while its MAC
+        // resets, then let the radio object reset the MAC.  If the reset
+        // can't be done, the radio stays open.
+        RetireRadio(handle, pRadioWrapper);
+        try
+        {
+            pRadioWrapper->GetRadioPointer()->ResetMac(resetType);
+        }
+        catch (...)
+        {
+            pRadioWrapper->GetRadioPointer()->Reinstate();
+            g_pActiveRadios->Reinstate(handle);
+            throw;
+        }
 
-        // Remove the radio from the active radio table and delete the radio
-        // object
+        // The handle is no longer valid, so remove the radio from the active
+        // radio table and delete the radio object
         g_pActiveRadios->Remove(handle);
         delete pRadioWrapper;
     }
@@ -4507,24 +4565,16 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacClearError(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x\n",
             __FUNCTION__,
@@ -4562,22 +4612,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacGetError(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, wait for the
+        // operation that holds it, if any, to end and wrap the lock so it is
+        // automatically released
+        pRadioWrapper =
+            RetrieveAndLockRadioForQuery(handle, radioReference, radioQuery);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Verify parameters
         if ((NULL == pError) ||
@@ -4586,7 +4631,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacGetError(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x\n",
             __FUNCTION__,
@@ -4625,24 +4670,16 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacBypassWriteRegister(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.4x,0x%.4x\n",
             __FUNCTION__,
@@ -4682,21 +4719,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacBypassReadRegister(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-        }
+        // Get the radio object, without the library lock, wait for the
+        // operation that holds it, if any, to end and wrap the lock so it is
+        // automatically released
+        pRadioWrapper =
+            RetrieveAndLockRadioForQuery(handle, radioReference, radioQuery);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate the parmaters
         if (NULL == pValue)
@@ -4704,7 +4737,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacBypassReadRegister(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -4743,22 +4776,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacGetRegion(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, wait for the
+        // operation that holds it, if any, to end and wrap the lock so it is
+        // automatically released
+        pRadioWrapper =
+            RetrieveAndLockRadioForQuery(handle, radioReference, radioQuery);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate parameters
         if ((NULL == pRegion) || (NULL != pRegionConfig))
@@ -4766,7 +4794,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_MacGetRegion(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x\n",
             __FUNCTION__,
@@ -4804,23 +4832,16 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioSetGpioPinsConfiguration(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-        }
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -4861,22 +4882,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioGetGpioPinsConfiguration(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, wait for the
+        // operation that holds it, if any, to end and wrap the lock so it is
+        // automatically released
+        pRadioWrapper =
+            RetrieveAndLockRadioForQuery(handle, radioReference, radioQuery);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate parameters
         if (NULL == pConfiguration)
@@ -4884,7 +4900,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioGetGpioPinsConfiguration(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x\n",
             __FUNCTION__,
@@ -4924,22 +4940,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioReadGpioPins(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, wait for the
+        // operation that holds it, if any, to end and wrap the lock so it is
+        // automatically released
+        pRadioWrapper =
+            RetrieveAndLockRadioForQuery(handle, radioReference, radioQuery);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate parameters
         if (NULL == pValue)
@@ -4947,7 +4958,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioReadGpioPins(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x\n",
             __FUNCTION__,
@@ -4986,24 +4997,16 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioWriteGpioPins(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -5041,21 +5044,14 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioTurnCarrierWaveOn(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-        }
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Let the radio object turn on the carrier wave
         pRadioWrapper->GetRadioPointer()->ToggleCarrierWave(true);
@@ -5086,22 +5082,14 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioTurnCarrierWaveOff(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Let the radio object turn off the carrier wave
         pRadioWrapper->GetRadioPointer()->ToggleCarrierWave(false);
@@ -5135,21 +5123,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioIssueCommand(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create a scope so that the lock is released after the command is
-        // started.  Once the command is started, we can start processing
-        // packets and know that the radio object will be valid as it cannot
-        // go away until it gets at least a chance to start processing packets.
+        // Create a scope for starting the command.  The radio reference keeps
+        // the radio object valid, even if another thread closes the radio,
+        // until the command is complete and the radio lock released.
         {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
+            // Get the radio object, without the library lock, and wrap the lock
+            // so it is automatically released
+            pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
             radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
 
@@ -5160,7 +5144,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioIssueCommand(
                 throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
             }
 
-            g_pTracer->PrintMessage(
+            RFID_TRACE(
                 rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
                 "%s,0x%.8x,0x%.8x\n",
                 __FUNCTION__,
@@ -5210,21 +5194,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioTurnCarrierWaveOnRandom(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create a scope so that the lock is released after the command is
-        // started.  Once the command is started, we can start processing
-        // packets and know that the radio object will be valid as it cannot
-        // go away until it gets at least a chance to start processing packets.
+        // Create a scope for starting the command.  The radio reference keeps
+        // the radio object valid, even if another thread closes the radio,
+        // until the command is complete and the radio lock released.
         {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
+            // Get the radio object, without the library lock, and wrap the lock
+            // so it is automatically released
+            pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
             radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
             // Validate the parameters.
@@ -5279,22 +5259,14 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioSetImpinjExtensions(
 
     try
     {
+        RadioReference          radioReference;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate the parameters
         if ((pExtensions->blockWriteMode  > RFID_BLOCKWRITE_MODE_FORCE_TWO)     ||
@@ -5305,7 +5277,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioSetImpinjExtensions(
         }
 
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x,0x%.8x,0x%.8x,0x%.8x\n",
             __FUNCTION__,
@@ -5347,22 +5319,17 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioGetImpinjExtensions(
 
     try
     {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
         rfid::CplMutexAutoLock  radioLock;
         RadioWrapper*           pRadioWrapper;
 
-        // Create an explicit scope so that we release the library lock as soon
-        // as we have the radio lock
-        {
-            // Acquire the library lock
-            rfid::CplMutexAutoLock libraryLock;
-            libraryLock.Assume(AcquireLibraryLock());
-
-            // Get the radio object and wrap the lock so it is automatically
-            // released
-            pRadioWrapper = RetrieveAndLockRadio(handle);
-            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
-
-        }
+        // Get the radio object, without the library lock, wait for the
+        // operation that holds it, if any, to end and wrap the lock so it is
+        // automatically released
+        pRadioWrapper =
+            RetrieveAndLockRadioForQuery(handle, radioReference, radioQuery);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
 
         // Validate the parameters pointer
         if (NULL == pExtensions)
@@ -5370,7 +5337,7 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioGetImpinjExtensions(
             throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
         }
 
-        g_pTracer->PrintMessage(
+        RFID_TRACE(
             rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
             "%s,0x%.8x\n",
             __FUNCTION__,
@@ -5392,103 +5359,1307 @@ RFID_LIBRARY_API RFID_STATUS RFID_RadioGetImpinjExtensions(
 } // RFID_RadioGetImpinjExtensions
   
 
+#ifdef RFID_LIBRARY_EXTENSIONS
 
 ////////////////////////////////////////////////////////////////////////////////
-// File-scoped helper function defintions
-////////////////////////////////////////////////////////////////////////////////
-
-namespace
-{
-
-////////////////////////////////////////////////////////////////////////////////
-// Name: AcquireLibraryLock
+// Name: RFID_18K6CSetAccessRetryPolicy
 //
 // Description:
-//   Attempts to acquire the library lock.  If the library lock has not been
-//   initialized or if after acquiring the lock, it is determined that the 
-//   library is not initialized, then the lock fails and an exception is
-//   thrown (rfid::RfidErrorException).
+//   Configures how tag reads and writes respond to a failed tag access.  The
+//   policy may not be changed while the radio is executing a tag-protocol
+//   operation.
 ////////////////////////////////////////////////////////////////////////////////
-rfid::CplMutexHandle AcquireLibraryLock()
+RFID_LIBRARY_API RFID_STATUS RFID_18K6CSetAccessRetryPolicy(
+    RFID_RADIO_HANDLE                       handle,
+    const RFID_18K6C_ACCESS_RETRY_POLICY*   pPolicy
+    )
 {
-    // Make sure that the library has been initialized at least once
-    if (NULL == g_libraryLockHandle.get())
+    RFID_STATUS status = RFID_STATUS_OK;
+
+    try
     {
-        throw rfid::RfidErrorException(RFID_ERROR_NOT_INITIALIZED, __FUNCTION__);
-    }
+        RadioReference          radioReference;
+        rfid::CplMutexAutoLock  radioLock;
+        RadioWrapper*           pRadioWrapper;
 
-    // Lock the library and verify it is initialized
-    rfid::CplMutexAutoLock libraryLock(g_libraryLockHandle.get());
-    if (!g_libraryIsInitialized)
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
+
+        // Validate the parameters
+        if ((NULL == pPolicy)                                               ||
+            (sizeof(RFID_18K6C_ACCESS_RETRY_POLICY) != pPolicy->length)     ||
+            (0 == pPolicy->maxAttempts)                                     ||
+            (RFID_18K6C_MAX_ACCESS_ATTEMPTS < pPolicy->maxAttempts)         ||
+            (RFID_18K6C_MAX_ACCESS_BACKOFF < pPolicy->backoffTime)          ||
+            (RFID_18K6C_MAX_ACCESS_POWER_STEP < pPolicy->powerStep)         ||
+            (pPolicy->powerStep &&
+             (!pPolicy->maxPowerLevel                                       ||
+              (RFID_18K6C_MAX_ACCESS_POWER_LEVEL < pPolicy->maxPowerLevel))) ||
+            (pPolicy->antennaPortMask & ~((1 << (RFID_MAX_ANTENNA_PORT + 1)) - 1)))
+        {
+            throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+        }
+
+        RFID_TRACE(
+            rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
+            "%s,0x%.8x,0x%.8x,0x%.8x,0x%.8x,0x%.8x,0x%.8x\n",
+            __FUNCTION__,
+            handle,
+            pPolicy->maxAttempts,
+            pPolicy->backoffTime,
+            pPolicy->powerStep,
+            pPolicy->maxPowerLevel,
+            pPolicy->antennaPortMask);
+
+        // Let the radio object set the access retry policy
+        pRadioWrapper->GetRadioPointer()->Set18K6CAccessRetryPolicy(pPolicy);
+    }
+    catch (rfid::RfidErrorException& error)
     {
-        throw rfid::RfidErrorException(RFID_ERROR_NOT_INITIALIZED, __FUNCTION__);
+        status = error.GetError();
+    }
+    catch (...)
+    {
+        status = RFID_ERROR_FAILURE;
     }
 
-    // Now return the lock so that the caller can unlock when they are done
-    return libraryLock.Transfer();
-} // AcquireLibraryLock
+    return status;
+} // RFID_18K6CSetAccessRetryPolicy
 
 ////////////////////////////////////////////////////////////////////////////////
-// Name: GetRadioObject
+// Name: RFID_18K6CGetAccessRetryPolicy
 //
 // Description:
-//   Locates the pointer for the radio object that corresponds to the handle
-//   provided, throwing an RFID_ERROR_INVALID_HANDLE exception if it cannot
-//   be found
+//   Retrieves the access retry policy for the radio.  The policy may not be
+//   retrieved while the radio is executing a tag-protocol operation.
 ////////////////////////////////////////////////////////////////////////////////
-RadioWrapper* GetRadioObject(
-    RFID_RADIO_HANDLE   handle
+RFID_LIBRARY_API RFID_STATUS RFID_18K6CGetAccessRetryPolicy(
+    RFID_RADIO_HANDLE                   handle,
+    RFID_18K6C_ACCESS_RETRY_POLICY*     pPolicy
     )
 {
-    // Get the radio object from the table and verify that there
-    // actually is one.
-    RadioWrapper* pRadioWrapper = g_pActiveRadios->Get(handle);
-    if (NULL == pRadioWrapper)
+    RFID_STATUS status = RFID_STATUS_OK;
+
+    try
     {
-        g_pTracer->PrintMessage(
-            rfid::Tracer::RFID_LOG_SEVERITY_INFO,
-            "%s: Unable to find radio 0x%.8x\n",
+        RadioReference          radioReference;
+        RadioWrapper*           pRadioWrapper;
+
+        // Get the radio object, without the library lock.  This is served
+        // from the radio's snapshot, so the radio lock isn't needed.
+        pRadioWrapper = AcquireRadio(handle, radioReference);
+
+        // Validate the parameters
+        if ((NULL == pPolicy)                                           ||
+            (sizeof(RFID_18K6C_ACCESS_RETRY_POLICY) != pPolicy->length))
+        {
+            throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+        }
+
+        RFID_TRACE(
+            rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
+            "%s,0x%.8x\n",
             __FUNCTION__,
             handle);
-        throw rfid::RfidErrorException(RFID_ERROR_INVALID_HANDLE, __FUNCTION__);
+
+        // Let the radio object retrieve the access retry policy
+        pRadioWrapper->GetRadioPointer()->Get18K6CAccessRetryPolicy(pPolicy);
+    }
+    catch (rfid::RfidErrorException& error)
+    {
+        status = error.GetError();
+    }
+    catch (...)
+    {
+        status = RFID_ERROR_FAILURE;
     }
 
-    return pRadioWrapper;
-} // GetRadioObject
+    return status;
+} // RFID_18K6CGetAccessRetryPolicy
 
 ////////////////////////////////////////////////////////////////////////////////
-// Name: RetrieveAndLockRadio
+// Name: RFID_18K6CDefineSelectCriteriaSet
 //
 // Description:
-//   Gets the radio object and attempts to acquire the radio lock.  If the lock
-//   is already held the function fails and an exception is thrown
-//   (rfid::RfidErrorException).
+//   Validates a set of tag-selection criteria and caches it under an ID so
+//   that it can later be activated without being revalidated or recompiled.
 ////////////////////////////////////////////////////////////////////////////////
-RadioWrapper* RetrieveAndLockRadio(
-    RFID_RADIO_HANDLE   handle
+RFID_LIBRARY_API RFID_STATUS RFID_18K6CDefineSelectCriteriaSet(
+    RFID_RADIO_HANDLE                   handle,
+    INT32U                              setId,
+    const RFID_18K6C_SELECT_CRITERIA*   pCriteria,
+    INT32U                              flags
     )
 {
-    // First get the wrapper object for the radio
-    RadioWrapper* pRadioWrapper = GetRadioObject(handle);
+    RFID_STATUS status = RFID_STATUS_OK;
 
-    // Now, attempt to lock the radio
-    INT32U status;
-    status = CPL_MutexTryLock(pRadioWrapper->GetRadioLockHandle());
-    if (status)
+    RFID_UNREFERENCED_LOCAL(flags);
+
+    try
     {
-        g_pTracer->PrintMessage(
-            rfid::Tracer::RFID_LOG_SEVERITY_ERROR,
-            "%s: Unable to obtain lock for radio 0x%.8x\n",
-            __FUNCTION__,
-            handle);
+        RadioReference          radioReference;
+        rfid::CplMutexAutoLock  radioLock;
+        RadioWrapper*           pRadioWrapper;
+
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
+
+        // Validate the parameters
+        Validate18K6CSelectCriteria(pCriteria);
+
+        RFID_TRACE(
+            rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
+            "%s,0x%.8x,0x%.8x,0x%.8x\n",
+            __FUNCTION__,
+            handle,
+            setId,
+            pCriteria->countCriteria);
+
+        // Now that all parameters are validated, let the radio cache the set
+        pRadioWrapper->GetRadioPointer()->Define18K6CSelectCriteriaSet(setId, pCriteria);
+    }
+    catch (rfid::RfidErrorException& error)
+    {
+        status = error.GetError();
+    }
+    catch (...)
+    {
+        status = RFID_ERROR_FAILURE;
+    }
+
+    return status;
+} // RFID_18K6CDefineSelectCriteriaSet
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: RFID_18K6CActivateSelectCriteriaSet
+//
+// Description:
+//   Makes a previously-defined select criteria set the radio's tag-selection
+//   criteria.
+////////////////////////////////////////////////////////////////////////////////
+RFID_LIBRARY_API RFID_STATUS RFID_18K6CActivateSelectCriteriaSet(
+    RFID_RADIO_HANDLE   handle,
+    INT32U              setId,
+    INT32U              flags
+    )
+{
+    RFID_STATUS status = RFID_STATUS_OK;
+
+    RFID_UNREFERENCED_LOCAL(flags);
+
+    try
+    {
+        RadioReference          radioReference;
+        rfid::CplMutexAutoLock  radioLock;
+        RadioWrapper*           pRadioWrapper;
+
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
+
+        RFID_TRACE(
+            rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
+            "%s,0x%.8x,0x%.8x\n",
+            __FUNCTION__,
+            handle,
+            setId);
+
+        // Let the radio write the set to the MAC
+        pRadioWrapper->GetRadioPointer()->Activate18K6CSelectCriteriaSet(setId);
+    }
+    catch (rfid::RfidErrorException& error)
+    {
+        status = error.GetError();
+    }
+    catch (...)
+    {
+        status = RFID_ERROR_FAILURE;
+    }
+
+    return status;
+} // RFID_18K6CActivateSelectCriteriaSet
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: RFID_18K6CDeleteSelectCriteriaSet
+//
+// Description:
+//   Removes a previously-defined select criteria set.
+////////////////////////////////////////////////////////////////////////////////
+RFID_LIBRARY_API RFID_STATUS RFID_18K6CDeleteSelectCriteriaSet(
+    RFID_RADIO_HANDLE   handle,
+    INT32U              setId,
+    INT32U              flags
+    )
+{
+    RFID_STATUS status = RFID_STATUS_OK;
+
+    RFID_UNREFERENCED_LOCAL(flags);
+
+    try
+    {
+        RadioReference          radioReference;
+        rfid::CplMutexAutoLock  radioLock;
+        RadioWrapper*           pRadioWrapper;
+
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
+
+        RFID_TRACE(
+            rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
+            "%s,0x%.8x,0x%.8x\n",
+            __FUNCTION__,
+            handle,
+            setId);
+
+        // Let the radio forget the set
+        pRadioWrapper->GetRadioPointer()->Delete18K6CSelectCriteriaSet(setId);
+    }
+    catch (rfid::RfidErrorException& error)
+    {
+        status = error.GetError();
+    }
+    catch (...)
+    {
+        status = RFID_ERROR_FAILURE;
+    }
+
+    return status;
+} // RFID_18K6CDeleteSelectCriteriaSet
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: RFID_18K6CSetDynamicQTuner
+//
+// Description:
+//   Enables, disables or reconfigures the library's closed-loop tuning of the
+//   dynamic-Q singulation algorithm parameters.
+////////////////////////////////////////////////////////////////////////////////
+RFID_LIBRARY_API RFID_STATUS RFID_18K6CSetDynamicQTuner(
+    RFID_RADIO_HANDLE                       handle,
+    const RFID_18K6C_DYNAMICQ_TUNER_PARMS*  pParms
+    )
+{
+    RFID_STATUS status = RFID_STATUS_OK;
+
+    try
+    {
+        RadioReference          radioReference;
+        rfid::CplMutexAutoLock  radioLock;
+        RadioWrapper*           pRadioWrapper;
+
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
+
+        // Validate the parameters
+        if ((NULL == pParms)                                                 ||
+            (sizeof(RFID_18K6C_DYNAMICQ_TUNER_PARMS) != pParms->length)      ||
+            (RFID_18K6C_MAX_Q < pParms->maxQValue)                           ||
+            (pParms->minQValue > pParms->maxQValue)                          ||
+            (0 == pParms->thresholdMultiplier)                               ||
+            (RFID_18K6C_MAX_THRESH_MULTIPLIER < pParms->thresholdMultiplier) ||
+            (0 == pParms->responsiveness)                                    ||
+            (RFID_18K6C_MAX_TUNER_RESPONSIVENESS < pParms->responsiveness))
+        {
+            throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+        }
+
+        RFID_TRACE(
+            rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
+            "%s,0x%.8x,0x%.8x,0x%.8x,0x%.8x,0x%.8x,0x%.8x\n",
+            __FUNCTION__,
+            handle,
+            pParms->enabled,
+            pParms->minQValue,
+            pParms->maxQValue,
+            pParms->thresholdMultiplier,
+            pParms->responsiveness);
+
+        // Let the radio object configure the tuner
+        pRadioWrapper->GetRadioPointer()->SetDynamicQTuner(pParms);
+    }
+    catch (rfid::RfidErrorException& error)
+    {
+        status = error.GetError();
+    }
+    catch (...)
+    {
+        status = RFID_ERROR_FAILURE;
+    }
+
+    return status;
+} // RFID_18K6CSetDynamicQTuner
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: RFID_18K6CGetDynamicQTuner
+//
+// Description:
+//   Retrieves the dynamic-Q tuner configuration and, optionally, its current
+//   state.
+////////////////////////////////////////////////////////////////////////////////
+RFID_LIBRARY_API RFID_STATUS RFID_18K6CGetDynamicQTuner(
+    RFID_RADIO_HANDLE                   handle,
+    RFID_18K6C_DYNAMICQ_TUNER_PARMS*    pParms,
+    RFID_18K6C_DYNAMICQ_TUNER_STATUS*   pStatus
+    )
+{
+    RFID_STATUS status = RFID_STATUS_OK;
+
+    try
+    {
+        RadioReference          radioReference;
+        RadioWrapper*           pRadioWrapper;
+
+        // Get the radio object, without the library lock.  This is served
+        // from the radio's snapshot, so the radio lock isn't needed.
+        pRadioWrapper = AcquireRadio(handle, radioReference);
+
+        // Validate the parameters
+        if ((NULL == pParms)                                            ||
+            (sizeof(RFID_18K6C_DYNAMICQ_TUNER_PARMS) != pParms->length) ||
+            ((NULL != pStatus) &&
+             (sizeof(RFID_18K6C_DYNAMICQ_TUNER_STATUS) != pStatus->length)))
+        {
+            throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+        }
+
+        RFID_TRACE(
+            rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
+            "%s,0x%.8x\n",
+            __FUNCTION__,
+            handle);
+
+        // Let the radio object retrieve the tuner configuration and state
+        pRadioWrapper->GetRadioPointer()->GetDynamicQTuner(pParms, pStatus);
+    }
+    catch (rfid::RfidErrorException& error)
+    {
+        status = error.GetError();
+    }
+    catch (...)
+    {
+        status = RFID_ERROR_FAILURE;
+    }
+
+    return status;
+} // RFID_18K6CGetDynamicQTuner
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: RFID_RadioSetAntennaScheduler
+//
+// Description:
+//   Enables, disables or reconfigures the library's yield-weighted scheduling
+//   of the antenna ports' dwell times and inventory cycle counts.
+////////////////////////////////////////////////////////////////////////////////
+RFID_LIBRARY_API RFID_STATUS RFID_RadioSetAntennaScheduler(
+    RFID_RADIO_HANDLE                   handle,
+    const RFID_ANTENNA_SCHEDULER_PARMS* pParms
+    )
+{
+    RFID_STATUS status = RFID_STATUS_OK;
+
+    try
+    {
+        RadioReference          radioReference;
+        rfid::CplMutexAutoLock  radioLock;
+        RadioWrapper*           pRadioWrapper;
+
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
+
+        // Validate the parameters
+        if ((NULL == pParms)                                              ||
+            (sizeof(RFID_ANTENNA_SCHEDULER_PARMS) != pParms->length)      ||
+            (0 == pParms->minDwellTime)                                   ||
+            (pParms->minDwellTime > pParms->maxDwellTime)                 ||
+            (0 == pParms->minInventoryCycles)                             ||
+            (pParms->minInventoryCycles > pParms->maxInventoryCycles)     ||
+            (0 == pParms->responsiveness)                                 ||
+            (RFID_MAX_SCHEDULER_RESPONSIVENESS < pParms->responsiveness))
+        {
+            throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+        }
+
+        RFID_TRACE(
+            rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
+            "%s,0x%.8x,0x%.8x,0x%.8x,0x%.8x,0x%.8x,0x%.8x,0x%.8x\n",
+            __FUNCTION__,
+            handle,
+            pParms->enabled,
+            pParms->minDwellTime,
+            pParms->maxDwellTime,
+            pParms->minInventoryCycles,
+            pParms->maxInventoryCycles,
+            pParms->responsiveness);
+
+        // Let the radio object configure the scheduler
+        pRadioWrapper->GetRadioPointer()->SetAntennaScheduler(pParms);
+    }
+    catch (rfid::RfidErrorException& error)
+    {
+        status = error.GetError();
+    }
+    catch (...)
+    {
+        status = RFID_ERROR_FAILURE;
+    }
+
+    return status;
+} // RFID_RadioSetAntennaScheduler
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: RFID_RadioGetAntennaScheduler
+//
+// Description:
+//   Retrieves the antenna scheduler configuration.
+////////////////////////////////////////////////////////////////////////////////
+RFID_LIBRARY_API RFID_STATUS RFID_RadioGetAntennaScheduler(
+    RFID_RADIO_HANDLE               handle,
+    RFID_ANTENNA_SCHEDULER_PARMS*   pParms
+    )
+{
+    RFID_STATUS status = RFID_STATUS_OK;
+
+    try
+    {
+        RadioReference          radioReference;
+        RadioWrapper*           pRadioWrapper;
+
+        // Get the radio object, without the library lock.  This is served
+        // from the radio's snapshot, so the radio lock isn't needed.
+        pRadioWrapper = AcquireRadio(handle, radioReference);
+
+        // Validate the parameters
+        if ((NULL == pParms) ||
+            (sizeof(RFID_ANTENNA_SCHEDULER_PARMS) != pParms->length))
+        {
+            throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+        }
+
+        RFID_TRACE(
+            rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
+            "%s,0x%.8x\n",
+            __FUNCTION__,
+            handle);
+
+        // Let the radio object retrieve the scheduler configuration
+        pRadioWrapper->GetRadioPointer()->GetAntennaScheduler(pParms);
+    }
+    catch (rfid::RfidErrorException& error)
+    {
+        status = error.GetError();
+    }
+    catch (...)
+    {
+        status = RFID_ERROR_FAILURE;
+    }
+
+    return status;
+} // RFID_RadioGetAntennaScheduler
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: RFID_AntennaPortGetYield
+//
+// Description:
+//   Retrieves the new-tag yield the antenna scheduler has measured for an
+//   antenna port and the airtime it has scheduled for the port.
+////////////////////////////////////////////////////////////////////////////////
+RFID_LIBRARY_API RFID_STATUS RFID_AntennaPortGetYield(
+    RFID_RADIO_HANDLE           handle,
+    INT32U                      antennaPort,
+    RFID_ANTENNA_PORT_YIELD*    pYield
+    )
+{
+    RFID_STATUS status = RFID_STATUS_OK;
+
+    try
+    {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
+        rfid::CplMutexAutoLock  radioLock;
+        RadioWrapper*           pRadioWrapper;
+
+        // Get the radio object, without the library lock.  The radio is only
+        // locked if the answer isn't in its snapshot.
+        pRadioWrapper = AcquireRadio(handle, radioReference);
+
+        // Validate the parameters
+        if ((NULL == pYield) ||
+            (sizeof(RFID_ANTENNA_PORT_YIELD) != pYield->length))
+        {
+            throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+        }
+
+        RFID_TRACE(
+            rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
+            "%s,0x%.8x,0x%.8x\n",
+            __FUNCTION__,
+            handle,
+            antennaPort);
+
+        // Let the radio object retrieve the port's yield.  If the snapshot
+        // doesn't have the port's configuration yet, read it from the MAC.
+        if (!pRadioWrapper->GetRadioPointer()->GetAntennaPortYield(
+                antennaPort,
+                pYield))
+        {
+            RFID_ANTENNA_PORT_CONFIG config;
+
+            LockRadioForQuery(handle, pRadioWrapper, radioQuery);
+            radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
+
+            pRadioWrapper->GetRadioPointer()->GetAntennaPortConfiguration(
+                antennaPort,
+                &config);
+            pRadioWrapper->GetRadioPointer()->GetAntennaPortYield(
+                antennaPort,
+                pYield);
+        }
+    }
+    catch (rfid::RfidErrorException& error)
+    {
+        status = error.GetError();
+    }
+    catch (...)
+    {
+        status = RFID_ERROR_FAILURE;
+    }
+
+    return status;
+} // RFID_AntennaPortGetYield
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: RFID_18K6CSetPacketSubscription
+//
+// Description:
+//   Sets the packet types that an ISO 18000-6C tag-protocol operation passes
+//   to the application's packet callback.
+////////////////////////////////////////////////////////////////////////////////
+RFID_LIBRARY_API RFID_STATUS RFID_18K6CSetPacketSubscription(
+    RFID_RADIO_HANDLE               handle,
+    RFID_18K6C_OPERATION            operation,
+    const RFID_PACKET_SUBSCRIPTION* pSubscription
+    )
+{
+    RFID_STATUS status = RFID_STATUS_OK;
+
+    try
+    {
+        RadioReference          radioReference;
+        rfid::CplMutexAutoLock  radioLock;
+        RadioWrapper*           pRadioWrapper;
+
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
+
+        // Validate the parameters
+        if ((RFID_18K6C_OPERATION_LAST <= operation) ||
+            ((NULL != pSubscription) &&
+             (sizeof(RFID_PACKET_SUBSCRIPTION) != pSubscription->length)))
+        {
+            throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+        }
+
+        RFID_TRACE(
+            rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
+            "%s,0x%.8x,%u,0x%.8x,0x%.8x\n",
+            __FUNCTION__,
+            handle,
+            operation,
+            (NULL != pSubscription) ? pSubscription->commonPackets : ~0U,
+            (NULL != pSubscription) ? pSubscription->diagnosticsPackets : ~0U);
+
+        // Let the radio object record the subscription
+        pRadioWrapper->GetRadioPointer()->SetPacketSubscription(
+            operation,
+            pSubscription);
+    }
+    catch (rfid::RfidErrorException& error)
+    {
+        status = error.GetError();
+    }
+    catch (...)
+    {
+        status = RFID_ERROR_FAILURE;
+    }
+
+    return status;
+} // RFID_18K6CSetPacketSubscription
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: RFID_18K6CGetPacketSubscription
+//
+// Description:
+//   Retrieves the packet types that an ISO 18000-6C tag-protocol operation
+//   passes to the application's packet callback.
+////////////////////////////////////////////////////////////////////////////////
+RFID_LIBRARY_API RFID_STATUS RFID_18K6CGetPacketSubscription(
+    RFID_RADIO_HANDLE           handle,
+    RFID_18K6C_OPERATION        operation,
+    RFID_PACKET_SUBSCRIPTION*   pSubscription
+    )
+{
+    RFID_STATUS status = RFID_STATUS_OK;
+
+    try
+    {
+        RadioReference          radioReference;
+        RadioWrapper*           pRadioWrapper;
+
+        // Get the radio object, without the library lock.  This is served
+        // from the radio's snapshot, so the radio lock isn't needed.
+        pRadioWrapper = AcquireRadio(handle, radioReference);
+
+        // Validate the parameters
+        if ((RFID_18K6C_OPERATION_LAST <= operation) ||
+            (NULL == pSubscription) ||
+            (sizeof(RFID_PACKET_SUBSCRIPTION) != pSubscription->length))
+        {
+            throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+        }
+
+        RFID_TRACE(
+            rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
+            "%s,0x%.8x,%u\n",
+            __FUNCTION__,
+            handle,
+            operation);
+
+        // Let the radio object retrieve the subscription
+        pRadioWrapper->GetRadioPointer()->GetPacketSubscription(
+            operation,
+            pSubscription);
+    }
+    catch (rfid::RfidErrorException& error)
+    {
+        status = error.GetError();
+    }
+    catch (...)
+    {
+        status = RFID_ERROR_FAILURE;
+    }
+
+    return status;
+} // RFID_18K6CGetPacketSubscription
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: RFID_RadioGetClockModel
+//
+// Description:
+//   Retrieves the model of the host time at which the radio module's
+//   millisecond counter had a value.
+////////////////////////////////////////////////////////////////////////////////
+RFID_LIBRARY_API RFID_STATUS RFID_RadioGetClockModel(
+    RFID_RADIO_HANDLE       handle,
+    RFID_RADIO_CLOCK_MODEL* pModel
+    )
+{
+    RFID_STATUS status = RFID_STATUS_OK;
+
+    try
+    {
+        RadioReference          radioReference;
+        RadioWrapper*           pRadioWrapper;
+
+        // Get the radio object, without the library lock.  This is served
+        // from the radio's snapshot, so the radio lock isn't needed.
+        pRadioWrapper = AcquireRadio(handle, radioReference);
+
+        // Validate the parameters
+        if ((NULL == pModel) ||
+            (sizeof(RFID_RADIO_CLOCK_MODEL) != pModel->length))
+        {
+            throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+        }
+
+        // Let the radio object retrieve the model
+        pRadioWrapper->GetRadioPointer()->GetClockModel(pModel);
+    }
+    catch (rfid::RfidErrorException& error)
+    {
+        status = error.GetError();
+    }
+    catch (...)
+    {
+        status = RFID_ERROR_FAILURE;
+    }
+
+    return status;
+} // RFID_RadioGetClockModel
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: RFID_RadioMacTimeToHostTime
+//
+// Description:
+//   Converts a value of the radio module's millisecond counter to host time
+//   using a clock model.
+////////////////////////////////////////////////////////////////////////////////
+RFID_LIBRARY_API RFID_STATUS RFID_RadioMacTimeToHostTime(
+    const RFID_RADIO_CLOCK_MODEL*   pModel,
+    INT32U                          macTime,
+    INT64U*                         pHostTime
+    )
+{
+    // This is pure arithmetic, so neither the library nor the radio need be
+    // locked and it may be used freely from a packet callback
+    if ((NULL == pModel)                                  ||
+        (sizeof(RFID_RADIO_CLOCK_MODEL) != pModel->length) ||
+        !pModel->valid                                    ||
+        (NULL == pHostTime))
+    {
+        return RFID_ERROR_INVALID_PARAMETER;
+    }
+
+    *pHostTime = rfid::MacClock::GetHostTime(*pModel, macTime);
+
+    return RFID_STATUS_OK;
+} // RFID_RadioMacTimeToHostTime
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: RFID_RadioSetResponseTimeout
+//
+// Description:
+//   Sets how long the radio may stay silent before it is considered to have
+//   stopped responding.
+////////////////////////////////////////////////////////////////////////////////
+RFID_LIBRARY_API RFID_STATUS RFID_RadioSetResponseTimeout(
+    RFID_RADIO_HANDLE   handle,
+    INT32U              timeout
+    )
+{
+    RFID_STATUS status = RFID_STATUS_OK;
+
+    try
+    {
+        RadioReference          radioReference;
+        rfid::CplMutexAutoLock  radioLock;
+        RadioWrapper*           pRadioWrapper;
+
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
+
+        // Validate the parameters
+        if ((RFID_MIN_RESPONSE_TIMEOUT > timeout) ||
+            (RFID_MAX_RESPONSE_TIMEOUT < timeout))
+        {
+            throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+        }
+
+        RFID_TRACE(
+            rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
+            "%s,0x%.8x,%u\n",
+            __FUNCTION__,
+            handle,
+            timeout);
+
+        // Let the radio object record the timeout
+        pRadioWrapper->GetRadioPointer()->SetResponseTimeout(timeout);
+    }
+    catch (rfid::RfidErrorException& error)
+    {
+        status = error.GetError();
+    }
+    catch (...)
+    {
+        status = RFID_ERROR_FAILURE;
+    }
+
+    return status;
+} // RFID_RadioSetResponseTimeout
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: RFID_RadioGetResponseTimeout
+//
+// Description:
+//   Retrieves how long the radio may stay silent before it is considered to
+//   have stopped responding.
+////////////////////////////////////////////////////////////////////////////////
+RFID_LIBRARY_API RFID_STATUS RFID_RadioGetResponseTimeout(
+    RFID_RADIO_HANDLE   handle,
+    INT32U*             pTimeout
+    )
+{
+    RFID_STATUS status = RFID_STATUS_OK;
+
+    try
+    {
+        RadioReference          radioReference;
+        RadioWrapper*           pRadioWrapper;
+
+        // Get the radio object, without the library lock.  This is served
+        // from the radio's snapshot, so the radio lock isn't needed.
+        pRadioWrapper = AcquireRadio(handle, radioReference);
+
+        // Validate the parameters
+        if (NULL == pTimeout)
+        {
+            throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+        }
+
+        RFID_TRACE(
+            rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
+            "%s,0x%.8x\n",
+            __FUNCTION__,
+            handle);
+
+        // Let the radio object retrieve the timeout
+        *pTimeout = pRadioWrapper->GetRadioPointer()->GetResponseTimeout();
+    }
+    catch (rfid::RfidErrorException& error)
+    {
+        status = error.GetError();
+    }
+    catch (...)
+    {
+        status = RFID_ERROR_FAILURE;
+    }
+
+    return status;
+} // RFID_RadioGetResponseTimeout
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: RFID_RadioSaveConfiguration
+//
+// Description:
+//   Captures the radio module's configuration in a binary blob that
+//   RFID_RadioRestoreConfiguration can put back.
+////////////////////////////////////////////////////////////////////////////////
+RFID_LIBRARY_API RFID_STATUS RFID_RadioSaveConfiguration(
+    RFID_RADIO_HANDLE   handle,
+    INT8U*              pBuffer,
+    INT32U*             pLength
+    )
+{
+    RFID_STATUS status = RFID_STATUS_OK;
+
+    try
+    {
+        RadioReference          radioReference;
+        RadioQuery              radioQuery;
+        rfid::CplMutexAutoLock  radioLock;
+        RadioWrapper*           pRadioWrapper;
+
+        // Get the radio object, without the library lock, wait for the
+        // operation that holds it, if any, to end and wrap the lock so it is
+        // automatically released
+        pRadioWrapper =
+            RetrieveAndLockRadioForQuery(handle, radioReference, radioQuery);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
+
+        // Validate the parameters
+        if (NULL == pLength)
+        {
+            throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+        }
+
+        RFID_TRACE(
+            rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
+            "%s,0x%.8x,0x%.8x,%u\n",
+            __FUNCTION__,
+            handle,
+            pBuffer,
+            *pLength);
+
+        // Let the radio object capture the configuration
+        pRadioWrapper->GetRadioPointer()->SaveConfiguration(pBuffer, pLength);
+    }
+    catch (rfid::RfidErrorException& error)
+    {
+        status = error.GetError();
+    }
+    catch (...)
+    {
+        status = RFID_ERROR_FAILURE;
+    }
+
+    return status;
+} // RFID_RadioSaveConfiguration
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: RFID_RadioRestoreConfiguration
+//
+// Description:
+//   Puts back a configuration captured by RFID_RadioSaveConfiguration.
+////////////////////////////////////////////////////////////////////////////////
+RFID_LIBRARY_API RFID_STATUS RFID_RadioRestoreConfiguration(
+    RFID_RADIO_HANDLE   handle,
+    const INT8U*        pBuffer,
+    INT32U              length
+    )
+{
+    RFID_STATUS status = RFID_STATUS_OK;
+
+    try
+    {
+        RadioReference          radioReference;
+        rfid::CplMutexAutoLock  radioLock;
+        RadioWrapper*           pRadioWrapper;
+
+        // Get the radio object, without the library lock, and wrap the lock
+        // so it is automatically released
+        pRadioWrapper = RetrieveAndLockRadio(handle, radioReference);
+        radioLock.Assume(pRadioWrapper->GetRadioLockHandle());
+
+        // Validate the parameters
+        if (NULL == pBuffer)
+        {
+            throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+        }
+
+        RFID_TRACE(
+            rfid::Tracer::RFID_LOG_SEVERITY_TRACE,
+            "%s,0x%.8x,0x%.8x,%u\n",
+            __FUNCTION__,
+            handle,
+            pBuffer,
+            length);
+
+        // Let the radio object restore the configuration
+        pRadioWrapper->GetRadioPointer()->RestoreConfiguration(pBuffer, length);
+    }
+    catch (rfid::RfidErrorException& error)
+    {
+        status = error.GetError();
+    }
+    catch (...)
+    {
+        status = RFID_ERROR_FAILURE;
+    }
+
+    return status;
+} // RFID_RadioRestoreConfiguration
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: RFID_RadioGetStatistics
+//
+// Description:
+//   Retrieves what the library has done with the radio and how long it took.
+////////////////////////////////////////////////////////////////////////////////
+RFID_LIBRARY_API RFID_STATUS RFID_RadioGetStatistics(
+    RFID_RADIO_HANDLE       handle,
+    RFID_RADIO_STATISTICS*  pStatistics
+    )
+{
+    RFID_STATUS status = RFID_STATUS_OK;
+
+    try
+    {
+        RadioReference          radioReference;
+        RadioWrapper*           pRadioWrapper;
+
+        // Get the radio object, without the library lock.  The statistics
+        // are kept with interlocked updates, so the radio lock isn't needed.
+        pRadioWrapper = AcquireRadio(handle, radioReference);
+
+        // Validate the parameters
+        if ((NULL == pStatistics) ||
+            (sizeof(RFID_RADIO_STATISTICS) != pStatistics->length))
+        {
+            throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+        }
+
+        pRadioWrapper->GetRadioPointer()->GetStatistics().Get(pStatistics);
+        g_libraryLockWait.Get(&pStatistics->libraryLockWait);
+    }
+    catch (rfid::RfidErrorException& error)
+    {
+        status = error.GetError();
+    }
+    catch (...)
+    {
+        status = RFID_ERROR_FAILURE;
+    }
+
+    return status;
+} // RFID_RadioGetStatistics
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: RFID_RadioResetStatistics
+//
+// Description:
+//   Sets the radio's counters to zero and empties its histograms.
+////////////////////////////////////////////////////////////////////////////////
+RFID_LIBRARY_API RFID_STATUS RFID_RadioResetStatistics(
+    RFID_RADIO_HANDLE   handle
+    )
+{
+    RFID_STATUS status = RFID_STATUS_OK;
+
+    try
+    {
+        RadioReference          radioReference;
+        RadioWrapper*           pRadioWrapper;
+
+        // Get the radio object, without the library lock
+        pRadioWrapper = AcquireRadio(handle, radioReference);
+
+        pRadioWrapper->GetRadioPointer()->GetStatistics().Reset();
+    }
+    catch (rfid::RfidErrorException& error)
+    {
+        status = error.GetError();
+    }
+    catch (...)
+    {
+        status = RFID_ERROR_FAILURE;
+    }
+
+    return status;
+} // RFID_RadioResetStatistics
+
+#endif // RFID_LIBRARY_EXTENSIONS
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// File-scoped helper function defintions
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: AcquireLibraryLock
+//
+// Description:
+//   Attempts to acquire the library lock.  If the library lock has not been
+//   initialized or if after acquiring the lock, it is determined that the 
+//   library is not initialized, then the lock fails and an exception is
+//   thrown (rfid::RfidErrorException).
+////////////////////////////////////////////////////////////////////////////////
+rfid::CplMutexHandle AcquireLibraryLock()
+{
+    // Make sure that the library has been initialized at least once
+    if (NULL == g_libraryLockHandle.get())
+    {
+        throw rfid::RfidErrorException(RFID_ERROR_NOT_INITIALIZED, __FUNCTION__);
+    }
+
+    // Lock the library and verify it is initialized
+    INT64U waitStart = rfid::StatisticsClock::Now();
+    rfid::CplMutexAutoLock libraryLock(g_libraryLockHandle.get());
+    g_libraryLockWait.Record(rfid::StatisticsClock::Now() - waitStart);
+    if (!g_libraryIsInitialized)
+    {
+        throw rfid::RfidErrorException(RFID_ERROR_NOT_INITIALIZED, __FUNCTION__);
+    }
+
+    // Now return the lock so that the caller can unlock when they are done
+    return libraryLock.Transfer();
+} // AcquireLibraryLock
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: GetRadioObject
+//
+// Description:
+//   Locates the pointer for the radio object that corresponds to the handle
+//   provided, throwing an RFID_ERROR_INVALID_HANDLE exception if it cannot
+//   be found
+////////////////////////////////////////////////////////////////////////////////
+RadioWrapper* GetRadioObject(
+    RFID_RADIO_HANDLE   handle
+    )
+{
+    // Get the radio object from the table and verify that there
+    // actually is one.
+    RadioWrapper* pRadioWrapper = g_pActiveRadios->Get(handle);
+    if (NULL == pRadioWrapper)
+    {
+        RFID_TRACE(
+            rfid::Tracer::RFID_LOG_SEVERITY_INFO,
+            "%s: Unable to find radio 0x%.8x\n",
+            __FUNCTION__,
+            handle);
+        throw rfid::RfidErrorException(RFID_ERROR_INVALID_HANDLE, __FUNCTION__);
+    }
+
+    return pRadioWrapper;
+} // GetRadioObject
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: AcquireRadio
+//
+// Description:
+//   Gets the radio object without taking the library lock and takes a
+//   reference to it.  Throws an RFID_ERROR_NOT_INITIALIZED or
+//   RFID_ERROR_INVALID_HANDLE exception (rfid::RfidErrorException) on failure.
+////////////////////////////////////////////////////////////////////////////////
+RadioWrapper* AcquireRadio(
+    RFID_RADIO_HANDLE   handle,
+    RadioReference&     reference
+    )
+{
+    // Shutdown removes every radio from the table before it marks the library
+    // as not initialized, so a radio that can be acquired is still usable
+    if ((NULL == g_pActiveRadios.get()) || !g_libraryIsInitialized)
+    {
+        throw rfid::RfidErrorException(RFID_ERROR_NOT_INITIALIZED, __FUNCTION__);
+    }
+
+    RadioWrapper* pRadioWrapper = g_pActiveRadios->Acquire(handle);
+    if (NULL == pRadioWrapper)
+    {
+        // The library may have been shut down since it was checked, in which
+        // case the tracer may be gone too
+        if (!g_libraryIsInitialized)
+        {
+            throw rfid::RfidErrorException(RFID_ERROR_NOT_INITIALIZED, __FUNCTION__);
+        }
+        RFID_TRACE(
+            rfid::Tracer::RFID_LOG_SEVERITY_INFO,
+            "%s: Unable to find radio 0x%.8x\n",
+            __FUNCTION__,
+            handle);
+        throw rfid::RfidErrorException(RFID_ERROR_INVALID_HANDLE, __FUNCTION__);
+    }
+    reference.Assume(handle);
+
+    return pRadioWrapper;
+} // AcquireRadio
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: RetrieveAndLockRadio
+//
+// Description:
+//   Gets the radio object, and a reference to it, and attempts to acquire the
+//   radio lock.  If the lock is already held the function fails and an
+//   exception is thrown (rfid::RfidErrorException).
+////////////////////////////////////////////////////////////////////////////////
+RadioWrapper* RetrieveAndLockRadio(
+    RFID_RADIO_HANDLE   handle,
+    RadioReference&     reference
+    )
+{
+    // First get the wrapper object for the radio
+    RadioWrapper* pRadioWrapper = AcquireRadio(handle, reference);
+    INT64U        waitStart     = rfid::StatisticsClock::Now();
+
+    // Let the queries that were made while the radio was busy go first, but
+    // don't let a steady stream of them hold the operation off for good
+    if (pRadioWrapper->HasQueries())
+    {
+        CPL_TimeSpec startTime;
+        CPL_TimeSpecGet(&startTime);
+
+        INT32U waited;
+        while (pRadioWrapper->HasQueries() &&
+               ((waited = MillisecondsSince(startTime)) < QUERY_GIVE_WAY_MILLIS))
+        {
+            INT32U       remaining = QUERY_GIVE_WAY_MILLIS - waited;
+            CPL_TimeSpec interval;
+            interval.seconds     = static_cast<INT32S>(remaining / 1000);
+            interval.nanoseconds = static_cast<INT32S>(remaining % 1000) * 1000000;
+            pRadioWrapper->WaitForQueries(interval);
+        }
+    }
+
+    // Now, attempt to lock the radio
+    INT32U status;
+    status = CPL_MutexTryLock(pRadioWrapper->GetRadioLockHandle());
+    if (status)
+    {
+        RFID_TRACE(
+            rfid::Tracer::RFID_LOG_SEVERITY_ERROR,
+            "%s: Unable to obtain lock for radio 0x%.8x\n",
+            __FUNCTION__,
+            handle);
         throw rfid::RfidErrorException(CPL_WARN_WOULDBLOCK == status ?
                                             RFID_ERROR_RADIO_BUSY :
                                             RFID_ERROR_FAILURE, __FUNCTION__);
     }
+    pRadioWrapper->GetRadioPointer()->GetStatistics().RecordRadioLockWait(
+        rfid::StatisticsClock::Now() - waitStart);
 
     return pRadioWrapper;
 } // RetrieveAndLockRadio
 
+////////////////////////////////////////////////////////////////////////////////
+// Name: RetrieveAndLockRadioForQuery
+//
+// Description:
+//   Gets the radio object, and a reference to it, and acquires the radio lock
+//   for a query that needs the MAC, waiting for the operation that holds it
+//   to end.
+////////////////////////////////////////////////////////////////////////////////
+RadioWrapper* RetrieveAndLockRadioForQuery(
+    RFID_RADIO_HANDLE   handle,
+    RadioReference&     reference,
+    RadioQuery&         query
+    )
+{
+    // First get the wrapper object for the radio
+    RadioWrapper* pRadioWrapper = AcquireRadio(handle, reference);
+
+    // Now, wait for the radio lock
+    LockRadioForQuery(handle, pRadioWrapper, query);
+
+    return pRadioWrapper;
+} // RetrieveAndLockRadioForQuery
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: LockRadioForQuery
+//
+// Description:
+//   Acquires the radio lock for a query that needs the MAC, for a radio that
+//   the caller has already acquired.
+////////////////////////////////////////////////////////////////////////////////
+void LockRadioForQuery(
+    RFID_RADIO_HANDLE   handle,
+    RadioWrapper*       pRadioWrapper,
+    RadioQuery&         query
+    )
+{
+    // Get in line ahead of the next operation
+    query.Begin(pRadioWrapper);
+
+    // Wait for the lock.  Operations give way to the queries that are
+    // counted, so it is released when the command that holds it ends.
+    INT64U waitStart = rfid::StatisticsClock::Now();
+    INT32U status    = CPL_MutexLock(pRadioWrapper->GetRadioLockHandle());
+    if (status)
+    {
+        RFID_TRACE(
+            rfid::Tracer::RFID_LOG_SEVERITY_ERROR,
+            "%s: Unable to obtain lock for radio 0x%.8x\n",
+            __FUNCTION__,
+            handle);
+        throw rfid::RfidErrorException(RFID_ERROR_FAILURE, __FUNCTION__);
+    }
+    pRadioWrapper->GetRadioPointer()->GetStatistics().RecordRadioLockWait(
+        rfid::StatisticsClock::Now() - waitStart);
+} // LockRadioForQuery
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: MillisecondsSince
+//
+// Description:
+//   Determines how much time has passed since a moment
+////////////////////////////////////////////////////////////////////////////////
+INT32U MillisecondsSince(
+    const CPL_TimeSpec& startTime
+    )
+{
+    CPL_TimeSpec currentTime;
+    CPL_TimeSpecGet(&currentTime);
+    CPL_TimeSpecDiff(&currentTime, &startTime);
+
+    return static_cast<INT32U>(currentTime.seconds) * 1000 +
+        currentTime.nanoseconds / 1000000;
+} // MillisecondsSince
+
 ////////////////////////////////////////////////////////////////////////////////
 // Name: CloseAndDeleteRadioCallback
 //
@@ -5508,18 +6679,16 @@ ActiveRadioTable::CALLBACK_STATUS CloseAndDeleteRadioCallback(
 {
     RFID_UNREFERENCED_LOCAL(context);
 
-    g_pTracer->PrintMessage(
+    RFID_TRACE(
         rfid::Tracer::RFID_LOG_SEVERITY_INFO,
         "%s: Close and delete radio 0x%.8x\n",
         __FUNCTION__,
         handle);
 
-    // Close the radio and delete the object
-    CloseAndDeleteRadioObject(pRadioWrapper);
+    // Close the radio, remove it from the table and delete the object
+    CloseAndDeleteRadioObject(handle, pRadioWrapper);
 
-    // Let the active radios table know that it can remove the entry as we have
-    // deleted the object
-    return ActiveRadioTable::CALLBACK_STATUS_REMOVE_AND_CONTINUE;
+    return ActiveRadioTable::CALLBACK_STATUS_CONTINUE;
 } // CloseAndDeleteRadioCallback
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -5534,45 +6703,73 @@ ActiveRadioTable::CALLBACK_STATUS CloseAndDeleteRadioCallback(
 //
 ////////////////////////////////////////////////////////////////////////////////
 void CloseAndDeleteRadioObject(
-    RadioWrapper*   pRadioWrapper
+    RFID_RADIO_HANDLE   handle,
+    RadioWrapper*       pRadioWrapper
     )
 {
+    // Make sure that no other thread is using the radio.  If we are not
+    // allowed to close the radio, then let this exception percolate up.
+    RetireRadio(handle, pRadioWrapper);
+
+    // Wrap the radio wrapper with an auto_ptr to ensure that it gets destroyed
+    // on exit from the function (no matter what).  The wrapper will ensure that
+    // the radio and its lock are properly deleted.
+    std::auto_ptr<RadioWrapper> pWrapper(pRadioWrapper);
+    g_pActiveRadios->Remove(handle);
+
     // Tell the radio to close
     try
     {
         pRadioWrapper->GetRadioPointer()->Close();
     }
-    catch (rfid::RfidErrorException& error)
-    {
-        // If we are not allowed to close the radio, then let this exception
-        // percolate up
-        if (RFID_ERROR_CURRENTLY_NOT_ALLOWED == error.GetError())
-        {
-            throw;
-        }
-    }
     catch (...)
     {
     }
+} // CloseAndDeleteRadioObject
 
-    // Wrap the radio wrapper with an auto_ptr to ensure that it gets destroyed
-    // on exit from the function (no matter what).  The wrapper will ensure that
-    // the radio and its lock are properly deleted.
-    std::auto_ptr<RadioWrapper> pWrapper(pRadioWrapper);
+////////////////////////////////////////////////////////////////////////////////
+// Name: RetireRadio
+//
+// Description:
+//   Takes a radio out of service before it is closed or reset
+//
+//   NOTE: On entry to the function, it is assumed that the library has already
+//   been locked.
+//
+////////////////////////////////////////////////////////////////////////////////
+void RetireRadio(
+    RFID_RADIO_HANDLE   handle,
+    RadioWrapper*       pRadioWrapper
+    )
+{
+    // From here on, no other thread can acquire the radio
+    g_pActiveRadios->Retire(handle);
 
-    // Wait for the radio lock to ensure that the radio is not in use any more.
-    // We only care about threads that may have retrieved and locked the radio
-    // pointer before this function was called.  During this callback, the
-    // library is locked so other threads will be blocked until the callback is
-    // finished.
+    // The thread running an operation holds its reference until the operation
+    // ends, so end it, and any operation that a thread which acquired the
+    // radio before it was retired starts from now on.  A radio cannot be taken out of service from its own
+    // packet callback, as that thread's reference would never be released.
     try
     {
-        rfid::CplMutexAutoLock lock(pRadioWrapper->GetRadioLockHandle());
+        pRadioWrapper->GetRadioPointer()->Retire();
+    }
+    catch (rfid::RfidErrorException& error)
+    {
+        if (RFID_ERROR_CURRENTLY_NOT_ALLOWED == error.GetError())
+        {
+            g_pActiveRadios->Reinstate(handle);
+            throw;
+        }
     }
     catch (...)
     {
     }
-} // CloseAndDeleteRadioObject
+
+    // Wait for the threads that acquired the radio before it was retired to
+    // release it.  As the radio lock is only held along with a reference, the
+    // radio is not in use any more when it returns.
+    g_pActiveRadios->Drain(handle);
+} // RetireRadio
 
 ////////////////////////////////////////////////////////////////////////////////
 // Name: Validate18K6CCommonParameters
@@ -5727,6 +6924,129 @@ void Validate18K6CTagGroup(
     } // switch (pGroup->target)
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Name: Validate18K6CSelectCriteria
+//
+// Description:
+//   Validates the fields in the 18K6C select criteria structures.  Throws an
+//   RFID_ERROR_INVALID_PARAMETER exception of one of the fields is invalid
+//
+// Parameters:
+//   pCriteria - a pointer to the select criteria structure
+//
+// Returns:
+//   Nothing.
+////////////////////////////////////////////////////////////////////////////////
+void Validate18K6CSelectCriteria(
+    const RFID_18K6C_SELECT_CRITERIA*   pCriteria
+    )
+{
+    if ((NULL == pCriteria) ||
+        ((0 != pCriteria->countCriteria) && (NULL == pCriteria->pCriteria)))
+    {
+        throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+    }
+
+    // Validate each of the selection criteria
+    INT32U                             index;
+    const RFID_18K6C_SELECT_CRITERION* pCriterion;
+
+    for (index = 0, pCriterion = pCriteria->pCriteria;
+         index < pCriteria->countCriteria;
+         ++index, ++pCriterion)
+    {
+        const RFID_18K6C_SELECT_MASK*   pMask   = &pCriterion->mask;
+        const RFID_18K6C_SELECT_ACTION* pAction = &pCriterion->action;
+
+        // Validate the mask bank
+        switch (pMask->bank)
+        {
+            // Valid memory banks
+            case RFID_18K6C_MEMORY_BANK_EPC:
+            case RFID_18K6C_MEMORY_BANK_TID:
+            case RFID_18K6C_MEMORY_BANK_USER:
+            {
+                break;
+            }
+            // Invalid memory banks
+            case RFID_18K6C_MEMORY_BANK_RESERVED:
+            default:
+            {
+                throw rfid::RfidErrorException(
+                    RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+                break;
+            }
+        } // switch (pMask->bank)
+
+        // Validate the mask bit count
+        if (RFID_18K6C_MAX_SELECT_MASK_CNT < pMask->count)
+        {
+            throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+        }
+
+        // Validate the action target
+        switch (pAction->target)
+        {
+            // Valid targets
+            case RFID_18K6C_TARGET_INVENTORY_S0:
+            case RFID_18K6C_TARGET_INVENTORY_S1:
+            case RFID_18K6C_TARGET_INVENTORY_S2:
+            case RFID_18K6C_TARGET_INVENTORY_S3:
+            case RFID_18K6C_TARGET_SELECTED:
+            {
+                break;
+            }
+            // Invalid targets
+            default:
+            {
+                throw rfid::RfidErrorException(
+                    RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+                break;
+            }
+        } // switch (pAction->target)
+
+        // Validate the matching/non-matching action combination.  We'll
+        // arbitrarily pick the match action and then verify that the
+        // non-matching action is valid when used with the matching action.
+        switch (pAction->action)
+        {
+            // Valid actions
+            case RFID_18K6C_ACTION_ASLINVA_DSLINVB:
+            case RFID_18K6C_ACTION_ASLINVA_NOTHING:
+            case RFID_18K6C_ACTION_NOTHING_DSLINVB: 
+            case RFID_18K6C_ACTION_NSLINVS_NOTHING:
+            case RFID_18K6C_ACTION_DSLINVB_ASLINVA:
+            case RFID_18K6C_ACTION_DSLINVB_NOTHING:
+            case RFID_18K6C_ACTION_NOTHING_ASLINVA:
+            case RFID_18K6C_ACTION_NOTHING_NSLINVS:
+            {
+                break;
+            }
+            // Invalid actions
+            default:
+            {
+                throw rfid::RfidErrorException(
+                    RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+                break;
+            }
+        } // switch (pAction->action)
+
+        // If truncate was requested, then it is only valid if the
+        // memory bank is EPC, the target is the SL flag, and this is
+        // the last selection criterion
+        //if (pAction->enableTruncate                             &&
+        //    ((RFID_18K6C_MEMORY_BANK_EPC != pMask->bank)     ||
+        //     (RFID_18K6C_TARGET_SELECTED != pAction->target) ||
+        //     ((pCriteria->countCriteria - 1) != index)))
+        // 
+        // DMS:  MAC Firmware does not yest support truncation.
+        if (pAction->enableTruncate)
+        {
+            throw rfid::RfidErrorException(RFID_ERROR_INVALID_PARAMETER, __FUNCTION__);
+        }
+    } // for (...)
+} // Validate18K6CSelectCriteria
+
 ////////////////////////////////////////////////////////////////////////////////
 // Name: Validate18K6CSingulationAlgorithmParameters
 //
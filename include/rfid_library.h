@@ -51,7 +51,19 @@ extern "C" {
  * Parameters:
  *   pLibraryVersion - pointer to structure that on return will contain the
  *     version of the library.  May be NULL if not required by application.
- *   flags - library startup flags.  There are no flags defined at this time.
+ *   flags - library startup flags.  Zero, or:
+ *     RFID_FLAG_SYNTHETIC_RADIOS - instead of the attached radios, enumerate
+ *       and open synthetic radios, whose MACs answer every command at once.
+ *       They read tag populations of 1, 100, 1,000 and 10,000 tags, in the
+ *       order they are enumerated, and are meant for measuring the library
+ *       and the application without a radio.
+ *     RFID_FLAG_CAPTURE_PACKETS - capture every packet the radios send, with
+ *       the host time and the radio's cookie, to rfid_library.rcap in the
+ *       current directory.  The packets are written by a background thread,
+ *       in chunks indexed by time and packet type, and are decoded offline
+ *       with packet_capture_decode.  A packet that arrives when the capture
+ *       is too far behind is dropped from the capture (and counted), never
+ *       delayed.
  *
  * Returns:
  *   RFID_STATUS_OK
@@ -21,7 +21,7 @@
  *     This file contains the required entry point for the DLL.
  *     
  * Contents:
- *     DllMain() - main DLL entry point
+ *     DllMain() - main DLL entry point, which registers the library's probes
  *     
  *
  *****************************************************************************
@@ -29,6 +29,12 @@
 
 #include <windows.h>
 #include "rfid_platform_types.h"
+#include "rfid_probes.h"
+
+// The library's probes (5b7e231f-7f17-5060-4d09-2f2467c0293f)
+RFID_PROBE_DEFINE_PROVIDER(
+    "Impinj.Rfid.Library",
+    (0x5b7e231f, 0x7f17, 0x5060, 0x4d, 0x09, 0x2f, 0x24, 0x67, 0xc0, 0x29, 0x3f));
 
 ////////////////////////////////////////////////////////////////////////////////
 // Name: DllMain
@@ -60,8 +66,10 @@ BOOL APIENTRY DllMain(HANDLE hModule,
     switch (ulReason)
     {
         case DLL_PROCESS_ATTACH:
+            RFID_PROBE_REGISTER();
             break;
         case DLL_PROCESS_DETACH:
+            RFID_PROBE_UNREGISTER();
             break;
         case DLL_THREAD_ATTACH:
             break;
@@ -27,6 +27,8 @@
 #ifndef RFID_LIBRARY_EXT_H_INCLUDED
 #define RFID_LIBRARY_EXT_H_INCLUDED
 
+#include "rfid_types.h"
+#include "rfid_structs.h"
 #include "rfid_library_export.h"
 #include "rfid_error.h"
 
@@ -34,6 +36,647 @@
 extern "C" {
 #endif
 
+/******************************************************************************
+ * Name: RFID_18K6CSetAccessRetryPolicy
+ *
+ * Description:
+ *   Configures how RFID_18K6CTagRead and RFID_18K6CTagWrite respond to a
+ *   failed tag access.  After each attempt the library classifies the
+ *   outcome reported in the tag-access packets.  If no tag was accessed, or
+ *   the failure is recoverable (e.g., no reply, bad CRC, tag lost or
+ *   insufficient power), the command is reissued.  Before each retry the
+ *   library may wait, raise the antenna power and/or switch to the next
+ *   antenna port, as specified by the policy.  The MAC error is cleared
+ *   between attempts only if the command actually ended with an error.  The
+ *   packets for every attempt are passed to the application callback.  A
+ *   cancel or abort requested between attempts ends the access, which then
+ *   fails with RFID_ERROR_OPERATION_CANCELLED.  The policy remains in effect
+ *   until a subsequent call to RFID_18K6CSetAccessRetryPolicy.  The default
+ *   policy issues each access command once.  The policy may not be changed
+ *   while the radio is executing a tag-protocol operation.
+ *
+ * Parameters:
+ *   handle - handle to radio upon which the retry policy will be configured.
+ *     This is the handle from a successful call to RFID_RadioOpen.
+ *   pPolicy - a pointer to a structure that specifies the retry policy.  This
+ *     parameter must not be NULL.
+ *
+ * Returns:
+ *   RFID_STATUS_OK
+ *   RFID_ERROR_NOT_INITIALIZED
+ *   RFID_ERROR_INVALID_HANDLE
+ *   RFID_ERROR_INVALID_PARAMETER
+ *   RFID_ERROR_RADIO_BUSY
+ ******************************************************************************/
+RFID_LIBRARY_API RFID_STATUS RFID_18K6CSetAccessRetryPolicy(
+    RFID_RADIO_HANDLE                       handle,
+    const RFID_18K6C_ACCESS_RETRY_POLICY*   pPolicy
+    );
+
+/******************************************************************************
+ * Name: RFID_18K6CGetAccessRetryPolicy
+ *
+ * Description:
+ *   Retrieves the access retry policy for the radio.  The policy may not be
+ *   retrieved while the radio is executing a tag-protocol operation.
+ *
+ * Parameters:
+ *   handle - handle to radio for which the retry policy will be retrieved.
+ *     This is the handle from a successful call to RFID_RadioOpen.
+ *   pPolicy - a pointer to a structure that upon return contains the retry
+ *     policy.  The application must set the length field to
+ *     sizeof(RFID_18K6C_ACCESS_RETRY_POLICY).  This parameter must not be
+ *     NULL.
+ *
+ * Returns:
+ *   RFID_STATUS_OK
+ *   RFID_ERROR_NOT_INITIALIZED
+ *   RFID_ERROR_INVALID_HANDLE
+ *   RFID_ERROR_INVALID_PARAMETER
+ *   RFID_ERROR_RADIO_BUSY
+ ******************************************************************************/
+RFID_LIBRARY_API RFID_STATUS RFID_18K6CGetAccessRetryPolicy(
+    RFID_RADIO_HANDLE                   handle,
+    RFID_18K6C_ACCESS_RETRY_POLICY*     pPolicy
+    );
+
+/******************************************************************************
+ * Name: RFID_18K6CDefineSelectCriteriaSet
+ *
+ * Description:
+ *   Validates a set of tag-selection criteria and caches it in the library
+ *   under an application-chosen ID.  Defining a set does not change the
+ *   radio's current selection criteria; the set takes effect only when it is
+ *   activated with RFID_18K6CActivateSelectCriteriaSet.  Defining a set with
+ *   the ID of an existing set replaces it.  At most 64 sets may be defined
+ *   for a radio.  A set may not be defined while the radio is executing a
+ *   tag-protocol operation.
+ *
+ * Parameters:
+ *   handle - handle to radio for which the selection criteria set will be
+ *     defined.  This is the handle from a successful call to RFID_RadioOpen.
+ *   setId - the ID under which the selection criteria set will be cached.
+ *   pCriteria - a pointer to a structure that specifies the ISO 18000-6C
+ *     tag-selection criteria, with the same requirements as for
+ *     RFID_18K6CSetSelectCriteria.  This parameter must not be NULL.
+ *   flags - Reserved for future use.  Set to zero.
+ *
+ * Returns:
+ *   RFID_STATUS_OK
+ *   RFID_ERROR_NOT_INITIALIZED
+ *   RFID_ERROR_INVALID_HANDLE
+ *   RFID_ERROR_INVALID_PARAMETER
+ *   RFID_ERROR_OUT_OF_MEMORY
+ *   RFID_ERROR_RADIO_BUSY
+ ******************************************************************************/
+RFID_LIBRARY_API RFID_STATUS RFID_18K6CDefineSelectCriteriaSet(
+    RFID_RADIO_HANDLE                   handle,
+    INT32U                              setId,
+    const RFID_18K6C_SELECT_CRITERIA*   pCriteria,
+    INT32U                              flags
+    );
+
+/******************************************************************************
+ * Name: RFID_18K6CActivateSelectCriteriaSet
+ *
+ * Description:
+ *   Makes a set defined with RFID_18K6CDefineSelectCriteriaSet the radio's
+ *   tag-selection criteria, as if it had been passed to
+ *   RFID_18K6CSetSelectCriteria.  Only the MAC registers whose contents
+ *   differ from the criteria last written by the library are written, so
+ *   switching between sets that share descriptors is cheap.  A set may not be
+ *   activated while the radio is executing a tag-protocol operation.
+ *
+ * Parameters:
+ *   handle - handle to radio for which the selection criteria set will be
+ *     activated.  This is the handle from a successful call to
+ *     RFID_RadioOpen.
+ *   setId - the ID of a previously-defined selection criteria set.
+ *   flags - Reserved for future use.  Set to zero.
+ *
+ * Returns:
+ *   RFID_STATUS_OK
+ *   RFID_ERROR_NOT_INITIALIZED
+ *   RFID_ERROR_INVALID_HANDLE
+ *   RFID_ERROR_INVALID_PARAMETER
+ *   RFID_ERROR_RADIO_BUSY
+ ******************************************************************************/
+RFID_LIBRARY_API RFID_STATUS RFID_18K6CActivateSelectCriteriaSet(
+    RFID_RADIO_HANDLE   handle,
+    INT32U              setId,
+    INT32U              flags
+    );
+
+/******************************************************************************
+ * Name: RFID_18K6CDeleteSelectCriteriaSet
+ *
+ * Description:
+ *   Removes a set defined with RFID_18K6CDefineSelectCriteriaSet.  Deleting
+ *   a set does not change the radio's current selection criteria.  A set may
+ *   not be deleted while the radio is executing a tag-protocol operation.
+ *
+ * Parameters:
+ *   handle - handle to radio for which the selection criteria set will be
+ *     deleted.  This is the handle from a successful call to RFID_RadioOpen.
+ *   setId - the ID of a previously-defined selection criteria set.
+ *   flags - Reserved for future use.  Set to zero.
+ *
+ * Returns:
+ *   RFID_STATUS_OK
+ *   RFID_ERROR_NOT_INITIALIZED
+ *   RFID_ERROR_INVALID_HANDLE
+ *   RFID_ERROR_INVALID_PARAMETER
+ *   RFID_ERROR_RADIO_BUSY
+ ******************************************************************************/
+RFID_LIBRARY_API RFID_STATUS RFID_18K6CDeleteSelectCriteriaSet(
+    RFID_RADIO_HANDLE   handle,
+    INT32U              setId,
+    INT32U              flags
+    );
+
+/******************************************************************************
+ * Name: RFID_18K6CSetDynamicQTuner
+ *
+ * Description:
+ *   Enables, disables or reconfigures the library's closed-loop tuning of the
+ *   dynamic-Q singulation algorithm.  While enabled, every
+ *   RFID_18K6CTagInventory has the MAC report inventory-cycle diagnostics.
+ *   From the collision and empty-slot counts of each cycle the library
+ *   estimates the number of tags in the field and, before the next inventory
+ *   starts, sets the starting Q to suit that population, narrows or widens
+ *   the range the MAC may move Q within, and lowers the Q-adjustment
+ *   threshold while the population is changing quickly.  The diagnostics
+ *   packets the application did not request through
+ *   RFID_RadioSetResponseDataMode are not passed to the application's
+ *   callback.  Enabling the tuner resets its population estimate.  The
+ *   dynamic-Q parameters the tuner writes are those returned by
+ *   RFID_18K6CGetSingulationAlgorithmParameters; retryCount and toggleTarget
+ *   are left as the application set them.  The tuner may not be configured
+ *   while the radio is executing a tag-protocol operation.
+ *
+ * Parameters:
+ *   handle - handle to radio for which the tuner will be configured.  This is
+ *     the handle from a successful call to RFID_RadioOpen.
+ *   pParms - a pointer to a structure that specifies the tuner configuration.
+ *     This parameter must not be NULL.
+ *
+ * Returns:
+ *   RFID_STATUS_OK
+ *   RFID_ERROR_NOT_INITIALIZED
+ *   RFID_ERROR_INVALID_HANDLE
+ *   RFID_ERROR_INVALID_PARAMETER
+ *   RFID_ERROR_RADIO_BUSY
+ *   RFID_ERROR_RADIO_FAILURE
+ *   RFID_ERROR_RADIO_NOT_PRESENT
+ ******************************************************************************/
+RFID_LIBRARY_API RFID_STATUS RFID_18K6CSetDynamicQTuner(
+    RFID_RADIO_HANDLE                       handle,
+    const RFID_18K6C_DYNAMICQ_TUNER_PARMS*  pParms
+    );
+
+/******************************************************************************
+ * Name: RFID_18K6CGetDynamicQTuner
+ *
+ * Description:
+ *   Retrieves the dynamic-Q tuner configuration and, optionally, its current
+ *   state.  The tuner configuration may not be retrieved while the radio is
+ *   executing a tag-protocol operation.
+ *
+ * Parameters:
+ *   handle - handle to radio for which the tuner configuration will be
+ *     retrieved.  This is the handle from a successful call to
+ *     RFID_RadioOpen.
+ *   pParms - a pointer to a structure that upon return contains the tuner
+ *     configuration.  The application must set the length field to
+ *     sizeof(RFID_18K6C_DYNAMICQ_TUNER_PARMS).  This parameter must not be
+ *     NULL.
+ *   pStatus - a pointer to a structure that upon return contains the tuner
+ *     state.  The application must set the length field to
+ *     sizeof(RFID_18K6C_DYNAMICQ_TUNER_STATUS).  May be NULL if the state is
+ *     not wanted.
+ *
+ * Returns:
+ *   RFID_STATUS_OK
+ *   RFID_ERROR_NOT_INITIALIZED
+ *   RFID_ERROR_INVALID_HANDLE
+ *   RFID_ERROR_INVALID_PARAMETER
+ *   RFID_ERROR_RADIO_BUSY
+ ******************************************************************************/
+RFID_LIBRARY_API RFID_STATUS RFID_18K6CGetDynamicQTuner(
+    RFID_RADIO_HANDLE                   handle,
+    RFID_18K6C_DYNAMICQ_TUNER_PARMS*    pParms,
+    RFID_18K6C_DYNAMICQ_TUNER_STATUS*   pStatus
+    );
+
+/******************************************************************************
+ * Name: RFID_RadioSetAntennaScheduler
+ *
+ * Description:
+ *   Enables, disables or reconfigures the library's yield-weighted scheduling
+ *   of the antenna ports' airtime.  While enabled, the library watches the
+ *   antenna and inventory packets of every RFID_18K6CTagInventory and counts,
+ *   for each logical antenna port, the tags it reads that no port has read
+ *   earlier in the same antenna cycle.  At the end of each antenna cycle the
+ *   configured dwell times (and inventory cycle counts) of the enabled ports
+ *   are shared out again in proportion to that yield, never below the floor
+ *   or above the ceiling in the scheduler configuration, and the new values
+ *   are written before the next inventory starts.  With the radio in
+ *   continuous operation mode, the schedule therefore only takes effect when
+ *   the inventory is restarted.  Disabling the scheduler restores the dwell
+ *   times and inventory cycle counts the application configured.  Enabling it
+ *   forgets the yields measured earlier.  The scheduler may not be configured
+ *   while the radio is executing a tag-protocol operation.
+ *
+ * Parameters:
+ *   handle - handle to radio for which the scheduler will be configured.  This
+ *     is the handle from a successful call to RFID_RadioOpen.
+ *   pParms - a pointer to a structure that specifies the scheduler
+ *     configuration.  This parameter must not be NULL.
+ *
+ * Returns:
+ *   RFID_STATUS_OK
+ *   RFID_ERROR_NOT_INITIALIZED
+ *   RFID_ERROR_INVALID_HANDLE
+ *   RFID_ERROR_INVALID_PARAMETER
+ *   RFID_ERROR_RADIO_BUSY
+ *   RFID_ERROR_RADIO_FAILURE
+ *   RFID_ERROR_RADIO_NOT_PRESENT
+ ******************************************************************************/
+RFID_LIBRARY_API RFID_STATUS RFID_RadioSetAntennaScheduler(
+    RFID_RADIO_HANDLE                   handle,
+    const RFID_ANTENNA_SCHEDULER_PARMS* pParms
+    );
+
+/******************************************************************************
+ * Name: RFID_RadioGetAntennaScheduler
+ *
+ * Description:
+ *   Retrieves the antenna scheduler configuration.  The scheduler
+ *   configuration may not be retrieved while the radio is executing a
+ *   tag-protocol operation.
+ *
+ * Parameters:
+ *   handle - handle to radio for which the scheduler configuration will be
+ *     retrieved.  This is the handle from a successful call to
+ *     RFID_RadioOpen.
+ *   pParms - a pointer to a structure that upon return contains the scheduler
+ *     configuration.  The application must set the length field to
+ *     sizeof(RFID_ANTENNA_SCHEDULER_PARMS).  This parameter must not be NULL.
+ *
+ * Returns:
+ *   RFID_STATUS_OK
+ *   RFID_ERROR_NOT_INITIALIZED
+ *   RFID_ERROR_INVALID_HANDLE
+ *   RFID_ERROR_INVALID_PARAMETER
+ *   RFID_ERROR_RADIO_BUSY
+ ******************************************************************************/
+RFID_LIBRARY_API RFID_STATUS RFID_RadioGetAntennaScheduler(
+    RFID_RADIO_HANDLE               handle,
+    RFID_ANTENNA_SCHEDULER_PARMS*   pParms
+    );
+
+/******************************************************************************
+ * Name: RFID_AntennaPortGetYield
+ *
+ * Description:
+ *   Retrieves the new-tag yield the antenna scheduler has measured for a
+ *   logical antenna port and the dwell time and inventory cycle count it has
+ *   scheduled for the port.  The yield may not be retrieved while the radio
+ *   is executing a tag-protocol operation.
+ *
+ * Parameters:
+ *   handle - handle to radio for which the yield will be retrieved.  This is
+ *     the handle from a successful call to RFID_RadioOpen.
+ *   antennaPort - the logical antenna port.  Must be less than the number of
+ *     logical antenna ports the radio supports.
+ *   pYield - a pointer to a structure that upon return contains the port's
+ *     yield.  The application must set the length field to
+ *     sizeof(RFID_ANTENNA_PORT_YIELD).  This parameter must not be NULL.
+ *
+ * Returns:
+ *   RFID_STATUS_OK
+ *   RFID_ERROR_NOT_INITIALIZED
+ *   RFID_ERROR_INVALID_HANDLE
+ *   RFID_ERROR_INVALID_PARAMETER
+ *   RFID_ERROR_RADIO_BUSY
+ *   RFID_ERROR_RADIO_FAILURE
+ *   RFID_ERROR_RADIO_NOT_PRESENT
+ ******************************************************************************/
+RFID_LIBRARY_API RFID_STATUS RFID_AntennaPortGetYield(
+    RFID_RADIO_HANDLE           handle,
+    INT32U                      antennaPort,
+    RFID_ANTENNA_PORT_YIELD*    pYield
+    );
+
+/******************************************************************************
+ * Name: RFID_18K6CSetPacketSubscription
+ *
+ * Description:
+ *   Sets the packet types that an ISO 18000-6C tag-protocol operation passes
+ *   to the packet callback the application supplies with the operation.  The
+ *   library still processes every packet itself, so the operation completes
+ *   and reports errors as usual whatever the subscription.  Where possible,
+ *   the radio module is also told not to produce packets that are neither
+ *   subscribed to nor needed by the library (see RFID_PACKET_SUBSCRIPTION).
+ *   By default, every operation passes on every packet.  The subscription
+ *   may not be set while the radio is executing a tag-protocol operation.
+ *
+ * Parameters:
+ *   handle - handle to radio for which the subscription will be set.  This
+ *     is the handle from a successful call to RFID_RadioOpen.
+ *   operation - the tag-protocol operation the subscription applies to.
+ *   pSubscription - a pointer to the packet types to pass on.  The
+ *     application must set the length field to
+ *     sizeof(RFID_PACKET_SUBSCRIPTION).  If NULL, every packet is passed on.
+ *
+ * Returns:
+ *   RFID_STATUS_OK
+ *   RFID_ERROR_NOT_INITIALIZED
+ *   RFID_ERROR_INVALID_HANDLE
+ *   RFID_ERROR_INVALID_PARAMETER
+ *   RFID_ERROR_RADIO_BUSY
+ ******************************************************************************/
+RFID_LIBRARY_API RFID_STATUS RFID_18K6CSetPacketSubscription(
+    RFID_RADIO_HANDLE               handle,
+    RFID_18K6C_OPERATION            operation,
+    const RFID_PACKET_SUBSCRIPTION* pSubscription
+    );
+
+/******************************************************************************
+ * Name: RFID_18K6CGetPacketSubscription
+ *
+ * Description:
+ *   Retrieves the packet types that an ISO 18000-6C tag-protocol operation
+ *   passes to the application's packet callback.  The subscription may not
+ *   be retrieved while the radio is executing a tag-protocol operation.
+ *
+ * Parameters:
+ *   handle - handle to radio for which the subscription will be retrieved.
+ *     This is the handle from a successful call to RFID_RadioOpen.
+ *   operation - the tag-protocol operation whose subscription is wanted.
+ *   pSubscription - a pointer to a structure that upon return contains the
+ *     subscription.  The application must set the length field to
+ *     sizeof(RFID_PACKET_SUBSCRIPTION).  This parameter must not be NULL.
+ *
+ * Returns:
+ *   RFID_STATUS_OK
+ *   RFID_ERROR_NOT_INITIALIZED
+ *   RFID_ERROR_INVALID_HANDLE
+ *   RFID_ERROR_INVALID_PARAMETER
+ *   RFID_ERROR_RADIO_BUSY
+ ******************************************************************************/
+RFID_LIBRARY_API RFID_STATUS RFID_18K6CGetPacketSubscription(
+    RFID_RADIO_HANDLE           handle,
+    RFID_18K6C_OPERATION        operation,
+    RFID_PACKET_SUBSCRIPTION*   pSubscription
+    );
+
+/******************************************************************************
+ * Name: RFID_RadioGetClockModel
+ *
+ * Description:
+ *   Retrieves the library's model of the host time at which the radio
+ *   module's millisecond counter (the ms_ctr field of many packets) had a
+ *   value.  Together with RFID_RadioMacTimeToHostTime, this gives a tag read
+ *   a host timestamp free of the transport and queueing delays of the packet
+ *   carrying it.  The model only changes while the radio executes an
+ *   operation, so an application typically retrieves it after each
+ *   operation.  It may also be retrieved from within a packet callback.
+ *
+ * Parameters:
+ *   handle - handle to radio for which the model will be retrieved.  This is
+ *     the handle from a successful call to RFID_RadioOpen.
+ *   pModel - a pointer to a structure that upon return contains the model.
+ *     The application must set the length field to
+ *     sizeof(RFID_RADIO_CLOCK_MODEL).  This parameter must not be NULL.
+ *
+ * Returns:
+ *   RFID_STATUS_OK
+ *   RFID_ERROR_NOT_INITIALIZED
+ *   RFID_ERROR_INVALID_HANDLE
+ *   RFID_ERROR_INVALID_PARAMETER
+ ******************************************************************************/
+RFID_LIBRARY_API RFID_STATUS RFID_RadioGetClockModel(
+    RFID_RADIO_HANDLE       handle,
+    RFID_RADIO_CLOCK_MODEL* pModel
+    );
+
+/******************************************************************************
+ * Name: RFID_RadioMacTimeToHostTime
+ *
+ * Description:
+ *   Converts a value of the radio module's millisecond counter to the host
+ *   time, in milliseconds since midnight GMT, January 1, 1970, at which the
+ *   radio module had it.  The conversion is arithmetic only, so it is cheap
+ *   enough to apply to every tag read and may be called from anywhere,
+ *   including a packet callback.  Counter values up to about 24 days either
+ *   side of the model's reference are converted correctly.
+ *
+ * Parameters:
+ *   pModel - a pointer to a model retrieved by RFID_RadioGetClockModel.  Its
+ *     valid field must be non-zero.  This parameter must not be NULL.
+ *   macTime - the counter value, e.g., the ms_ctr field of a packet,
+ *     converted to host byte order.
+ *   pHostTime - a pointer to a variable that upon return contains the host
+ *     time.  This parameter must not be NULL.
+ *
+ * Returns:
+ *   RFID_STATUS_OK
+ *   RFID_ERROR_INVALID_PARAMETER
+ ******************************************************************************/
+RFID_LIBRARY_API RFID_STATUS RFID_RadioMacTimeToHostTime(
+    const RFID_RADIO_CLOCK_MODEL*   pModel,
+    INT32U                          macTime,
+    INT64U*                         pHostTime
+    );
+
+/******************************************************************************
+ * Name: RFID_RadioSetResponseTimeout
+ *
+ * Description:
+ *   Sets how long the radio module may send nothing while the library waits
+ *   for data before the radio is considered to have stopped responding, and
+ *   the operation fails with RFID_ERROR_RADIO_NOT_RESPONDING.  During long
+ *   operations, the radio module sends a command-active packet after 3
+ *   seconds without other packets, so the timeout can be little more than
+ *   that.  The default is 7 seconds.  Applies only to radio modules with MAC
+ *   firmware 2.4.0 or later.  The timeout may not be set while the radio is
+ *   executing a tag-protocol operation.
+ *
+ * Parameters:
+ *   handle - handle to radio for which the timeout will be set.  This is the
+ *     handle from a successful call to RFID_RadioOpen.
+ *   timeout - the timeout in milliseconds.  Valid values are 3500 to 60000,
+ *     inclusive.
+ *
+ * Returns:
+ *   RFID_STATUS_OK
+ *   RFID_ERROR_NOT_INITIALIZED
+ *   RFID_ERROR_INVALID_HANDLE
+ *   RFID_ERROR_INVALID_PARAMETER
+ *   RFID_ERROR_RADIO_BUSY
+ ******************************************************************************/
+RFID_LIBRARY_API RFID_STATUS RFID_RadioSetResponseTimeout(
+    RFID_RADIO_HANDLE   handle,
+    INT32U              timeout
+    );
+
+/******************************************************************************
+ * Name: RFID_RadioGetResponseTimeout
+ *
+ * Description:
+ *   Retrieves how long the radio module may send nothing before it is
+ *   considered to have stopped responding.
+ *
+ * Parameters:
+ *   handle - handle to radio for which the timeout will be retrieved.  This
+ *     is the handle from a successful call to RFID_RadioOpen.
+ *   pTimeout - a pointer to a variable that upon return contains the timeout
+ *     in milliseconds.  This parameter must not be NULL.
+ *
+ * Returns:
+ *   RFID_STATUS_OK
+ *   RFID_ERROR_NOT_INITIALIZED
+ *   RFID_ERROR_INVALID_HANDLE
+ *   RFID_ERROR_INVALID_PARAMETER
+ ******************************************************************************/
+RFID_LIBRARY_API RFID_STATUS RFID_RadioGetResponseTimeout(
+    RFID_RADIO_HANDLE   handle,
+    INT32U*             pTimeout
+    );
+
+/******************************************************************************
+ * Name: RFID_RadioSaveConfiguration
+ *
+ * Description:
+ *   Captures the radio module's host-configurable settings in a binary blob:
+ *   the antenna port descriptors and antenna cycle count, the select and
+ *   post-singulation match criteria, the query tag group, the singulation
+ *   algorithm and its parameters, the Impinj extensions and the current link
+ *   profile.  The blob starts with a magic number and a version, is
+ *   protected by a CRC and may be kept (e.g., in a file) to configure the
+ *   same kind of radio module later with RFID_RadioRestoreConfiguration.
+ *   Settings the library keeps rather than the radio module (e.g., the
+ *   dynamic-Q tuner, antenna scheduler, access retry policy and packet
+ *   subscriptions) are not included.  The configuration may not be saved
+ *   while the radio is executing a tag-protocol operation.
+ *
+ * Parameters:
+ *   handle - handle to radio whose configuration will be saved.  This is the
+ *     handle from a successful call to RFID_RadioOpen.
+ *   pBuffer - a pointer to a buffer that upon return contains the blob.  May
+ *     be NULL if *pLength is zero.
+ *   pLength - a pointer to a variable that on entry contains the size, in
+ *     bytes, of the buffer and upon return contains the size of the blob.  If
+ *     the buffer is too small, the size of the blob is still returned.  This
+ *     parameter must not be NULL.
+ *
+ * Returns:
+ *   RFID_STATUS_OK
+ *   RFID_ERROR_NOT_INITIALIZED
+ *   RFID_ERROR_INVALID_HANDLE
+ *   RFID_ERROR_INVALID_PARAMETER
+ *   RFID_ERROR_BUFFER_TOO_SMALL
+ *   RFID_ERROR_RADIO_BUSY
+ *   RFID_ERROR_RADIO_FAILURE
+ *   RFID_ERROR_RADIO_NOT_PRESENT
+ ******************************************************************************/
+RFID_LIBRARY_API RFID_STATUS RFID_RadioSaveConfiguration(
+    RFID_RADIO_HANDLE   handle,
+    INT8U*              pBuffer,
+    INT32U*             pLength
+    );
+
+/******************************************************************************
+ * Name: RFID_RadioRestoreConfiguration
+ *
+ * Description:
+ *   Configures the radio module from a blob returned by
+ *   RFID_RadioSaveConfiguration.  The link profile is changed only if it
+ *   differs from the radio module's current one, and the registers are
+ *   written in a single pipelined sequence that is checked once at the end,
+ *   which makes this much faster than configuring the radio module setting by
+ *   setting.  If the radio module rejects the configuration (e.g., because
+ *   it has fewer antenna ports than the one that saved it), it may be left
+ *   partly configured.  The configuration may not be restored while the
+ *   radio is executing a tag-protocol operation.
+ *
+ * Parameters:
+ *   handle - handle to radio that will be configured.  This is the handle
+ *     from a successful call to RFID_RadioOpen.
+ *   pBuffer - a pointer to the blob.  This parameter must not be NULL.
+ *   length - the size, in bytes, of the blob.
+ *
+ * Returns:
+ *   RFID_STATUS_OK
+ *   RFID_ERROR_NOT_INITIALIZED
+ *   RFID_ERROR_INVALID_HANDLE
+ *   RFID_ERROR_INVALID_PARAMETER
+ *   RFID_ERROR_RADIO_BUSY
+ *   RFID_ERROR_RADIO_FAILURE
+ *   RFID_ERROR_RADIO_NOT_PRESENT
+ ******************************************************************************/
+RFID_LIBRARY_API RFID_STATUS RFID_RadioRestoreConfiguration(
+    RFID_RADIO_HANDLE   handle,
+    const INT8U*        pBuffer,
+    INT32U              length
+    );
+
+/******************************************************************************
+ * Name: RFID_RadioGetStatistics
+ *
+ * Description:
+ *   Retrieves what the library has done with the radio since it was opened
+ *   or its statistics were last reset: register accesses, transport reads,
+ *   packets, packet callbacks, cancels, aborts and timeouts, and histograms
+ *   of register round trips, packet interarrival times, packet callback
+ *   durations and lock waits.  Comparing the round trips and interarrival
+ *   times with the callback durations and lock waits shows whether time is
+ *   going to the radio module or to the host.  The statistics are always
+ *   kept, cost little, and may be retrieved at any time, including while the
+ *   radio is executing a tag-protocol operation and from within a packet
+ *   callback.
+ *
+ * Parameters:
+ *   handle - handle to radio for which the statistics will be retrieved.
+ *     This is the handle from a successful call to RFID_RadioOpen.
+ *   pStatistics - a pointer to a structure that upon return contains the
+ *     statistics.  The application must set the length field to
+ *     sizeof(RFID_RADIO_STATISTICS).  This parameter must not be NULL.
+ *
+ * Returns:
+ *   RFID_STATUS_OK
+ *   RFID_ERROR_NOT_INITIALIZED
+ *   RFID_ERROR_INVALID_HANDLE
+ *   RFID_ERROR_INVALID_PARAMETER
+ ******************************************************************************/
+RFID_LIBRARY_API RFID_STATUS RFID_RadioGetStatistics(
+    RFID_RADIO_HANDLE       handle,
+    RFID_RADIO_STATISTICS*  pStatistics
+    );
+
+/******************************************************************************
+ * Name: RFID_RadioResetStatistics
+ *
+ * Description:
+ *   Sets the radio's counters to zero and empties its histograms, except for
+ *   the library lock wait, which all radios share.  The statistics may be
+ *   reset at any time, including while the radio is executing a
+ *   tag-protocol operation.
+ *
+ * Parameters:
+ *   handle - handle to radio for which the statistics will be reset.  This
+ *     is the handle from a successful call to RFID_RadioOpen.
+ *
+ * Returns:
+ *   RFID_STATUS_OK
+ *   RFID_ERROR_NOT_INITIALIZED
+ *   RFID_ERROR_INVALID_HANDLE
+ ******************************************************************************/
+RFID_LIBRARY_API RFID_STATUS RFID_RadioResetStatistics(
+    RFID_RADIO_HANDLE   handle
+    );
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,113 @@
+/*
+ *****************************************************************************
+ *                                                                           *
+ *                 IMPINJ CONFIDENTIAL AND PROPRIETARY                       *
+ *                                                                           *
+ * This source code is the sole property of Impinj, Inc.  Reproduction or    *
+ * utilization of this source code in whole or in part is forbidden without  *
+ * the prior written consent of Impinj, Inc.                                 *
+ *                                                                           *
+ * (c) Copyright Impinj, Inc. 2009. All rights reserved.                     *
+ *                                                                           *
+ *****************************************************************************
+ */
+
+/*
+ *****************************************************************************
+ *
+ * $Id$
+ *
+ * Description:
+ *     This header defines the static probes placed at the library's hot-path
+ *     events.  A probe costs a test of a flag (Windows) or a no-op
+ *     instruction (Linux) until something attaches to it, so the probes are
+ *     always compiled in:
+ *
+ *     - On Windows a probe is a TraceLogging (ETW) event of the binary's
+ *       provider, e.g. for the library:
+ *
+ *           tracelog -start rfid -f rfid.etl -guid *Impinj.Rfid.Library
+ *
+ *     - On Linux, where <sys/sdt.h> is available, a probe is a USDT probe
+ *       of provider rfid, e.g.:
+ *
+ *           bpftrace -e 'usdt:librfid.so:rfid:callback_exit { ... }'
+ *
+ *     Every argument is passed as a signed 64-bit integer.  Define
+ *     RFID_PROBES_DISABLED to leave the probes out.
+ *
+ *
+ *****************************************************************************
+ */
+
+#ifndef RFID_PROBES_H_INCLUDED
+#define RFID_PROBES_H_INCLUDED
+
+#include "rfid_platform_types.h"
+
+#if !defined(RFID_PROBES_DISABLED)
+#if defined(_WIN32) && !defined(_WIN32_WCE)
+#define RFID_PROBES_ETW
+#elif defined(__linux__) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define RFID_PROBES_SDT
+#endif
+#endif
+#endif
+
+#if defined(RFID_PROBES_ETW)
+
+#include <windows.h>
+#include <TraceLoggingProvider.h>
+
+// Each binary (the library, an application) has its own provider, which one
+// of its files defines with RFID_PROBE_DEFINE_PROVIDER.  Its GUID must be the
+// one ETW derives from its name, so that it can be enabled by name.
+TRACELOGGING_DECLARE_PROVIDER(g_hRfidProbes);
+
+#define RFID_PROBE_DEFINE_PROVIDER(name, guid)                              \
+    TRACELOGGING_DEFINE_PROVIDER(g_hRfidProbes, name, guid)
+#define RFID_PROBE_REGISTER()       TraceLoggingRegister(g_hRfidProbes)
+#define RFID_PROBE_UNREGISTER()     TraceLoggingUnregister(g_hRfidProbes)
+
+// The arguments are only evaluated when the event is enabled
+#define RFID_PROBE2(probe, n1, v1, n2, v2)                                  \
+    TraceLoggingWrite(                                                      \
+        g_hRfidProbes,                                                      \
+        #probe,                                                             \
+        TraceLoggingInt64((INT64S)(v1), #n1),                               \
+        TraceLoggingInt64((INT64S)(v2), #n2))
+#define RFID_PROBE3(probe, n1, v1, n2, v2, n3, v3)                          \
+    TraceLoggingWrite(                                                      \
+        g_hRfidProbes,                                                      \
+        #probe,                                                             \
+        TraceLoggingInt64((INT64S)(v1), #n1),                               \
+        TraceLoggingInt64((INT64S)(v2), #n2),                               \
+        TraceLoggingInt64((INT64S)(v3), #n3))
+
+#elif defined(RFID_PROBES_SDT)
+
+#include <sys/sdt.h>
+
+// USDT probes need no registration; the argument names are for the reader
+#define RFID_PROBE_DEFINE_PROVIDER(name, guid)
+#define RFID_PROBE_REGISTER()       ((void) 0)
+#define RFID_PROBE_UNREGISTER()     ((void) 0)
+
+#define RFID_PROBE2(probe, n1, v1, n2, v2)                                  \
+    DTRACE_PROBE2(rfid, probe, (INT64S)(v1), (INT64S)(v2))
+#define RFID_PROBE3(probe, n1, v1, n2, v2, n3, v3)                          \
+    DTRACE_PROBE3(rfid, probe, (INT64S)(v1), (INT64S)(v2), (INT64S)(v3))
+
+#else
+
+#define RFID_PROBE_DEFINE_PROVIDER(name, guid)
+#define RFID_PROBE_REGISTER()       ((void) 0)
+#define RFID_PROBE_UNREGISTER()     ((void) 0)
+
+#define RFID_PROBE2(probe, n1, v1, n2, v2)                  ((void) 0)
+#define RFID_PROBE3(probe, n1, v1, n2, v2, n3, v3)          ((void) 0)
+
+#endif
+
+#endif // #ifndef RFID_PROBES_H_INCLUDED
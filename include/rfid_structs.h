@@ -877,4 +877,294 @@ typedef struct {
     RFID_FAST_ID                  fastId;
 } RFID_IMPINJ_EXTENSIONS;
 
+/******************************************************************************
+ * Name:  RFID_18K6C_ACCESS_RETRY_POLICY - Specifies how the library reissues
+ *        an ISO 18000-6C tag read or write whose tag access failed.
+ ******************************************************************************/
+typedef struct {
+    /* The length of the structure in bytes.  Application must set this to    */
+    /* sizeof(RFID_18K6C_ACCESS_RETRY_POLICY).                                */
+    INT32U  length;
+    /* The maximum number of times the access command is issued, including    */
+    /* the first attempt.  A value of 1 disables retries.  Only failures that */
+    /* are considered recoverable (e.g., no reply, bad CRC, tag lost or       */
+    /* insufficient power) are retried; failures such as an invalid password  */
+    /* or locked memory are reported immediately.  Valid values are 1 to 16,  */
+    /* inclusive.                                                             */
+    INT32U  maxAttempts;
+    /* The number of milliseconds to wait before the first retry.  The delay  */
+    /* doubles for each subsequent retry.  Zero retries immediately.  Valid   */
+    /* values are 0 to 1000, inclusive.                                       */
+    INT32U  backoffTime;
+    /* The amount, in 0.1 (i.e., 1/10th) dBm, by which the power level of the */
+    /* enabled logical antenna ports is raised for each retry.  The original  */
+    /* power levels are restored once the operation completes.  Zero leaves   */
+    /* the power levels unchanged.  Valid values are 0 to 100, inclusive.     */
+    INT32U  powerStep;
+    /* The power level, in 0.1 (i.e., 1/10th) dBm, that a stepped-up power    */
+    /* level will not exceed.  A port configured above this level keeps its   */
+    /* configured level.  Ignored if powerStep is zero; otherwise, valid      */
+    /* values are 1 to 330, inclusive.                                        */
+    INT32U  maxPowerLevel;
+    /* A bit mask of logical antenna ports (bit 0 is logical port 0) to       */
+    /* rotate through on retries.  For each retry, only the next port in the  */
+    /* mask is enabled.  The original antenna port states are restored once   */
+    /* the operation completes.  Zero disables antenna switching.             */
+    INT32U  antennaPortMask;
+} RFID_18K6C_ACCESS_RETRY_POLICY;
+
+/******************************************************************************
+ * Name:  RFID_18K6C_DYNAMICQ_TUNER_PARMS - Configures the library's closed-
+ *        loop tuning of the dynamic-Q singulation algorithm parameters.
+ ******************************************************************************/
+typedef struct {
+    /* The length of the structure in bytes.  Application must set this to    */
+    /* sizeof(RFID_18K6C_DYNAMICQ_TUNER_PARMS).                               */
+    INT32U  length;
+    /* A non-zero value enables the tuner.  While enabled, the library turns  */
+    /* on the inventory-cycle diagnostics packets for each inventory (the     */
+    /* packets the application did not ask for are not passed to its          */
+    /* callback), estimates the tag population from the collision and         */
+    /* empty-slot counts of each inventory cycle and, before the next         */
+    /* inventory is started, rewrites the starting, minimum and maximum Q     */
+    /* values and the Q-adjustment threshold multiplier of the dynamic-Q      */
+    /* algorithm.  The tuner only has an effect when the dynamic-Q algorithm  */
+    /* is the current singulation algorithm.                                  */
+    BOOL32  enabled;
+    /* The lowest Q value the tuner may configure.  Valid values are 0 to 15, */
+    /* inclusive.                                                             */
+    INT32U  minQValue;
+    /* The highest Q value the tuner may configure.  Valid values are 0 to    */
+    /* 15, inclusive, and must not be less than minQValue.                    */
+    INT32U  maxQValue;
+    /* The Q-adjustment threshold multiplier, in units of fourths (i.e.,      */
+    /* 0.25), used while the tag population is steady.  While the population  */
+    /* is changing quickly the tuner halves it so that the MAC adjusts Q      */
+    /* sooner.  Valid values are 1 to 255, inclusive.                         */
+    INT32U  thresholdMultiplier;
+    /* The weight, in percent, that the newest inventory cycle carries in the */
+    /* population estimate.  Larger values follow population swings faster;   */
+    /* smaller values are less disturbed by a single noisy cycle.  Valid      */
+    /* values are 1 to 100, inclusive.                                        */
+    INT32U  responsiveness;
+} RFID_18K6C_DYNAMICQ_TUNER_PARMS;
+
+/******************************************************************************
+ * Name:  RFID_18K6C_DYNAMICQ_TUNER_STATUS - The state of the library's
+ *        dynamic-Q tuner.
+ ******************************************************************************/
+typedef struct {
+    /* The length of the structure in bytes.  Application must set this to    */
+    /* sizeof(RFID_18K6C_DYNAMICQ_TUNER_STATUS).                              */
+    INT32U  length;
+    /* The number of inventory cycles the tuner has observed since it was     */
+    /* last enabled.                                                          */
+    INT32U  cycles;
+    /* The smoothed estimate of the number of tags responding in an inventory */
+    /* cycle.                                                                 */
+    INT32U  populationEstimate;
+    /* The dynamic-Q parameters that will be used for the next inventory.     */
+    INT32U  startQValue;
+    INT32U  minQValue;
+    INT32U  maxQValue;
+    INT32U  thresholdMultiplier;
+    /* For the last inventory cycle, the percentage of slots in which more    */
+    /* than one tag replied (i.e., an RN16 was received but no EPC was read)  */
+    /* and the percentage of slots in which no tag replied.                   */
+    INT32U  collisionRatio;
+    INT32U  emptyRatio;
+    /* The smoothed number of good EPC reads per second over the inventory    */
+    /* cycles.  Zero if the cycle timing was not reported.                    */
+    INT32U  readRate;
+} RFID_18K6C_DYNAMICQ_TUNER_STATUS;
+
+/******************************************************************************
+ * Name:  RFID_ANTENNA_SCHEDULER_PARMS - Configures the library's yield-
+ *        weighted scheduling of the antenna ports' airtime.
+ ******************************************************************************/
+typedef struct {
+    /* The length of the structure in bytes.  Application must set this to    */
+    /* sizeof(RFID_ANTENNA_SCHEDULER_PARMS).                                  */
+    INT32U  length;
+    /* A non-zero value enables the scheduler.  While enabled, the library    */
+    /* counts the tags each enabled antenna port reads that no port has read  */
+    /* earlier in the same antenna cycle.  At the end of every antenna cycle  */
+    /* it shares the sum of the configured dwell times (and, separately, of   */
+    /* the configured inventory cycle counts) among the enabled ports in      */
+    /* proportion to that yield, and writes the new values before the next    */
+    /* inventory is started.  A port whose dwell time (or inventory cycle     */
+    /* count) is configured as zero keeps it.  The values returned by         */
+    /* RFID_AntennaPortGetConfiguration remain those the application          */
+    /* configured.                                                            */
+    BOOL32  enabled;
+    /* The dwell time, in milliseconds, that a port may not be scheduled      */
+    /* below or above.  The floor keeps a port that has not been reading tags */
+    /* in the schedule so that tags arriving at it are noticed.  minDwellTime */
+    /* must be at least 1 and must not exceed maxDwellTime.                   */
+    INT32U  minDwellTime;
+    INT32U  maxDwellTime;
+    /* The inventory cycle count that a port may not be scheduled below or    */
+    /* above.  minInventoryCycles must be at least 1 and must not exceed      */
+    /* maxInventoryCycles.                                                    */
+    INT32U  minInventoryCycles;
+    INT32U  maxInventoryCycles;
+    /* The weight, in percent, that the newest visit to a port carries in its */
+    /* yield.  Larger values follow traffic moving between ports faster;      */
+    /* smaller values are less disturbed by a single busy visit.  Valid       */
+    /* values are 1 to 100, inclusive.                                        */
+    INT32U  responsiveness;
+} RFID_ANTENNA_SCHEDULER_PARMS;
+
+/******************************************************************************
+ * Name:  RFID_ANTENNA_PORT_YIELD - The tag yield the antenna scheduler has
+ *        measured for an antenna port.
+ ******************************************************************************/
+typedef struct {
+    /* The length of the structure in bytes.  Application must set this to    */
+    /* sizeof(RFID_ANTENNA_PORT_YIELD).                                       */
+    INT32U  length;
+    /* The number of visits to the port the scheduler has observed since it   */
+    /* was last enabled.                                                      */
+    INT32U  visits;
+    /* The number of new tags read during the last visit to the port and the  */
+    /* smoothed number of new tags per visit, in hundredths of a tag.         */
+    INT32U  newTags;
+    INT32U  averageNewTags;
+    /* The dwell time, in milliseconds, and inventory cycle count that will   */
+    /* be used for the port by the next inventory.                            */
+    INT32U  dwellTime;
+    INT32U  numberInventoryCycles;
+} RFID_ANTENNA_PORT_YIELD;
+
+/******************************************************************************
+ * Name:  RFID_PACKET_SUBSCRIPTION - The packet types an ISO 18000-6C tag-
+ *        protocol operation passes to the application's packet callback.
+ ******************************************************************************/
+/* The bit in a subscription mask for a packet type, i.e., the bit for its    */
+/* number within its class (see rfid_packets.h).                              */
+#define RFID_PACKET_SUBSCRIPTION_BIT(t)     ((INT32U) 1 << ((t) & 0x0FFF))
+typedef struct {
+    /* The length of the structure in bytes.  Application must set this to    */
+    /* sizeof(RFID_PACKET_SUBSCRIPTION).                                      */
+    INT32U  length;
+    /* One mask for each packet class.  A packet is passed to the callback    */
+    /* only if the bit RFID_PACKET_SUBSCRIPTION_BIT(pkt_type) is set in the   */
+    /* mask for its class.  Packets numbered 32 or above within their class   */
+    /* are always passed on.  The library tracks the command-end packet and   */
+    /* any errors itself, so the operation completes (and reports failures)   */
+    /* as usual whether or not they are subscribed to.  When the operation    */
+    /* starts, the library also has the radio module stop producing the       */
+    /* round, inventory-cycle, diagnostics and (for an inventory) inventory   */
+    /* packets that RFID_RadioSetResponseDataMode enabled if no subscribed    */
+    /* packet needs them; RFID_RadioGetResponseDataMode still reports the     */
+    /* mode the application set.                                              */
+    INT32U  commonPackets;
+    INT32U  diagnosticsPackets;
+    INT32U  statusPackets;
+    INT32U  reservedPackets;
+    INT32U  debugPackets;
+} RFID_PACKET_SUBSCRIPTION;
+
+/******************************************************************************
+ * Name:  RFID_RADIO_CLOCK_MODEL - The library's model of the host time at
+ *        which the radio module's millisecond counter (ms_ctr) had a value.
+ ******************************************************************************/
+typedef struct {
+    /* The length of the structure in bytes.  Application must set this to    */
+    /* sizeof(RFID_RADIO_CLOCK_MODEL).                                        */
+    INT32U  length;
+    /* Non-zero once the library has seen a packet from which to build the    */
+    /* model, along with the number of packets seen.  The library samples the */
+    /* host clock when a command-begin, command-active or command-end packet  */
+    /* arrives; the packets that arrive quickest fix the model.  The model is */
+    /* started again when the radio module is reset.                          */
+    BOOL32  valid;
+    INT32U  samples;
+    /* A counter value and the host time, in milliseconds since midnight GMT, */
+    /* January 1, 1970, at which the radio module had it.                     */
+    INT32U  macReference;
+    INT64U  hostReference;
+    /* How much faster the host clock runs than the radio module's counter,   */
+    /* in parts per billion.  The host time of a counter value c is           */
+    /* hostReference + d + d * drift / 10^9, where d is (INT32S) (c -         */
+    /* macReference).  RFID_RadioMacTimeToHostTime does the arithmetic.       */
+    INT32S  drift;
+} RFID_RADIO_CLOCK_MODEL;
+
+/******************************************************************************
+ * Name:  RFID_STATISTICS_HISTOGRAM - A distribution of durations, in
+ *        microseconds, that the library has measured.
+ ******************************************************************************/
+/* The number of buckets in a histogram.  Durations below 8 microseconds each */
+/* have a bucket.  Above that, every power of two is split into 8 buckets, so */
+/* a duration is known to within 12.5%.  Bucket b, for b of 8 or more, holds  */
+/* durations from (8 + b % 8) << (b / 8 - 1) microseconds up to the start of  */
+/* bucket b + 1.                                                              */
+#define RFID_STATISTICS_HISTOGRAM_BUCKETS   256
+typedef struct {
+    /* The number of durations measured, their total and the longest.        */
+    INT64U  count;
+    INT64U  total;
+    INT64U  maximum;
+    /* The percentiles of the durations.  Each is the top of the bucket that  */
+    /* holds it, so it is never less than the true value.                     */
+    INT64U  median;
+    INT64U  percentile90;
+    INT64U  percentile99;
+    INT64U  percentile999;
+    /* The number of durations in each bucket.                                */
+    INT32U  buckets[RFID_STATISTICS_HISTOGRAM_BUCKETS];
+} RFID_STATISTICS_HISTOGRAM;
+
+/******************************************************************************
+ * Name:  RFID_RADIO_STATISTICS - What the library has done with a radio since
+ *        it was opened or its statistics were last reset.
+ ******************************************************************************/
+/* The dimensions of the packet counts: one row per packet class and one      */
+/* entry per packet number within the class (see rfid_packets.h).  Packets    */
+/* numbered 31 or above within their class are counted in the last entry.     */
+#define RFID_STATISTICS_PACKET_CLASSES      5
+#define RFID_STATISTICS_PACKET_NUMBERS      32
+typedef struct {
+    /* The length of the structure in bytes.  Application must set this to    */
+    /* sizeof(RFID_RADIO_STATISTICS).                                         */
+    INT32U  length;
+    /* MAC register reads and writes requested of the radio module.          */
+    INT64U  registerReads;
+    INT64U  registerWrites;
+    /* Calls made to the transport to read from the radio module, including   */
+    /* those that only ask how many bytes are waiting, and the bytes read.    */
+    INT64U  transportReads;
+    INT64U  bytesReceived;
+    /* Operation response packets received, in total and by type.            */
+    INT64U  packets;
+    INT32U  packetsByType[RFID_STATISTICS_PACKET_CLASSES]
+                         [RFID_STATISTICS_PACKET_NUMBERS];
+    /* Packet callback invocations.                                           */
+    INT64U  callbacks;
+    /* Operations the application cancelled or aborted.                       */
+    INT64U  cancels;
+    INT64U  aborts;
+    /* Operations that failed because the radio module sent nothing for the   */
+    /* response timeout, and cancelled operations that were aborted because   */
+    /* the radio module took too long to end them.                            */
+    INT64U  responseTimeouts;
+    INT64U  cancelTimeouts;
+    /* How long register reads took from request to response, how long       */
+    /* passed between consecutive packets of an operation, and how long the   */
+    /* packet callback took to return.  Long round trips and packet gaps with */
+    /* quick callbacks point at the radio module or its transport; slow       */
+    /* callbacks point at the host.                                           */
+    RFID_STATISTICS_HISTOGRAM   registerRoundTrip;
+    RFID_STATISTICS_HISTOGRAM   packetInterarrival;
+    RFID_STATISTICS_HISTOGRAM   callbackDuration;
+    /* How long calls waited for the library lock, which is only taken to     */
+    /* start up and shut down the library, enumerate, open and close radios,  */
+    /* reset the MAC and update its nonvolatile memory.  It is shared by all  */
+    /* radios and is not reset by RFID_RadioResetStatistics.                  */
+    RFID_STATISTICS_HISTOGRAM   libraryLockWait;
+    /* How long calls for the radio waited for its lock.                      */
+    RFID_STATISTICS_HISTOGRAM   radioLockWait;
+} RFID_RADIO_STATISTICS;
+
 #endif  /* #ifndef RFID_STRUCTS_H_INCLUDED */
@@ -0,0 +1,205 @@
+/*
+ *****************************************************************************
+ *                                                                           *
+ *                 IMPINJ CONFIDENTIAL AND PROPRIETARY                       *
+ *                                                                           *
+ * This source code is the sole property of Impinj, Inc.  Reproduction or    *
+ * utilization of this source code in whole or in part is forbidden without  *
+ * the prior written consent of Impinj, Inc.                                 *
+ *                                                                           *
+ * (c) Copyright Impinj, Inc. 2009. All rights reserved.                     *
+ *                                                                           *
+ *****************************************************************************
+ */
+
+/*
+ *****************************************************************************
+ *
+ * $Id$
+ *
+ * Description:
+ *     This header presents the ring buffer that the live MAC transport uses
+ *     to cache the bytes it reads from the transport layer.
+ *
+ *
+ *****************************************************************************
+ */
+
+#ifndef RING_BUFFER_H_INCLUDED
+#define RING_BUFFER_H_INCLUDED
+
+#include <assert.h>
+#include <string.h>
+#include "rfid_platform_types.h"
+
+namespace rfid
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: RingBuffer
+//
+// Description: This class provides a simple implementation of a ring buffer
+//   that will be used to cache data from the underlying transport layer.
+//   SIZE is the number of bytes that the ring buffer holds.
+////////////////////////////////////////////////////////////////////////////////
+template <INT32U SIZE>
+class RingBuffer
+{
+public:
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        RingBuffer
+    // Description: Creates the ring buffer
+    // Parameters:  None
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    RingBuffer() :
+        m_used(0),
+        m_head(0),
+        m_tail(0)
+    {
+    } // RingBuffer::RingBuffer
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        Empty
+    // Description: Returns whether or not ring buffer is empty
+    // Parameters:  None
+    // Returns:     0 - ring buffer is not empty, !0 - ring buffer is empty
+    ////////////////////////////////////////////////////////////////////////////
+    BOOL32 Empty() const
+    {
+        return m_used == 0;
+    } // RingBuffer::Empty
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        Full
+    // Description: Returns whether or not ring buffer is full
+    // Parameters:  None
+    // Returns:     0 - ring buffer is not full, !0 - ring buffer is full
+    ////////////////////////////////////////////////////////////////////////////
+    BOOL32 Full() const
+    {
+        return m_used == SIZE;
+    } // RingBuffer::Full
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        BytesUsed
+    // Description: Returns the number of bytes in the ring buffer
+    // Parameters:  None
+    // Returns:     The number of bytes in the ring buffer
+    ////////////////////////////////////////////////////////////////////////////
+    INT32U BytesUsed() const
+    {
+        return m_used;
+    } // RingBuffer::BytesUsed
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        BytesFree
+    // Description: Returns the number of free bytes available in the ring
+    //              buffer
+    // Parameters:  None
+    // Returns:     The number of bytes free in the ring buffer
+    ////////////////////////////////////////////////////////////////////////////
+    INT32U BytesFree() const
+    {
+        return SIZE - m_used;
+    } // RingBuffer::BytesFree
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        Clear
+    // Description: Empties out the ring buffer
+    // Parameters:  None
+    // Returns:     Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void Clear()
+    {
+        m_head = m_tail = m_used = 0;
+    } // RingBuffer::Clear
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        Add
+    // Description: Adds the bytes in the buffer provided to the ring buffer
+    // Parameters:  pBuffer - pointer to bytes to add to ring buffer
+    //              bufferSize - the number of bytes in buffer
+    // Returns:     The number of free bytes in ring buffer after addition
+    ////////////////////////////////////////////////////////////////////////////
+    INT32U Add(
+        const INT8U*    pBuffer,
+        INT32U          bufferSize
+        )
+    {
+        assert(bufferSize <= this->BytesFree());
+
+        // If the bytes will extend beyond the end of the buffer...
+        if ((m_tail + bufferSize) > SIZE)
+        {
+            // Add however bytes necessary to get to end of array
+            INT32U  appendSize = SIZE - m_tail;
+            memcpy(m_ring + m_tail, pBuffer, appendSize);
+
+            // Now copy the remaining bytes to the front of the array
+            INT32U  prependSize = bufferSize - appendSize;
+            memcpy(m_ring, pBuffer + appendSize, prependSize);
+        }
+        else
+        {
+            // Simply copy bytes to array
+            memcpy(m_ring + m_tail, pBuffer, bufferSize);
+        }
+
+        // Increment the number of bytes in ring buffer and adjust tail
+        // to "point" to where next byte is to be copied
+        m_used += bufferSize;
+        m_tail = (m_tail + bufferSize) % SIZE;
+
+        return this->BytesFree();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name:        Remove
+    // Description: Copies bytes from the ring buffer to buffer provided
+    // Parameters:  pBuffer - pointer to buffer into which to put bytes
+    //              bufferSize - the number of bytes to retrieve
+    // Returns:     The number of bytes in the ring buffer after the removal
+    ////////////////////////////////////////////////////////////////////////////
+    INT32U Remove(
+        INT8U*  pBuffer,
+        INT32U  bufferSize
+        )
+    {
+        assert(bufferSize <= this->BytesUsed());
+
+        // If the bytes will extend beyond the end of the buffer...
+        if ((m_head + bufferSize) > SIZE)
+        {
+            // Copy the bytes up through the end of the array
+            INT32U  firstCopy = SIZE - m_head;
+            memcpy(pBuffer, m_ring + m_head, firstCopy);
+
+            // Copy the bytes from the front of the array
+            INT32U  secondCopy = bufferSize - firstCopy;
+            memcpy(pBuffer + firstCopy, m_ring, secondCopy);
+        }
+        else
+        {
+            // Simply copy bytes from array
+            memcpy(pBuffer, m_ring + m_head, bufferSize);
+        }
+
+        // Decrement the number of bytes in ring buffer and update the head
+        // to "point" to the next byte to consume
+        m_used -= bufferSize;
+        m_head = (m_head + bufferSize) % SIZE;
+
+        return this->BytesUsed();
+    }
+
+private:
+    INT8U           m_ring[SIZE];       // The array that holds ring buffer
+    INT32U          m_used;             // The number of bytes in buffer
+    INT32U          m_head;             // The next byte to consume
+    INT32U          m_tail;             // The next byte to fill
+}; // class RingBuffer
+
+} // namespace rfid
+
+#endif // #ifndef RING_BUFFER_H_INCLUDED
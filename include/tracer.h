@@ -100,7 +100,7 @@ public:
         ) const
     {
         // Verify that the message is at or above the threshold before logging
-        if (severity >= m_severityThreshold)
+        if (this->IsLogged(severity))
         {
             va_list arguments;
             va_start(arguments, format);
@@ -108,6 +108,27 @@ public:
         }
     } // PrintMessage
 
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: IsLogged
+    //
+    // Description:
+    //   Determines whether messages of a severity are logged, so that callers
+    //   can skip working out the arguments of messages that are not
+    //
+    // Parameters:
+    //   severity - the severity level to check
+    //
+    // Returns:
+    //   true  - messages of the severity are logged
+    //   false - messages of the severity are discarded
+    ////////////////////////////////////////////////////////////////////////////
+    bool IsLogged(
+        RFID_LOG_SEVERITY   severity
+        ) const
+    {
+        return severity >= m_severityThreshold;
+    } // IsLogged
+
 protected:
     ////////////////////////////////////////////////////////////////////////////
     // Name: Tracer
@@ -0,0 +1,728 @@
+/*
+ *****************************************************************************
+ *                                                                           *
+ *                 IMPINJ CONFIDENTIAL AND PROPRIETARY                       *
+ *                                                                           *
+ * This source code is the sole property of Impinj, Inc.  Reproduction or    *
+ * utilization of this source code in whole or in part is forbidden without  *
+ * the prior written consent of Impinj, Inc.                                 *
+ *                                                                           *
+ * (c) Copyright Impinj, Inc. 2009. All rights reserved.                     *
+ *                                                                           *
+ *****************************************************************************
+ */
+
+/*
+ *****************************************************************************
+ *
+ * $Id$
+ *
+ * Description:
+ *     This file contains the implementation for the binary file tracer.
+ *
+ *
+ *****************************************************************************
+ */
+
+#include <stdarg.h>
+#include <string.h>
+#include <wchar.h>
+#include <new>
+#include "tracer_binary.h"
+#include "rfid_exceptions.h"
+#include "auto_lock_compat.h"
+#include "compat_time.h"
+
+namespace
+{
+    // The sizes of the integer that a conversion's length modifier names
+    enum
+    {
+        ARGUMENT_CHAR,
+        ARGUMENT_SHORT,
+        ARGUMENT_INT,
+        ARGUMENT_LONG,
+        ARGUMENT_INT64,
+        ARGUMENT_SIZE
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: PackBytes
+    //
+    // Description:
+    //   Copies bytes into a slot's arguments if they fit
+    ////////////////////////////////////////////////////////////////////////////
+    bool PackBytes(
+        INT8U*&         pNext,
+        const INT8U*    pEnd,
+        const void*     pBytes,
+        size_t          length
+        )
+    {
+        if (static_cast<size_t>(pEnd - pNext) < length)
+        {
+            return false;
+        }
+        memcpy(pNext, pBytes, length);
+        pNext += length;
+        return true;
+    } // PackBytes
+}
+
+namespace rfid
+{
+
+////////////////////////////////////////////////////////////////////////////
+// Name: TracerBinary
+//
+// Description:
+//   Initializes the binary file logging tracer and starts the thread that
+//   writes the file
+////////////////////////////////////////////////////////////////////////////
+TracerBinary::TracerBinary(
+    const char*         fileName,
+    RFID_LOG_SEVERITY   minSeverity
+    ) :
+    Tracer(minSeverity),
+    m_tracerFileWrapper(
+        CPL_FileOpen(fileName, CPL_WRITE, CPL_CREAT | CPL_TRUNC)),
+    m_stopWriter(0)
+{
+    // Verify that the tracer file was created properly
+    if (-1 == m_tracerFileWrapper.Get())
+    {
+        throw RfidErrorException(RFID_ERROR_FAILURE, __FUNCTION__);
+    }
+
+    // Create the mutex that is used to lock the list of rings
+    if (CPL_MutexInit(&m_ringsLock))
+    {
+        throw RfidErrorException(RFID_ERROR_FAILURE, __FUNCTION__);
+    }
+    m_ringsLockWrapper.Assume(&m_ringsLock);
+
+    TraceBinaryFile::FILE_HEADER header;
+    header.magic   = TraceBinaryFile::MAGIC;
+    header.version = TraceBinaryFile::VERSION;
+    if (sizeof(header) !=
+        CPL_FileWrite(m_tracerFileWrapper, &header, sizeof(header)))
+    {
+        throw RfidErrorException(RFID_ERROR_FAILURE, __FUNCTION__);
+    }
+
+    m_writeBuffer.reserve(WRITE_BUFFER_SIZE);
+
+    if (CPL_ThreadKeyCreate(&m_ringKey, TracerBinary::RingThreadExited))
+    {
+        throw RfidErrorException(RFID_ERROR_FAILURE, __FUNCTION__);
+    }
+
+    if (CPL_ThreadCreate(&m_writerThread, TracerBinary::WriterThread, this))
+    {
+        CPL_ThreadKeyDelete(m_ringKey);
+        throw RfidErrorException(RFID_ERROR_FAILURE, __FUNCTION__);
+    }
+} // TracerBinary::TracerBinary
+
+////////////////////////////////////////////////////////////////////////////
+// Name: ~TracerBinary
+//
+// Description:
+//   Writes the messages that are still queued and shuts down the RFID
+//   logging subsystem.
+////////////////////////////////////////////////////////////////////////////
+TracerBinary::~TracerBinary()
+{
+    // The writer makes a last pass before it exits
+    CPL_AtomicExchange32(&m_stopWriter, 1);
+    CPL_ThreadJoin(&m_writerThread, NULL);
+
+    // Deleting the key only marks the rings of the threads still running
+    CPL_ThreadKeyDelete(m_ringKey);
+    for (TRACE_RINGS::iterator ring = m_rings.begin();
+         ring != m_rings.end();
+         ++ring)
+    {
+        delete *ring;
+    }
+} // TracerBinary::~TracerBinary
+
+////////////////////////////////////////////////////////////////////////////
+// Name: LogMessage
+//
+// Description:
+//   Queues a message on the calling thread's ring.  The format string is
+//   not copied and must outlive the tracer, which a string literal does.
+//   If the ring is full, the message is dropped and counted.
+////////////////////////////////////////////////////////////////////////////
+void TracerBinary::LogMessage(
+    RFID_LOG_SEVERITY   severity,
+    const char*         format,
+    va_list             arguments
+    ) const
+{
+    TRACE_RING* pRing = this->GetRing();
+    if (NULL == pRing)
+    {
+        return;
+    }
+
+    // Only this thread moves the head, so only the tail can have changed
+    INT32U head = static_cast<INT32U>(pRing->head);
+    if (head - static_cast<INT32U>(pRing->tail) >= RING_SLOTS)
+    {
+        CPL_AtomicIncrement32(&pRing->dropped);
+        return;
+    }
+
+    TRACE_SLOT* pSlot = &pRing->slots[head % RING_SLOTS];
+    CPL_TimeSpecGet(&pSlot->time);
+    pSlot->format   = format;
+    pSlot->severity = severity;
+    pSlot->threadId = pRing->threadId;
+    TracerBinary::PackArguments(pSlot, format, arguments);
+
+    // Hand the slot to the writer
+    CPL_AtomicExchange32(&pRing->head, static_cast<CPL_Atomic32>(head + 1));
+} // TracerBinary::LogMessage
+
+////////////////////////////////////////////////////////////////////////////
+// Name: GetRing
+//
+// Description:
+//   Retrieves the calling thread's ring, creating it on first use
+////////////////////////////////////////////////////////////////////////////
+TracerBinary::TRACE_RING* TracerBinary::GetRing() const
+{
+    TRACE_RING* pRing = static_cast<TRACE_RING*>(CPL_ThreadKeyGet(m_ringKey));
+    if (NULL != pRing)
+    {
+        return pRing;
+    }
+
+    if (NULL == (pRing = new (std::nothrow) TRACE_RING))
+    {
+        return NULL;
+    }
+    pRing->head     = 0;
+    pRing->tail     = 0;
+    pRing->dropped  = 0;
+    pRing->exited   = 0;
+    pRing->threadId = CPL_ThreadGetID();
+
+    try
+    {
+        CplMutexAutoLock ringsGuard(&m_ringsLock);
+        m_rings.push_back(pRing);
+    }
+    catch (...)
+    {
+        delete pRing;
+        return NULL;
+    }
+    CPL_ThreadKeySet(m_ringKey, pRing);
+
+    return pRing;
+} // TracerBinary::GetRing
+
+////////////////////////////////////////////////////////////////////////////
+// Name: RingThreadExited
+//
+// Description:
+//   Called when a thread that has a ring exits, to let the writer free
+//   the ring once it has written the ring's messages
+////////////////////////////////////////////////////////////////////////////
+void CPL_THREAD_KEY_CALLBACK TracerBinary::RingThreadExited(
+    void*               pRing
+    )
+{
+    // The writer may free the ring as soon as this is set
+    CPL_AtomicExchange32(&static_cast<TRACE_RING*>(pRing)->exited, 1);
+} // TracerBinary::RingThreadExited
+
+////////////////////////////////////////////////////////////////////////////
+// Name: PackArguments
+//
+// Description:
+//   Packs a message's arguments into a slot as the file layout describes
+////////////////////////////////////////////////////////////////////////////
+void TracerBinary::PackArguments(
+    TRACE_SLOT*         pSlot,
+    const char*         format,
+    va_list             arguments
+    )
+{
+    INT8U*          pNext = pSlot->arguments;
+    const INT8U*    pEnd  = pSlot->arguments + SLOT_ARGUMENT_BYTES;
+    bool            fits  = true;
+
+    pSlot->flags = 0;
+
+    for (const char* pFormat = format; fits && *pFormat; ++pFormat)
+    {
+        if (('%' != *pFormat) || ('%' == *++pFormat))
+        {
+            continue;
+        }
+
+        // Skip the flags, and pack a '*' width or precision
+        while (*pFormat && strchr("-+ #0", *pFormat))
+        {
+            ++pFormat;
+        }
+        for (int field = 0; fits && (field < 2); ++field)
+        {
+            if ('*' == *pFormat)
+            {
+                INT64S value = va_arg(arguments, int);
+                fits = PackBytes(pNext, pEnd, &value, sizeof(value));
+                ++pFormat;
+            }
+            while ((*pFormat >= '0') && (*pFormat <= '9'))
+            {
+                ++pFormat;
+            }
+            if ((0 == field) && ('.' == *pFormat))
+            {
+                ++pFormat;
+            }
+            else
+            {
+                break;
+            }
+        }
+        if (!fits)
+        {
+            break;
+        }
+
+        // Work out the size of the argument from the length modifier
+        int size = ARGUMENT_INT;
+        if ('h' == *pFormat)
+        {
+            size = ('h' == *++pFormat) ? (++pFormat, ARGUMENT_CHAR) :
+                ARGUMENT_SHORT;
+        }
+        else if ('l' == *pFormat)
+        {
+            size = ('l' == *++pFormat) ? (++pFormat, ARGUMENT_INT64) :
+                ARGUMENT_LONG;
+        }
+        else if (('j' == *pFormat) || ('L' == *pFormat))
+        {
+            size = ARGUMENT_INT64;
+            ++pFormat;
+        }
+        else if (('z' == *pFormat) || ('t' == *pFormat))
+        {
+            size = ARGUMENT_SIZE;
+            ++pFormat;
+        }
+        else if ('I' == *pFormat)
+        {
+            if (('6' == pFormat[1]) && ('4' == pFormat[2]))
+            {
+                size = ARGUMENT_INT64;
+                pFormat += 3;
+            }
+            else if (('3' == pFormat[1]) && ('2' == pFormat[2]))
+            {
+                pFormat += 3;
+            }
+            else
+            {
+                size = ARGUMENT_SIZE;
+                ++pFormat;
+            }
+        }
+
+        switch (*pFormat)
+        {
+            case 'd':
+            case 'i':
+            {
+                INT64S value;
+                switch (size)
+                {
+                    case ARGUMENT_CHAR:
+                        value = static_cast<signed char>(va_arg(arguments, int));
+                        break;
+                    case ARGUMENT_SHORT:
+                        value = static_cast<short>(va_arg(arguments, int));
+                        break;
+                    case ARGUMENT_LONG:
+                        value = va_arg(arguments, long);
+                        break;
+                    case ARGUMENT_INT64:
+                        value = va_arg(arguments, INT64S);
+                        break;
+                    case ARGUMENT_SIZE:
+                        value = va_arg(arguments, ptrdiff_t);
+                        break;
+                    default:
+                        value = va_arg(arguments, int);
+                        break;
+                }
+                fits = PackBytes(pNext, pEnd, &value, sizeof(value));
+                break;
+            }
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+            {
+                INT64U value;
+                switch (size)
+                {
+                    case ARGUMENT_CHAR:
+                        value = static_cast<unsigned char>(
+                            va_arg(arguments, unsigned int));
+                        break;
+                    case ARGUMENT_SHORT:
+                        value = static_cast<unsigned short>(
+                            va_arg(arguments, unsigned int));
+                        break;
+                    case ARGUMENT_LONG:
+                        value = va_arg(arguments, unsigned long);
+                        break;
+                    case ARGUMENT_INT64:
+                        value = va_arg(arguments, INT64U);
+                        break;
+                    case ARGUMENT_SIZE:
+                        value = va_arg(arguments, size_t);
+                        break;
+                    default:
+                        value = va_arg(arguments, unsigned int);
+                        break;
+                }
+                fits = PackBytes(pNext, pEnd, &value, sizeof(value));
+                break;
+            }
+            case 'c':
+            case 'C':
+            {
+                INT64S value = va_arg(arguments, int);
+                fits = PackBytes(pNext, pEnd, &value, sizeof(value));
+                break;
+            }
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+            {
+                double value = va_arg(arguments, double);
+                fits = PackBytes(pNext, pEnd, &value, sizeof(value));
+                break;
+            }
+            case 'p':
+            {
+                INT64U value = reinterpret_cast<size_t>(
+                    va_arg(arguments, void*));
+                fits = PackBytes(pNext, pEnd, &value, sizeof(value));
+                break;
+            }
+            case 'n':
+                va_arg(arguments, void*);
+                break;
+            case 's':
+            case 'S':
+            {
+                // Wide strings are narrowed a character at a time
+                const char*     pString     = NULL;
+                const wchar_t*  pWideString = NULL;
+                size_t          length      = 0;
+                if (('S' == *pFormat) || (ARGUMENT_LONG == size))
+                {
+                    pWideString = va_arg(arguments, const wchar_t*);
+                    length = (NULL == pWideString) ? 0 : wcslen(pWideString);
+                }
+                else
+                {
+                    pString = va_arg(arguments, const char*);
+                    length = (NULL == pString) ? 0 : strlen(pString);
+                }
+
+                INT16U packedLength;
+                if ((NULL == pString) && (NULL == pWideString))
+                {
+                    packedLength = TraceBinaryFile::STRING_NULL;
+                    fits = PackBytes(
+                        pNext, pEnd, &packedLength, sizeof(packedLength));
+                    break;
+                }
+
+                // Pack as much of the string as fits
+                size_t room = pEnd - pNext;
+                if (room <= sizeof(packedLength))
+                {
+                    fits = false;
+                    break;
+                }
+                room -= sizeof(packedLength);
+                if (length > room)
+                {
+                    length = room;
+                    fits   = false;
+                }
+                packedLength = static_cast<INT16U>(length);
+                PackBytes(pNext, pEnd, &packedLength, sizeof(packedLength));
+                if (NULL != pString)
+                {
+                    PackBytes(pNext, pEnd, pString, length);
+                }
+                else
+                {
+                    for (size_t index = 0; index < length; ++index)
+                    {
+                        *pNext++ = static_cast<INT8U>(
+                            (pWideString[index] < 0x80) ?
+                                pWideString[index] : '?');
+                    }
+                }
+                break;
+            }
+            default:
+                // An incomplete or unknown conversion, so the arguments can't
+                // be followed any further
+                fits = false;
+                break;
+        }
+
+        if (!*pFormat)
+        {
+            break;
+        }
+    }
+
+    if (!fits)
+    {
+        pSlot->flags |= TraceBinaryFile::MESSAGE_TRUNCATED;
+    }
+    pSlot->argumentBytes = static_cast<INT16U>(pNext - pSlot->arguments);
+} // TracerBinary::PackArguments
+
+////////////////////////////////////////////////////////////////////////////
+// Name: WriteQueuedMessages
+//
+// Description:
+//   Writes every message queued on the rings, oldest first, and flushes
+//   the file
+////////////////////////////////////////////////////////////////////////////
+void TracerBinary::WriteQueuedMessages()
+{
+    // Threads only take the lock to add their ring
+    CplMutexAutoLock ringsGuard(&m_ringsLock);
+
+    std::vector<INT32U> heads(m_rings.size());
+    std::vector<bool>   exited(m_rings.size());
+    bool                written = false;
+    size_t              index;
+
+    for (index = 0; index < m_rings.size(); ++index)
+    {
+        TRACE_RING* pRing = m_rings[index];
+
+        // A thread that had exited before its head is read has queued all
+        // it ever will
+        exited[index] = (0 != CPL_AtomicCompareExchange32(&pRing->exited, 0, 0));
+        heads[index]  = static_cast<INT32U>(pRing->head);
+
+        CPL_Atomic32 dropped = CPL_AtomicExchange32(&pRing->dropped, 0);
+        if (dropped)
+        {
+            TraceBinaryFile::DROPPED_RECORD record;
+            record.header.type   = TraceBinaryFile::RECORD_DROPPED;
+            record.header.length = sizeof(record);
+            record.threadId      = pRing->threadId;
+            record.count         = dropped;
+            this->AppendRecord(&record, sizeof(record), NULL, 0);
+            written = true;
+        }
+    }
+
+    // Merge the rings' messages into time order
+    for (;;)
+    {
+        TRACE_RING*         pOldest = NULL;
+        const TRACE_SLOT*   pSlot   = NULL;
+
+        for (index = 0; index < m_rings.size(); ++index)
+        {
+            TRACE_RING* pRing = m_rings[index];
+            INT32U      tail  = static_cast<INT32U>(pRing->tail);
+
+            if (tail == heads[index])
+            {
+                continue;
+            }
+
+            const TRACE_SLOT* pCandidate = &pRing->slots[tail % RING_SLOTS];
+            if ((NULL == pSlot) ||
+                (pCandidate->time.seconds < pSlot->time.seconds) ||
+                ((pCandidate->time.seconds == pSlot->time.seconds) &&
+                 (pCandidate->time.nanoseconds < pSlot->time.nanoseconds)))
+            {
+                pOldest = pRing;
+                pSlot   = pCandidate;
+            }
+        }
+        if (NULL == pSlot)
+        {
+            break;
+        }
+
+        // The first message with a format brings the format with it
+        if (m_writtenFormats.insert(pSlot->format).second)
+        {
+            size_t length = strlen(pSlot->format);
+            size_t room   = 0xFFFF - sizeof(TraceBinaryFile::FORMAT_RECORD);
+            length = (length < room) ? length : room;
+
+            TraceBinaryFile::FORMAT_RECORD record;
+            record.header.type   = TraceBinaryFile::RECORD_FORMAT;
+            record.header.length =
+                static_cast<INT16U>(sizeof(record) + length);
+            record.formatId      = reinterpret_cast<size_t>(pSlot->format);
+            this->AppendRecord(
+                &record,
+                sizeof(record),
+                pSlot->format,
+                static_cast<INT32U>(length));
+        }
+
+        TraceBinaryFile::MESSAGE_RECORD record;
+        record.header.type   = TraceBinaryFile::RECORD_MESSAGE;
+        record.header.length =
+            static_cast<INT16U>(sizeof(record) + pSlot->argumentBytes);
+        record.formatId      = reinterpret_cast<size_t>(pSlot->format);
+        record.severity      = pSlot->severity;
+        record.threadId      = pSlot->threadId;
+        record.seconds       = pSlot->time.seconds;
+        record.nanoseconds   = pSlot->time.nanoseconds;
+        record.flags         = pSlot->flags;
+        this->AppendRecord(
+            &record,
+            sizeof(record),
+            pSlot->arguments,
+            pSlot->argumentBytes);
+        written = true;
+
+        // Hand the slot back to its thread
+        CPL_AtomicExchange32(
+            &pOldest->tail,
+            static_cast<CPL_Atomic32>(static_cast<INT32U>(pOldest->tail) + 1));
+    }
+
+    // Free the rings of the threads that have exited, which are now empty
+    size_t kept = 0;
+    for (index = 0; index < m_rings.size(); ++index)
+    {
+        if (exited[index])
+        {
+            delete m_rings[index];
+        }
+        else
+        {
+            m_rings[kept++] = m_rings[index];
+        }
+    }
+    m_rings.resize(kept);
+
+    if (written)
+    {
+        this->WriteBuffer();
+        CPL_FileFlush(m_tracerFileWrapper);
+    }
+} // TracerBinary::WriteQueuedMessages
+
+////////////////////////////////////////////////////////////////////////////
+// Name: AppendRecord
+//
+// Description:
+//   Appends a record to the write buffer, writing the buffer out first if
+//   the record doesn't fit
+////////////////////////////////////////////////////////////////////////////
+void TracerBinary::AppendRecord(
+    const void*         pHeader,
+    INT32U              headerLength,
+    const void*         pBody,
+    INT32U              bodyLength
+    )
+{
+    if (m_writeBuffer.size() + headerLength + bodyLength > WRITE_BUFFER_SIZE)
+    {
+        this->WriteBuffer();
+    }
+
+    const INT8U* pHeaderBytes = static_cast<const INT8U*>(pHeader);
+    const INT8U* pBodyBytes   = static_cast<const INT8U*>(pBody);
+    m_writeBuffer.insert(
+        m_writeBuffer.end(),
+        pHeaderBytes,
+        pHeaderBytes + headerLength);
+    m_writeBuffer.insert(
+        m_writeBuffer.end(),
+        pBodyBytes,
+        pBodyBytes + bodyLength);
+} // TracerBinary::AppendRecord
+
+////////////////////////////////////////////////////////////////////////////
+// Name: WriteBuffer
+//
+// Description:
+//   Writes the write buffer out to the file
+////////////////////////////////////////////////////////////////////////////
+void TracerBinary::WriteBuffer()
+{
+    if (!m_writeBuffer.empty())
+    {
+        CPL_FileWrite(
+            m_tracerFileWrapper,
+            &m_writeBuffer[0],
+            static_cast<INT32U>(m_writeBuffer.size()));
+        m_writeBuffer.clear();
+    }
+} // TracerBinary::WriteBuffer
+
+////////////////////////////////////////////////////////////////////////////
+// Name: WriterThread
+//
+// Description:
+//   Writes queued messages every WRITE_INTERVAL milliseconds until the
+//   tracer is destroyed
+////////////////////////////////////////////////////////////////////////////
+void* TracerBinary::WriterThread(
+    void*               context
+    )
+{
+    TracerBinary* pTracer = static_cast<TracerBinary*>(context);
+
+    while (!pTracer->m_stopWriter)
+    {
+        CPL_MillisecondSleep(WRITE_INTERVAL);
+        try
+        {
+            pTracer->WriteQueuedMessages();
+        }
+        catch (...)
+        {
+            // Try again next time
+        }
+    }
+
+    // Pick up whatever was queued while the tracer was being destroyed
+    try
+    {
+        pTracer->WriteQueuedMessages();
+    }
+    catch (...)
+    {
+    }
+
+    return NULL;
+} // TracerBinary::WriterThread
+
+} // namespace rfid
@@ -0,0 +1,365 @@
+/*
+ *****************************************************************************
+ *                                                                           *
+ *                 IMPINJ CONFIDENTIAL AND PROPRIETARY                       *
+ *                                                                           *
+ * This source code is the sole property of Impinj, Inc.  Reproduction or    *
+ * utilization of this source code in whole or in part is forbidden without  *
+ * the prior written consent of Impinj, Inc.                                 *
+ *                                                                           *
+ * (c) Copyright Impinj, Inc. 2009. All rights reserved.                     *
+ *                                                                           *
+ *****************************************************************************
+ */
+
+/*
+ *****************************************************************************
+ *
+ * $Id$
+ *
+ * Description:
+ *     This header presents the interface for the class that is used to
+ *     represent the RFID tracing facility that logs messages to a binary
+ *     file.  A message is not formatted when it is logged: its format
+ *     string's address and its raw arguments are queued per thread, and a
+ *     background thread writes them to the file in batches.  The layout of
+ *     the file is described here so that the offline decoder can read it.
+ *
+ *
+ *****************************************************************************
+ */
+
+#ifndef TRACER_BINARY_H_INCLUDED
+#define TRACER_BINARY_H_INCLUDED
+
+#include <vector>
+#include <set>
+#include "tracer.h"
+#include "auto_handle_compat.h"
+#include "compat_atomic.h"
+#include "compat_fildes.h"
+#include "compat_mutex.h"
+#include "compat_thread.h"
+
+namespace rfid
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: TraceBinaryFile
+//
+// Description: The layout of a binary trace file.  The file starts with a
+//              header, which is followed by records that each start with a
+//              record header.  A format record precedes the first message
+//              that uses the format.  Message arguments are packed in the
+//              order of the format's conversions: a '*' width or precision
+//              and every numeric or pointer conversion is 8 bytes (integers
+//              are sign- or zero-extended as the conversion says), and a
+//              string is a 16-bit length followed by its characters, or
+//              STRING_NULL for a null pointer.  All values are in host byte
+//              order.
+////////////////////////////////////////////////////////////////////////////////
+namespace TraceBinaryFile
+{
+    enum
+    {
+        MAGIC               = 0x43525452,   // "RTRC"
+        VERSION             = 1,
+        STRING_NULL         = 0xFFFF
+    };
+
+    enum
+    {
+        RECORD_FORMAT       = 1,            // A format string
+        RECORD_MESSAGE      = 2,            // A message
+        RECORD_DROPPED      = 3             // Messages that were dropped
+    };
+
+    enum
+    {
+        MESSAGE_TRUNCATED   = 0x0001        // Arguments didn't all fit
+    };
+
+#pragma pack(push, 1)
+    struct FILE_HEADER
+    {
+        INT32U  magic;
+        INT32U  version;
+    };
+
+    struct RECORD_HEADER
+    {
+        INT16U  type;
+        INT16U  length;                     // Including this header
+    };
+
+    // Followed by the format's characters, without a terminator
+    struct FORMAT_RECORD
+    {
+        RECORD_HEADER   header;
+        INT64U          formatId;
+    };
+
+    // Followed by the message's arguments
+    struct MESSAGE_RECORD
+    {
+        RECORD_HEADER   header;
+        INT64U          formatId;
+        INT32U          severity;
+        INT32U          threadId;
+        INT32S          seconds;
+        INT32S          nanoseconds;
+        INT16U          flags;
+    };
+
+    struct DROPPED_RECORD
+    {
+        RECORD_HEADER   header;
+        INT32U          threadId;
+        INT32U          count;
+    };
+#pragma pack(pop)
+} // namespace TraceBinaryFile
+
+////////////////////////////////////////////////////////////////////////////////
+// Name: TracerBinary
+//
+// Description: The binary file tracer class (i.e., queues all tracer messages
+//              unformatted and writes them to a binary file in the
+//              background)
+////////////////////////////////////////////////////////////////////////////////
+class TracerBinary : public Tracer
+{
+public:
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: TracerBinary
+    //
+    // Description:
+    //   Initializes the binary file logging tracer and starts the thread that
+    //   writes the file
+    //
+    // Parameters:
+    //   fileName - name of the binary trace file
+    //   severityThreshold - minimum severity for messages to log
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    TracerBinary(
+        const char*         fileName,
+        RFID_LOG_SEVERITY   severityThreshold
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: ~TracerBinary
+    //
+    // Description:
+    //   Writes the messages that are still queued and shuts down the RFID
+    //   logging subsystem.
+    //
+    // Parameters:
+    //   None
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    ~TracerBinary();
+
+private:
+    enum {
+        RING_SLOTS          = 256,          // Messages queued per thread
+        SLOT_ARGUMENT_BYTES = 480,          // Argument bytes per message
+        WRITE_BUFFER_SIZE   = 65536,        // Bytes written at once
+        WRITE_INTERVAL      = 50            // Milliseconds between batches
+    };
+
+    // A message waiting to be written
+    struct TRACE_SLOT
+    {
+        const char*     format;
+        INT32U          severity;
+        INT32U          threadId;
+        CPL_TimeSpec    time;
+        INT16U          flags;
+        INT16U          argumentBytes;
+        INT8U           arguments[SLOT_ARGUMENT_BYTES];
+    };
+
+    // The messages of one thread.  The thread only advances the head and the
+    // writer only advances the tail, so neither needs a lock.  Once the
+    // thread has exited, the writer frees the ring after emptying it.
+    struct TRACE_RING
+    {
+        volatile CPL_Atomic32   head;
+        volatile CPL_Atomic32   tail;
+        volatile CPL_Atomic32   dropped;
+        volatile CPL_Atomic32   exited;
+        INT32U                  threadId;
+        TRACE_SLOT              slots[RING_SLOTS];
+    };
+    typedef std::vector<TRACE_RING*>    TRACE_RINGS;
+
+    CplFileAutoHandle   m_tracerFileWrapper;    // A wrapper around the tracer
+                                                // file handle that ensures that
+                                                // it is automatically destroyed
+    CPL_ThreadKey       m_ringKey;              // Holds each thread's ring
+    mutable TRACE_RINGS m_rings;                // Every thread's ring
+    mutable CPL_Mutex   m_ringsLock;            // A lock to protect the list
+                                                // of rings
+    CplMutexAutoHandle  m_ringsLockWrapper;     // A wrapper around the lock
+                                                // to ensure automatic cleanup
+    std::set<const char*>   m_writtenFormats;   // Formats already in the file
+    std::vector<INT8U>  m_writeBuffer;          // Records not yet written
+    volatile CPL_Atomic32   m_stopWriter;       // Tells the writer to finish
+    CPL_Thread          m_writerThread;         // Writes the file
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: LogMessage
+    //
+    // Description:
+    //   Queues a message on the calling thread's ring.  The format string is
+    //   not copied and must outlive the tracer, which a string literal does.
+    //   If the ring is full, the message is dropped and counted.
+    //
+    // Parameters:
+    //   severity - the severity level for this message
+    //   format - the format string for the message (uses printf format
+    //     specifiers)
+    //   arguments - the variable argument list for the format specifier
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void LogMessage(
+        RFID_LOG_SEVERITY   severity,
+        const char*         format,
+        va_list             arguments
+        ) const;
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: GetRing
+    //
+    // Description:
+    //   Retrieves the calling thread's ring, creating it on first use
+    //
+    // Parameters:
+    //   None
+    //
+    // Returns:
+    //   The ring, or NULL if it could not be created
+    ////////////////////////////////////////////////////////////////////////////
+    TRACE_RING* GetRing() const;
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: RingThreadExited
+    //
+    // Description:
+    //   Called when a thread that has a ring exits, to let the writer free
+    //   the ring once it has written the ring's messages
+    //
+    // Parameters:
+    //   pRing - the thread's ring
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    static void CPL_THREAD_KEY_CALLBACK RingThreadExited(
+        void*               pRing
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: PackArguments
+    //
+    // Description:
+    //   Packs a message's arguments into a slot as the file layout describes
+    //
+    // Parameters:
+    //   pSlot - the slot to pack the arguments into
+    //   format - the format string for the message
+    //   arguments - the variable argument list for the format specifier
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    static void PackArguments(
+        TRACE_SLOT*         pSlot,
+        const char*         format,
+        va_list             arguments
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: WriteQueuedMessages
+    //
+    // Description:
+    //   Writes every message queued on the rings, oldest first, and flushes
+    //   the file
+    //
+    // Parameters:
+    //   None
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void WriteQueuedMessages();
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: AppendRecord
+    //
+    // Description:
+    //   Appends a record to the write buffer, writing the buffer out first if
+    //   the record doesn't fit
+    //
+    // Parameters:
+    //   pHeader - the record's fixed part
+    //   headerLength - the length of the fixed part
+    //   pBody - the record's variable part
+    //   bodyLength - the length of the variable part
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void AppendRecord(
+        const void*         pHeader,
+        INT32U              headerLength,
+        const void*         pBody,
+        INT32U              bodyLength
+        );
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: WriteBuffer
+    //
+    // Description:
+    //   Writes the write buffer out to the file
+    //
+    // Parameters:
+    //   None
+    //
+    // Returns:
+    //   Nothing
+    ////////////////////////////////////////////////////////////////////////////
+    void WriteBuffer();
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: WriterThread
+    //
+    // Description:
+    //   Writes queued messages every WRITE_INTERVAL milliseconds until the
+    //   tracer is destroyed
+    //
+    // Parameters:
+    //   context - the tracer
+    //
+    // Returns:
+    //   NULL
+    ////////////////////////////////////////////////////////////////////////////
+    static void* WriterThread(
+        void*               context
+        );
+
+    // Prevent copying of tracer objects
+    TracerBinary(const TracerBinary&);
+    const TracerBinary& operator = (const TracerBinary&);
+}; // class TracerBinary
+
+} // namespace rfid
+
+#endif // TRACER_BINARY_H_INCLUDED
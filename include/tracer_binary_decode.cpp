@@ -0,0 +1,425 @@
+/*
+ *****************************************************************************
+ *                                                                           *
+ *                 IMPINJ CONFIDENTIAL AND PROPRIETARY                       *
+ *                                                                           *
+ * This source code is the sole property of Impinj, Inc.  Reproduction or    *
+ * utilization of this source code in whole or in part is forbidden without  *
+ * the prior written consent of Impinj, Inc.                                 *
+ *                                                                           *
+ * (c) Copyright Impinj, Inc. 2009. All rights reserved.                     *
+ *                                                                           *
+ *****************************************************************************
+ */
+
+/*
+ *****************************************************************************
+ *
+ * $Id$
+ *
+ * Description:
+ *     This file contains the offline decoder for binary trace files.  It
+ *     formats each message the way the file tracer would have, so that the
+ *     output reads like rfid_library.log.  It is a standalone program that
+ *     is not part of the library, e.g.:
+ *
+ *         cl /EHsc tracer_binary_decode.cpp
+ *         tracer_binary_decode rfid_library.rtrc rfid_library.log
+ *
+ *
+ *****************************************************************************
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "tracer_binary.h"
+
+#ifdef _MSC_VER
+#define snprintf _snprintf
+#endif
+
+namespace
+{
+    typedef std::map<INT64U, std::string>   FORMATS;
+
+    enum
+    {
+        MAX_BUFFER_SIZE = 1024
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: GetSeverityString
+    //
+    // Description:
+    //   Returns the string that the tracers log for a severity level
+    ////////////////////////////////////////////////////////////////////////////
+    const char* GetSeverityString(
+        INT32U  severity
+        )
+    {
+        switch (severity)
+        {
+            case rfid::Tracer::RFID_LOG_SEVERITY_DEBUG:
+                return "DEBUG";
+            case rfid::Tracer::RFID_LOG_SEVERITY_INFO:
+                return "INFO";
+            case rfid::Tracer::RFID_LOG_SEVERITY_TRACE:
+                return "TRACE";
+            case rfid::Tracer::RFID_LOG_SEVERITY_WARNING:
+                return "WARNING";
+            case rfid::Tracer::RFID_LOG_SEVERITY_ERROR:
+                return "ERROR";
+            default:
+                return "UNKNOWN";
+        }
+    } // GetSeverityString
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: UnpackBytes
+    //
+    // Description:
+    //   Copies the next bytes out of a message's arguments if there are
+    //   enough of them left
+    ////////////////////////////////////////////////////////////////////////////
+    bool UnpackBytes(
+        const INT8U*&   pNext,
+        const INT8U*    pEnd,
+        void*           pBytes,
+        size_t          length
+        )
+    {
+        if (static_cast<size_t>(pEnd - pNext) < length)
+        {
+            return false;
+        }
+        memcpy(pBytes, pNext, length);
+        pNext += length;
+        return true;
+    } // UnpackBytes
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Name: FormatMessage
+    //
+    // Description:
+    //   Formats a message by walking its format one conversion at a time and
+    //   formatting each with the argument that was packed for it.  A message
+    //   whose arguments run out ends with "...".
+    ////////////////////////////////////////////////////////////////////////////
+    std::string FormatMessage(
+        const char*     format,
+        const INT8U*    pArguments,
+        size_t          argumentBytes
+        )
+    {
+        const INT8U*    pNext = pArguments;
+        const INT8U*    pEnd  = pArguments + argumentBytes;
+        std::string     message;
+        char            buffer[MAX_BUFFER_SIZE];
+
+        for (const char* pFormat = format; *pFormat; ++pFormat)
+        {
+            if ('%' != *pFormat)
+            {
+                message += *pFormat;
+                continue;
+            }
+            if ('%' == pFormat[1])
+            {
+                message += '%';
+                ++pFormat;
+                continue;
+            }
+
+            // Rebuild the conversion with any '*' replaced by its value
+            std::string conversion("%");
+            bool        complete = true;
+            for (++pFormat; *pFormat && strchr("-+ #0", *pFormat); ++pFormat)
+            {
+                conversion += *pFormat;
+            }
+            for (int field = 0; complete && (field < 2); ++field)
+            {
+                if ('*' == *pFormat)
+                {
+                    INT64S value;
+                    if (!(complete = UnpackBytes(
+                            pNext, pEnd, &value, sizeof(value))))
+                    {
+                        break;
+                    }
+                    snprintf(buffer, sizeof(buffer), "%d",
+                        static_cast<int>(value));
+                    conversion += buffer;
+                    ++pFormat;
+                }
+                while ((*pFormat >= '0') && (*pFormat <= '9'))
+                {
+                    conversion += *pFormat++;
+                }
+                if ((0 == field) && ('.' == *pFormat))
+                {
+                    conversion += *pFormat++;
+                }
+                else
+                {
+                    break;
+                }
+            }
+
+            // The packed arguments are already widened, so the length
+            // modifier is replaced
+            while (*pFormat && strchr("hlLjztI0123456789", *pFormat))
+            {
+                ++pFormat;
+            }
+
+            buffer[0] = '\0';
+            switch (complete ? *pFormat : '\0')
+            {
+                case 'd':
+                case 'i':
+                case 'u':
+                case 'o':
+                case 'x':
+                case 'X':
+                {
+                    INT64U value;
+                    if ((complete =
+                            UnpackBytes(pNext, pEnd, &value, sizeof(value))))
+                    {
+                        conversion += "ll";
+                        conversion += *pFormat;
+                        snprintf(buffer, sizeof(buffer), conversion.c_str(),
+                            value);
+                    }
+                    break;
+                }
+                case 'c':
+                case 'C':
+                {
+                    INT64S value;
+                    if ((complete =
+                            UnpackBytes(pNext, pEnd, &value, sizeof(value))))
+                    {
+                        conversion += 'c';
+                        snprintf(buffer, sizeof(buffer), conversion.c_str(),
+                            static_cast<int>(value));
+                    }
+                    break;
+                }
+                case 'e':
+                case 'E':
+                case 'f':
+                case 'g':
+                case 'G':
+                case 'a':
+                case 'A':
+                {
+                    double value;
+                    if ((complete =
+                            UnpackBytes(pNext, pEnd, &value, sizeof(value))))
+                    {
+                        conversion += *pFormat;
+                        snprintf(buffer, sizeof(buffer), conversion.c_str(),
+                            value);
+                    }
+                    break;
+                }
+                case 'p':
+                {
+                    INT64U value;
+                    if ((complete =
+                            UnpackBytes(pNext, pEnd, &value, sizeof(value))))
+                    {
+                        conversion += 'p';
+                        snprintf(buffer, sizeof(buffer), conversion.c_str(),
+                            reinterpret_cast<void*>(
+                                static_cast<size_t>(value)));
+                    }
+                    break;
+                }
+                case 'n':
+                    break;
+                case 's':
+                case 'S':
+                {
+                    INT16U length;
+                    if (!(complete = UnpackBytes(
+                            pNext, pEnd, &length, sizeof(length))))
+                    {
+                        break;
+                    }
+                    std::string value("(null)");
+                    if (rfid::TraceBinaryFile::STRING_NULL != length)
+                    {
+                        length = (pEnd - pNext < length) ?
+                            static_cast<INT16U>(pEnd - pNext) : length;
+                        value.assign(
+                            reinterpret_cast<const char*>(pNext), length);
+                        pNext += length;
+                    }
+                    conversion += 's';
+                    snprintf(buffer, sizeof(buffer), conversion.c_str(),
+                        value.c_str());
+                    break;
+                }
+                default:
+                    complete = false;
+                    break;
+            }
+            buffer[sizeof(buffer) - 1] = '\0';
+            message += buffer;
+
+            if (!complete)
+            {
+                message += "...\n";
+                break;
+            }
+        }
+
+        return message;
+    } // FormatMessage
+}
+
+int main(
+    int     argc,
+    char*   argv[]
+    )
+{
+    if ((argc < 2) || (argc > 3))
+    {
+        fprintf(stderr, "usage: %s <trace file> [<output file>]\n", argv[0]);
+        return 1;
+    }
+
+    FILE* pTrace = fopen(argv[1], "rb");
+    if (NULL == pTrace)
+    {
+        fprintf(stderr, "ERROR: cannot open %s\n", argv[1]);
+        return 1;
+    }
+    FILE* pOutput = (3 == argc) ? fopen(argv[2], "w") : stdout;
+    if (NULL == pOutput)
+    {
+        fprintf(stderr, "ERROR: cannot create %s\n", argv[2]);
+        fclose(pTrace);
+        return 1;
+    }
+
+    rfid::TraceBinaryFile::FILE_HEADER fileHeader;
+    if ((1 != fread(&fileHeader, sizeof(fileHeader), 1, pTrace)) ||
+        (rfid::TraceBinaryFile::MAGIC != fileHeader.magic) ||
+        (rfid::TraceBinaryFile::VERSION != fileHeader.version))
+    {
+        fprintf(stderr, "ERROR: %s is not a binary trace file\n", argv[1]);
+        fclose(pTrace);
+        return 1;
+    }
+
+    FORMATS                         formats;
+    std::vector<INT8U>              record;
+    rfid::TraceBinaryFile::RECORD_HEADER header;
+    INT32U                          messages = 0;
+    int                             result   = 0;
+
+    while (1 == fread(&header, sizeof(header), 1, pTrace))
+    {
+        if (header.length < sizeof(header))
+        {
+            fprintf(stderr, "ERROR: corrupt record after %u messages\n",
+                messages);
+            result = 1;
+            break;
+        }
+        record.resize(header.length);
+        memcpy(&record[0], &header, sizeof(header));
+        if ((header.length > sizeof(header)) &&
+            (1 != fread(&record[sizeof(header)],
+                        header.length - sizeof(header),
+                        1,
+                        pTrace)))
+        {
+            // The tracer was stopped part way through a write
+            fprintf(stderr, "WARNING: trace file ends part way through a "
+                "record\n");
+            break;
+        }
+
+        switch (header.type)
+        {
+            case rfid::TraceBinaryFile::RECORD_FORMAT:
+            {
+                rfid::TraceBinaryFile::FORMAT_RECORD format;
+                if (header.length < sizeof(format))
+                {
+                    break;
+                }
+                memcpy(&format, &record[0], sizeof(format));
+                formats[format.formatId].assign(
+                    reinterpret_cast<const char*>(&record[sizeof(format)]),
+                    header.length - sizeof(format));
+                break;
+            }
+            case rfid::TraceBinaryFile::RECORD_MESSAGE:
+            {
+                rfid::TraceBinaryFile::MESSAGE_RECORD message;
+                if (header.length < sizeof(message))
+                {
+                    break;
+                }
+                memcpy(&message, &record[0], sizeof(message));
+
+                FORMATS::const_iterator format =
+                    formats.find(message.formatId);
+                std::string text = (formats.end() == format) ?
+                    std::string("(unknown format)\n") :
+                    FormatMessage(
+                        format->second.c_str(),
+                        &record[0] + sizeof(message),
+                        header.length - sizeof(message));
+                if ((message.flags &
+                     rfid::TraceBinaryFile::MESSAGE_TRUNCATED) &&
+                    (text.size() < 4 ||
+                     text.compare(text.size() - 4, 4, "...\n")))
+                {
+                    text += "...\n";
+                }
+
+                fprintf(pOutput, "%d.%.9d,0x%.8x,%s,%s",
+                    message.seconds,
+                    message.nanoseconds,
+                    message.threadId,
+                    GetSeverityString(message.severity),
+                    text.c_str());
+                ++messages;
+                break;
+            }
+            case rfid::TraceBinaryFile::RECORD_DROPPED:
+            {
+                rfid::TraceBinaryFile::DROPPED_RECORD dropped;
+                if (header.length < sizeof(dropped))
+                {
+                    break;
+                }
+                memcpy(&dropped, &record[0], sizeof(dropped));
+                fprintf(pOutput, "-,0x%.8x,WARNING,%u messages dropped\n",
+                    dropped.threadId,
+                    dropped.count);
+                break;
+            }
+            default:
+                // Skip records from a newer tracer
+                break;
+        }
+    }
+
+    fclose(pTrace);
+    if (stdout != pOutput)
+    {
+        fclose(pOutput);
+    }
+    return result;
+} // main
@@ -0,0 +1,218 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <string.h>
+#include <WinSock2.h>
+#include "rfid_library.h"
+#include "antenna_health.h"
+
+
+/* The antenna ports the reader uses                                         */
+#define HEALTH_FIRST_PORT       1
+#define HEALTH_LAST_PORT        4
+
+/* Reading the sense values costs a few register accesses per port, so only  */
+/* do it this often (in milliseconds) unless a port is being re-probed       */
+#define HEALTH_SAMPLE_INTERVAL  1000
+
+/* How long (in milliseconds) a faulty port stays disabled before it is      */
+/* tried again.  Every failed probe doubles the wait, up to the maximum.     */
+#define HEALTH_MIN_BACKOFF      2000
+#define HEALTH_MAX_BACKOFF      60000
+
+enum
+{
+	ANTENNA_HEALTHY,
+	ANTENNA_OPEN,
+	ANTENNA_SHORTED
+};
+
+typedef struct
+{
+	int     fault;
+	int     disabled;   /* disabled by us, not by the operator */
+	int     probing;    /* re-enabled to be measured after the next inventory */
+	DWORD   backoff;
+	DWORD   nextProbe;
+} ANTENNA_HEALTH;
+
+static ANTENNA_HEALTH   health[HEALTH_LAST_PORT + 1];
+static DWORD            nextSample = 0;
+static int              healthEnabled = 1;
+/* Sense values below this many ohms are taken as a short.  Many UHF         */
+/* antennas are DC grounded, so short detection is off unless asked for.    */
+static INT32U           shortOhms = 0;
+
+static const char* faultName(int fault)
+{
+	return (ANTENNA_OPEN == fault) ? "OPEN" : "SHORTED";
+}
+
+static void report(SOCKET control, const char* message)
+{
+	printf("%s\n", message);
+	send(control, message, strlen(message), 0);
+}
+
+static void setPortState(RFID_RADIO_HANDLE handle, INT32U port, RFID_ANTENNA_PORT_STATE state)
+{
+	RFID_STATUS status = RFID_AntennaPortSetState(handle, port, state);
+
+	if (RFID_STATUS_OK != status)
+	{
+		fprintf(stderr,
+			"ERROR: RFID_AntennaPortSetState returned 0x%.8x\n",
+			status);
+	}
+}
+
+/* ANT_HEALTH ON|OFF [short ohms] */
+void setAntennaHealth(int enable, INT32U shortLimit)
+{
+	healthEnabled = enable;
+	shortOhms = shortLimit;
+	nextSample = GetTickCount();
+}
+
+/* Call between inventories.  Disables the ports whose antenna-sense value  */
+/* says the antenna is open (or shorted), re-enables them for a probe once  */
+/* their backoff expires and reports every change on the control channel.  */
+void checkAntennaHealth(RFID_RADIO_HANDLE handle, SOCKET control)
+{
+	RFID_ANTENNA_PORT_STATUS portStatus;
+	RFID_ANTENNA_PORT_CONFIG portConfig;
+	RFID_STATUS status;
+	DWORD now = GetTickCount();
+	char message[64];
+	INT32U port;
+	int probing = 0;
+
+	/* Switched off: just give back any port we are keeping disabled       */
+	if (!healthEnabled)
+	{
+		restoreAntennaHealth(handle, control);
+		return;
+	}
+
+	/* Give the ports whose backoff has expired another inventory           */
+	for (port = HEALTH_FIRST_PORT; port <= HEALTH_LAST_PORT; ++port)
+	{
+		if (health[port].disabled && (LONG)(now - health[port].nextProbe) >= 0)
+		{
+			setPortState(handle, port, RFID_ANTENNA_PORT_STATE_ENABLED);
+			health[port].disabled = 0;
+			health[port].probing = 1;
+			probing = 1;
+		}
+	}
+	if (probing)
+	{
+		/* Measure them right after that inventory                          */
+		nextSample = now;
+		return;
+	}
+	if ((LONG)(now - nextSample) < 0)
+	{
+		return;
+	}
+	nextSample = now + HEALTH_SAMPLE_INTERVAL;
+
+	/* The threshold is the same for every port                             */
+	portConfig.length = sizeof(RFID_ANTENNA_PORT_CONFIG);
+	status = RFID_AntennaPortGetConfiguration(handle, HEALTH_FIRST_PORT, &portConfig);
+	if (RFID_STATUS_OK != status)
+	{
+		return;
+	}
+
+	for (port = HEALTH_FIRST_PORT; port <= HEALTH_LAST_PORT; ++port)
+	{
+		ANTENNA_HEALTH* antenna = &health[port];
+		int fault;
+
+		portStatus.length = sizeof(RFID_ANTENNA_PORT_STATUS);
+		status = RFID_AntennaPortGetStatus(handle, port, &portStatus);
+		if (RFID_STATUS_OK != status)
+		{
+			break;
+		}
+		/* A port the operator disabled (or that we are keeping disabled)   */
+		/* has not been measured                                            */
+		if (RFID_ANTENNA_PORT_STATE_DISABLED == portStatus.state)
+		{
+			continue;
+		}
+
+		if (portStatus.antennaSenseValue >= portConfig.antennaSenseThreshold)
+		{
+			fault = ANTENNA_OPEN;
+		}
+		else if (portStatus.antennaSenseValue < shortOhms)
+		{
+			fault = ANTENNA_SHORTED;
+		}
+		else
+		{
+			fault = ANTENNA_HEALTHY;
+		}
+
+		if (ANTENNA_HEALTHY != fault)
+		{
+			/* Wait longer after each failed probe                          */
+			if (antenna->probing)
+			{
+				antenna->backoff = (antenna->backoff * 2 < HEALTH_MAX_BACKOFF) ?
+					antenna->backoff * 2 : HEALTH_MAX_BACKOFF;
+			}
+			else
+			{
+				antenna->backoff = HEALTH_MIN_BACKOFF;
+			}
+			setPortState(handle, port, RFID_ANTENNA_PORT_STATE_DISABLED);
+			antenna->disabled = 1;
+			antenna->probing = 0;
+			antenna->nextProbe = now + antenna->backoff;
+
+			if (antenna->fault != fault)
+			{
+				sprintf(message, "$ANT_DOWN,%u,%s,%u#", port, faultName(fault),
+					portStatus.antennaSenseValue);
+				report(control, message);
+			}
+			antenna->fault = fault;
+		}
+		else
+		{
+			if (antenna->fault != ANTENNA_HEALTHY)
+			{
+				sprintf(message, "$ANT_UP,%u,%u#", port,
+					portStatus.antennaSenseValue);
+				report(control, message);
+			}
+			memset(antenna, 0, sizeof(*antenna));
+		}
+	}
+}
+
+/* Call when reading stops: gives back the ports we disabled so that the    */
+/* operator sees them as configured and the next start probes them again.   */
+void restoreAntennaHealth(RFID_RADIO_HANDLE handle, SOCKET control)
+{
+	char message[64];
+	INT32U port;
+
+	for (port = HEALTH_FIRST_PORT; port <= HEALTH_LAST_PORT; ++port)
+	{
+		if (health[port].disabled)
+		{
+			setPortState(handle, port, RFID_ANTENNA_PORT_STATE_ENABLED);
+		}
+		if (health[port].fault != ANTENNA_HEALTHY)
+		{
+			sprintf(message, "$ANT_UNKNOWN,%u#", port);
+			report(control, message);
+		}
+		memset(&health[port], 0, sizeof(health[port]));
+	}
+	nextSample = GetTickCount();
+}
@@ -0,0 +1,14 @@
+#ifndef ANTENNA_HEALTH_H_
+
+#define ANTENNA_HEALTH_H_
+
+#include <WinSock2.h>
+#include "rfid_library.h"
+
+
+void setAntennaHealth(int enable, INT32U shortLimit);
+void checkAntennaHealth(RFID_RADIO_HANDLE handle, SOCKET control);
+void restoreAntennaHealth(RFID_RADIO_HANDLE handle, SOCKET control);
+
+
+#endif /* ANTENNA_HEALTH_H_ */
@@ -0,0 +1,203 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rfid_library.h"
+#include "rfid_packets.h"
+#include "byte_swap.h"
+#include "inventory_batch.h"
+#include "tag_codec.h"
+
+
+/* The number of EPC and TID bytes reserved per read.  The arena grows if    */
+/* the reads are longer than that.                                           */
+#define ARENA_BYTES_PER_READ    24
+
+/* The channel index is in the upper six bits of chidx_phyant                */
+#define INVENTORY_CHANNEL(c)    ((c) >> 2)
+
+/* Room for capacity reads, in every column */
+int createInventoryBatch(INVENTORY_BATCH* batch, INT32U capacity)
+{
+	memset(batch, 0, sizeof(*batch));
+
+	batch->capacity = capacity;
+	batch->arenaSize = capacity * ARENA_BYTES_PER_READ;
+	batch->arena = (INT8U*)malloc(batch->arenaSize);
+	batch->epcOffset = (INT32U*)malloc(capacity * sizeof(INT32U));
+	batch->epcLength = (INT8U*)malloc(capacity);
+	batch->tidOffset = (INT32U*)malloc(capacity * sizeof(INT32U));
+	batch->tidLength = (INT8U*)malloc(capacity);
+	batch->pc = (INT16U*)malloc(capacity * sizeof(INT16U));
+	batch->rssi = (INT16S*)malloc(capacity * sizeof(INT16S));
+	batch->antenna = (INT8U*)malloc(capacity);
+	batch->msCounter = (INT32U*)malloc(capacity * sizeof(INT32U));
+	batch->phase = (INT8U*)malloc(capacity);
+	batch->channel = (INT8U*)malloc(capacity);
+	batch->crcValid = (INT8U*)malloc(capacity);
+
+	if (NULL == batch->arena || NULL == batch->epcOffset ||
+		NULL == batch->epcLength || NULL == batch->tidOffset ||
+		NULL == batch->tidLength || NULL == batch->pc ||
+		NULL == batch->rssi || NULL == batch->antenna ||
+		NULL == batch->msCounter || NULL == batch->phase ||
+		NULL == batch->channel || NULL == batch->crcValid)
+	{
+		destroyInventoryBatch(batch);
+		return 0;
+	}
+	return 1;
+}
+
+void destroyInventoryBatch(INVENTORY_BATCH* batch)
+{
+	free(batch->arena);
+	free(batch->epcOffset);
+	free(batch->epcLength);
+	free(batch->tidOffset);
+	free(batch->tidLength);
+	free(batch->pc);
+	free(batch->rssi);
+	free(batch->antenna);
+	free(batch->msCounter);
+	free(batch->phase);
+	free(batch->channel);
+	free(batch->crcValid);
+	memset(batch, 0, sizeof(*batch));
+}
+
+/* Empties the batch, keeping its memory and the current antenna */
+void clearInventoryBatch(INVENTORY_BATCH* batch)
+{
+	batch->count = 0;
+	batch->arenaUsed = 0;
+}
+
+static int reserveArena(INVENTORY_BATCH* batch, INT32U length)
+{
+	INT8U* arena;
+	INT32U size;
+
+	if (batch->arenaUsed + length <= batch->arenaSize)
+	{
+		return 1;
+	}
+	size = batch->arenaSize * 2 + length;
+	arena = (INT8U*)realloc(batch->arena, size);
+	if (NULL == arena)
+	{
+		return 0;
+	}
+	batch->arena = arena;
+	batch->arenaSize = size;
+	return 1;
+}
+
+/* Adds the read in an inventory packet to the batch, or notes the antenna   */
+/* of an antenna-begin packet.  Other packets are ignored.  Returns 0 if the */
+/* batch is full (or out of memory), otherwise 1.                            */
+int decodeInventoryPacket(INVENTORY_BATCH* batch, const INT8U* pBuffer)
+{
+	const RFID_PACKET_COMMON* common = (const RFID_PACKET_COMMON*)pBuffer;
+	const RFID_PACKET_18K6C_INVENTORY* inv;
+	const INT8U* data;
+	INT16U packetType = MacToHost16(common->pkt_type);
+	INT16U rssi;
+	INT32U index;
+	int length;
+	int epcLength;
+	int tidLength;
+
+	if (RFID_PACKET_TYPE_ANTENNA_BEGIN == packetType)
+	{
+		batch->currentAntenna = MacToHost32(
+			((const RFID_PACKET_ANTENNA_BEGIN*)pBuffer)->antenna);
+		return 1;
+	}
+	if (RFID_PACKET_TYPE_18K6C_INVENTORY != packetType)
+	{
+		return 1;
+	}
+	if (batch->count >= batch->capacity)
+	{
+		return 0;
+	}
+
+	inv = (const RFID_PACKET_18K6C_INVENTORY*)pBuffer;
+	data = (const INT8U*)&inv->inv_data[0];
+	length = inventoryDataLength(inv);
+	tidLength = INVENTORY_HAS_M4_TID(common->flags) ? M4_TID_LENGTH : 0;
+	epcLength = length - tidLength - 4;  /* -4 for 16-bit PC and CRC */
+	if (epcLength < 0)
+	{
+		epcLength = 0;
+		tidLength = 0;
+	}
+	if (!reserveArena(batch, epcLength + tidLength))
+	{
+		return 0;
+	}
+
+	index = batch->count++;
+
+	/* PC, EPC, CRC and then the TID, if any */
+	batch->pc[index] = (INT16U)((data[0] << 8) | data[1]);
+	batch->epcOffset[index] = batch->arenaUsed;
+	batch->epcLength[index] = (INT8U)epcLength;
+	memcpy(&batch->arena[batch->arenaUsed], &data[2], epcLength);
+	batch->arenaUsed += epcLength;
+	batch->tidOffset[index] = batch->arenaUsed;
+	batch->tidLength[index] = (INT8U)tidLength;
+	memcpy(&batch->arena[batch->arenaUsed], &data[4 + epcLength], tidLength);
+	batch->arenaUsed += tidLength;
+
+	/* Firmware that doesn't report the RSSI in tenths of a dBm leaves it    */
+	/* 0.  The narrow-band RSSI is no substitute: it is relative to the      */
+	/* receiver's gain, not in dBm.                                          */
+	rssi = MacToHost16(inv->rssi);
+	batch->rssi[index] = rssi ? (INT16S)((INT16S)rssi * 10) :
+		INVENTORY_RSSI_UNKNOWN;
+	batch->antenna[index] = (INT8U)batch->currentAntenna;
+	batch->msCounter[index] = MacToHost32(inv->ms_ctr);
+	batch->phase[index] = inv->phase;
+	batch->channel[index] = (INT8U)INVENTORY_CHANNEL(inv->chidx_phyant);
+	batch->crcValid[index] =
+		RFID_18K6C_INVENTORY_CRC_IS_INVALID(common->flags) ? 0 : 1;
+	return 1;
+}
+
+/* Decodes a buffer of back-to-back packets.  Returns the number of bytes    */
+/* consumed, which is less than bufferLength if the batch filled up or the   */
+/* buffer ends in a partial packet.                                          */
+INT32U decodeInventoryPackets(INVENTORY_BATCH* batch, const INT8U* pBuffer, INT32U bufferLength)
+{
+	INT32U offset = 0;
+
+	while (bufferLength - offset >= sizeof(RFID_PACKET_COMMON))
+	{
+		const RFID_PACKET_COMMON* common =
+			(const RFID_PACKET_COMMON*)&pBuffer[offset];
+		INT32U packetLength = sizeof(RFID_PACKET_COMMON) +
+			MacToHost16(common->pkt_len) * 4;
+
+		if (bufferLength - offset < packetLength ||
+			!decodeInventoryPacket(batch, &pBuffer[offset]))
+		{
+			break;
+		}
+		offset += packetLength;
+	}
+	return offset;
+}
+
+/* Writes the RSSI in dBm, to a tenth of a dBm, or nothing if it is unknown  */
+void formatInventoryRssi(INT16S rssi, char* buf)
+{
+	if (INVENTORY_RSSI_UNKNOWN == rssi)
+	{
+		buf[0] = '\0';
+		return;
+	}
+	sprintf(buf, "%.1f", rssi / 100.0);
+}
@@ -0,0 +1,52 @@
+#ifndef INVENTORY_BATCH_H_
+
+#define INVENTORY_BATCH_H_
+
+#include "rfid_library.h"
+
+/* The RSSI of a read from firmware that doesn't report it in dBm            */
+#define INVENTORY_RSSI_UNKNOWN  ((INT16S)-32768)
+
+/* The longest string formatInventoryRssi writes, with its terminator        */
+#define INVENTORY_RSSI_CHARS    8
+
+/* The tag reads decoded from inventory packets, one array per field, so     */
+/* that deduplication, filtering and encoding can loop over a single field.  */
+/* Read i is described by element i of every array.                          */
+typedef struct
+{
+	INT32U  count;
+	INT32U  capacity;
+	/* The EPC and TID bytes of the reads, in the order they were decoded    */
+	INT8U*  arena;
+	INT32U  arenaUsed;
+	INT32U  arenaSize;
+	/* Where the EPC (without PC and CRC) and the TID of each read are in    */
+	/* the arena.  tidLength is 0 if the read has no TID.                    */
+	INT32U* epcOffset;
+	INT8U*  epcLength;
+	INT32U* tidOffset;
+	INT8U*  tidLength;
+	INT16U* pc;
+	/* In hundredths of a dBm, or INVENTORY_RSSI_UNKNOWN if the MAC doesn't  */
+	/* report the RSSI in dBm                                                */
+	INT16S* rssi;
+	/* The logical antenna of the last antenna-begin packet                  */
+	INT8U*  antenna;
+	INT32U* msCounter;
+	INT8U*  phase;
+	INT8U*  channel;
+	INT8U*  crcValid;
+	/* The logical antenna the following reads are on                        */
+	INT32U  currentAntenna;
+} INVENTORY_BATCH;
+
+int createInventoryBatch(INVENTORY_BATCH* batch, INT32U capacity);
+void destroyInventoryBatch(INVENTORY_BATCH* batch);
+void clearInventoryBatch(INVENTORY_BATCH* batch);
+int decodeInventoryPacket(INVENTORY_BATCH* batch, const INT8U* pBuffer);
+INT32U decodeInventoryPackets(INVENTORY_BATCH* batch, const INT8U* pBuffer, INT32U bufferLength);
+void formatInventoryRssi(INT16S rssi, char* buf);
+
+
+#endif /* INVENTORY_BATCH_H_ */
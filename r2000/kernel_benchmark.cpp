@@ -0,0 +1,394 @@
+/*
+ * Times the per-tag kernels of the library and the server on their own, over
+ * inventory packets with the EPC lengths that readers see in the field, and
+ * writes the results as JSON.  It is a standalone program that is not part
+ * of r2000.exe; the kernel_benchmark project in r2000.sln builds it (use the
+ * Release configuration), as does e.g.:
+ *
+ *     cl /EHsc /O2 /I..\include kernel_benchmark.cpp tag_codec.c ..\include\crc32.cpp
+ *     kernel_benchmark [seconds per case] > kernels.json
+ */
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+#include "rfid_library.h"
+#include "rfid_packets.h"
+#include "byte_swap.h"
+#include "crc32.h"
+#include "ring_buffer.h"
+#include "tag_codec.h"
+
+
+/* The packets each case cycles through.  Enough that the lengths are mixed */
+/* as the distribution says, few enough that they stay in the cache.        */
+#define PACKET_COUNT            4096
+
+/* The longest EPC (31 words), its hex and the longest inventory packet     */
+#define MAX_EPC_BYTES           62
+#define MAX_EPC_DIGITS          (MAX_EPC_BYTES * 2)
+#define MAX_PACKET_BYTES        (sizeof(RFID_PACKET_COMMON) + 12 + 4 + MAX_EPC_BYTES + M4_TID_LENGTH + 3)
+
+/* hexadecimalToDecimal parses a 96-bit EPC                                 */
+#define PARSED_EPC_DIGITS       24
+
+/* The live transport's cache and the bytes it holds before a read          */
+#define RING_SIZE               2048
+#define RING_BACKLOG            1000
+
+#define DEFAULT_SECONDS         0.5
+
+/* One EPC length in a distribution: how many reads in a hundred have it    */
+/* and how many of those also carry an M4 TID                               */
+typedef struct
+{
+	int     percent;
+	int     epcBytes;
+	int     tidPercent;
+} EPC_SHARE;
+
+typedef struct
+{
+	const char*         name;
+	const EPC_SHARE*    shares;
+	int                 shareCount;
+} EPC_DISTRIBUTION;
+
+/* Retail: SGTIN-96 throughout                                              */
+static const EPC_SHARE sgtin96[] = { { 100, 12, 0 } };
+/* A mixed site: mostly 96-bit, some 128-bit and 112-bit (which needs 2     */
+/* bytes of padding), a few 496-bit, and a tenth of the reads with TIDs     */
+static const EPC_SHARE mixed[] = {
+	{ 75, 12, 10 }, { 15, 16, 10 }, { 5, 14, 10 }, { 5, 62, 10 } };
+/* Serialization checks: 96-bit EPCs, every read with its TID               */
+static const EPC_SHARE tid[] = { { 100, 12, 100 } };
+/* Tags that use the whole EPC bank                                         */
+static const EPC_SHARE long496[] = { { 100, 62, 0 } };
+
+static const EPC_DISTRIBUTION distributions[] = {
+	{ "sgtin96", sgtin96, sizeof(sgtin96) / sizeof(sgtin96[0]) },
+	{ "mixed", mixed, sizeof(mixed) / sizeof(mixed[0]) },
+	{ "m4tid", tid, sizeof(tid) / sizeof(tid[0]) },
+	{ "epc496", long496, sizeof(long496) / sizeof(long496[0]) }
+};
+
+/* The packets of one distribution and what the kernels work on             */
+typedef struct
+{
+	INT8U*  packets;
+	INT32U  offsets[PACKET_COUNT];
+	INT32U  sizes[PACKET_COUNT];
+	/* The upper-case hex of each EPC, as the server's clients send it      */
+	char    epcDigits[PACKET_COUNT][MAX_EPC_DIGITS + 1];
+	INT32U  packetBytes;
+	INT32U  epcBytes;
+} PACKET_SET;
+
+typedef INT32U (*KERNEL)(const PACKET_SET* pSet, INT32U* pBytes);
+
+/* Folded into the output so that no kernel's work can be optimized away    */
+static volatile INT32U sink;
+
+static LONGLONG frequency;
+
+static LONGLONG now(void)
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return counter.QuadPart;
+}
+
+/* The same pseudo-random packets on every run                              */
+static INT32U nextRandom(INT32U* pState)
+{
+	*pState = *pState * 1103515245 + 12345;
+	return (*pState >> 16) & 0x7fff;
+}
+
+static const INT8U* packetAt(const PACKET_SET* pSet, INT32U index)
+{
+	return pSet->packets + pSet->offsets[index];
+}
+
+static const INT8U* epcOf(const PACKET_SET* pSet, INT32U index)
+{
+	const RFID_PACKET_18K6C_INVENTORY* inv =
+		(const RFID_PACKET_18K6C_INVENTORY*)packetAt(pSet, index);
+	return (const INT8U*)&inv->inv_data[0] + 2;
+}
+
+/* Makes the inventory packets of a distribution as the MAC sends them      */
+static int buildPackets(const EPC_DISTRIBUTION* pDistribution, PACKET_SET* pSet)
+{
+	static const char digits[] = "0123456789ABCDEF";
+	INT32U random = 0x2000;
+	INT32U offset = 0;
+	INT32U index;
+
+	pSet->packets = (INT8U*)malloc(PACKET_COUNT * MAX_PACKET_BYTES);
+	if (NULL == pSet->packets)
+	{
+		return 0;
+	}
+	pSet->packetBytes = 0;
+	pSet->epcBytes = 0;
+
+	for (index = 0; index < PACKET_COUNT; ++index)
+	{
+		RFID_PACKET_18K6C_INVENTORY* inv = (RFID_PACKET_18K6C_INVENTORY*)(pSet->packets + offset);
+		INT8U* data = (INT8U*)&inv->inv_data[0];
+		int pick = nextRandom(&random) % 100;
+		int share = 0;
+		int hasTid;
+		int dataBytes;
+		int padding;
+		int byte;
+
+		while (share < pDistribution->shareCount - 1 &&
+			pick >= pDistribution->shares[share].percent)
+		{
+			pick -= pDistribution->shares[share].percent;
+			++share;
+		}
+		hasTid = (int)(nextRandom(&random) % 100) < pDistribution->shares[share].tidPercent;
+		dataBytes = 4 + pDistribution->shares[share].epcBytes + (hasTid ? M4_TID_LENGTH : 0);
+		padding = (4 - dataBytes % 4) % 4;
+
+		memset(inv, 0, MAX_PACKET_BYTES);
+		inv->cmn.pkt_ver = 1;
+		inv->cmn.flags = (INT8U)((padding << 6) | (hasTid ? 0x04 : 0x00));
+		inv->cmn.pkt_type = HostToMac16(RFID_PACKET_TYPE_18K6C_INVENTORY);
+		inv->cmn.pkt_len = HostToMac16(3 + (dataBytes + padding) / 4);
+		inv->ms_ctr = HostToMac32(index);
+		inv->nb_rssi = (INT8U)nextRandom(&random);
+
+		/* PC (the EPC length in words), EPC, CRC and then the TID          */
+		data[0] = (INT8U)((pDistribution->shares[share].epcBytes / 2) << 3);
+		for (byte = 2; byte < dataBytes; ++byte)
+		{
+			data[byte] = (INT8U)nextRandom(&random);
+		}
+		for (byte = 0; byte < pDistribution->shares[share].epcBytes; ++byte)
+		{
+			pSet->epcDigits[index][byte * 2] = digits[data[2 + byte] >> 4];
+			pSet->epcDigits[index][byte * 2 + 1] = digits[data[2 + byte] & 0x0f];
+		}
+		pSet->epcDigits[index][byte * 2] = '\0';
+
+		pSet->offsets[index] = offset;
+		pSet->sizes[index] = sizeof(RFID_PACKET_COMMON) + 12 + dataBytes + padding;
+		pSet->packetBytes += pSet->sizes[index];
+		pSet->epcBytes += pDistribution->shares[share].epcBytes;
+		offset += pSet->sizes[index];
+	}
+	return 1;
+}
+
+/* RFID_PACKET_18K6C_INVENTORY length and padding decode                    */
+static INT32U decodeKernel(const PACKET_SET* pSet, INT32U* pBytes)
+{
+	INT32U sum = 0;
+	INT32U index;
+
+	for (index = 0; index < PACKET_COUNT; ++index)
+	{
+		const RFID_PACKET_18K6C_INVENTORY* inv =
+			(const RFID_PACKET_18K6C_INVENTORY*)packetAt(pSet, index);
+		sum += inventoryDataLength(inv) + inventoryEpcLength(inv);
+	}
+	*pBytes = PACKET_COUNT * (INT32U)sizeof(RFID_PACKET_COMMON);
+	return sum;
+}
+
+/* Int32ArrayMacToHost over each packet after its preamble, then            */
+/* Int16ArrayMacToHost over its PC and EPC words                            */
+static INT32U macToHostKernel(const PACKET_SET* pSet, INT32U* pBytes)
+{
+	INT32U words[MAX_PACKET_BYTES / 4];
+	INT32U sum = 0;
+	INT32U index;
+
+	for (index = 0; index < PACKET_COUNT; ++index)
+	{
+		const RFID_PACKET_18K6C_INVENTORY* inv =
+			(const RFID_PACKET_18K6C_INVENTORY*)packetAt(pSet, index);
+		INT32U count = MacToHost16(inv->cmn.pkt_len);
+		memcpy(words, &inv->ms_ctr, count * 4);
+		Int32ArrayMacToHost(words, count);
+		Int16ArrayMacToHost((INT16U*)&words[3], 1 + inventoryEpcLength(inv) / 2);
+		sum += words[0] + words[3];
+	}
+	*pBytes = pSet->packetBytes - PACKET_COUNT * (INT32U)sizeof(RFID_PACKET_COMMON);
+	return sum;
+}
+
+/* saveByteArray of each EPC into the string the server sends               */
+static INT32U encodeKernel(const PACKET_SET* pSet, INT32U* pBytes)
+{
+	char buf[MAX_EPC_DIGITS + 1];
+	INT32U sum = 0;
+	INT32U index;
+
+	for (index = 0; index < PACKET_COUNT; ++index)
+	{
+		const RFID_PACKET_18K6C_INVENTORY* inv =
+			(const RFID_PACKET_18K6C_INVENTORY*)packetAt(pSet, index);
+		buf[0] = '\0';
+		saveByteArray(epcOf(pSet, index), inventoryEpcLength(inv), buf);
+		sum += buf[0];
+	}
+	*pBytes = pSet->epcBytes;
+	return sum;
+}
+
+/* hexadecimalToDecimal of the first 96 bits of each EPC's hex, as the      */
+/* WRITE_EPC command gets them from a client                                */
+static INT32U parseKernel(const PACKET_SET* pSet, INT32U* pBytes)
+{
+	INT16U words[PARSED_EPC_DIGITS / 4];
+	INT32U sum = 0;
+	INT32U index;
+
+	for (index = 0; index < PACKET_COUNT; ++index)
+	{
+		hexadecimalToDecimal((char*)pSet->epcDigits[index], words);
+		sum += words[0] + words[5];
+	}
+	*pBytes = PACKET_COUNT * PARSED_EPC_DIGITS;
+	return sum;
+}
+
+/* FastCrc32 over each packet, as NV update checks its packets              */
+static INT32U crcKernel(const PACKET_SET* pSet, INT32U* pBytes)
+{
+	INT32U sum = 0;
+	INT32U index;
+
+	for (index = 0; index < PACKET_COUNT; ++index)
+	{
+		sum += rfid::FastCrc32(0, packetAt(pSet, index), pSet->sizes[index]);
+	}
+	*pBytes = pSet->packetBytes;
+	return sum;
+}
+
+/* RingBuffer::Add of each packet and RingBuffer::Remove of one as long,    */
+/* with the backlog the live transport's cache carries, so that the head    */
+/* and the tail wrap around at every packet size                            */
+static INT32U ringKernel(const PACKET_SET* pSet, INT32U* pBytes)
+{
+	static rfid::RingBuffer<RING_SIZE> ring;
+	INT8U buffer[MAX_PACKET_BYTES];
+	INT32U sum = 0;
+	INT32U index;
+
+	ring.Clear();
+	memset(buffer, 0, sizeof(buffer));
+	while (ring.BytesUsed() < RING_BACKLOG)
+	{
+		ring.Add(buffer, sizeof(buffer));
+	}
+	for (index = 0; index < PACKET_COUNT; ++index)
+	{
+		ring.Add(packetAt(pSet, index), pSet->sizes[index]);
+		sum += ring.Remove(buffer, pSet->sizes[index]);
+		sum += buffer[0];
+	}
+	*pBytes = pSet->packetBytes * 2;
+	return sum;
+}
+
+typedef struct
+{
+	const char* name;
+	KERNEL      kernel;
+} KERNEL_CASE;
+
+static const KERNEL_CASE kernels[] = {
+	{ "inventoryDecode", decodeKernel },
+	{ "macToHostArrays", macToHostKernel },
+	{ "saveByteArray", encodeKernel },
+	{ "hexadecimalToDecimal", parseKernel },
+	{ "fastCrc32", crcKernel },
+	{ "ringBuffer", ringKernel }
+};
+
+/* Runs a kernel over the packets until the time is up and writes how long  */
+/* each tag took                                                            */
+static void runCase(const KERNEL_CASE* pCase, const EPC_DISTRIBUTION* pDistribution, const PACKET_SET* pSet, double seconds, int first)
+{
+	LONGLONG limit = (LONGLONG)(seconds * frequency);
+	LONGLONG start;
+	LONGLONG elapsed;
+	INT32U passes = 0;
+	INT32U bytes = 0;
+	double tags;
+
+	/* Once to warm the cache and the branch predictors                     */
+	sink += pCase->kernel(pSet, &bytes);
+
+	start = now();
+	do
+	{
+		sink += pCase->kernel(pSet, &bytes);
+		++passes;
+		elapsed = now() - start;
+	} while (elapsed < limit);
+
+	tags = (double)passes * PACKET_COUNT;
+	printf("%s\n    {\"kernel\": \"%s\", \"epcLengths\": \"%s\", "
+		"\"tags\": %.0f, \"seconds\": %.6f, "
+		"\"nanosecondsPerTag\": %.2f, \"megabytesPerSecond\": %.1f}",
+		first ? "" : ",",
+		pCase->name, pDistribution->name,
+		tags, (double)elapsed / frequency,
+		(double)elapsed * 1e9 / frequency / tags,
+		(double)passes * bytes / ((double)elapsed / frequency) / 1e6);
+}
+
+int main(int argc, char* argv[])
+{
+	static PACKET_SET set;
+	LARGE_INTEGER counterFrequency;
+	double seconds = DEFAULT_SECONDS;
+	size_t distribution;
+	size_t kernel;
+	int first = 1;
+
+	if (argc > 1)
+	{
+		seconds = atof(argv[1]);
+		if (seconds <= 0)
+		{
+			fprintf(stderr, "usage: kernel_benchmark [seconds per case]\n");
+			return 1;
+		}
+	}
+	QueryPerformanceFrequency(&counterFrequency);
+	frequency = counterFrequency.QuadPart;
+
+	printf("{\n  \"benchmark\": \"r2000-kernels\",\n"
+		"  \"packetsPerPass\": %u,\n"
+		"  \"cases\": [",
+		PACKET_COUNT);
+	for (distribution = 0; distribution < sizeof(distributions) / sizeof(distributions[0]); ++distribution)
+	{
+		if (!buildPackets(&distributions[distribution], &set))
+		{
+			fprintf(stderr, "ERROR: Failed to allocate memory\n");
+			return 1;
+		}
+		for (kernel = 0; kernel < sizeof(kernels) / sizeof(kernels[0]); ++kernel)
+		{
+			runCase(&kernels[kernel], &distributions[distribution], &set, seconds, first);
+			first = 0;
+			fflush(stdout);
+		}
+		free(set.packets);
+	}
+	printf("\n  ],\n  \"checksum\": %u\n}\n", sink);
+	return 0;
+}
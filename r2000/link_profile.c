@@ -0,0 +1,336 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <WinSock2.h>
+#include "rfid_library.h"
+#include "rfid_packets.h"
+#include "byte_swap.h"
+#include "link_profile.h"
+
+
+/* The radio doesn't say how many link profiles it has, so we ask for        */
+/* profiles until it refuses one (or we reach this many)                     */
+#define MAX_LINK_PROFILES       16
+
+/* Enough room to count the unique tags of a large population.  Must be a    */
+/* power of two.                                                             */
+#define UNIQUE_TAG_SLOTS        4096
+
+typedef struct
+{
+	DWORD   deadline;
+	INT32U  reads;
+	INT32U  crcErrors;
+	INT32U  uniqueTags;
+	INT32U  tagHashes[UNIQUE_TAG_SLOTS];
+} BENCHMARK_CONTEXT;
+
+
+/* FNV-1a hash of the PC, EPC and CRC of a tag.  Zero marks a free slot.     */
+static INT32U hashTag(const INT8U* data, int length)
+{
+	INT32U hash = 2166136261u;
+
+	while (length-- > 0)
+	{
+		hash = (hash ^ *data++) * 16777619u;
+	}
+	return hash ? hash : 1;
+}
+
+static void countTag(BENCHMARK_CONTEXT* bench, const INT8U* data, int length)
+{
+	INT32U hash = hashTag(data, length);
+	INT32U slot = hash & (UNIQUE_TAG_SLOTS - 1);
+
+	/* Once the table is nearly full, count reads only                       */
+	if (bench->uniqueTags >= UNIQUE_TAG_SLOTS - UNIQUE_TAG_SLOTS / 8)
+	{
+		return;
+	}
+	while (bench->tagHashes[slot] != 0)
+	{
+		if (bench->tagHashes[slot] == hash)
+		{
+			return;
+		}
+		slot = (slot + 1) & (UNIQUE_TAG_SLOTS - 1);
+	}
+	bench->tagHashes[slot] = hash;
+	bench->uniqueTags++;
+}
+
+static INT32S benchmarkCallback(RFID_RADIO_HANDLE handle, INT32U bufferLength, const INT8U* pBuffer, void* context)
+{
+	BENCHMARK_CONTEXT* bench = (BENCHMARK_CONTEXT*)context;
+	RFID_PACKET_COMMON* common = (RFID_PACKET_COMMON*)pBuffer;
+	RFID_UNREFERENCED_LOCAL(handle);
+	RFID_UNREFERENCED_LOCAL(bufferLength);
+
+	if (MacToHost16(common->pkt_type) == RFID_PACKET_TYPE_18K6C_INVENTORY)
+	{
+		RFID_PACKET_18K6C_INVENTORY* inv = (RFID_PACKET_18K6C_INVENTORY*)pBuffer;
+		int length = ((MacToHost16(common->pkt_len) - 3) * 4) - (common->flags >> 6);
+
+		if (RFID_18K6C_INVENTORY_CRC_IS_INVALID(common->flags))
+		{
+			bench->crcErrors++;
+		}
+		else
+		{
+			bench->reads++;
+			countTag(bench, (INT8U*)&inv->inv_data[0], length);
+		}
+	}
+
+	/* A non-zero return stops the inventory once the dwell is over          */
+	return ((LONG)(GetTickCount() - bench->deadline) >= 0) ? 1 : 0;
+}
+
+/* Inventories with the radio's current settings for dwellTime milliseconds */
+static void runTrial(RFID_RADIO_HANDLE handle, INT32U dwellTime, BENCHMARK_CONTEXT* bench, LINK_PROFILE_RESULT* result)
+{
+	RFID_18K6C_INVENTORY_PARMS inventoryParms;
+	RFID_STATUS status;
+	DWORD start = GetTickCount();
+	DWORD elapsed;
+
+	memset(bench, 0, sizeof(*bench));
+	bench->deadline = start + dwellTime;
+
+	inventoryParms.length = sizeof(RFID_18K6C_INVENTORY_PARMS);
+	inventoryParms.common.tagStopCount = 0;
+	inventoryParms.common.pCallback = benchmarkCallback;
+	inventoryParms.common.pCallbackCode = NULL;
+	inventoryParms.common.context = bench;
+
+	/* Each inventory ends when the antennas have had their dwell (or the    */
+	/* callback stops it), so keep starting them until our dwell is over     */
+	while ((LONG)(GetTickCount() - bench->deadline) < 0)
+	{
+		status = RFID_18K6CTagInventory(handle, &inventoryParms, 0);
+		if (RFID_STATUS_OK != status && RFID_ERROR_OPERATION_CANCELLED != status)
+		{
+			/* The abort requested by the callback lands here too; anything */
+			/* else means this combination can't be measured                */
+			if ((LONG)(GetTickCount() - bench->deadline) < 0)
+			{
+				fprintf(stderr,
+					"ERROR: RFID_18K6CTagInventory returned 0x%.8x\n",
+					status);
+				break;
+			}
+		}
+	}
+
+	elapsed = GetTickCount() - start;
+	if (elapsed == 0)
+	{
+		elapsed = 1;
+	}
+	result->uniqueTagsPerSecond = bench->uniqueTags * 1000.0 / elapsed;
+	result->readsPerSecond = bench->reads * 1000.0 / elapsed;
+	result->crcErrorRate = (bench->reads + bench->crcErrors) ?
+		(double)bench->crcErrors / (bench->reads + bench->crcErrors) : 0.0;
+}
+
+/* A profile wins on unique tags per second, then on total reads per second */
+static int isBetter(const LINK_PROFILE_RESULT* a, const LINK_PROFILE_RESULT* b)
+{
+	if (a->uniqueTagsPerSecond != b->uniqueTagsPerSecond)
+	{
+		return a->uniqueTagsPerSecond > b->uniqueTagsPerSecond;
+	}
+	return a->readsPerSecond > b->readsPerSecond;
+}
+
+/* Runs an inventory for dwellTime milliseconds with every enabled link      */
+/* profile and, if withSessions is set, every session/target combination.    */
+/* Reports the best combination in pBest and, if apply is set, leaves the     */
+/* radio configured with it; otherwise the original settings are restored.   */
+/* Returns the number of combinations measured.                              */
+int benchmarkLinkProfiles(RFID_RADIO_HANDLE handle, INT32U dwellTime, int withSessions, int apply, LINK_PROFILE_RESULT* pBest)
+{
+	RFID_RADIO_LINK_PROFILE linkProfile;
+	RFID_18K6C_TAG_GROUP originalGroup;
+	RFID_18K6C_TAG_GROUP group;
+	LINK_PROFILE_RESULT result;
+	BENCHMARK_CONTEXT* bench;
+	RFID_STATUS status;
+	INT32U originalProfile;
+	INT32U profile;
+	INT32U session;
+	INT32U target;
+	int measured = 0;
+
+	bench = (BENCHMARK_CONTEXT*)malloc(sizeof(BENCHMARK_CONTEXT));
+	if (NULL == bench)
+	{
+		fprintf(stderr, "ERROR: Failed to allocate memory\n");
+		return 0;
+	}
+
+	RFID_RadioGetCurrentLinkProfile(handle, &originalProfile);
+	RFID_18K6CGetQueryTagGroup(handle, &originalGroup);
+	memset(pBest, 0, sizeof(*pBest));
+
+	for (profile = 0; profile < MAX_LINK_PROFILES; ++profile)
+	{
+		linkProfile.length = sizeof(RFID_RADIO_LINK_PROFILE);
+		if (RFID_STATUS_OK != RFID_RadioGetLinkProfile(handle, profile, &linkProfile))
+		{
+			break;
+		}
+		if (!linkProfile.enabled)
+		{
+			continue;
+		}
+		status = RFID_RadioSetCurrentLinkProfile(handle, profile);
+		if (RFID_STATUS_OK != status)
+		{
+			fprintf(stderr,
+				"ERROR: RFID_RadioSetCurrentLinkProfile returned 0x%.8x\n",
+				status);
+			continue;
+		}
+
+		for (session = 0; session < (withSessions ? 4u : 1u); ++session)
+		{
+			for (target = 0; target < (withSessions ? 2u : 1u); ++target)
+			{
+				group = originalGroup;
+				if (withSessions)
+				{
+					group.session = session;
+					group.target = target;
+					RFID_18K6CSetQueryTagGroup(handle, &group);
+				}
+
+				runTrial(handle, dwellTime, bench, &result);
+				result.profile = profile;
+				result.session = group.session;
+				result.target = group.target;
+				printf("Profile %u S%u %c: %.1f tags/s, %.1f reads/s, %.2f%% CRC errors\n",
+					result.profile, result.session, result.target ? 'B' : 'A',
+					result.uniqueTagsPerSecond, result.readsPerSecond,
+					result.crcErrorRate * 100.0);
+
+				if (!measured++ || isBetter(&result, pBest))
+				{
+					*pBest = result;
+				}
+			}
+		}
+	}
+
+	/* Leave the radio with the winner, or as we found it                    */
+	if (apply && measured)
+	{
+		group = originalGroup;
+		group.session = pBest->session;
+		group.target = pBest->target;
+		RFID_RadioSetCurrentLinkProfile(handle, pBest->profile);
+		RFID_18K6CSetQueryTagGroup(handle, &group);
+	}
+	else
+	{
+		RFID_RadioSetCurrentLinkProfile(handle, originalProfile);
+		RFID_18K6CSetQueryTagGroup(handle, &originalGroup);
+	}
+
+	free(bench);
+	return measured;
+}
+
+/* The value of a link parameter for a profile, in the units the operator    */
+/* uses: Tari in microseconds, BLF in kHz and M as 1 (FM0), 2, 4 or 8        */
+static double linkParam(const RFID_RADIO_LINK_PROFILE* profile, LINK_PARAM param)
+{
+	switch (param)
+	{
+	case LINK_PARAM_TARI:
+		return profile->profileConfig.iso18K6C.tari / 1000.0;
+	case LINK_PARAM_BLF:
+		return profile->profileConfig.iso18K6C.trLinkFrequency / 1000.0;
+	default:
+		return 1 << profile->profileConfig.iso18K6C.millerNumber;
+	}
+}
+
+/* The radio only supports the Tari/BLF/M combinations in its link profiles, */
+/* so selecting a value means selecting the enabled profile closest to it,   */
+/* preferring one that keeps the other parameters of the current profile.    */
+/* Returns the profile selected, or -1.                                      */
+int selectLinkProfile(RFID_RADIO_HANDLE handle, LINK_PARAM param, double value)
+{
+	RFID_RADIO_LINK_PROFILE current;
+	RFID_RADIO_LINK_PROFILE linkProfile;
+	RFID_STATUS status;
+	INT32U currentProfile;
+	INT32U profile;
+	double bestDistance = 0.0;
+	int bestKept = 0;
+	int best = -1;
+	LINK_PARAM other;
+
+	if (RFID_STATUS_OK != RFID_RadioGetCurrentLinkProfile(handle, &currentProfile))
+	{
+		return -1;
+	}
+	current.length = sizeof(RFID_RADIO_LINK_PROFILE);
+	if (RFID_STATUS_OK != RFID_RadioGetLinkProfile(handle, currentProfile, &current))
+	{
+		return -1;
+	}
+
+	for (profile = 0; profile < MAX_LINK_PROFILES; ++profile)
+	{
+		double distance;
+		int kept = 0;
+
+		linkProfile.length = sizeof(RFID_RADIO_LINK_PROFILE);
+		if (RFID_STATUS_OK != RFID_RadioGetLinkProfile(handle, profile, &linkProfile))
+		{
+			break;
+		}
+		if (!linkProfile.enabled)
+		{
+			continue;
+		}
+
+		distance = linkParam(&linkProfile, param) - value;
+		distance = distance < 0 ? -distance : distance;
+		for (other = LINK_PARAM_TARI; other <= LINK_PARAM_M; ++other)
+		{
+			if (other != param &&
+				linkParam(&linkProfile, other) == linkParam(&current, other))
+			{
+				kept++;
+			}
+		}
+
+		if (best < 0 || distance < bestDistance ||
+			(distance == bestDistance && kept > bestKept))
+		{
+			best = (int)profile;
+			bestDistance = distance;
+			bestKept = kept;
+		}
+	}
+
+	if (best >= 0 && (INT32U)best != currentProfile)
+	{
+		status = RFID_RadioSetCurrentLinkProfile(handle, best);
+		if (RFID_STATUS_OK != status)
+		{
+			fprintf(stderr,
+				"ERROR: RFID_RadioSetCurrentLinkProfile returned 0x%.8x\n",
+				status);
+			return -1;
+		}
+	}
+	printf("Link profile %d\n", best);
+	return best;
+}
@@ -0,0 +1,32 @@
+#ifndef LINK_PROFILE_H_
+
+#define LINK_PROFILE_H_
+
+#include "rfid_library.h"
+
+
+/* The link parameters an operator can ask for by value */
+enum
+{
+	LINK_PARAM_TARI,
+	LINK_PARAM_BLF,
+	LINK_PARAM_M
+};
+typedef INT32U  LINK_PARAM;
+
+/* The result of inventorying with one profile/session/target combination */
+typedef struct
+{
+	INT32U  profile;
+	INT32U  session;
+	INT32U  target;
+	double  uniqueTagsPerSecond;
+	double  readsPerSecond;
+	double  crcErrorRate;
+} LINK_PROFILE_RESULT;
+
+int selectLinkProfile(RFID_RADIO_HANDLE handle, LINK_PARAM param, double value);
+int benchmarkLinkProfiles(RFID_RADIO_HANDLE handle, INT32U dwellTime, int withSessions, int apply, LINK_PROFILE_RESULT* pBest);
+
+
+#endif /* LINK_PROFILE_H_ */
@@ -0,0 +1,515 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <string.h>
+#include <WinSock2.h>
+#include "rfid_library.h"
+#include "rfid_library_ext.h"
+#include "rfid_packets.h"
+#include "byte_swap.h"
+#include "reader_params.h"
+#include "radio_supervisor.h"
+#include "multi_radio.h"
+#include "server_metrics.h"
+#include "rfid_probes.h"
+#include "inventory_batch.h"
+
+
+/* The reads each radio can have waiting to be merged.  A radio that gets    */
+/* further ahead than this loses its newest reads.                           */
+#define MULTI_QUEUE_SIZE        4096
+
+/* An EPC is at most 31 words                                                */
+#define MULTI_MAX_EPC_BYTES     62
+
+/* A read is held back this long (in milliseconds) for the other radios to   */
+/* report anything read before it, unless they all have reads waiting        */
+#define MULTI_DEFAULT_WINDOW    200
+
+/* How often (in milliseconds) the merge looks for reads to send             */
+#define MULTI_MERGE_INTERVAL    10
+
+/* How often (in milliseconds) stopping re-cancels a radio's inventory       */
+#define MULTI_STOP_INTERVAL     100
+
+/* Milliseconds between 1601 (FILETIME) and 1970                             */
+#define FILETIME_EPOCH_MS       11644473600000ULL
+
+/* Room for a radio's saved configuration (as in radio_supervisor.c)         */
+#define MULTI_CONFIG_SIZE       4096
+
+typedef struct
+{
+	INT64U  time;       /* host time (ms since 1970) the radio read the tag */
+	LONGLONG received;  /* when the callback had it (per metricsNow)        */
+	INT32U  antenna;
+	INT16S  rssi;       /* hundredths of a dBm, as the decoder reports it   */
+	INT8U   epcLength;
+	INT8U   epc[MULTI_MAX_EPC_BYTES];
+} MULTI_READ;
+
+typedef struct
+{
+	INT32U                  id;     /* the radio's place in the enumeration */
+	RFID_RADIO_HANDLE       handle;
+	HANDLE                  thread;
+	volatile int            running;
+	/* Only touched by the radio's own thread                                */
+	RFID_RADIO_CLOCK_MODEL  clockModel;
+	/* Decodes the radio's packets one read at a time and follows the        */
+	/* antenna they are on                                                   */
+	INVENTORY_BATCH         batch;
+	/* The reads waiting to be merged, oldest first                          */
+	CRITICAL_SECTION        lock;
+	MULTI_READ              queue[MULTI_QUEUE_SIZE];
+	INT32U                  head;
+	INT32U                  count;
+	INT32U                  dropped;
+} MULTI_RADIO;
+
+static MULTI_RADIO      radios[MULTI_MAX_RADIOS];
+static INT32U           radioCount = 0;
+static int              multiEnabled = 0;
+static int              pinThreads = 0;
+static INT32U           mergeWindow = MULTI_DEFAULT_WINDOW;
+static volatile int     merging = 0;
+static HANDLE           mergeThread = NULL;
+static SOCKET           mergeOutput;
+static SOCKET           mergeControl;
+
+static INT64U hostNow(void)
+{
+	FILETIME now;
+	ULARGE_INTEGER time;
+
+	GetSystemTimeAsFileTime(&now);
+	time.LowPart = now.dwLowDateTime;
+	time.HighPart = now.dwHighDateTime;
+	return time.QuadPart / 10000 - FILETIME_EPOCH_MS;
+}
+
+static void report(SOCKET control, const char* message)
+{
+	printf("%s\n", message);
+	send(control, message, strlen(message), 0);
+}
+
+/* Opens the radios after the first (which the caller has opened) and sets  */
+/* them up the same way.  Returns the number of radios that are open.       */
+int openMultiRadios(const RFID_RADIO_ENUM* pEnum, RFID_RADIO_HANDLE first, INT32U maxAttempts)
+{
+	RFID_STATUS status;
+	INT32U index;
+
+	memset(radios, 0, sizeof(radios));
+	radios[0].id = 0;
+	radios[0].handle = first;
+	InitializeCriticalSection(&radios[0].lock);
+	radioCount = 1;
+
+	for (index = 1;
+		index < pEnum->countRadios && radioCount < MULTI_MAX_RADIOS;
+		++index)
+	{
+		MULTI_RADIO* radio = &radios[radioCount];
+
+		status = RFID_RadioOpen(pEnum->ppRadioInfo[index]->cookie, &radio->handle, 0);
+		if (RFID_STATUS_OK != status)
+		{
+			fprintf(stderr, "ERROR: RFID_RadioOpen returned 0x%.8x for radio %u\n",
+				status, index);
+			continue;
+		}
+		setAccessRetryPolicy(radio->handle, maxAttempts);
+		setInventorySubscription(radio->handle);
+		setResponseTimeout(radio->handle);
+		radio->id = index;
+		InitializeCriticalSection(&radio->lock);
+		++radioCount;
+	}
+	copyMultiRadioConfiguration();
+	return radioCount;
+}
+
+/* Gives the radios after the first the first radio's configuration (what    */
+/* RFID_RadioSaveConfiguration keeps: antennas and their power, link         */
+/* profile, singulation, select criteria and Impinj extensions).  Call after */
+/* anything changes the first radio's configuration.  Returns the number of  */
+/* radios that would not take it.                                            */
+int copyMultiRadioConfiguration(void)
+{
+	static INT8U registers[MULTI_CONFIG_SIZE];
+	INT32U length = sizeof(registers);
+	RFID_STATUS status;
+	INT32U index;
+	int failed = 0;
+
+	if (radioCount < 2)
+	{
+		return 0;
+	}
+	status = RFID_RadioSaveConfiguration(radios[0].handle, registers, &length);
+	if (RFID_STATUS_OK != status)
+	{
+		fprintf(stderr, "ERROR: RFID_RadioSaveConfiguration returned 0x%.8x\n",
+			status);
+		return radioCount - 1;
+	}
+	for (index = 1; index < radioCount; ++index)
+	{
+		status = RFID_RadioRestoreConfiguration(radios[index].handle, registers, length);
+		if (RFID_STATUS_OK != status)
+		{
+			fprintf(stderr, "ERROR: RFID_RadioRestoreConfiguration returned 0x%.8x for radio %u\n",
+				status, radios[index].id);
+			++failed;
+		}
+	}
+	return failed;
+}
+
+/* Closes the radios openMultiRadios opened; the first is the caller's       */
+void closeMultiRadios(void)
+{
+	INT32U index;
+
+	stopMultiRead();
+	for (index = 0; index < radioCount; ++index)
+	{
+		if (index > 0)
+		{
+			RFID_RadioClose(radios[index].handle);
+		}
+		DeleteCriticalSection(&radios[index].lock);
+	}
+	radioCount = 0;
+}
+
+INT32U getMultiRadioCount(void)
+{
+	return radioCount;
+}
+
+/* MULTI_RADIO ON|OFF [window ms] [PIN] */
+void setMultiRadio(int enable, INT32U windowMs, int pin)
+{
+	multiEnabled = enable;
+	mergeWindow = windowMs ? windowMs : MULTI_DEFAULT_WINDOW;
+	pinThreads = pin;
+}
+
+int isMultiRadioEnabled(void)
+{
+	return multiEnabled;
+}
+
+static void queueRead(MULTI_RADIO* radio, const MULTI_READ* read)
+{
+	EnterCriticalSection(&radio->lock);
+	if (radio->count < MULTI_QUEUE_SIZE)
+	{
+		radio->queue[(radio->head + radio->count) % MULTI_QUEUE_SIZE] = *read;
+		++radio->count;
+		metricsQueued();
+	}
+	else
+	{
+		++radio->dropped;
+		metricsDropped(1);
+	}
+	LeaveCriticalSection(&radio->lock);
+}
+
+static INT32S multiCallback(RFID_RADIO_HANDLE handle, INT32U bufferLength, const INT8U* pBuffer, void* context)
+{
+	MULTI_RADIO* radio = (MULTI_RADIO*)context;
+	INVENTORY_BATCH* batch = &radio->batch;
+	const RFID_PACKET_COMMON* common = (const RFID_PACKET_COMMON*)pBuffer;
+	INT16U packetType = MacToHost16(common->pkt_type);
+	MULTI_READ read;
+	int epcLength;
+
+	RFID_UNREFERENCED_LOCAL(handle);
+	RFID_UNREFERENCED_LOCAL(bufferLength);
+
+	RFID_PROBE3(tag_callback,
+		handle, handle,
+		packetType, packetType,
+		length, bufferLength);
+	if (RFID_PACKET_TYPE_ANTENNA_BEGIN == packetType)
+	{
+		decodeInventoryPacket(batch, pBuffer);
+		return 0;
+	}
+	if (RFID_PACKET_TYPE_18K6C_INVENTORY != packetType)
+	{
+		return 0;
+	}
+
+	read.received = metricsNow();
+	clearInventoryBatch(batch);
+	if (!decodeInventoryPacket(batch, pBuffer) || !batch->count)
+	{
+		return 0;
+	}
+	epcLength = batch->epcLength[0];
+	if (epcLength <= 0)
+	{
+		return 0;
+	}
+	if (epcLength > MULTI_MAX_EPC_BYTES)
+	{
+		epcLength = MULTI_MAX_EPC_BYTES;
+	}
+
+	/* Until the clock model has seen a packet, use when the read arrived   */
+	if (!radio->clockModel.valid ||
+		RFID_STATUS_OK != RFID_RadioMacTimeToHostTime(&radio->clockModel,
+			batch->msCounter[0], &read.time))
+	{
+		read.time = hostNow();
+	}
+	read.antenna = batch->antenna[0];
+	read.rssi = batch->rssi[0];
+	read.epcLength = (INT8U)epcLength;
+	memcpy(read.epc, &batch->arena[batch->epcOffset[0]], epcLength);
+	metricsRead(read.antenna, read.epc, epcLength);
+	queueRead(radio, &read);
+	return 0;
+}
+
+/* Inventories one radio until reading stops or the radio goes away         */
+static DWORD WINAPI readRadio(void* data)
+{
+	MULTI_RADIO* radio = (MULTI_RADIO*)data;
+	RFID_18K6C_INVENTORY_PARMS parms;
+	RFID_STATUS status;
+	char message[32];
+
+	memset(&parms, 0, sizeof(parms));
+	parms.length = sizeof(RFID_18K6C_INVENTORY_PARMS);
+	parms.common.tagStopCount = 0;
+	parms.common.pCallback = multiCallback;
+	parms.common.pCallbackCode = NULL;
+	parms.common.context = radio;
+
+	if (!createInventoryBatch(&radio->batch, 1))
+	{
+		fprintf(stderr, "ERROR: Out of memory for radio %u's read decoder\n",
+			radio->id);
+		radio->running = 0;
+		return 0;
+	}
+	radio->clockModel.length = sizeof(RFID_RADIO_CLOCK_MODEL);
+	RFID_RadioGetClockModel(radio->handle, &radio->clockModel);
+
+	while (radio->running)
+	{
+		LONGLONG inventoryStart = metricsNow();
+
+		status = RFID_18K6CTagInventory(radio->handle, &parms, 0);
+		metricsInventoryTime(inventoryStart);
+		if (RFID_STATUS_OK != status && isRadioLost(status))
+		{
+			sprintf(message, "$RADIO_DOWN,%u#", radio->id);
+			report(mergeControl, message);
+			break;
+		}
+		/* The reads of the next inventory are timed with what this one     */
+		/* taught the clock model                                           */
+		RFID_RadioGetClockModel(radio->handle, &radio->clockModel);
+	}
+	destroyInventoryBatch(&radio->batch);
+	radio->running = 0;
+	return 0;
+}
+
+static void sendRead(const MULTI_READ* read, INT32U id)
+{
+	char message[MULTI_MAX_EPC_BYTES * 2 + 64];
+	char rssi[INVENTORY_RSSI_CHARS];
+	char* epc = &message[1];
+	int index;
+	int sent;
+
+	/* $<EPC>,<RSSI>,<antenna>,<ms since 1970>,<radio>#                      */
+	message[0] = '$';
+	for (index = 0; index < read->epcLength; ++index)
+	{
+		sprintf(&epc[index * 2], "%.2x", read->epc[index]);
+	}
+	formatInventoryRssi(read->rssi, rssi);
+	sprintf(&epc[read->epcLength * 2], ",%s,%u,%llu,%u#", rssi,
+		read->antenna, read->time, id);
+	sent = send(mergeOutput, message, strlen(message), 0);
+	RFID_PROBE3(tag_send,
+		socket, mergeOutput,
+		length, strlen(message),
+		result, sent);
+	metricsSent(read->received, sent);
+}
+
+/* A k-way merge of the radios' queues.  Each queue is in time order, so   */
+/* the oldest read at the head of a queue is the oldest read waiting.  It   */
+/* can go once every radio still reading has a read waiting, or once it is  */
+/* older than the reorder window; flush sends everything.                   */
+static void mergeReads(int flush)
+{
+	for (;;)
+	{
+		MULTI_RADIO* oldest = NULL;
+		INT64U oldestTime = 0;
+		MULTI_READ read;
+		int waiting = 0;
+		INT32U index;
+
+		for (index = 0; index < radioCount; ++index)
+		{
+			MULTI_RADIO* radio = &radios[index];
+
+			EnterCriticalSection(&radio->lock);
+			if (radio->count)
+			{
+				INT64U time = radio->queue[radio->head].time;
+
+				if (NULL == oldest || time < oldestTime)
+				{
+					oldest = radio;
+					oldestTime = time;
+				}
+			}
+			else if (radio->running)
+			{
+				waiting = 1;
+			}
+			LeaveCriticalSection(&radio->lock);
+		}
+
+		if (NULL == oldest)
+		{
+			return;
+		}
+		if (waiting && !flush && oldestTime + mergeWindow > hostNow())
+		{
+			return;
+		}
+
+		EnterCriticalSection(&oldest->lock);
+		read = oldest->queue[oldest->head];
+		oldest->head = (oldest->head + 1) % MULTI_QUEUE_SIZE;
+		--oldest->count;
+		LeaveCriticalSection(&oldest->lock);
+		metricsDequeued();
+
+		sendRead(&read, oldest->id);
+	}
+}
+
+static DWORD WINAPI mergeRadios(void* data)
+{
+	RFID_UNREFERENCED_LOCAL(data);
+
+	while (merging)
+	{
+		mergeReads(0);
+		Sleep(MULTI_MERGE_INTERVAL);
+	}
+	mergeReads(1);
+	return 0;
+}
+
+/* Starts an inventory thread for every radio (pinned to a CPU each, if     */
+/* asked for) and the thread that merges their reads onto output.  Returns  */
+/* 0 if the radios are already reading.                                     */
+int startMultiRead(RFID_RADIO_HANDLE first, SOCKET output, SOCKET control)
+{
+	SYSTEM_INFO system;
+	INT32U index;
+
+	if (merging)
+	{
+		return 0;
+	}
+	GetSystemInfo(&system);
+
+	/* The first radio may have been reopened since it was opened           */
+	radios[0].handle = first;
+	mergeOutput = output;
+	mergeControl = control;
+	merging = 1;
+
+	for (index = 0; index < radioCount; ++index)
+	{
+		MULTI_RADIO* radio = &radios[index];
+
+		radio->head = 0;
+		radio->count = 0;
+		radio->dropped = 0;
+		radio->running = 1;
+		radio->thread = CreateThread(NULL, 0, readRadio, radio,
+			CREATE_SUSPENDED, NULL);
+		if (NULL == radio->thread)
+		{
+			radio->running = 0;
+			continue;
+		}
+		if (pinThreads)
+		{
+			SetThreadAffinityMask(radio->thread,
+				(DWORD_PTR)1 << (index % system.dwNumberOfProcessors));
+		}
+		ResumeThread(radio->thread);
+	}
+	mergeThread = CreateThread(NULL, 0, mergeRadios, NULL, 0, NULL);
+	return 1;
+}
+
+/* Stops the radios, waits for their threads and sends the reads that are  */
+/* still waiting                                                            */
+void stopMultiRead(void)
+{
+	char message[48];
+	INT32U index;
+
+	if (!merging)
+	{
+		return;
+	}
+	for (index = 0; index < radioCount; ++index)
+	{
+		radios[index].running = 0;
+	}
+	for (index = 0; index < radioCount; ++index)
+	{
+		if (NULL == radios[index].thread)
+		{
+			continue;
+		}
+		/* Cancel again in case the thread was just starting an inventory   */
+		do
+		{
+			RFID_RadioCancelOperation(radios[index].handle, 0);
+		} while (WAIT_TIMEOUT ==
+			WaitForSingleObject(radios[index].thread, MULTI_STOP_INTERVAL));
+		CloseHandle(radios[index].thread);
+		radios[index].thread = NULL;
+	}
+
+	merging = 0;
+	if (NULL != mergeThread)
+	{
+		WaitForSingleObject(mergeThread, INFINITE);
+		CloseHandle(mergeThread);
+		mergeThread = NULL;
+	}
+
+	for (index = 0; index < radioCount; ++index)
+	{
+		if (radios[index].dropped)
+		{
+			sprintf(message, "$RADIO_DROPPED,%u,%u#", radios[index].id,
+				radios[index].dropped);
+			report(mergeControl, message);
+		}
+	}
+}
@@ -0,0 +1,22 @@
+#ifndef MULTI_RADIO_H_
+
+#define MULTI_RADIO_H_
+
+#include <WinSock2.h>
+#include "rfid_library.h"
+
+
+/* The most radios the reader runs at once                                   */
+#define MULTI_MAX_RADIOS        8
+
+int openMultiRadios(const RFID_RADIO_ENUM* pEnum, RFID_RADIO_HANDLE first, INT32U maxAttempts);
+void closeMultiRadios(void);
+int copyMultiRadioConfiguration(void);
+INT32U getMultiRadioCount(void);
+void setMultiRadio(int enable, INT32U windowMs, int pinThreads);
+int isMultiRadioEnabled(void);
+int startMultiRead(RFID_RADIO_HANDLE first, SOCKET output, SOCKET control);
+void stopMultiRead(void);
+
+
+#endif /* MULTI_RADIO_H_ */
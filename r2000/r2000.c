@@ -12,6 +12,7 @@
 #include <stdlib.h>
 #include <WinSock2.h>
 #include "rfid_library.h"
+#include "rfid_library_ext.h"
 #include "rfid_packets.h"
 #include "byte_swap.h"
 #include "print_packet.h"
@@ -20,18 +21,41 @@
 #include "r2000.h"
 #include "reader_params.h"
 #include "sample_utility.h"
+#include "link_profile.h"
+#include "antenna_health.h"
+#include "radio_supervisor.h"
+#include "multi_radio.h"
+#include "stop_benchmark.h"
+#include "server_metrics.h"
+#include "throughput_benchmark.h"
+#include "register_profiler.h"
+#include "rfid_probes.h"
+#include "inventory_batch.h"
 
 
 #pragma comment(lib, "wsock32.lib")
 #pragma comment(lib, "rfid.lib")
 
+/* The reader's probes (85813560-ca18-5835-c41c-6ca4df1f0a11)               */
+RFID_PROBE_DEFINE_PROVIDER(
+	"Impinj.R2000",
+	(0x85813560, 0xca18, 0x5835, 0xc4, 0x1c, 0x6c, 0xa4, 0xdf, 0x1f, 0x0a, 0x11));
+
 
 INT8U      maxOriginalAntennas = 0;
 INT8U      maxAccessAPIRetries = 6;
-INT8U      accessAPIRetryCount = 0;
+
+/* The radio configuration SAVE_CONFIG keeps and the next start restores     */
+#define RADIO_CONFIG_FILE "radio_config.bin"
 
 int startReading = 0;
 SOCKET clientRead;
+SOCKET clientControl;
+
+/* TIMESTAMPS ON: append to every read the host time (ms since 1970) at     */
+/* which the radio read it, from the library's model of the MAC's clock     */
+int sendTimestamps = 0;
+RFID_RADIO_CLOCK_MODEL clockModel;
 
 
 RFID_RADIO_HANDLE           handle;
@@ -80,117 +104,72 @@ RFID_18K6C_READ_PARMS                   readParms;
 RFID_18K6C_WRITE_PARMS                  writeParms;
 CONTEXT_PARMS                           context;
 INT32U									antena;
+/* Decodes the packets PacketCallbackFunction is given, one read at a time  */
+INVENTORY_BATCH                         readBatch;
 char dataHex[4];
 
-static void saveByteArray(const INT8U* bytes, int length, char* buf)
-{
-	int index;
-	char* b;
-
-	b = malloc(sizeof(char) * (1 + 1));
-
-	for (index = 0; index < length; ++index)
-	{
-		sprintf(b, "%.2x", bytes[index]);
-		//printf("%s", b);
-		strcat(buf, b);
-		memset(b, 0, sizeof(b));
-	}
-}
-
 INT32S PacketCallbackFunction(RFID_RADIO_HANDLE handle, INT32U bufferLength, const INT8U* pBuffer, void* context)
 {
 	int* indent = (int*)context;
 	RFID_UNREFERENCED_LOCAL(handle);
-	char mensaje[50];
-	int index;
+	char mensaje[64];
 	char buf[25];
-	char PC[5]; 
-	char b[1];
-	char rsi[4];
-	char rssi[3];
-	//const INT8U* packet;
+	char rssi[INVENTORY_RSSI_CHARS];
 
 
 	RFID_PACKET_COMMON* common = (RFID_PACKET_COMMON*)pBuffer; 
 	INT16U packetType = MacToHost16(common->pkt_type);
 
+	RFID_PROBE3(tag_callback,
+		handle, handle,
+		packetType, packetType,
+		length, bufferLength);
 	memset(buf, 0, sizeof(buf));
 	memset(mensaje, 0, sizeof(mensaje));
-	memset(rssi, 0, sizeof(rssi));
 
 
 	if (packetType == RFID_PACKET_TYPE_ANTENNA_BEGIN) {
-		RFID_PACKET_ANTENNA_BEGIN* antennabegin = (RFID_PACKET_ANTENNA_BEGIN*)pBuffer;
-
-		antena = MacToHost32(antennabegin->antenna);
-		/*INT8 a = MacToHost32(antennabegin->antenna);
-		INT8U ant = MacToHost32(antennabegin->antenna);*/
+		decodeInventoryPacket(&readBatch, pBuffer);
+		antena = readBatch.currentAntenna;
 	}
 	else if (packetType == RFID_PACKET_TYPE_18K6C_INVENTORY) {
+		LONGLONG received = metricsNow();
 
-		RFID_PACKET_18K6C_INVENTORY* inv = (RFID_PACKET_18K6C_INVENTORY*)pBuffer;
-		int length = ((MacToHost16(common->pkt_len) - 3) * 4) - (common->flags >> 6);
-
-
-		INT8U* byteData = (INT8U*)& inv->inv_data[0];
-		//INT16U ri = (INT8U*)& inv->rssi;
-		//INT16U rsi = (INT16U*)& inv->rssi;
-		//INT8 rssi = (INT8*)& inv->rssi;
-		//printf("RSSI: %d", rssi);
-		//INT8U rs = (INT8U*)& inv->rssi;
-
-		/*INT32 nb_rssi32 = (INT32*)& inv->nb_rssi;
-		
-		INT8U nb_rssiu = (INT8U*)& inv->nb_rssi;
-		
-
-		INT8U pr = &inv->nb_rssi;*/
-		//	printf(" %u, %u, %u\n", &inv->rssi, ri, rs);
-
-		//INT8 nb_rssi = (INT8*)&inv->nb_rssi;
-		//printf("NB_RSSI: %d\n", nb_rssi);
-
-		saveByteArray((INT8*)&inv->nb_rssi, 1, rssi);
-		//printf("RSSI: %s\n", rssi);
-
+		const INT8U* epc = NULL;
 		int epcLength = 0;
-		int tidLength = 0;
-		if (((common->flags >> 2) & 0x03) == 0x01)  /* M4 TID (12 bytes) is included in data */
-		{
-			tidLength = 12;
-		}
-		epcLength = length - tidLength - 4;  /* -4 for 16-bit PC and CRC */
 
-		memset(buf, 0, sizeof(buf));
-	
-		int* selAnt[4]; 
-		//getEnabledAntena(handle, selAnt);
-
-
-		saveByteArray(&byteData[2], epcLength, buf);
-		//printf("EPC: %s", buf);
+		/* The batch holds just this read: the EPC, and the RSSI in dBm     */
+		clearInventoryBatch(&readBatch);
+		if (decodeInventoryPacket(&readBatch, pBuffer) && readBatch.count) {
+			epc = &readBatch.arena[readBatch.epcOffset[0]];
+			epcLength = readBatch.epcLength[0];
+			formatInventoryRssi(readBatch.rssi[0], rssi);
+			saveByteArray(epc, epcLength, buf);
+		}
 
 		if (strlen(buf) != 0) {
-			/*printf(" PC: ");
-			saveByteArray(&byteData[0], 2, PC);
-
-			printf(" CRC: "); 
-			saveByteArray(&byteData[2 + epcLength], 2, CRC);*/
-
-			/*printf(" RSSI: "); s
-			printf("%d\n", rssi);*/
-			/*sprintf(rsi, "%u", rssi);
-			printf("%s\n", rsi);*/
-
-			//sprintf(mensaje, "%s,%s,%s,%s", PC, buf, CRC, rsi);
-			sprintf(mensaje, "$%s,%s,%u#", buf, rssi, antena);
-			printf(mensaje);
-			send(clientRead, mensaje, strlen(mensaje), 0);
+			INT64U readTime;
+			if (sendTimestamps &&
+				RFID_STATUS_OK == RFID_RadioMacTimeToHostTime(&clockModel, readBatch.msCounter[0], &readTime))
+			{
+				sprintf(mensaje, "$%s,%s,%u,%llu#", buf, rssi, antena, readTime);
+			}
+			else
+			{
+				sprintf(mensaje, "$%s,%s,%u#", buf, rssi, antena);
+			}
+			/* Printing every read held the callback up more than sending   */
+			/* it; STATS and the metrics listener report on the reads       */
+			metricsRead(antena, epc, epcLength);
+			int sent = send(clientRead, mensaje, strlen(mensaje), 0);
+			RFID_PROBE3(tag_send,
+				socket, clientRead,
+				length, strlen(mensaje),
+				result, sent);
+			metricsSent(received, sent);
 
 			memset(buf, 0, sizeof(buf));
 			memset(mensaje, 0, sizeof(mensaje));
-			memset(rssi, 0, sizeof(rssi));
 
 		}
 	}
@@ -213,73 +192,50 @@ DWORD WINAPI startRead(void* data) {
 
 	int index;
 
+	clockModel.length = sizeof(RFID_RADIO_CLOCK_MODEL);
+	RFID_RadioGetClockModel(handle, &clockModel);
+	/* What to put back if the radio has to be reopened                     */
+	captureRadioConfiguration(handle);
+
 	while (startReading == 1) {
+		LONGLONG inventoryStart = metricsNow();
+
 		//printf("START READING\n");
 		/* Attempt to perform an inventory on the radio */
-		if (RFID_STATUS_OK !=
-			(status = RFID_18K6CTagInventory(handle, &inventoryParms, inventoryFlags)))
+		status = RFID_18K6CTagInventory(handle, &inventoryParms, inventoryFlags);
+		metricsInventoryTime(inventoryStart);
+		if (RFID_STATUS_OK != status)
 		{
 			//printf("RFID_18K6CTagInventory failed: RC = %d\n", status);
+			/* The radio has gone (e.g., a USB brown-out): get it back as   */
+			/* it was and carry on reading                                  */
+			if (isRadioLost(status))
+			{
+				setMetricsState(METRICS_STATE_RECOVERING, 1);
+				if (!recoverRadio(&handle, clientControl, &startReading))
+				{
+					setMetricsState(METRICS_STATE_IDLE, 1);
+					break;
+				}
+				setMetricsState(METRICS_STATE_READING, 1);
+				restoreAntennaHealth(handle, clientControl);
+			}
 		}
+		/* Skip ports whose antenna has been pulled (or has come back) */
+		checkAntennaHealth(handle, clientControl);
+		/* The reads of the next inventory are timed with what this one     */
+		/* taught the clock model                                           */
+		RFID_RadioGetClockModel(handle, &clockModel);
 	}
+	restoreAntennaHealth(handle, clientControl);
 	return 0;
 }
 
 DWORD WINAPI stopRead(void* data) {
+	stopMultiRead();
 	RFID_RadioCancelOperation(handle, 0);
 	startReading = 0;
-}
-
-// Function to convert hexadecimal to decimal
-int* hexadecimalToDecimal(char hexVal[], INT16U* data)
-{
-	int len = 24;
-
-	// Initializing base value to 1, i.e 16^0 
-	int base = 1;
-	int cont = 0;
-	int write = 5;
-
-	int dec_val = 0;
-	INT16U writeData[6];
-
-	// Extracting characters as digits from last character 
-	for (int i = len - 1; i >= 0; i--)
-	{
-		// if character lies in '0'-'9', converting  
-		// it to integral 0-9 by subtracting 48 from 
-		// ASCII value. 
-		if (hexVal[i] >= '0' && hexVal[i] <= '9')
-		{
-			dec_val += (hexVal[i] - 48) * base;
-
-			// incrementing base by power 
-			base = base * 16;
-		}
-
-		// if character lies in 'A'-'F' , converting  
-		// it to integral 10 - 15 by subtracting 55  
-		// from ASCII value 
-		else if (hexVal[i] >= 'A' && hexVal[i] <= 'F')
-		{
-			dec_val += (hexVal[i] - 55) * base;
-
-			// incrementing base by power 
-			base = base * 16;
-		}
-		cont++;
-		if (cont == 4) {
-			writeData[write] = dec_val;
-			data[write] = dec_val;
-			write--;
-			cont = 0;
-			dec_val = 0;
-			base = 1;
-		}
-	}
-	//data = writeData;
-
-	return data;
+	setMetricsState(METRICS_STATE_IDLE, 1);
 }
 
 #define BYTES_PER_LEN_UNIT  4
@@ -359,25 +315,18 @@ DWORD WINAPI readTagData(void* data) {
 	readParms.common.tagStopCount = 0;
 	readParms.common.context = &context;
 
-	/* Keep attempting to read   from the tag's memory until it     */
-	/* succeeds or until the tag-read function fails for some reason.         */
-	accessAPIRetryCount = 0;
-	while ((RFID_STATUS_OK == status) &&
-		!context.succesfulAccessPackets &&
-		(accessAPIRetryCount < maxAccessAPIRetries))
-	{
-		printf("Attempting to read \n\n");
+	/* The library reissues the read while the failure is recoverable (see   */
+	/* setAccessRetryPolicy); the MAC only needs clearing if the read failed. */
+	printf("Attempting to read \n\n");
 
-		status = RFID_18K6CTagRead(handle, &readParms, 0);
-		if (RFID_STATUS_OK != status)
-		{
-			fprintf(
-				stderr,
-				"ERROR: RFID_18K6CTagRead returned 0x%.8x\n",
-				status);
-		}
+	status = RFID_18K6CTagRead(handle, &readParms, 0);
+	if (RFID_STATUS_OK != status)
+	{
+		fprintf(
+			stderr,
+			"ERROR: RFID_18K6CTagRead returned 0x%.8x\n",
+			status);
 		RFID_MacClearError(handle);
-		accessAPIRetryCount++;
 	}
 	if (!context.succesfulAccessPackets)
 	{
@@ -415,25 +364,18 @@ DWORD WINAPI readTagData(void* data) {
 	readParms.common.tagStopCount = 0;
 	readParms.common.context = &context;
 
-	/* Keep attempting to read   from the tag's memory until it     */
-	/* succeeds or until the tag-read function fails for some reason.         */
-	accessAPIRetryCount = 0;
-	while ((RFID_STATUS_OK == status) &&
-		!context.succesfulAccessPackets &&
-		(accessAPIRetryCount < maxAccessAPIRetries))
-	{
-		printf("Attempting to read \n\n");
+	/* The library reissues the read while the failure is recoverable (see   */
+	/* setAccessRetryPolicy); the MAC only needs clearing if the read failed. */
+	printf("Attempting to read \n\n");
 
-		status = RFID_18K6CTagRead(handle, &readParms, 0);
-		if (RFID_STATUS_OK != status)
-		{
-			fprintf(
-				stderr,
-				"ERROR: RFID_18K6CTagRead returned 0x%.8x\n",
-				status);
-		}
+	status = RFID_18K6CTagRead(handle, &readParms, 0);
+	if (RFID_STATUS_OK != status)
+	{
+		fprintf(
+			stderr,
+			"ERROR: RFID_18K6CTagRead returned 0x%.8x\n",
+			status);
 		RFID_MacClearError(handle);
-		accessAPIRetryCount++;
 	}
 	if (!context.succesfulAccessPackets)
 	{
@@ -532,24 +474,17 @@ void writeTagData(INT16U data[6]) {
 	writeParms.common.pCallbackCode = NULL;
 	writeParms.common.tagStopCount = 0;
 	writeParms.common.context = &context;
-	/* Keep attempting to write  to the tag's  memory until it      */
-		   /* succeeds or until the tag-write function fails for some reason.        */
-	accessAPIRetryCount = 0;
-	while ((RFID_STATUS_OK == status) &&
-		!context.succesfulAccessPackets &&
-		(accessAPIRetryCount < maxAccessAPIRetries))
+	/* The library reissues the write while the failure is recoverable (see  */
+	/* setAccessRetryPolicy); the MAC only needs clearing if the write failed.*/
+	printf("Attempting to write \n\n");
+	status = RFID_18K6CTagWrite(handle, &writeParms, 0);
+	if (RFID_STATUS_OK != status)
 	{
-		printf("Attempting to write \n\n");
-		status = RFID_18K6CTagWrite(handle, &writeParms, 0);
-		if (RFID_STATUS_OK != status)
-		{
-			fprintf(
-				stderr,
-				"ERROR: RFID_18K6CTagWrite returned 0x%.8x\n",
-				status);
-		}
+		fprintf(
+			stderr,
+			"ERROR: RFID_18K6CTagWrite returned 0x%.8x\n",
+			status);
 		RFID_MacClearError(handle);
-		accessAPIRetryCount++;
 	}
 	if (!context.succesfulAccessPackets)
 	{
@@ -593,9 +528,6 @@ int main(
 
 
 
-	RFID_UNREFERENCED_LOCAL(argc);
-	RFID_UNREFERENCED_LOCAL(argv);
-
 	//Servidor socket
 	WSADATA WSAData;
 	SOCKET server, client;
@@ -613,8 +545,46 @@ int main(
 	double power = 0.0;
 	char* nuevo[20];
 
-	/* Initialialize the RFID library                                         */
-	status = RFID_Startup(&version, 0);
+	RFID_PROBE_REGISTER();
+	initMetrics();
+	if (!createInventoryBatch(&readBatch, 1))
+	{
+		fprintf(stderr, "ERROR: Out of memory for the read decoder\n");
+		RFID_PROBE_UNREGISTER();
+		return 1;
+	}
+
+	/* r2000 BENCH_E2E [reads]: run the reads of the library's synthetic    */
+	/* radios through the tag callback to a loopback socket, print the      */
+	/* results as JSON and exit                                             */
+	if (argc > 1 && strcmp(argv[1], "BENCH_E2E") == 0)
+	{
+		INT32U reads = (argc > 2) ? (INT32U)atoi(argv[2]) : 0;
+
+		retval = benchmarkThroughput(PacketCallbackFunction, &indent_level, &clientRead,
+			reads ? reads : THROUGHPUT_DEFAULT_READS, stdout);
+		RFID_PROBE_UNREGISTER();
+		return retval;
+	}
+
+	/* r2000 PROFILE_REGISTERS [SYNTHETIC] [calls]: time the register       */
+	/* accesses and configuration calls of the first radio (or synthetic    */
+	/* radio), print the results as JSON and exit                           */
+	if (argc > 1 && strcmp(argv[1], "PROFILE_REGISTERS") == 0)
+	{
+		int synthetic = (argc > 2 && strcmp(argv[2], "SYNTHETIC") == 0);
+		INT32U calls = (argc > 2 + synthetic) ? (INT32U)atoi(argv[2 + synthetic]) : 0;
+
+		retval = profileRegisters(synthetic, calls ? calls : REGISTER_PROFILE_DEFAULT_SAMPLES, stdout);
+		RFID_PROBE_UNREGISTER();
+		return retval;
+	}
+
+	/* Initialialize the RFID library.  r2000 CAPTURE serves as usual but     */
+	/* captures every packet the radios send to rfid_library.rcap, for        */
+	/* packet_capture_decode.                                                 */
+	status = RFID_Startup(&version,
+		(argc > 1 && strcmp(argv[1], "CAPTURE") == 0) ? RFID_FLAG_CAPTURE_PACKETS : 0);
 	if (RFID_STATUS_OK != status)
 	{
 		fprintf(stderr, "ERROR: RFID_Startup returned 0x%.8x\n", status);
@@ -673,8 +643,20 @@ int main(
 		fprintf(stderr, "ERROR: RFID_RadioOpen returned 0x%.8x\n", status);
 		free(pEnum);
 	}
-	pExtensions.fastId = RFID_FAST_ID_DISABLED;
-	RFID_STATUS RFID_RadioSetImpinjExtensions(handle, pExtensions);
+	if (RFID_STATUS_OK == RFID_RadioGetImpinjExtensions(handle, &pExtensions)) {
+		pExtensions.fastId = RFID_FAST_ID_DISABLED;
+		RFID_RadioSetImpinjExtensions(handle, &pExtensions);
+	}
+	setAccessRetryPolicy(handle, maxAccessAPIRetries);
+	setInventorySubscription(handle);
+	setResponseTimeout(handle);
+	if (restoreRadioConfigurationFile(handle, RADIO_CONFIG_FILE)) {
+		printf("Radio configuration restored from %s\n", RADIO_CONFIG_FILE);
+	}
+	/* The other radios are read alongside the first in MULTI_RADIO mode    */
+	if (openMultiRadios(pEnum, handle, maxAccessAPIRetries) > 1) {
+		printf("%u radios open\n", getMultiRadioCount());
+	}
 
 
 	/* COMUNICACIN SOCKET CON EL SOFTWARE MYRUNS */
@@ -683,6 +665,7 @@ int main(
 	if ((client = accept(server, (struct sockaddr*) & clientAddr, &clientAddrSize)) != INVALID_SOCKET)
 	{
 		conectado = 1;
+		clientControl = client;
 		printf("CONECTADO AL READER\n");
 	}
 
@@ -727,6 +710,7 @@ int main(
 			double value = atof(pow);
 			printf("RECIBIDO POWER: %.1f\n", value);
 			setAntennaPower(handle, value);
+			copyMultiRadioConfiguration();
 			send(client, "OK#", 3, 0);
 		}
 		else if (strcmp(msg, "ANT_PORTS") == 0) {
@@ -758,6 +742,7 @@ int main(
 			char* ant = strtok(NULL, "");
 			printf("CONECTADAS: %s\n", ant);
 			setSelectedAntena(handle, ant);
+			copyMultiRadioConfiguration();
 			send(client, "OK#", 3, 0);
 		}
 		else if (strncmp(msg, "GET_INFO", 8) == 0) {
@@ -788,6 +773,7 @@ int main(
 			fflush(stdout);
 
 			setAdvancedOptions(handle, "SET_REGION", nuevo);
+			copyMultiRadioConfiguration();
 			send(client, "OK#", 3, 0);
 		}
 		else if (strncmp(msg, "SET_TARI", 8) == 0) {
@@ -797,6 +783,7 @@ int main(
 			printf("SET TARI: %s\n", tari);
 			fflush(stdout);
 			setAdvancedOptions(handle, "SET_TARI", tari);
+			copyMultiRadioConfiguration();
 			send(client, "OK#", 3, 0);
 
 		}
@@ -807,6 +794,7 @@ int main(
 			printf("SET BLF: %s\n", blf);
 			fflush(stdout);
 			setAdvancedOptions(handle, "SET_BLF", blf);
+			copyMultiRadioConfiguration();
 			send(client, "OK#", 3, 0);
 		}
 		else if (strncmp(msg, "SET_M", 5) == 0) {
@@ -816,11 +804,17 @@ int main(
 			printf("SET M: %s\n", m);
 			fflush(stdout);
 			setAdvancedOptions(handle, "SET_M", m);
+			copyMultiRadioConfiguration();
 			send(client, "OK#", 3, 0);
 		}
 		else if (strncmp(msg, "SET_Q", 5) == 0) {
 			printf("msg: %s\n", msg);
-			//setAdvancedOptions(handle, "SET_Q", nuevo);
+			char* mens = strtok(msg, " ");
+			char* q = strtok(NULL, "");
+			printf("SET Q: %s\n", q);
+			fflush(stdout);
+			setAdvancedOptions(handle, "SET_Q", q);
+			copyMultiRadioConfiguration();
 			send(client, "OK#", 3, 0);
 
 		}
@@ -831,6 +825,7 @@ int main(
 			printf("SESION: %s\n", session);
 			fflush(stdout);
 			setAdvancedOptions(handle, "SET_SESSION", session);
+			copyMultiRadioConfiguration();
 			send(client, "OK#", 3, 0);
 		}
 		else if (strncmp(msg, "SET_TARGET", 10) == 0) {
@@ -840,12 +835,190 @@ int main(
 			printf("SET TARGET: %s\n", target);
 			fflush(stdout);
 			setAdvancedOptions(handle, "SET_TARGET", target);
+			copyMultiRadioConfiguration();
+			send(client, "OK#", 3, 0);
+		}
+		else if (strncmp(msg, "BENCH_PROFILES", 14) == 0) {
+			/* BENCH_PROFILES <dwell ms> [SESSIONS] [APPLY] */
+			printf("msg: %s\n", msg);
+			if (startReading) {
+				send(client, "BUSY#", 5, 0);
+			}
+			else {
+				LINK_PROFILE_RESULT best;
+				char benchSend[128];
+				int withSessions = 0;
+				int apply = 0;
+				INT32U dwell = 2000;
+				char* mens = strtok(msg, " ");
+				char* arg = strtok(NULL, " ");
+
+				if (arg != NULL) {
+					dwell = atoi(arg);
+					while ((arg = strtok(NULL, " ")) != NULL) {
+						if (strcmp(arg, "SESSIONS") == 0) {
+							withSessions = 1;
+						}
+						else if (strcmp(arg, "APPLY") == 0) {
+							apply = 1;
+						}
+					}
+				}
+				if (benchmarkLinkProfiles(handle, dwell, withSessions, apply, &best) > 0) {
+					if (apply) {
+						copyMultiRadioConfiguration();
+					}
+					sprintf(benchSend, "$%u,%u,%u,%.1f,%.1f,%.4f#", best.profile,
+						best.session, best.target, best.uniqueTagsPerSecond,
+						best.readsPerSecond, best.crcErrorRate);
+					send(client, benchSend, strlen(benchSend), 0);
+				}
+				else {
+					send(client, "ERROR#", 6, 0);
+				}
+			}
+		}
+		else if (strncmp(msg, "BENCH_STOP", 10) == 0) {
+			/* BENCH_STOP [runs] [dwell ms]                                  */
+			/* $STOP,<runs>,<last packet median,p95,max>,<idle median,p95,max># */
+			printf("msg: %s\n", msg);
+			if (startReading) {
+				send(client, "BUSY#", 5, 0);
+			}
+			else {
+				STOP_BENCHMARK_RESULT stopResult;
+				char stopSend[128];
+				char* mens = strtok(msg, " ");
+				char* runs = strtok(NULL, " ");
+				char* dwell = strtok(NULL, " ");
+
+				if (benchmarkStop(handle, runs != NULL ? atoi(runs) : 20,
+					dwell != NULL ? atoi(dwell) : 500, &stopResult) > 0) {
+					sprintf(stopSend, "$STOP,%u,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f#",
+						stopResult.runs, stopResult.lastPacket.median,
+						stopResult.lastPacket.p95, stopResult.lastPacket.max,
+						stopResult.idle.median, stopResult.idle.p95,
+						stopResult.idle.max);
+					send(client, stopSend, strlen(stopSend), 0);
+				}
+				else {
+					send(client, "ERROR#", 6, 0);
+				}
+			}
+		}
+		else if (strncmp(msg, "ANT_HEALTH", 10) == 0) {
+			/* ANT_HEALTH ON|OFF [short ohms] */
+			printf("msg: %s\n", msg);
+			char* mens = strtok(msg, " ");
+			char* onOff = strtok(NULL, " ");
+			char* ohms = strtok(NULL, " ");
+			setAntennaHealth(onOff == NULL || strcmp(onOff, "OFF") != 0,
+				ohms != NULL ? atoi(ohms) : 0);
+			send(client, "OK#", 3, 0);
+		}
+		else if (strncmp(msg, "TIMESTAMPS", 10) == 0) {
+			/* TIMESTAMPS ON|OFF */
+			printf("msg: %s\n", msg);
+			sendTimestamps = strstr(msg, "OFF") == NULL;
 			send(client, "OK#", 3, 0);
 		}
+		else if (strncmp(msg, "SAVE_CONFIG", 11) == 0) {
+			printf("msg: %s\n", msg);
+			if (startReading) {
+				send(client, "BUSY#", 5, 0);
+			}
+			else if (saveRadioConfigurationFile(handle, RADIO_CONFIG_FILE)) {
+				send(client, "OK#", 3, 0);
+			}
+			else {
+				send(client, "ERROR#", 6, 0);
+			}
+		}
+		else if (strncmp(msg, "RECOVERY_STATS", 14) == 0) {
+			/* $RECOVERY,<count>,<last ms>,<max ms>,<total ms># */
+			RECOVERY_STATS stats;
+			char statsSend[64];
+
+			printf("msg: %s\n", msg);
+			getRecoveryStats(&stats);
+			sprintf(statsSend, "$RECOVERY,%u,%u,%u,%u#", stats.count,
+				stats.lastMs, stats.maxMs, stats.totalMs);
+			send(client, statsSend, strlen(statsSend), 0);
+		}
+		else if (strncmp(msg, "STATS", 5) == 0) {
+			/* $STATS,<state>,<reads/s>,<unique tags/s>,<p50 us>,<p90 us>,  */
+			/* <p99 us>,<max us>,<queued>,<dropped>,<duty cycle %>          */
+			/* [,<antenna>:<reads/s>:<unique tags/s>]...#                   */
+			char statsSend[512];
+			int length;
+
+			printf("msg: %s\n", msg);
+			length = formatMetrics(statsSend, sizeof(statsSend));
+			if (length > 0) {
+				send(client, statsSend, length, 0);
+			}
+			else {
+				send(client, "ERROR#", 6, 0);
+			}
+		}
+		else if (strncmp(msg, "METRICS_PORT", 12) == 0) {
+			/* METRICS_PORT <port>|OFF: serve the STATS figures as text to  */
+			/* whoever connects to port                                     */
+			printf("msg: %s\n", msg);
+			char* mens = strtok(msg, " ");
+			char* port = strtok(NULL, " ");
+
+			if (port == NULL || strcmp(port, "OFF") == 0) {
+				stopMetricsListener();
+				send(client, "OK#", 3, 0);
+			}
+			else if (startMetricsListener(atoi(port))) {
+				send(client, "OK#", 3, 0);
+			}
+			else {
+				send(client, "ERROR#", 6, 0);
+			}
+		}
+		else if (strncmp(msg, "MULTI_RADIO", 11) == 0) {
+			/* MULTI_RADIO ON|OFF [window ms] [PIN] */
+			printf("msg: %s\n", msg);
+			if (startReading) {
+				send(client, "BUSY#", 5, 0);
+			}
+			else {
+				char* mens = strtok(msg, " ");
+				char* onOff = strtok(NULL, " ");
+				char* arg;
+				INT32U window = 0;
+				int pin = 0;
+
+				while ((arg = strtok(NULL, " ")) != NULL) {
+					if (strcmp(arg, "PIN") == 0) {
+						pin = 1;
+					}
+					else {
+						window = atoi(arg);
+					}
+				}
+				setMultiRadio(onOff == NULL || strcmp(onOff, "OFF") != 0,
+					window, pin);
+				send(client, "OK#", 3, 0);
+			}
+		}
 		else if (strncmp(msg, "START_READING", 13) == 0) {
 			antena = 0;
+			readBatch.currentAntenna = 0;
 			printf("msg: %s\n", msg);
-			HANDLE thread = CreateThread(NULL, 0, startRead, clientRead, 0, NULL);
+			if (isMultiRadioEnabled()) {
+				/* $<EPC>,<RSSI>,<antenna>,<ms since 1970>,<radio># in time */
+				/* order across the radios                                   */
+				startMultiRead(handle, clientRead, clientControl);
+				setMetricsState(METRICS_STATE_MULTI, getMultiRadioCount());
+			}
+			else {
+				HANDLE thread = CreateThread(NULL, 0, startRead, clientRead, 0, NULL);
+				setMetricsState(METRICS_STATE_READING, 1);
+			}
 			startReading = 1;
 			send(client, "OK#", 3, 0);
 		}
@@ -884,9 +1057,12 @@ int main(
 
 	}
 
+		closeMultiRadios();
+		stopMetricsListener();
 		closesocket(client);
 		//closesocket(client2);
 		printf("Client disconnected!\n");
 		WSACleanup();
+		RFID_PROBE_UNREGISTER();
 
 } /* main */
\ No newline at end of file
@@ -6,13 +6,4 @@
 #define RFID_PORT			5558 //UDP port for rfid module
 
 
-
-void Int32ArrayMacToHost(
-	INT32U*         pBegin,
-	INT32U          numberInt32
-);
-
-void Int16ArrayMacToHost(
-	INT16U*         pBegin,
-	INT32U          numberInt16
-);
\ No newline at end of file
+#include "tag_codec.h"
\ No newline at end of file
@@ -0,0 +1,279 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <WinSock2.h>
+#include "rfid_library.h"
+#include "rfid_library_ext.h"
+#include "radio_supervisor.h"
+
+
+/* The radio sends a command-active packet every 3 seconds while an         */
+/* inventory has nothing else to report, so a radio that has sent nothing    */
+/* for this long (in milliseconds) is gone.  The library waits 7 seconds     */
+/* unless told otherwise.                                                    */
+#define SUPERVISOR_RESPONSE_TIMEOUT 3500
+
+/* How long to wait (in milliseconds) before looking for the radio again.   */
+/* A USB brown-out takes the radio off the bus for a second or two, so      */
+/* start quickly and double the wait after every failed attempt.            */
+#define SUPERVISOR_MIN_BACKOFF      100
+#define SUPERVISOR_MAX_BACKOFF      5000
+
+/* Room for the radio's saved registers: a few hundred register writes    */
+#define SUPERVISOR_REGISTERS_SIZE   4096
+
+/* Everything the reader configures on the radio, as it was when inventory  */
+/* last started, so that it can be put back on a reopened radio.  The radio */
+/* itself keeps the antenna ports, link profile, query group, singulation   */
+/* and Impinj extensions, which RFID_RadioSaveConfiguration captures; the   */
+/* rest is kept by the library.                                             */
+typedef struct
+{
+	int                                     valid;
+	INT8U                                   registers[SUPERVISOR_REGISTERS_SIZE];
+	INT32U                                  registersLength;
+	RFID_18K6C_DYNAMICQ_TUNER_PARMS         tuner;
+	RFID_ANTENNA_SCHEDULER_PARMS            scheduler;
+	RFID_18K6C_ACCESS_RETRY_POLICY          retryPolicy;
+	RFID_PACKET_SUBSCRIPTION                subscription;
+	RFID_RESPONSE_MODE                      responseMode;
+} RADIO_CONFIGURATION;
+
+static RADIO_CONFIGURATION  configuration;
+static RECOVERY_STATS       recovery;
+
+
+static void report(SOCKET control, const char* message)
+{
+	printf("%s\n", message);
+	send(control, message, strlen(message), 0);
+}
+
+static int check(RFID_STATUS status, const char* function)
+{
+	if (RFID_STATUS_OK != status)
+	{
+		fprintf(stderr, "ERROR: %s returned 0x%.8x\n", function, status);
+		return 0;
+	}
+	return 1;
+}
+
+/* Have the library give up on a silent radio soon after its heartbeat      */
+/* stops instead of after the default 7 seconds                             */
+void setResponseTimeout(RFID_RADIO_HANDLE handle)
+{
+	check(RFID_RadioSetResponseTimeout(handle, SUPERVISOR_RESPONSE_TIMEOUT),
+		"RFID_RadioSetResponseTimeout");
+}
+
+/* The statuses that mean the radio (or the handle to it) is gone, rather   */
+/* than that an inventory failed                                            */
+int isRadioLost(RFID_STATUS status)
+{
+	return RFID_ERROR_RADIO_NOT_RESPONDING == status ||
+		RFID_ERROR_RADIO_FAILURE == status ||
+		RFID_ERROR_RADIO_NOT_PRESENT == status ||
+		RFID_ERROR_INVALID_HANDLE == status;
+}
+
+/* Call while the radio is idle, e.g., before inventory starts.  Remembers   */
+/* the radio's configuration for recoverRadio.                               */
+void captureRadioConfiguration(RFID_RADIO_HANDLE handle)
+{
+	static RADIO_CONFIGURATION config;
+	RFID_18K6C_DYNAMICQ_TUNER_STATUS tunerStatus;
+
+	memset(&config, 0, sizeof(config));
+	config.registersLength = sizeof(config.registers);
+	config.tuner.length = sizeof(RFID_18K6C_DYNAMICQ_TUNER_PARMS);
+	tunerStatus.length = sizeof(RFID_18K6C_DYNAMICQ_TUNER_STATUS);
+	config.scheduler.length = sizeof(RFID_ANTENNA_SCHEDULER_PARMS);
+	config.retryPolicy.length = sizeof(RFID_18K6C_ACCESS_RETRY_POLICY);
+	config.subscription.length = sizeof(RFID_PACKET_SUBSCRIPTION);
+
+	if (check(RFID_RadioSaveConfiguration(handle, config.registers,
+			&config.registersLength),
+			"RFID_RadioSaveConfiguration") &&
+		check(RFID_18K6CGetDynamicQTuner(handle, &config.tuner, &tunerStatus),
+			"RFID_18K6CGetDynamicQTuner") &&
+		check(RFID_RadioGetAntennaScheduler(handle, &config.scheduler),
+			"RFID_RadioGetAntennaScheduler") &&
+		check(RFID_18K6CGetAccessRetryPolicy(handle, &config.retryPolicy),
+			"RFID_18K6CGetAccessRetryPolicy") &&
+		check(RFID_18K6CGetPacketSubscription(handle,
+			RFID_18K6C_OPERATION_INVENTORY, &config.subscription),
+			"RFID_18K6CGetPacketSubscription") &&
+		check(RFID_RadioGetResponseDataMode(handle,
+			(RFID_RESPONSE_TYPE)RFID_RESPONSE_TYPE_DATA, &config.responseMode),
+			"RFID_RadioGetResponseDataMode"))
+	{
+		config.valid = 1;
+		configuration = config;
+	}
+	/* Otherwise keep the last configuration that could be read whole       */
+}
+
+/* Writes the captured configuration to a freshly opened radio before       */
+/* inventory resumes: the radio's registers in one pipelined sequence, then */
+/* the library's settings.                                                  */
+static RFID_STATUS restoreRadioConfiguration(RFID_RADIO_HANDLE handle)
+{
+	RFID_STATUS status;
+
+	if (!configuration.valid)
+	{
+		return RFID_STATUS_OK;
+	}
+
+	status = RFID_RadioRestoreConfiguration(handle, configuration.registers,
+		configuration.registersLength);
+	if (RFID_STATUS_OK == status)
+		status = RFID_18K6CSetDynamicQTuner(handle, &configuration.tuner);
+	if (RFID_STATUS_OK == status)
+		status = RFID_RadioSetAntennaScheduler(handle, &configuration.scheduler);
+	if (RFID_STATUS_OK == status)
+		status = RFID_18K6CSetAccessRetryPolicy(handle, &configuration.retryPolicy);
+	if (RFID_STATUS_OK == status)
+		status = RFID_18K6CSetPacketSubscription(handle,
+			RFID_18K6C_OPERATION_INVENTORY, &configuration.subscription);
+	if (RFID_STATUS_OK == status)
+		status = RFID_RadioSetResponseDataMode(handle,
+			(RFID_RESPONSE_TYPE)RFID_RESPONSE_TYPE_DATA, configuration.responseMode);
+	if (RFID_STATUS_OK == status)
+		status = RFID_RadioSetResponseTimeout(handle, SUPERVISOR_RESPONSE_TIMEOUT);
+	return status;
+}
+
+/* Opens the first attached radio and configures it as it was */
+static RFID_STATUS reopenRadio(RFID_RADIO_HANDLE* pHandle)
+{
+	RFID_RADIO_ENUM* pEnum;
+	RFID_STATUS status;
+
+	pEnum = (RFID_RADIO_ENUM*)malloc(sizeof(RFID_RADIO_ENUM));
+	if (NULL == pEnum)
+	{
+		return RFID_ERROR_OUT_OF_MEMORY;
+	}
+	pEnum->length = sizeof(RFID_RADIO_ENUM);
+	pEnum->totalLength = sizeof(RFID_RADIO_ENUM);
+
+	while (RFID_ERROR_BUFFER_TOO_SMALL ==
+		(status = RFID_RetrieveAttachedRadiosList(pEnum, 0)))
+	{
+		RFID_RADIO_ENUM* pNewEnum =
+			(RFID_RADIO_ENUM*)realloc(pEnum, pEnum->totalLength);
+		if (NULL == pNewEnum)
+		{
+			free(pEnum);
+			return RFID_ERROR_OUT_OF_MEMORY;
+		}
+		pEnum = pNewEnum;
+	}
+	if (RFID_STATUS_OK == status)
+	{
+		status = pEnum->countRadios ?
+			RFID_RadioOpen(pEnum->ppRadioInfo[0]->cookie, pHandle, 0) :
+			RFID_ERROR_RADIO_NOT_PRESENT;
+	}
+	free(pEnum);
+
+	if (RFID_STATUS_OK == status)
+	{
+		status = restoreRadioConfiguration(*pHandle);
+		if (RFID_STATUS_OK != status)
+		{
+			RFID_RadioClose(*pHandle);
+		}
+	}
+	return status;
+}
+
+/* Call when an operation on the radio failed with a status isRadioLost    */
+/* accepts.  Closes the radio and keeps trying to reopen and reconfigure it */
+/* until it succeeds or *pKeepTrying is cleared.  Reports $RADIO_DOWN# and   */
+/* $RADIO_UP,<ms>#.  Returns 1 if *pHandle is a working radio again.         */
+int recoverRadio(RFID_RADIO_HANDLE* pHandle, SOCKET control, volatile int* pKeepTrying)
+{
+	DWORD start = GetTickCount();
+	DWORD backoff = SUPERVISOR_MIN_BACKOFF;
+	DWORD elapsed;
+	RFID_STATUS status;
+	char message[64];
+
+	report(control, "$RADIO_DOWN#");
+	RFID_RadioClose(*pHandle);
+
+	while (*pKeepTrying)
+	{
+		status = reopenRadio(pHandle);
+		if (RFID_STATUS_OK == status)
+		{
+			elapsed = GetTickCount() - start;
+			recovery.count++;
+			recovery.lastMs = elapsed;
+			recovery.maxMs = (elapsed > recovery.maxMs) ? elapsed : recovery.maxMs;
+			recovery.totalMs += elapsed;
+
+			sprintf(message, "$RADIO_UP,%u#", elapsed);
+			report(control, message);
+			return 1;
+		}
+		Sleep(backoff);
+		backoff = (backoff * 2 < SUPERVISOR_MAX_BACKOFF) ?
+			backoff * 2 : SUPERVISOR_MAX_BACKOFF;
+	}
+	return 0;
+}
+
+/* SAVE_CONFIG: keeps the radio's configuration in a file so that the next */
+/* start can put it back in one go                                          */
+int saveRadioConfigurationFile(RFID_RADIO_HANDLE handle, const char* path)
+{
+	static INT8U registers[SUPERVISOR_REGISTERS_SIZE];
+	INT32U length = sizeof(registers);
+	FILE* file;
+	int saved;
+
+	if (!check(RFID_RadioSaveConfiguration(handle, registers, &length),
+		"RFID_RadioSaveConfiguration"))
+	{
+		return 0;
+	}
+	file = fopen(path, "wb");
+	if (NULL == file)
+	{
+		return 0;
+	}
+	saved = fwrite(registers, 1, length, file) == length;
+	fclose(file);
+	return saved;
+}
+
+/* Call after opening the radio.  Returns 0 if there is no saved            */
+/* configuration or the radio would not take it.                            */
+int restoreRadioConfigurationFile(RFID_RADIO_HANDLE handle, const char* path)
+{
+	static INT8U registers[SUPERVISOR_REGISTERS_SIZE];
+	size_t length;
+	FILE* file;
+
+	file = fopen(path, "rb");
+	if (NULL == file)
+	{
+		return 0;
+	}
+	length = fread(registers, 1, sizeof(registers), file);
+	fclose(file);
+	return check(RFID_RadioRestoreConfiguration(handle, registers, (INT32U)length),
+		"RFID_RadioRestoreConfiguration");
+}
+
+/* RECOVERY_STATS */
+void getRecoveryStats(RECOVERY_STATS* stats)
+{
+	*stats = recovery;
+}
@@ -0,0 +1,29 @@
+#ifndef RADIO_SUPERVISOR_H_
+
+#define RADIO_SUPERVISOR_H_
+
+#include <WinSock2.h>
+#include "rfid_library.h"
+
+
+/* How the reader has recovered from losing the radio: the number of times, */
+/* and the time (in milliseconds) from the failure being noticed to          */
+/* inventory being able to resume                                            */
+typedef struct
+{
+	INT32U  count;
+	INT32U  lastMs;
+	INT32U  maxMs;
+	INT32U  totalMs;
+} RECOVERY_STATS;
+
+void setResponseTimeout(RFID_RADIO_HANDLE handle);
+int isRadioLost(RFID_STATUS status);
+void captureRadioConfiguration(RFID_RADIO_HANDLE handle);
+int recoverRadio(RFID_RADIO_HANDLE* pHandle, SOCKET control, volatile int* pKeepTrying);
+void getRecoveryStats(RECOVERY_STATS* stats);
+int saveRadioConfigurationFile(RFID_RADIO_HANDLE handle, const char* path);
+int restoreRadioConfigurationFile(RFID_RADIO_HANDLE handle, const char* path);
+
+
+#endif /* RADIO_SUPERVISOR_H_ */
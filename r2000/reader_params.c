@@ -5,10 +5,13 @@
 #include <stdlib.h>
 #include <WinSock2.h>
 #include "rfid_library.h"
+#include "rfid_library_ext.h"
+#include "rfid_packets.h"
 #include "network.h"
 #include "r2000.h"
 #include "byte_swap.h"
 #include "oemcfg.h"
+#include "link_profile.h"
 
 
 //#define OEMCFG_USBD_32BIT_LEN           40
@@ -169,6 +172,82 @@ int setAntennaPower(RFID_RADIO_HANDLE handle, double power) {
 	
 }
 
+/* Let the library retry failed reads and writes, but only when the failure  */
+/* is recoverable (no reply, bad CRC, insufficient power...).  The power    */
+/* is left at what SET_POWER configured; stepping it up would take the       */
+/* radio above the level the operator chose.                                 */
+void setAccessRetryPolicy(RFID_RADIO_HANDLE handle, INT32U maxAttempts) {
+	RFID_18K6C_ACCESS_RETRY_POLICY policy;
+
+	policy.length = sizeof(RFID_18K6C_ACCESS_RETRY_POLICY);
+	policy.maxAttempts = maxAttempts;
+	policy.backoffTime = 0;
+	policy.powerStep = 0;
+	policy.maxPowerLevel = 0;
+	policy.antennaPortMask = 0;
+	status = RFID_18K6CSetAccessRetryPolicy(handle, &policy);
+	if (RFID_STATUS_OK != status)
+	{
+		fprintf(stderr,
+			"ERROR: RFID_18K6CSetAccessRetryPolicy returned 0x%.8x\n",
+			status);
+	}
+}
+
+/* The inventory callback only looks at the antenna-begin and inventory      */
+/* packets, so don't have the library hand it (or the MAC send) the rest.    */
+void setInventorySubscription(RFID_RADIO_HANDLE handle) {
+	RFID_PACKET_SUBSCRIPTION subscription;
+
+	memset(&subscription, 0, sizeof(subscription));
+	subscription.length = sizeof(RFID_PACKET_SUBSCRIPTION);
+	subscription.commonPackets =
+		RFID_PACKET_SUBSCRIPTION_BIT(RFID_PACKET_TYPE_ANTENNA_BEGIN) |
+		RFID_PACKET_SUBSCRIPTION_BIT(RFID_PACKET_TYPE_18K6C_INVENTORY);
+	status = RFID_18K6CSetPacketSubscription(handle,
+		RFID_18K6C_OPERATION_INVENTORY, &subscription);
+	if (RFID_STATUS_OK != status)
+	{
+		fprintf(stderr,
+			"ERROR: RFID_18K6CSetPacketSubscription returned 0x%.8x\n",
+			status);
+	}
+}
+
+/* SET_Q AUTO: let the library pick the dynamic-Q parameters from the        */
+/* collision and empty-slot counts of each inventory cycle, so that Q keeps  */
+/* up with a tag population that swings from 1 to 500 tags on the conveyor.  */
+void setDynamicQTuner(RFID_RADIO_HANDLE handle, BOOL32 enable) {
+	RFID_18K6C_DYNAMICQ_TUNER_PARMS tuner;
+
+	tuner.length = sizeof(RFID_18K6C_DYNAMICQ_TUNER_PARMS);
+	tuner.enabled = enable;
+	tuner.minQValue = 0;
+	tuner.maxQValue = 9;
+	tuner.thresholdMultiplier = 4;
+	tuner.responsiveness = 60;
+	status = RFID_18K6CSetDynamicQTuner(handle, &tuner);
+	if (RFID_STATUS_OK != status)
+	{
+		fprintf(stderr,
+			"ERROR: RFID_18K6CSetDynamicQTuner returned 0x%.8x\n",
+			status);
+		return;
+	}
+	if (enable)
+	{
+		status = RFID_18K6CSetCurrentSingulationAlgorithm(
+			handle,
+			RFID_18K6C_SINGULATION_ALGORITHM_DYNAMICQ);
+		if (RFID_STATUS_OK != status)
+		{
+			fprintf(stderr,
+				"ERROR: RFID_18K6CSetCurrentSingulationAlgorithm returned 0x%.8x\n",
+				status);
+		}
+	}
+}
+
 
 void getConnectedAntennaPorts(RFID_RADIO_HANDLE handle, char ant[4]) {
 
@@ -341,28 +420,6 @@ void ConvertUsbString(
 //		(pSerialNumber->byteLength - 2) / 2);
 //} /* OemConfigMacToHost */
 
-void Int32ArrayMacToHost(
-	INT32U*         pBegin,
-	INT32U          numberInt32
-)
-{
-	for (; numberInt32; --numberInt32, ++pBegin)
-	{
-		*pBegin = MacToHost32(*pBegin);
-	}
-} /* Int32ArrayMacToHost */
-
-void Int16ArrayMacToHost(
-	INT16U*         pBegin,
-	INT32U          numberInt16
-)
-{
-	for (; numberInt16; --numberInt16, ++pBegin)
-	{
-		*pBegin = MacToHost16(*pBegin);
-	}
-}
-
 void getReaderInfo(RFID_RADIO_HANDLE handle, char inf[9]) {
 
 	//char						tempString[OEMCFG_USBD_32BIT_LEN * 4];
@@ -544,19 +601,52 @@ void setAdvancedOptions(RFID_RADIO_HANDLE handle, char msg[20], char inf[15]) {
 	} 
 	else if (strcmp(msg, "SET_TARI") == 0) {
 		printf("Option %s\n", "SET_TARI");
-
+		if (inf != NULL) {
+			selectLinkProfile(handle, LINK_PARAM_TARI, atof(inf));
+		}
 	}
 	else if (strcmp(msg, "SET_BLF") == 0) {
 		printf("Option %s\n", "SET_BLF");
-
+		if (inf != NULL) {
+			selectLinkProfile(handle, LINK_PARAM_BLF, atof(inf));
+		}
 	}
 	else if (strcmp(msg, "SET_M") == 0) {
 		printf("Option %s\n", "SET_M");
-
+		if (inf != NULL) {
+			selectLinkProfile(handle, LINK_PARAM_M, atof(inf));
+		}
 	}
 	else if (strcmp(msg, "SET_Q") == 0) {
 		printf("Option %s\n", "SET_Q");
-
+		if (inf != NULL && strncmp(inf, "AUTO", 4) == 0) {
+			setDynamicQTuner(handle, 1);
+		}
+		else if (inf != NULL)
+		{
+			RFID_18K6C_SINGULATION_FIXEDQ_PARMS fixedQParms;
+
+			setDynamicQTuner(handle, 0);
+			fixedQParms.length = sizeof(RFID_18K6C_SINGULATION_FIXEDQ_PARMS);
+			status = RFID_18K6CGetSingulationAlgorithmParameters(
+				handle,
+				RFID_18K6C_SINGULATION_ALGORITHM_FIXEDQ,
+				&fixedQParms);
+			fixedQParms.qValue = atoi(inf);
+			status = RFID_18K6CSetSingulationAlgorithmParameters(
+				handle,
+				RFID_18K6C_SINGULATION_ALGORITHM_FIXEDQ,
+				&fixedQParms);
+			if (RFID_STATUS_OK != status)
+			{
+				fprintf(stderr,
+					"ERROR: RFID_18K6CSetSingulationAlgorithmParameters returned 0x%.8x\n",
+					status);
+			}
+			status = RFID_18K6CSetCurrentSingulationAlgorithm(
+				handle,
+				RFID_18K6C_SINGULATION_ALGORITHM_FIXEDQ);
+		}
 	}
 	else if (strcmp(msg, "SET_SESSION") == 0) {
 		printf("Option %s\n", "SET_SESSION");
@@ -3,6 +3,9 @@
 void initializeRFID(RFID_RADIO_HANDLE handle, RFID_RADIO_ENUM* pEnum);
 int getAntennaPower(RFID_RADIO_HANDLE handle);
 int setAntennaPower(RFID_RADIO_HANDLE handle, double power);
+void setAccessRetryPolicy(RFID_RADIO_HANDLE handle, INT32U maxAttempts);
+void setInventorySubscription(RFID_RADIO_HANDLE handle);
+void setDynamicQTuner(RFID_RADIO_HANDLE handle, BOOL32 enable);
 void getConnectedAntennaPorts(RFID_RADIO_HANDLE handle, char ant[4]);
 void getReaderInfo(RFID_RADIO_HANDLE handle, char inf[9]);
 void getAdvancedOptions(RFID_RADIO_HANDLE handle, char inf[40]);
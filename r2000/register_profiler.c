@@ -0,0 +1,350 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+#include "rfid_library.h"
+#include "rfid_library_ext.h"
+#include "hostifregs.h"
+#include "register_profiler.h"
+
+
+/* Single accesses wait this long (in milliseconds) first, so that the      */
+/* transport is idle and nothing of the last access is still in flight      */
+#define SINGLE_ACCESS_GAP       2
+
+/* Room for the blob of RFID_RadioSaveConfiguration                         */
+#define CONFIGURATION_SIZE      8192
+
+/* How a case makes its calls                                               */
+typedef enum
+{
+	ACCESS_SINGLE,
+	ACCESS_BACK_TO_BACK,
+	ACCESS_PIPELINED
+} ACCESS;
+
+static const char* accessNames[] = { "single", "backToBack", "pipelined" };
+
+/* What the calls work on, read from the radio before the cases start so    */
+/* that the writes leave it as it was                                       */
+typedef struct
+{
+	INT32U                      antennaCycles;
+	INT32U                      linkProfile;
+	INT8U*                      configuration;
+	INT32U                      configurationLength;
+	RFID_ANTENNA_PORT_CONFIG    portConfig;
+	RFID_ANTENNA_PORT_STATUS    portStatus;
+	RFID_RADIO_LINK_PROFILE     profile;
+} PROFILE_STATE;
+
+typedef RFID_STATUS (*PROFILED_CALL)(RFID_RADIO_HANDLE handle, PROFILE_STATE* state);
+
+typedef struct
+{
+	const char*     name;
+	PROFILED_CALL   call;
+	ACCESS          access;
+} PROFILE_CASE;
+
+static LARGE_INTEGER frequency;
+
+static RFID_STATUS readRegister(RFID_RADIO_HANDLE handle, PROFILE_STATE* state)
+{
+	INT32U value;
+
+	RFID_UNREFERENCED_LOCAL(state);
+	return RFID_MacReadRegister(handle, MAC_VER, &value);
+}
+
+static RFID_STATUS writeRegister(RFID_RADIO_HANDLE handle, PROFILE_STATE* state)
+{
+	return RFID_MacWriteRegister(handle, HST_ANT_CYCLES, state->antennaCycles);
+}
+
+static RFID_STATUS getPortConfiguration(RFID_RADIO_HANDLE handle, PROFILE_STATE* state)
+{
+	state->portConfig.length = sizeof(RFID_ANTENNA_PORT_CONFIG);
+	return RFID_AntennaPortGetConfiguration(handle, 0, &state->portConfig);
+}
+
+static RFID_STATUS getPortStatus(RFID_RADIO_HANDLE handle, PROFILE_STATE* state)
+{
+	state->portStatus.length = sizeof(RFID_ANTENNA_PORT_STATUS);
+	return RFID_AntennaPortGetStatus(handle, 0, &state->portStatus);
+}
+
+static RFID_STATUS getCurrentLinkProfile(RFID_RADIO_HANDLE handle, PROFILE_STATE* state)
+{
+	INT32U profile;
+
+	RFID_UNREFERENCED_LOCAL(state);
+	return RFID_RadioGetCurrentLinkProfile(handle, &profile);
+}
+
+static RFID_STATUS getLinkProfile(RFID_RADIO_HANDLE handle, PROFILE_STATE* state)
+{
+	state->profile.length = sizeof(RFID_RADIO_LINK_PROFILE);
+	return RFID_RadioGetLinkProfile(handle, state->linkProfile, &state->profile);
+}
+
+static RFID_STATUS getSingulationAlgorithm(RFID_RADIO_HANDLE handle, PROFILE_STATE* state)
+{
+	RFID_18K6C_SINGULATION_ALGORITHM algorithm;
+
+	RFID_UNREFERENCED_LOCAL(state);
+	return RFID_18K6CGetCurrentSingulationAlgorithm(handle, &algorithm);
+}
+
+static RFID_STATUS saveConfiguration(RFID_RADIO_HANDLE handle, PROFILE_STATE* state)
+{
+	INT32U length = CONFIGURATION_SIZE;
+
+	return RFID_RadioSaveConfiguration(handle, state->configuration, &length);
+}
+
+static RFID_STATUS restoreConfiguration(RFID_RADIO_HANDLE handle, PROFILE_STATE* state)
+{
+	return RFID_RadioRestoreConfiguration(handle, state->configuration, state->configurationLength);
+}
+
+/* The register accesses on their own and then the configuration calls,     */
+/* which are back to back as an application makes them.  Restoring the      */
+/* configuration pipelines its register writes.                             */
+static const PROFILE_CASE cases[] = {
+	{ "RFID_MacReadRegister", readRegister, ACCESS_SINGLE },
+	{ "RFID_MacReadRegister", readRegister, ACCESS_BACK_TO_BACK },
+	{ "RFID_MacWriteRegister", writeRegister, ACCESS_SINGLE },
+	{ "RFID_MacWriteRegister", writeRegister, ACCESS_BACK_TO_BACK },
+	{ "RFID_RadioRestoreConfiguration", restoreConfiguration, ACCESS_PIPELINED },
+	{ "RFID_AntennaPortGetConfiguration", getPortConfiguration, ACCESS_BACK_TO_BACK },
+	{ "RFID_AntennaPortGetStatus", getPortStatus, ACCESS_BACK_TO_BACK },
+	{ "RFID_RadioGetCurrentLinkProfile", getCurrentLinkProfile, ACCESS_BACK_TO_BACK },
+	{ "RFID_RadioGetLinkProfile", getLinkProfile, ACCESS_BACK_TO_BACK },
+	{ "RFID_18K6CGetCurrentSingulationAlgorithm", getSingulationAlgorithm, ACCESS_BACK_TO_BACK },
+	{ "RFID_RadioSaveConfiguration", saveConfiguration, ACCESS_BACK_TO_BACK }
+};
+
+static int compareDuration(const void* a, const void* b)
+{
+	double difference = *(const double*)a - *(const double*)b;
+
+	return (difference < 0) ? -1 : (difference > 0) ? 1 : 0;
+}
+
+static double percentile(const double* sorted, INT32U count, double fraction)
+{
+	INT32U index = (INT32U)(fraction * count);
+
+	if (count == 0)
+	{
+		return 0.0;
+	}
+	return sorted[index < count ? index : count - 1];
+}
+
+static double microsecondsSince(const LARGE_INTEGER* pStart)
+{
+	LARGE_INTEGER now;
+
+	QueryPerformanceCounter(&now);
+	return (double)(now.QuadPart - pStart->QuadPart) * 1e6 / frequency.QuadPart;
+}
+
+/* Reads what the calls will work on and saves the configuration for the    */
+/* restore to put back                                                      */
+static int prepareState(RFID_RADIO_HANDLE handle, PROFILE_STATE* state)
+{
+	RFID_STATUS status;
+
+	memset(state, 0, sizeof(PROFILE_STATE));
+	state->configuration = (INT8U*)malloc(CONFIGURATION_SIZE);
+	if (state->configuration == NULL)
+	{
+		fprintf(stderr, "ERROR: Failed to allocate memory\n");
+		return 0;
+	}
+	state->configurationLength = CONFIGURATION_SIZE;
+	if (RFID_STATUS_OK != (status = RFID_MacReadRegister(handle, HST_ANT_CYCLES, &state->antennaCycles)) ||
+		RFID_STATUS_OK != (status = RFID_RadioGetCurrentLinkProfile(handle, &state->linkProfile)) ||
+		RFID_STATUS_OK != (status = RFID_RadioSaveConfiguration(handle, state->configuration, &state->configurationLength)))
+	{
+		fprintf(stderr, "ERROR: Reading the radio's configuration returned 0x%.8x\n", status);
+		free(state->configuration);
+		return 0;
+	}
+	return 1;
+}
+
+/* Makes the calls of a case and writes their wall times and, from the      */
+/* radio's statistics, the register accesses they made                      */
+static int runCase(RFID_RADIO_HANDLE handle, const PROFILE_CASE* pCase, PROFILE_STATE* state, INT32U samples, double* durations, FILE* output, int first)
+{
+	RFID_RADIO_STATISTICS statistics;
+	RFID_STATUS status;
+	LARGE_INTEGER start;
+	double firstCall;
+	double total = 0.0;
+	double accesses;
+	INT32U index;
+
+	/* The first call is timed on its own: it may fill a cache that the     */
+	/* rest are answered from                                               */
+	QueryPerformanceCounter(&start);
+	status = pCase->call(handle, state);
+	firstCall = microsecondsSince(&start);
+	if (RFID_STATUS_OK != status)
+	{
+		fprintf(stderr, "ERROR: %s returned 0x%.8x\n", pCase->name, status);
+		return 0;
+	}
+
+	RFID_RadioResetStatistics(handle);
+	for (index = 0; index < samples; ++index)
+	{
+		if (ACCESS_SINGLE == pCase->access)
+		{
+			Sleep(SINGLE_ACCESS_GAP);
+		}
+		QueryPerformanceCounter(&start);
+		status = pCase->call(handle, state);
+		durations[index] = microsecondsSince(&start);
+		if (RFID_STATUS_OK != status)
+		{
+			fprintf(stderr, "ERROR: %s returned 0x%.8x\n", pCase->name, status);
+			return 0;
+		}
+		total += durations[index];
+	}
+	statistics.length = sizeof(RFID_RADIO_STATISTICS);
+	RFID_RadioGetStatistics(handle, &statistics);
+	qsort(durations, samples, sizeof(double), compareDuration);
+
+	accesses = (double)(statistics.registerReads + statistics.registerWrites) / samples;
+	fprintf(output,
+		"%s\n    {\"call\": \"%s\", \"access\": \"%s\", \"calls\": %u, "
+		"\"registerReadsPerCall\": %.2f, \"registerWritesPerCall\": %.2f, "
+		"\"firstCallMicroseconds\": %.1f, ",
+		first ? "" : ",",
+		pCase->name, accessNames[pCase->access], samples,
+		(double)statistics.registerReads / samples,
+		(double)statistics.registerWrites / samples,
+		firstCall);
+	fprintf(output,
+		"\"wallMicroseconds\": {\"mean\": %.1f, \"p50\": %.1f, \"p99\": %.1f, "
+		"\"max\": %.1f}, \"microsecondsPerRegisterAccess\": %.1f, ",
+		total / samples,
+		percentile(durations, samples, 0.5),
+		percentile(durations, samples, 0.99),
+		durations[samples - 1],
+		accesses > 0 ? total / samples / accesses : 0.0);
+	/* The library times each register read from request to response        */
+	fprintf(output,
+		"\"readRoundTripMicroseconds\": {\"p50\": %llu, \"p99\": %llu, \"max\": %llu}}",
+		statistics.registerRoundTrip.median,
+		statistics.registerRoundTrip.percentile99,
+		statistics.registerRoundTrip.maximum);
+	return 1;
+}
+
+int profileRegisters(int synthetic, INT32U samples, FILE* output)
+{
+	RFID_VERSION version;
+	RFID_RADIO_ENUM* pEnum;
+	RFID_RADIO_INFO* pInfo;
+	RFID_RADIO_HANDLE handle;
+	RFID_STATUS status;
+	PROFILE_STATE state;
+	double* durations;
+	size_t index;
+	int ok = 1;
+
+	QueryPerformanceFrequency(&frequency);
+	durations = (double*)malloc(samples * sizeof(double));
+	if (durations == NULL || samples == 0)
+	{
+		fprintf(stderr, "ERROR: Failed to allocate memory\n");
+		free(durations);
+		return 1;
+	}
+
+	status = RFID_Startup(&version, synthetic ? RFID_FLAG_SYNTHETIC_RADIOS : 0);
+	if (RFID_STATUS_OK != status)
+	{
+		fprintf(stderr, "ERROR: RFID_Startup returned 0x%.8x\n", status);
+		free(durations);
+		return 1;
+	}
+
+	pEnum = (RFID_RADIO_ENUM*)malloc(sizeof(RFID_RADIO_ENUM));
+	if (pEnum == NULL)
+	{
+		fprintf(stderr, "ERROR: Failed to allocate memory\n");
+		RFID_Shutdown();
+		free(durations);
+		return 1;
+	}
+	pEnum->length = sizeof(RFID_RADIO_ENUM);
+	pEnum->totalLength = sizeof(RFID_RADIO_ENUM);
+	while (RFID_ERROR_BUFFER_TOO_SMALL ==
+		(status = RFID_RetrieveAttachedRadiosList(pEnum, 0)))
+	{
+		RFID_RADIO_ENUM* pNewEnum = (RFID_RADIO_ENUM*)realloc(pEnum, pEnum->totalLength);
+		if (pNewEnum == NULL)
+		{
+			break;
+		}
+		pEnum = pNewEnum;
+	}
+	if (RFID_STATUS_OK != status || pEnum->countRadios == 0)
+	{
+		fprintf(stderr, "ERROR: No radio to profile (0x%.8x)\n", status);
+		free(pEnum);
+		RFID_Shutdown();
+		free(durations);
+		return 1;
+	}
+
+	pInfo = pEnum->ppRadioInfo[0];
+	status = RFID_RadioOpen(pInfo->cookie, &handle, 0);
+	if (RFID_STATUS_OK != status)
+	{
+		fprintf(stderr, "ERROR: RFID_RadioOpen returned 0x%.8x\n", status);
+		free(pEnum);
+		RFID_Shutdown();
+		free(durations);
+		return 1;
+	}
+
+	if (prepareState(handle, &state))
+	{
+		fprintf(output,
+			"{\n  \"benchmark\": \"r2000-registers\",\n"
+			"  \"library\": \"%u.%u.%u.%u\",\n"
+			"  \"radio\": \"%.*s\",\n"
+			"  \"callsPerCase\": %u,\n"
+			"  \"cases\": [",
+			version.major, version.minor, version.maintenance, version.release,
+			(int)pInfo->idLength, (const char*)pInfo->pUniqueId,
+			samples);
+		for (index = 0; index < sizeof(cases) / sizeof(cases[0]) && ok; ++index)
+		{
+			ok = runCase(handle, &cases[index], &state, samples, durations, output, index == 0);
+			fflush(output);
+		}
+		fprintf(output, "\n  ]\n}\n");
+		free(state.configuration);
+	}
+	else
+	{
+		ok = 0;
+	}
+
+	RFID_RadioClose(handle);
+	free(pEnum);
+	RFID_Shutdown();
+	free(durations);
+	return ok ? 0 : 1;
+}
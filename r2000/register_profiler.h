@@ -0,0 +1,20 @@
+#ifndef REGISTER_PROFILER_H_
+
+#define REGISTER_PROFILER_H_
+
+#include <stdio.h>
+#include "rfid_library.h"
+
+
+/* The calls each case makes unless told otherwise                          */
+#define REGISTER_PROFILE_DEFAULT_SAMPLES    1000
+
+/* Opens the first radio (or the first of the library's synthetic radios)   */
+/* and measures the round trips of single, back-to-back and pipelined       */
+/* register accesses and the wall time and register accesses of each        */
+/* configuration call, and writes the results to output as JSON.  Must be   */
+/* called before RFID_Startup.                                              */
+int profileRegisters(int synthetic, INT32U samples, FILE* output);
+
+
+#endif /* REGISTER_PROFILER_H_ */
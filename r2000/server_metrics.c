@@ -0,0 +1,502 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <WinSock2.h>
+#include "rfid_library.h"
+#include "server_metrics.h"
+
+
+/* The tags read lately, to tell the first read of a tag in a second from   */
+/* the rest.  A power of two.                                               */
+#define METRICS_TAG_SLOTS       8192
+
+/* How many slots a tag is looked for in before one that has gone stale is  */
+/* reused                                                                   */
+#define METRICS_TAG_PROBES      16
+
+/* Send latencies, in microseconds, with four buckets to each power of two  */
+#define METRICS_LATENCY_BUCKETS 128
+
+/* Rates and percentiles are over at least this long (in milliseconds)      */
+#define METRICS_MIN_INTERVAL    1000
+
+/* How long (in milliseconds) the listener waits for a scraper's request    */
+#define METRICS_REQUEST_TIMEOUT 100
+
+/* The antennas past METRICS_MAX_ANTENNAS share the last counter            */
+#define METRICS_ANTENNA_COUNTERS    (METRICS_MAX_ANTENNAS + 1)
+
+typedef struct
+{
+	volatile LONG   key;        /* hash of the antenna and EPC, 0 if free   */
+	volatile LONG   second;     /* the second the tag was last read in       */
+} METRICS_TAG;
+
+/* The counters at one moment.  They only ever go up (and wrap), so a rate  */
+/* is the difference between two samples.                                   */
+typedef struct
+{
+	LONGLONG    time;
+	INT32U      reads[METRICS_ANTENNA_COUNTERS];
+	INT32U      unique[METRICS_ANTENNA_COUNTERS];
+	INT32U      sent;
+	INT32U      latency[METRICS_LATENCY_BUCKETS];
+	LONGLONG    inventory;
+} METRICS_SAMPLE;
+
+/* What STATS and the listener report                                       */
+typedef struct
+{
+	const char* state;
+	double      reads[METRICS_ANTENNA_COUNTERS];    /* per second */
+	double      unique[METRICS_ANTENNA_COUNTERS];   /* per second */
+	double      totalReads;
+	double      totalUnique;
+	INT32U      p50;                                /* microseconds */
+	INT32U      p90;
+	INT32U      p99;
+	INT32U      max;
+	INT32U      sent;
+	LONG        queued;
+	LONG        dropped;
+	double      dutyCycle;                          /* 0 to 1 */
+} METRICS_REPORT;
+
+/* Fed by the inventory callbacks and the senders without taking a lock     */
+static volatile LONG        reads[METRICS_ANTENNA_COUNTERS];
+static volatile LONG        unique[METRICS_ANTENNA_COUNTERS];
+static volatile LONG        sent;
+static volatile LONG        latency[METRICS_LATENCY_BUCKETS];
+static volatile LONG        queued;
+static volatile LONG        dropped;
+static volatile LONGLONG    inventoryTicks;
+static METRICS_TAG          tags[METRICS_TAG_SLOTS];
+
+static LONGLONG             frequency = 1;
+static LONGLONG             startTime;
+static const char* volatile radioState = METRICS_STATE_IDLE;
+static volatile LONG        stateRadios = 1;
+
+/* The window rates are over, which STATS and the listener share            */
+static CRITICAL_SECTION     sampleLock;
+static METRICS_SAMPLE       previous;
+static METRICS_SAMPLE       last;
+
+static SOCKET               listener = INVALID_SOCKET;
+static HANDLE               listenerThread = NULL;
+
+LONGLONG metricsNow(void)
+{
+	LARGE_INTEGER now;
+
+	QueryPerformanceCounter(&now);
+	return now.QuadPart;
+}
+
+static void takeSample(METRICS_SAMPLE* sample)
+{
+	INT32U index;
+
+	sample->time = metricsNow();
+	for (index = 0; index < METRICS_ANTENNA_COUNTERS; ++index)
+	{
+		sample->reads[index] = (INT32U)reads[index];
+		sample->unique[index] = (INT32U)unique[index];
+	}
+	sample->sent = (INT32U)sent;
+	for (index = 0; index < METRICS_LATENCY_BUCKETS; ++index)
+	{
+		sample->latency[index] = (INT32U)latency[index];
+	}
+	sample->inventory = inventoryTicks;
+}
+
+void initMetrics(void)
+{
+	LARGE_INTEGER ticksPerSecond;
+
+	QueryPerformanceFrequency(&ticksPerSecond);
+	frequency = ticksPerSecond.QuadPart;
+	startTime = metricsNow();
+	InitializeCriticalSection(&sampleLock);
+	takeSample(&last);
+	previous = last;
+}
+
+/* The state is one of the METRICS_STATE strings, and radios the number of  */
+/* radios inventorying in it                                                */
+void setMetricsState(const char* state, INT32U radios)
+{
+	InterlockedExchange(&stateRadios, radios ? (LONG)radios : 1);
+	radioState = state;
+}
+
+/* FNV-1a of the antenna and the EPC, never 0 (a free slot)                 */
+static LONG hashTag(INT32U antenna, const INT8U* epc, int epcLength)
+{
+	INT32U hash = 2166136261U;
+	int index;
+
+	for (index = 0; index < 4; ++index)
+	{
+		hash = (hash ^ ((antenna >> (index * 8)) & 0xff)) * 16777619U;
+	}
+	for (index = 0; index < epcLength; ++index)
+	{
+		hash = (hash ^ epc[index]) * 16777619U;
+	}
+	return hash ? (LONG)hash : 1;
+}
+
+/* Counts a read, and counts it as a unique tag if it is the first read of  */
+/* the tag on the antenna this second.  Once more tags are being read than  */
+/* the table holds, some reads are counted as unique that aren't.           */
+void metricsRead(INT32U antenna, const INT8U* epc, int epcLength)
+{
+	INT32U index = antenna < METRICS_MAX_ANTENNAS ? antenna : METRICS_MAX_ANTENNAS;
+	LONG second = (LONG)((metricsNow() - startTime) / frequency) + 1;
+	LONG key = hashTag(antenna, epc, epcLength);
+	METRICS_TAG* stale = NULL;
+	LONG staleKey = 0;
+	INT32U probe;
+
+	InterlockedIncrement(&reads[index]);
+	for (probe = 0; probe < METRICS_TAG_PROBES; ++probe)
+	{
+		METRICS_TAG* tag =
+			&tags[((INT32U)key + probe) & (METRICS_TAG_SLOTS - 1)];
+		LONG current = tag->key;
+
+		if (0 == current)
+		{
+			current = InterlockedCompareExchange(&tag->key, key, 0);
+			if (0 == current)
+			{
+				current = key;
+			}
+		}
+		if (current == key)
+		{
+			if (InterlockedExchange(&tag->second, second) != second)
+			{
+				InterlockedIncrement(&unique[index]);
+			}
+			return;
+		}
+		if (NULL == stale && tag->second < second - 1)
+		{
+			stale = tag;
+			staleKey = current;
+		}
+	}
+
+	/* Every slot the tag could be in is taken: have one that hasn't been   */
+	/* read from for a while                                                */
+	if (NULL != stale &&
+		InterlockedCompareExchange(&stale->key, key, staleKey) == staleKey)
+	{
+		InterlockedExchange(&stale->second, second);
+	}
+	InterlockedIncrement(&unique[index]);
+}
+
+static INT32U latencyBucket(LONGLONG microseconds)
+{
+	INT32U value = microseconds > 0xffffffff ? 0xffffffff :
+		microseconds < 0 ? 0 : (INT32U)microseconds;
+	INT32U msb;
+
+	if (value < 4)
+	{
+		return value;
+	}
+	for (msb = 2; msb < 31 && value >> (msb + 1); ++msb)
+	{
+	}
+	return 4 * (msb - 1) + ((value >> (msb - 2)) & 3);
+}
+
+/* The longest latency (in microseconds) that a bucket holds                */
+static INT32U latencyBucketTop(INT32U bucket)
+{
+	INT32U shift;
+
+	if (bucket < 4)
+	{
+		return bucket;
+	}
+	shift = bucket / 4 - 1;
+	return (INT32U)((((INT64U)(4 + bucket % 4) + 1) << shift) - 1);
+}
+
+/* Records the result of sending a read to the client, which was received   */
+/* (per metricsNow) in the inventory callback                               */
+void metricsSent(LONGLONG received, int result)
+{
+	if (SOCKET_ERROR == result)
+	{
+		InterlockedIncrement(&dropped);
+		return;
+	}
+	InterlockedIncrement(&latency[latencyBucket(
+		(metricsNow() - received) * 1000000 / frequency)]);
+	InterlockedIncrement(&sent);
+}
+
+/* Reads waiting to be sent                                                 */
+void metricsQueued(void)
+{
+	InterlockedIncrement(&queued);
+}
+
+void metricsDequeued(void)
+{
+	InterlockedDecrement(&queued);
+}
+
+/* Reads that were never sent                                               */
+void metricsDropped(INT32U count)
+{
+	InterlockedExchangeAdd(&dropped, (LONG)count);
+}
+
+/* Adds the time since start (per metricsNow) to the time spent             */
+/* inventorying                                                             */
+void metricsInventoryTime(LONGLONG start)
+{
+	InterlockedExchangeAdd64(&inventoryTicks, metricsNow() - start);
+}
+
+static INT32U latencyPercentile(const INT32U* buckets, INT32U count, INT32U perMille)
+{
+	INT32U target = (INT32U)(((INT64U)count * perMille + 999) / 1000);
+	INT32U total = 0;
+	INT32U bucket;
+
+	for (bucket = 0; bucket < METRICS_LATENCY_BUCKETS; ++bucket)
+	{
+		total += buckets[bucket];
+		if (total >= target)
+		{
+			return latencyBucketTop(bucket);
+		}
+	}
+	return latencyBucketTop(METRICS_LATENCY_BUCKETS - 1);
+}
+
+/* Rates and percentiles are over the window between the last two samples,  */
+/* which moves on once the last sample is METRICS_MIN_INTERVAL old          */
+static void getReport(METRICS_REPORT* report)
+{
+	METRICS_SAMPLE now;
+	METRICS_SAMPLE from;
+	METRICS_SAMPLE to;
+	INT32U buckets[METRICS_LATENCY_BUCKETS];
+	INT32U count = 0;
+	INT32U index;
+	double seconds;
+
+	takeSample(&now);
+	EnterCriticalSection(&sampleLock);
+	if ((now.time - last.time) * 1000 >= METRICS_MIN_INTERVAL * frequency)
+	{
+		previous = last;
+		last = now;
+	}
+	from = previous;
+	to = last;
+	LeaveCriticalSection(&sampleLock);
+
+	memset(report, 0, sizeof(*report));
+	report->state = radioState;
+	seconds = (double)(to.time - from.time) / frequency;
+	for (index = 0; index < METRICS_ANTENNA_COUNTERS && seconds > 0; ++index)
+	{
+		report->reads[index] = (to.reads[index] - from.reads[index]) / seconds;
+		report->unique[index] = (to.unique[index] - from.unique[index]) / seconds;
+		report->totalReads += report->reads[index];
+		report->totalUnique += report->unique[index];
+	}
+
+	for (index = 0; index < METRICS_LATENCY_BUCKETS; ++index)
+	{
+		buckets[index] = to.latency[index] - from.latency[index];
+		count += buckets[index];
+		if (buckets[index])
+		{
+			report->max = latencyBucketTop(index);
+		}
+	}
+	if (count)
+	{
+		report->p50 = latencyPercentile(buckets, count, 500);
+		report->p90 = latencyPercentile(buckets, count, 900);
+		report->p99 = latencyPercentile(buckets, count, 990);
+	}
+
+	report->sent = now.sent;
+	report->queued = queued;
+	report->dropped = dropped;
+	if (to.time > from.time)
+	{
+		report->dutyCycle = (double)(to.inventory - from.inventory) /
+			((double)(to.time - from.time) * stateRadios);
+		report->dutyCycle = report->dutyCycle > 1 ? 1 : report->dutyCycle;
+	}
+}
+
+/* STATS: $STATS,<state>,<reads/s>,<unique tags/s>,<p50 us>,<p90 us>,       */
+/* <p99 us>,<max us>,<queued>,<dropped>,<duty cycle %>[,<antenna>:<reads/s> */
+/* :<unique tags/s>]...#, with the antennas that read anything.  Returns    */
+/* the length.                                                              */
+int formatMetrics(char* buffer, size_t size)
+{
+	METRICS_REPORT report;
+	INT32U antenna;
+	int length;
+
+	getReport(&report);
+	length = snprintf(buffer, size, "$STATS,%s,%.1f,%.1f,%u,%u,%u,%u,%ld,%ld,%.1f",
+		report.state, report.totalReads, report.totalUnique, report.p50,
+		report.p90, report.p99, report.max, report.queued, report.dropped,
+		report.dutyCycle * 100);
+	for (antenna = 0;
+		antenna < METRICS_MAX_ANTENNAS && length >= 0 && (size_t)length < size;
+		++antenna)
+	{
+		if (report.reads[antenna] > 0)
+		{
+			length += snprintf(&buffer[length], size - length, ",%u:%.1f:%.1f",
+				antenna, report.reads[antenna], report.unique[antenna]);
+		}
+	}
+	if (length >= 0 && (size_t)length + 1 < size)
+	{
+		buffer[length++] = '#';
+		buffer[length] = '\0';
+		return length;
+	}
+	return -1;
+}
+
+/* The listener's reply, in the Prometheus text format behind an HTTP       */
+/* header so that a scraper or curl can read it as well as telnet           */
+static int formatMetricsText(char* buffer, size_t size)
+{
+	METRICS_REPORT report;
+	INT32U antenna;
+	int length;
+
+	getReport(&report);
+	length = snprintf(buffer, size,
+		"HTTP/1.0 200 OK\r\n"
+		"Content-Type: text/plain; version=0.0.4\r\n"
+		"\r\n"
+		"r2000_state{state=\"%s\"} 1\n"
+		"r2000_reads_per_second %.1f\n"
+		"r2000_unique_tags_per_second %.1f\n"
+		"r2000_send_latency_microseconds{quantile=\"0.5\"} %u\n"
+		"r2000_send_latency_microseconds{quantile=\"0.9\"} %u\n"
+		"r2000_send_latency_microseconds{quantile=\"0.99\"} %u\n"
+		"r2000_send_latency_microseconds{quantile=\"1\"} %u\n"
+		"r2000_reads_sent_total %u\n"
+		"r2000_send_queue_depth %ld\n"
+		"r2000_dropped_total %ld\n"
+		"r2000_inventory_duty_cycle %.3f\n",
+		report.state, report.totalReads, report.totalUnique, report.p50,
+		report.p90, report.p99, report.max, report.sent, report.queued,
+		report.dropped, report.dutyCycle);
+	for (antenna = 0;
+		antenna < METRICS_MAX_ANTENNAS && length >= 0 && (size_t)length < size;
+		++antenna)
+	{
+		if (report.reads[antenna] > 0)
+		{
+			length += snprintf(&buffer[length], size - length,
+				"r2000_antenna_reads_per_second{antenna=\"%u\"} %.1f\n"
+				"r2000_antenna_unique_tags_per_second{antenna=\"%u\"} %.1f\n",
+				antenna, report.reads[antenna], antenna, report.unique[antenna]);
+		}
+	}
+	return (length >= 0 && (size_t)length < size) ? length : -1;
+}
+
+/* Answers every connection with the metrics and closes it                  */
+static DWORD WINAPI serveMetrics(void* data)
+{
+	SOCKET server = (SOCKET)data;
+	DWORD timeout = METRICS_REQUEST_TIMEOUT;
+	char request[512];
+	char text[4096];
+	SOCKET client;
+	int length;
+
+	while ((client = accept(server, NULL, NULL)) != INVALID_SOCKET)
+	{
+		/* A scraper sends a request first; telnet or nc sends nothing      */
+		setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout,
+			sizeof(timeout));
+		recv(client, request, sizeof(request), 0);
+		length = formatMetricsText(text, sizeof(text));
+		if (length > 0)
+		{
+			send(client, text, length, 0);
+		}
+		shutdown(client, SD_SEND);
+		closesocket(client);
+	}
+	return 0;
+}
+
+/* METRICS_PORT <port>: serves the metrics on port.  Returns 0 if it can't  */
+/* listen there.                                                            */
+int startMetricsListener(int port)
+{
+	struct sockaddr_in address;
+
+	stopMetricsListener();
+	listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (INVALID_SOCKET == listener)
+	{
+		return 0;
+	}
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = INADDR_ANY;
+	address.sin_port = htons((u_short)port);
+	if (SOCKET_ERROR == bind(listener, (struct sockaddr*)&address, sizeof(address)) ||
+		SOCKET_ERROR == listen(listener, SOMAXCONN))
+	{
+		closesocket(listener);
+		listener = INVALID_SOCKET;
+		return 0;
+	}
+	listenerThread = CreateThread(NULL, 0, serveMetrics, (void*)listener, 0, NULL);
+	if (NULL == listenerThread)
+	{
+		closesocket(listener);
+		listener = INVALID_SOCKET;
+		return 0;
+	}
+	return 1;
+}
+
+/* METRICS_PORT OFF */
+void stopMetricsListener(void)
+{
+	if (INVALID_SOCKET == listener)
+	{
+		return;
+	}
+	/* Closing the socket fails the listener's accept                       */
+	closesocket(listener);
+	listener = INVALID_SOCKET;
+	if (NULL != listenerThread)
+	{
+		WaitForSingleObject(listenerThread, INFINITE);
+		CloseHandle(listenerThread);
+		listenerThread = NULL;
+	}
+}
@@ -0,0 +1,33 @@
+#ifndef SERVER_METRICS_H_
+
+#define SERVER_METRICS_H_
+
+#include <WinSock2.h>
+#include "rfid_library.h"
+
+
+/* The antennas whose reads are counted apart; the others are only in the   */
+/* totals                                                                   */
+#define METRICS_MAX_ANTENNAS    16
+
+/* What the radio is doing, for STATS and the metrics listener              */
+#define METRICS_STATE_IDLE          "IDLE"
+#define METRICS_STATE_READING       "READING"
+#define METRICS_STATE_MULTI         "MULTI_READING"
+#define METRICS_STATE_RECOVERING    "RECOVERING"
+
+void initMetrics(void);
+void setMetricsState(const char* state, INT32U radios);
+LONGLONG metricsNow(void);
+void metricsRead(INT32U antenna, const INT8U* epc, int epcLength);
+void metricsSent(LONGLONG received, int result);
+void metricsQueued(void);
+void metricsDequeued(void);
+void metricsDropped(INT32U count);
+void metricsInventoryTime(LONGLONG start);
+int formatMetrics(char* buffer, size_t size);
+int startMetricsListener(int port);
+void stopMetricsListener(void);
+
+
+#endif /* SERVER_METRICS_H_ */
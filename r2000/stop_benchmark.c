@@ -0,0 +1,195 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <WinSock2.h>
+#include "rfid_library.h"
+#include "rfid_library_ext.h"
+#include "stop_benchmark.h"
+
+
+/* The most runs a benchmark makes                                           */
+#define MAX_STOP_RUNS           1000
+
+typedef struct
+{
+	RFID_RADIO_HANDLE   handle;
+	volatile int        stopping;
+	/* Performance-counter ticks of the last packet and of the inventory     */
+	/* returning for the last time                                           */
+	volatile LONGLONG   lastPacket;
+	LONGLONG            idle;
+} STOP_RUN;
+
+static INT32S stopCallback(RFID_RADIO_HANDLE handle, INT32U bufferLength, const INT8U* pBuffer, void* context)
+{
+	STOP_RUN* run = (STOP_RUN*)context;
+	LARGE_INTEGER now;
+	RFID_UNREFERENCED_LOCAL(handle);
+	RFID_UNREFERENCED_LOCAL(bufferLength);
+	RFID_UNREFERENCED_LOCAL(pBuffer);
+
+	QueryPerformanceCounter(&now);
+	run->lastPacket = now.QuadPart;
+	return 0;
+}
+
+/* Inventories until the run is stopped                                     */
+static DWORD WINAPI inventoryUntilStopped(void* data)
+{
+	STOP_RUN* run = (STOP_RUN*)data;
+	RFID_18K6C_INVENTORY_PARMS inventoryParms;
+	RFID_STATUS status;
+	LARGE_INTEGER now;
+
+	inventoryParms.length = sizeof(RFID_18K6C_INVENTORY_PARMS);
+	inventoryParms.common.tagStopCount = 0;
+	inventoryParms.common.pCallback = stopCallback;
+	inventoryParms.common.pCallbackCode = NULL;
+	inventoryParms.common.context = run;
+
+	while (!run->stopping)
+	{
+		status = RFID_18K6CTagInventory(run->handle, &inventoryParms, 0);
+		if (RFID_STATUS_OK != status && RFID_ERROR_OPERATION_CANCELLED != status)
+		{
+			fprintf(stderr,
+				"ERROR: RFID_18K6CTagInventory returned 0x%.8x\n",
+				status);
+			break;
+		}
+	}
+	QueryPerformanceCounter(&now);
+	run->idle = now.QuadPart;
+	return 0;
+}
+
+static int compareLatency(const void* a, const void* b)
+{
+	double difference = *(const double*)a - *(const double*)b;
+
+	return (difference < 0) ? -1 : (difference > 0) ? 1 : 0;
+}
+
+static void summarize(double* latencies, INT32U count, STOP_LATENCY* latency)
+{
+	qsort(latencies, count, sizeof(double), compareLatency);
+	latency->median = latencies[count / 2];
+	latency->p95 = latencies[(count * 95) / 100];
+	latency->max = latencies[count - 1];
+}
+
+/* BENCH_STOP: inventories for dwellTime milliseconds and then cancels,     */
+/* runs times, measuring from the cancel being requested to the last packet */
+/* of the inventory and to the radio being idle.  Every packet is           */
+/* subscribed to for the benchmark so that the command-end is the last      */
+/* packet.  Returns the number of runs measured.                            */
+int benchmarkStop(RFID_RADIO_HANDLE handle, INT32U runs, INT32U dwellTime, STOP_BENCHMARK_RESULT* pResult)
+{
+	RFID_PACKET_SUBSCRIPTION subscription;
+	RFID_PACKET_SUBSCRIPTION everything;
+	RFID_STATUS status;
+	LARGE_INTEGER frequency;
+	double* lastPacket;
+	double* idle;
+	INT32U measured = 0;
+	INT32U index;
+
+	runs = (runs < MAX_STOP_RUNS) ? runs : MAX_STOP_RUNS;
+	if (!runs)
+	{
+		return 0;
+	}
+
+	/* Without every packet the last one seen need not be the command-end,  */
+	/* so don't measure at all if the subscription can't be changed (or put */
+	/* back afterwards)                                                     */
+	subscription.length = sizeof(RFID_PACKET_SUBSCRIPTION);
+	status = RFID_18K6CGetPacketSubscription(handle, RFID_18K6C_OPERATION_INVENTORY, &subscription);
+	if (RFID_STATUS_OK != status)
+	{
+		fprintf(stderr,
+			"ERROR: RFID_18K6CGetPacketSubscription returned 0x%.8x\n",
+			status);
+		return 0;
+	}
+	memset(&everything, 0xFF, sizeof(everything));
+	everything.length = sizeof(RFID_PACKET_SUBSCRIPTION);
+	status = RFID_18K6CSetPacketSubscription(handle, RFID_18K6C_OPERATION_INVENTORY, &everything);
+	if (RFID_STATUS_OK != status)
+	{
+		fprintf(stderr,
+			"ERROR: RFID_18K6CSetPacketSubscription returned 0x%.8x\n",
+			status);
+		return 0;
+	}
+
+	lastPacket = (double*)malloc(runs * sizeof(double));
+	idle = (double*)malloc(runs * sizeof(double));
+	if (NULL == lastPacket || NULL == idle)
+	{
+		runs = 0;
+	}
+	QueryPerformanceFrequency(&frequency);
+
+	for (index = 0; index < runs; ++index)
+	{
+		STOP_RUN run;
+		LARGE_INTEGER stop;
+		HANDLE thread;
+
+		memset(&run, 0, sizeof(run));
+		run.handle = handle;
+		thread = CreateThread(NULL, 0, inventoryUntilStopped, &run, 0, NULL);
+		if (NULL == thread)
+		{
+			break;
+		}
+		Sleep(dwellTime);
+
+		/* One cancel, as stopRead sends.  If it lands between two          */
+		/* inventories, the next one is the last as the run is stopping.    */
+		QueryPerformanceCounter(&stop);
+		run.stopping = 1;
+		status = RFID_RadioCancelOperation(handle, 0);
+		if (RFID_STATUS_OK != status)
+		{
+			fprintf(stderr,
+				"ERROR: RFID_RadioCancelOperation returned 0x%.8x\n",
+				status);
+		}
+		WaitForSingleObject(thread, INFINITE);
+		CloseHandle(thread);
+
+		/* A run whose inventory ended by itself just before the stop says  */
+		/* nothing about stopping                                           */
+		if (run.lastPacket < stop.QuadPart)
+		{
+			continue;
+		}
+		lastPacket[measured] =
+			(run.lastPacket - stop.QuadPart) * 1000.0 / frequency.QuadPart;
+		idle[measured] = (run.idle - stop.QuadPart) * 1000.0 / frequency.QuadPart;
+		++measured;
+	}
+
+	status = RFID_18K6CSetPacketSubscription(handle, RFID_18K6C_OPERATION_INVENTORY, &subscription);
+	if (RFID_STATUS_OK != status)
+	{
+		fprintf(stderr,
+			"ERROR: RFID_18K6CSetPacketSubscription returned 0x%.8x\n",
+			status);
+		measured = 0;
+	}
+
+	if (measured)
+	{
+		pResult->runs = measured;
+		summarize(lastPacket, measured, &pResult->lastPacket);
+		summarize(idle, measured, &pResult->idle);
+	}
+	free(lastPacket);
+	free(idle);
+	return measured;
+}
@@ -0,0 +1,28 @@
+#ifndef STOP_BENCHMARK_H_
+
+#define STOP_BENCHMARK_H_
+
+#include "rfid_library.h"
+
+
+/* The distribution, in milliseconds, of one stop latency over the runs     */
+typedef struct
+{
+	double  median;
+	double  p95;
+	double  max;
+} STOP_LATENCY;
+
+/* How quickly an inventory stops once it is cancelled: until the last      */
+/* packet of the inventory arrives and until the radio is idle again         */
+typedef struct
+{
+	INT32U          runs;
+	STOP_LATENCY    lastPacket;
+	STOP_LATENCY    idle;
+} STOP_BENCHMARK_RESULT;
+
+int benchmarkStop(RFID_RADIO_HANDLE handle, INT32U runs, INT32U dwellTime, STOP_BENCHMARK_RESULT* pResult);
+
+
+#endif /* STOP_BENCHMARK_H_ */
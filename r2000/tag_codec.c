@@ -0,0 +1,109 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <string.h>
+#include "rfid_library.h"
+#include "rfid_packets.h"
+#include "byte_swap.h"
+#include "tag_codec.h"
+
+
+int inventoryDataLength(const RFID_PACKET_18K6C_INVENTORY* inv)
+{
+	/* pkt_len counts the 32-bit words after the common preamble, of which  */
+	/* the first three are the fields before inv_data                       */
+	return ((MacToHost16(inv->cmn.pkt_len) - 3) * 4) -
+		RFID_18K6C_INVENTORY_PADDING_BYTES(inv->cmn.flags);
+}
+
+int inventoryEpcLength(const RFID_PACKET_18K6C_INVENTORY* inv)
+{
+	return inventoryDataLength(inv) - 4 -  /* -4 for 16-bit PC and CRC */
+		(INVENTORY_HAS_M4_TID(inv->cmn.flags) ? M4_TID_LENGTH : 0);
+}
+
+void saveByteArray(const INT8U* bytes, int length, char* buf)
+{
+	int index;
+	char b[3];
+
+	for (index = 0; index < length; ++index)
+	{
+		sprintf(b, "%.2x", bytes[index]);
+		strcat(buf, b);
+	}
+}
+
+// Function to convert hexadecimal to decimal
+int* hexadecimalToDecimal(char hexVal[], INT16U* data)
+{
+	int len = 24;
+
+	// Initializing base value to 1, i.e 16^0 
+	int base = 1;
+	int cont = 0;
+	int write = 5;
+
+	int dec_val = 0;
+	INT16U writeData[6];
+
+	// Extracting characters as digits from last character 
+	for (int i = len - 1; i >= 0; i--)
+	{
+		// if character lies in '0'-'9', converting  
+		// it to integral 0-9 by subtracting 48 from 
+		// ASCII value. 
+		if (hexVal[i] >= '0' && hexVal[i] <= '9')
+		{
+			dec_val += (hexVal[i] - 48) * base;
+
+			// incrementing base by power 
+			base = base * 16;
+		}
+
+		// if character lies in 'A'-'F' , converting  
+		// it to integral 10 - 15 by subtracting 55  
+		// from ASCII value 
+		else if (hexVal[i] >= 'A' && hexVal[i] <= 'F')
+		{
+			dec_val += (hexVal[i] - 55) * base;
+
+			// incrementing base by power 
+			base = base * 16;
+		}
+		cont++;
+		if (cont == 4) {
+			writeData[write] = dec_val;
+			data[write] = dec_val;
+			write--;
+			cont = 0;
+			dec_val = 0;
+			base = 1;
+		}
+	}
+	//data = writeData;
+
+	return data;
+}
+
+void Int32ArrayMacToHost(
+	INT32U*         pBegin,
+	INT32U          numberInt32
+)
+{
+	for (; numberInt32; --numberInt32, ++pBegin)
+	{
+		*pBegin = MacToHost32(*pBegin);
+	}
+} /* Int32ArrayMacToHost */
+
+void Int16ArrayMacToHost(
+	INT16U*         pBegin,
+	INT32U          numberInt16
+)
+{
+	for (; numberInt16; --numberInt16, ++pBegin)
+	{
+		*pBegin = MacToHost16(*pBegin);
+	}
+} /* Int16ArrayMacToHost */
@@ -0,0 +1,51 @@
+#ifndef TAG_CODEC_H_
+
+#define TAG_CODEC_H_
+
+#include "rfid_library.h"
+#include "rfid_packets.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* The per-tag conversions between the MAC's packets and what the server    */
+/* sends.  They depend on nothing but the packet layouts, so that the       */
+/* kernel benchmark can build them without the library.                     */
+
+/* An M4 TID, when the MAC appends one, is 12 bytes after the CRC           */
+#define M4_TID_LENGTH           12
+#define INVENTORY_HAS_M4_TID(f) ((((f) >> 2) & 0x03) == 0x01)
+
+/* The bytes of PC, EPC, CRC and TID in an inventory packet, without the    */
+/* padding that rounds them up to whole 32-bit words                        */
+int inventoryDataLength(const RFID_PACKET_18K6C_INVENTORY* inv);
+
+/* The bytes of EPC in an inventory packet.  Not positive if the packet is  */
+/* too short to hold one.                                                   */
+int inventoryEpcLength(const RFID_PACKET_18K6C_INVENTORY* inv);
+
+/* Appends the bytes, as lower-case hex, to the string in buf, which must   */
+/* have room for 2 * length more characters                                 */
+void saveByteArray(const INT8U* bytes, int length, char* buf);
+
+/* Parses the 24 upper-case hex digits of a 96-bit EPC into 6 words         */
+int* hexadecimalToDecimal(char hexVal[], INT16U* data);
+
+void Int32ArrayMacToHost(
+	INT32U*         pBegin,
+	INT32U          numberInt32
+);
+
+void Int16ArrayMacToHost(
+	INT16U*         pBegin,
+	INT32U          numberInt16
+);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TAG_CODEC_H_ */
@@ -0,0 +1,438 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <WinSock2.h>
+#include "rfid_library.h"
+#include "throughput_benchmark.h"
+
+#ifdef _DEBUG
+#include <crtdbg.h>
+#endif
+
+
+/* The synthetic radios' EPCs are the tag number (8 hex digits) and the     */
+/* performance counter at which the MAC made the packet (16 hex digits)     */
+#define EPC_DIGITS              24
+
+#define RECEIVE_BUFFER_SIZE     8192
+
+typedef struct
+{
+	SOCKET      socket;
+	/* The latency, in microseconds, of each read received                  */
+	double*     latencies;
+	INT32U      capacity;
+	INT32U      count;
+} RECEIVER;
+
+/* What one tag population and response mode did                            */
+typedef struct
+{
+	INT32U  tags;
+	INT32U  reads;
+	double  seconds;
+	double  cpuPerTag;
+	double  allocationsPerTag;
+	double  p50;
+	double  p99;
+	double  p999;
+	double  max;
+} THROUGHPUT_CASE;
+
+static LARGE_INTEGER frequency;
+
+#ifdef _DEBUG
+/* The CRT's debug heap lets every allocation be counted (the library's     */
+/* too, as it shares the CRT); a release build reports none                 */
+static volatile LONG allocations;
+static _CRT_ALLOC_HOOK previousHook;
+
+static int countAllocation(int type, void* data, size_t size, int block, long request, const unsigned char* file, int line)
+{
+	RFID_UNREFERENCED_LOCAL(data);
+	RFID_UNREFERENCED_LOCAL(size);
+	RFID_UNREFERENCED_LOCAL(block);
+	RFID_UNREFERENCED_LOCAL(request);
+	RFID_UNREFERENCED_LOCAL(file);
+	RFID_UNREFERENCED_LOCAL(line);
+
+	if (type == _HOOK_ALLOC || type == _HOOK_REALLOC)
+	{
+		InterlockedIncrement(&allocations);
+	}
+	return TRUE;
+}
+#endif
+
+static LONGLONG processCpuTime(void)
+{
+	FILETIME creation, exit, kernel, user;
+	ULARGE_INTEGER k, u;
+
+	GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+	k.LowPart = kernel.dwLowDateTime;
+	k.HighPart = kernel.dwHighDateTime;
+	u.LowPart = user.dwLowDateTime;
+	u.HighPart = user.dwHighDateTime;
+	/* In 100 ns units                                                      */
+	return (LONGLONG)(k.QuadPart + u.QuadPart);
+}
+
+static void recordRead(RECEIVER* receiver, const char* frame, LONGLONG now)
+{
+	unsigned long tag;
+	unsigned long long made;
+
+	if (strlen(frame) < EPC_DIGITS ||
+		sscanf(frame, "%8lx%16llx", &tag, &made) != 2 ||
+		receiver->count == receiver->capacity)
+	{
+		return;
+	}
+	receiver->latencies[receiver->count++] =
+		(double)(now - (LONGLONG)made) * 1000000.0 / (double)frequency.QuadPart;
+}
+
+/* Reads the $...# frames the callback sends until the sender shuts down    */
+static DWORD WINAPI receiveReads(void* data)
+{
+	RECEIVER* receiver = (RECEIVER*)data;
+	char buffer[RECEIVE_BUFFER_SIZE];
+	char frame[64];
+	int frameLength = -1;
+	int received;
+	int index;
+	LARGE_INTEGER now;
+
+	while ((received = recv(receiver->socket, buffer, sizeof(buffer), 0)) > 0)
+	{
+		QueryPerformanceCounter(&now);
+		for (index = 0; index < received; ++index)
+		{
+			if (buffer[index] == '$')
+			{
+				frameLength = 0;
+			}
+			else if (buffer[index] == '#')
+			{
+				/* "$#" follows every packet and is not a read              */
+				if (frameLength > 0)
+				{
+					frame[frameLength] = '\0';
+					recordRead(receiver, frame, now.QuadPart);
+				}
+				frameLength = -1;
+			}
+			else if (frameLength >= 0 && frameLength < (int)sizeof(frame) - 1)
+			{
+				frame[frameLength++] = buffer[index];
+			}
+		}
+	}
+	return 0;
+}
+
+/* Connects two sockets through the loopback interface                      */
+static int connectLoopback(SOCKET* pSender, SOCKET* pReceiver)
+{
+	struct sockaddr_in address;
+	int size = sizeof(address);
+	SOCKET listener;
+
+	*pSender = INVALID_SOCKET;
+	*pReceiver = INVALID_SOCKET;
+	listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (listener == INVALID_SOCKET)
+	{
+		return 0;
+	}
+
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = 0;
+	if (bind(listener, (struct sockaddr*)&address, sizeof(address)) == 0 &&
+		listen(listener, 1) == 0 &&
+		getsockname(listener, (struct sockaddr*)&address, &size) == 0)
+	{
+		*pSender = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		if (*pSender != INVALID_SOCKET &&
+			connect(*pSender, (struct sockaddr*)&address, sizeof(address)) == 0)
+		{
+			*pReceiver = accept(listener, NULL, NULL);
+		}
+	}
+	closesocket(listener);
+
+	if (*pReceiver == INVALID_SOCKET)
+	{
+		if (*pSender != INVALID_SOCKET)
+		{
+			closesocket(*pSender);
+			*pSender = INVALID_SOCKET;
+		}
+		return 0;
+	}
+	return 1;
+}
+
+static int compareLatency(const void* a, const void* b)
+{
+	double difference = *(const double*)a - *(const double*)b;
+
+	return (difference < 0) ? -1 : (difference > 0) ? 1 : 0;
+}
+
+static double percentile(const double* sorted, INT32U count, double fraction)
+{
+	INT32U index = (INT32U)(fraction * count);
+
+	if (count == 0)
+	{
+		return 0.0;
+	}
+	return sorted[index < count ? index : count - 1];
+}
+
+/* Inventories the radio until at least the given number of reads has been  */
+/* made, every read going through the callback to a loopback socket         */
+static int runCase(RFID_RADIO_HANDLE handle, INT32U tags, INT32U reads, RFID_PACKET_CALLBACK_FUNCTION callback, void* context, SOCKET* pSocket, THROUGHPUT_CASE* pCase)
+{
+	RFID_18K6C_INVENTORY_PARMS inventoryParms;
+	RECEIVER receiver;
+	SOCKET sender;
+	HANDLE thread;
+	RFID_STATUS status = RFID_STATUS_OK;
+	LARGE_INTEGER start, end;
+	LONGLONG cpuStart;
+	LONG allocationsStart = 0;
+	INT32U rounds = (reads + tags - 1) / tags;
+	INT32U round;
+
+	memset(&receiver, 0, sizeof(receiver));
+	receiver.capacity = rounds * tags;
+	receiver.latencies = (double*)malloc(sizeof(double) * receiver.capacity);
+	if (receiver.latencies == NULL)
+	{
+		fprintf(stderr, "ERROR: Failed to allocate memory\n");
+		return 0;
+	}
+	if (!connectLoopback(&sender, &receiver.socket))
+	{
+		fprintf(stderr, "ERROR: Failed to connect loopback sockets (%d)\n",
+			WSAGetLastError());
+		free(receiver.latencies);
+		return 0;
+	}
+	thread = CreateThread(NULL, 0, receiveReads, &receiver, 0, NULL);
+	*pSocket = sender;
+
+	inventoryParms.length = sizeof(RFID_18K6C_INVENTORY_PARMS);
+	inventoryParms.common.tagStopCount = 0;
+	inventoryParms.common.pCallback = callback;
+	inventoryParms.common.pCallbackCode = NULL;
+	inventoryParms.common.context = context;
+
+	cpuStart = processCpuTime();
+#ifdef _DEBUG
+	allocationsStart = allocations;
+#endif
+	QueryPerformanceCounter(&start);
+	for (round = 0; round < rounds && status == RFID_STATUS_OK; ++round)
+	{
+		status = RFID_18K6CTagInventory(handle, &inventoryParms, 0);
+	}
+
+	/* The case ends when the last read has reached the receiver            */
+	shutdown(sender, SD_SEND);
+	WaitForSingleObject(thread, INFINITE);
+	QueryPerformanceCounter(&end);
+	CloseHandle(thread);
+	*pSocket = INVALID_SOCKET;
+	closesocket(sender);
+	closesocket(receiver.socket);
+
+	if (status != RFID_STATUS_OK)
+	{
+		fprintf(stderr, "ERROR: RFID_18K6CTagInventory returned 0x%.8x\n",
+			status);
+		free(receiver.latencies);
+		return 0;
+	}
+
+	qsort(receiver.latencies, receiver.count, sizeof(double), compareLatency);
+	pCase->tags = tags;
+	pCase->reads = receiver.count;
+	pCase->seconds = (double)(end.QuadPart - start.QuadPart) / (double)frequency.QuadPart;
+	pCase->cpuPerTag = receiver.count ?
+		(double)(processCpuTime() - cpuStart) / 10.0 / receiver.count : 0.0;
+#ifdef _DEBUG
+	pCase->allocationsPerTag = receiver.count ?
+		(double)(allocations - allocationsStart) / receiver.count : 0.0;
+#else
+	RFID_UNREFERENCED_LOCAL(allocationsStart);
+	pCase->allocationsPerTag = -1.0;
+#endif
+	pCase->p50 = percentile(receiver.latencies, receiver.count, 0.50);
+	pCase->p99 = percentile(receiver.latencies, receiver.count, 0.99);
+	pCase->p999 = percentile(receiver.latencies, receiver.count, 0.999);
+	pCase->max = receiver.count ? receiver.latencies[receiver.count - 1] : 0.0;
+	free(receiver.latencies);
+	return 1;
+}
+
+static void writeCase(FILE* output, const THROUGHPUT_CASE* pCase, const char* mode, int first)
+{
+	fprintf(output,
+		"%s\n    {\"tags\": %u, \"responseMode\": \"%s\", \"reads\": %u, "
+		"\"seconds\": %.6f, \"tagsPerSecond\": %.1f, "
+		"\"cpuMicrosecondsPerTag\": %.3f, ",
+		first ? "" : ",",
+		pCase->tags, mode, pCase->reads,
+		pCase->seconds,
+		pCase->seconds > 0 ? pCase->reads / pCase->seconds : 0.0,
+		pCase->cpuPerTag);
+	if (pCase->allocationsPerTag < 0)
+	{
+		fprintf(output, "\"allocationsPerTag\": null, ");
+	}
+	else
+	{
+		fprintf(output, "\"allocationsPerTag\": %.3f, ", pCase->allocationsPerTag);
+	}
+	fprintf(output,
+		"\"latencyMicroseconds\": {\"p50\": %.1f, \"p99\": %.1f, "
+		"\"p999\": %.1f, \"max\": %.1f}}",
+		pCase->p50, pCase->p99, pCase->p999, pCase->max);
+}
+
+/* The tag population of a synthetic radio, from its ID ("SYNTHETIC-<n>")   */
+static INT32U tagPopulation(const RFID_RADIO_INFO* pInfo)
+{
+	INT32U tags = 0;
+	INT32U index;
+
+	for (index = 0; index < pInfo->idLength; ++index)
+	{
+		if (pInfo->pUniqueId[index] >= '0' && pInfo->pUniqueId[index] <= '9')
+		{
+			tags = tags * 10 + (pInfo->pUniqueId[index] - '0');
+		}
+	}
+	return tags;
+}
+
+int benchmarkThroughput(RFID_PACKET_CALLBACK_FUNCTION callback, void* context, SOCKET* pSocket, INT32U reads, FILE* output)
+{
+	static const RFID_RESPONSE_MODE modes[] = { RFID_RESPONSE_MODE_COMPACT, RFID_RESPONSE_MODE_NORMAL };
+	static const char* modeNames[] = { "compact", "normal" };
+	WSADATA wsaData;
+	RFID_VERSION version;
+	RFID_RADIO_ENUM* pEnum;
+	RFID_RADIO_HANDLE handle;
+	RFID_STATUS status;
+	THROUGHPUT_CASE result;
+	INT32U radio;
+	int mode;
+	int first = 1;
+	int ok = 1;
+
+	QueryPerformanceFrequency(&frequency);
+	if (WSAStartup(MAKEWORD(2, 0), &wsaData) != 0)
+	{
+		fprintf(stderr, "ERROR: WSAStartup failed\n");
+		return 1;
+	}
+#ifdef _DEBUG
+	previousHook = _CrtSetAllocHook(countAllocation);
+#endif
+
+	status = RFID_Startup(&version, RFID_FLAG_SYNTHETIC_RADIOS);
+	if (RFID_STATUS_OK != status)
+	{
+		fprintf(stderr, "ERROR: RFID_Startup returned 0x%.8x\n", status);
+		WSACleanup();
+		return 1;
+	}
+
+	pEnum = (RFID_RADIO_ENUM*)malloc(sizeof(RFID_RADIO_ENUM));
+	if (pEnum == NULL)
+	{
+		fprintf(stderr, "ERROR: Failed to allocate memory\n");
+		RFID_Shutdown();
+		WSACleanup();
+		return 1;
+	}
+	pEnum->length = sizeof(RFID_RADIO_ENUM);
+	pEnum->totalLength = sizeof(RFID_RADIO_ENUM);
+	while (RFID_ERROR_BUFFER_TOO_SMALL ==
+		(status = RFID_RetrieveAttachedRadiosList(pEnum, 0)))
+	{
+		RFID_RADIO_ENUM* pNewEnum = (RFID_RADIO_ENUM*)realloc(pEnum, pEnum->totalLength);
+		if (pNewEnum == NULL)
+		{
+			break;
+		}
+		pEnum = pNewEnum;
+	}
+	if (RFID_STATUS_OK != status)
+	{
+		fprintf(stderr, "ERROR: RFID_RetrieveAttachedRadiosList returned 0x%.8x\n", status);
+		free(pEnum);
+		RFID_Shutdown();
+		WSACleanup();
+		return 1;
+	}
+
+	fprintf(output,
+		"{\n  \"benchmark\": \"r2000-throughput\",\n"
+		"  \"library\": \"%u.%u.%u.%u\",\n"
+		"  \"readsPerCase\": %u,\n"
+		"  \"cases\": [",
+		version.major, version.minor, version.maintenance, version.release,
+		reads);
+
+	for (radio = 0; radio < pEnum->countRadios && ok; ++radio)
+	{
+		INT32U tags = tagPopulation(pEnum->ppRadioInfo[radio]);
+
+		status = RFID_RadioOpen(pEnum->ppRadioInfo[radio]->cookie, &handle, 0);
+		if (RFID_STATUS_OK != status)
+		{
+			fprintf(stderr, "ERROR: RFID_RadioOpen returned 0x%.8x\n", status);
+			ok = 0;
+			break;
+		}
+		for (mode = 0; mode < 2 && ok; ++mode)
+		{
+			status = RFID_RadioSetResponseDataMode(handle, RFID_RESPONSE_TYPE_DATA, modes[mode]);
+			if (RFID_STATUS_OK != status)
+			{
+				fprintf(stderr, "ERROR: RFID_RadioSetResponseDataMode returned 0x%.8x\n", status);
+				ok = 0;
+			}
+			else if (runCase(handle, tags, reads, callback, context, pSocket, &result))
+			{
+				writeCase(output, &result, modeNames[mode], first);
+				first = 0;
+				fflush(output);
+			}
+			else
+			{
+				ok = 0;
+			}
+		}
+		RFID_RadioClose(handle);
+	}
+	fprintf(output, "\n  ]\n}\n");
+
+	free(pEnum);
+	RFID_Shutdown();
+#ifdef _DEBUG
+	_CrtSetAllocHook(previousHook);
+#endif
+	WSACleanup();
+	return ok ? 0 : 1;
+}
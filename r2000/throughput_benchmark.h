@@ -0,0 +1,20 @@
+#ifndef THROUGHPUT_BENCHMARK_H_
+
+#define THROUGHPUT_BENCHMARK_H_
+
+#include <stdio.h>
+#include <WinSock2.h>
+#include "rfid_library.h"
+
+
+/* The reads each case makes unless told otherwise                          */
+#define THROUGHPUT_DEFAULT_READS    100000
+
+/* Runs the reads of the library's synthetic radios through the tag         */
+/* callback and a loopback socket for each tag population and response mode */
+/* and writes the results to output as JSON.  The callback sends to the     */
+/* socket it finds in *pSocket.  Must be called before RFID_Startup.        */
+int benchmarkThroughput(RFID_PACKET_CALLBACK_FUNCTION callback, void* context, SOCKET* pSocket, INT32U reads, FILE* output);
+
+
+#endif /* THROUGHPUT_BENCHMARK_H_ */